@@ -0,0 +1,74 @@
+/** Read many small files into memory concurrently
+ *
+ *  @file
+ *  @date 10/18/26
+ *  @version 1.0
+ *  @copyright GNU Public License.
+ */
+#pragma once
+
+#include <string>
+#include <vector>
+
+namespace illumina { namespace interop { namespace io
+{
+    namespace detail
+    {
+        class batch_file_reader_impl;
+    }
+    /** Read a list of files in order while the following files are read ahead on a pool of threads
+     *
+     * At most thread_count files are read ahead of the file last returned by next, so memory is bounded by the
+     * size of the window rather than by the number of files. The caller decodes each file while the next ones are
+     * being read.
+     *
+     * @note pthreads are used if available, otherwise each file is read when it is requested
+     */
+    class batch_file_reader
+    {
+    public:
+        /** Constructor
+         *
+         * @param files names of the files to read
+         * @param thread_count number of threads, and number of files read ahead
+         */
+        batch_file_reader(const std::vector<std::string>& files, const size_t thread_count);
+        /** Destructor
+         *
+         * Stops the threads if not all files were read
+         */
+        ~batch_file_reader();
+
+    public:
+        /** Get the bytes of the next file
+         *
+         * @param buffer destination for the bytes of the file
+         * @return false if the file could not be opened, or there are no more files
+         */
+        bool next(std::vector<char>& buffer);
+
+    private:
+        batch_file_reader(const batch_file_reader&);
+        batch_file_reader& operator=(const batch_file_reader&);
+
+    private:
+        detail::batch_file_reader_impl* m_reader;
+    };
+    /** Read a list of files into memory
+     *
+     * Each file is opened, sized and read by one of a pool of threads, so on a network file system the latency of
+     * each file is overlapped with the others rather than paid one after another. On POSIX systems the size comes
+     * from the open file descriptor, so there is no separate lookup of the path.
+     *
+     * @note OpenMP is used if available, otherwise the files are read one at a time
+     *
+     * @param files names of the files to read
+     * @param buffers destination for the bytes of each file, in the same order as files
+     * @param exists destination flag for each file, 0 if the file could not be opened
+     * @param thread_count number of threads
+     */
+    void read_files(const std::vector<std::string>& files,
+                    std::vector< std::vector<char> >& buffers,
+                    std::vector<unsigned char>& exists,
+                    const size_t thread_count);
+}}}
@@ -0,0 +1,154 @@
+/** Read and write a run folder packed into a single bundle file
+ *
+ * A bundle holds the InterOp files and XML files of a run folder as named sections. The file starts with a table of
+ * contents that gives the offset and size of each section, and each section starts on a page boundary, so a
+ * bundle is read with a single open and a single memory map.
+ *
+ * Layout (all integers are little endian):
+ *  - magic: 8 bytes, "IOPBNDL1"
+ *  - version: 4 bytes
+ *  - section count: 4 bytes
+ *  - for each section: name length (4 bytes), name, offset (8 bytes), size (8 bytes)
+ *  - section data, each starting at a multiple of SECTION_ALIGNMENT
+ *
+ * Section names are paths relative to the run folder, always with '/' as the separator, e.g.
+ * "InterOp/ErrorMetricsOut.bin" or "InterOp/C1.1/ErrorMetricsOut.bin".
+ *
+ *  @file
+ *  @date 10/18/26
+ *  @version 1.0
+ *  @copyright GNU Public License.
+ */
+#pragma once
+
+#include <map>
+#include <string>
+#include <vector>
+#include "interop/util/cstdint.h"
+#include "interop/util/exception.h"
+#include "interop/io/stream_exceptions.h"
+
+namespace illumina { namespace interop { namespace io
+{
+    /** Normalize a section name to use '/' as the path separator
+     *
+     * @param name path relative to the run folder
+     * @return section name
+     */
+    std::string bundle_section_name(const std::string& name);
+
+    /** Collect sections and write them to a bundle file
+     */
+    class bundle_writer
+    {
+        struct section
+        {
+            std::string name;
+            std::string file_name;
+            std::string data;
+        };
+        typedef std::vector<section> section_vector_t;
+    public:
+        enum
+        {
+            /** Each section starts at a multiple of this number of bytes */
+            SECTION_ALIGNMENT=4096
+        };
+
+    public:
+        /** Add a section from memory
+         *
+         * @param name section name, a path relative to the run folder
+         * @param data bytes of the section
+         * @param size number of bytes
+         */
+        void add(const std::string& name, const char* data, const size_t size);
+        /** Add a section read from a file when the bundle is written
+         *
+         * @param name section name, a path relative to the run folder
+         * @param file_name name of the file to copy
+         */
+        void add_file(const std::string& name, const std::string& file_name);
+        /** Get the number of sections
+         *
+         * @return number of sections
+         */
+        size_t size()const
+        {
+            return m_sections.size();
+        }
+        /** Write all the sections to a bundle file
+         *
+         * @param file_name name of the bundle file
+         * @throw file_not_found_exception
+         * @throw bad_format_exception
+         */
+        void write(const std::string& file_name)const INTEROP_THROW_SPEC((file_not_found_exception,
+                                                                           bad_format_exception));
+
+    private:
+        section_vector_t m_sections;
+    };
+
+    /** Map a bundle file into memory and look up its sections by name
+     *
+     * @note On POSIX systems the file is memory mapped, otherwise it is read into memory
+     */
+    class bundle_reader
+    {
+        typedef std::pair< ::uint64_t, ::uint64_t > section_range_t;
+        typedef std::map<std::string, section_range_t> section_map_t;
+    public:
+        /** Constructor
+         */
+        bundle_reader();
+        /** Destructor
+         */
+        ~bundle_reader();
+
+    private:
+        bundle_reader(const bundle_reader&);
+        bundle_reader& operator=(const bundle_reader&);
+
+    public:
+        /** Open a bundle file and read the table of contents
+         *
+         * @param file_name name of the bundle file
+         * @throw file_not_found_exception
+         * @throw bad_format_exception
+         */
+        void open(const std::string& file_name) INTEROP_THROW_SPEC((file_not_found_exception, bad_format_exception));
+        /** Release the bundle file
+         */
+        void close();
+        /** Find a section by name
+         *
+         * The section data remains valid until the bundle is closed. The data is mapped read only, so it must not
+         * be modified.
+         *
+         * @param name section name, a path relative to the run folder
+         * @param data destination pointer to the first byte of the section
+         * @param size destination number of bytes in the section
+         * @return true if the section was found
+         */
+        bool find(const std::string& name, const char*& data, size_t& size)const;
+        /** Test if the bundle has a section
+         *
+         * @param name section name, a path relative to the run folder
+         * @return true if the section was found
+         */
+        bool contains(const std::string& name)const;
+        /** List the names of all the sections
+         *
+         * @param names destination section names
+         */
+        void list_sections(std::vector<std::string>& names)const;
+
+    private:
+        section_map_t m_sections;
+        char* m_data;
+        size_t m_size;
+        bool m_is_mapped;
+        std::vector<char> m_buffer;
+    };
+}}}
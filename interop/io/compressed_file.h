@@ -0,0 +1,115 @@
+/** Read gzip or zstd compressed InterOp files
+ *
+ * Support for each compression format is optional and depends on whether zlib or zstd was found when the library
+ * was built.
+ *
+ *  @file
+ *  @date 10/18/26
+ *  @version 1.0
+ *  @copyright GNU Public License.
+ */
+#pragma once
+
+#include <string>
+#include <streambuf>
+#include <vector>
+#include "interop/util/exception.h"
+#include "interop/io/stream_exceptions.h"
+
+namespace illumina { namespace interop { namespace io
+{
+    /** Test if files with the given compression extension can be read
+     *
+     * @param extension file extension, either ".gz" or ".zst"
+     * @return true if the library was built with support for the extension
+     */
+    bool is_compression_supported(const std::string& extension);
+    /** Find a compressed copy of a file
+     *
+     * The extensions ".gz" and ".zst" are checked in that order, but only if the library supports them.
+     *
+     * @param file_name name of the uncompressed file
+     * @return name of the compressed copy or an empty string if none was found
+     */
+    std::string find_compressed_file(const std::string& file_name);
+    namespace detail
+    {
+        class compressed_file_reader;
+    }
+    /** Stream buffer that decompresses a gzip or zstd file while it is read
+     *
+     * A producer thread reads the compressed file and decompresses it in chunks into a bounded queue, so decoding
+     * the records overlaps with reading and decompressing the file. The format is detected from the magic bytes at
+     * the start of the file. A gzip file made of BGZF members, or a zstd file made of frames with a known content
+     * size, decompresses the members of each chunk in parallel, one member or frame per thread.
+     *
+     * @note The producer thread requires pthreads, otherwise each chunk is decompressed when the stream needs it
+     */
+    class compressed_filebuf : public std::streambuf
+    {
+    public:
+        /** Constructor
+         *
+         * @param file_name name of the compressed file
+         * @param thread_count number of threads for BGZF members or zstd frames, 0 uses the OpenMP default
+         * @throw file_not_found_exception
+         * @throw bad_format_exception
+         */
+        compressed_filebuf(const std::string& file_name, const size_t thread_count=0)
+                                                                        INTEROP_THROW_SPEC((file_not_found_exception,
+                                                                                bad_format_exception));
+        /** Destructor
+         *
+         * Stops the producer thread if the stream was not read to the end
+         */
+        ~compressed_filebuf();
+
+    public:
+        /** Test if the compressed data was complete
+         *
+         * @note only valid once the stream has been read to the end
+         *
+         * @return false if the compressed data ended early
+         */
+        bool is_complete()const;
+        /** Get the error raised while decompressing
+         *
+         * @return error message or an empty string
+         */
+        const std::string& error()const;
+
+    protected:
+        /** Get the next chunk of decompressed data
+         *
+         * @return next character or eof
+         */
+        int_type underflow();
+
+    private:
+        compressed_filebuf(const compressed_filebuf&);
+        compressed_filebuf& operator=(const compressed_filebuf&);
+
+    private:
+        detail::compressed_file_reader* m_reader;
+        std::vector<char> m_chunk;
+        std::string m_error;
+    };
+    /** Decompress a gzip or zstd file into memory
+     *
+     * The format is detected from the magic bytes at the start of the file. A file that holds multiple gzip
+     * members with a BGZF block size, or multiple zstd frames with a known content size, is decompressed in
+     * parallel, one member or frame per thread.
+     *
+     * @note OpenMP is used if available, otherwise thread_count is ignored
+     *
+     * @param file_name name of the compressed file
+     * @param buffer destination for the decompressed bytes
+     * @param thread_count number of threads, 0 uses the OpenMP default
+     * @return false if the compressed data ended early, the bytes decompressed so far are kept
+     * @throw file_not_found_exception
+     * @throw bad_format_exception
+     */
+    bool read_compressed_file(const std::string& file_name, std::vector<char>& buffer, const size_t thread_count=0)
+                                                                        INTEROP_THROW_SPEC((file_not_found_exception,
+                                                                                bad_format_exception));
+}}}
@@ -11,6 +11,7 @@
 #include <iosfwd>
 #include "interop/util/cstdint.h"
 #include "interop/model/metric_base/metric_set.h"
+#include "interop/io/load_filter.h"
 
 namespace illumina { namespace interop { namespace io
 {
@@ -59,10 +60,12 @@ namespace illumina { namespace interop { namespace io
          * @param in input stream
          * @param metric_set destination set of metrics
          * @param file_size number of bytes in the file
+         * @param filter skip records that are not selected by the filter
          */
         virtual void read_metrics(std::istream& in,
                                   model::metric_base::metric_set<Metric>& metric_set,
-                                  const size_t file_size)=0;
+                                  const size_t file_size,
+                                  const load_filter& filter)=0;
         /** Read only the header of a metric set
          *
          * @param in input stream
@@ -70,6 +73,17 @@ namespace illumina { namespace interop { namespace io
          * @return number of bytes read
          */
         virtual size_t read_header(std::istream& in, model::metric_base::metric_set<Metric>& metric_set)=0;
+        /** Read the id of each record in a block without decoding the rest of the record
+         *
+         * @param header metric set header
+         * @param buffer first byte of the first record
+         * @param record_count number of records in the block
+         * @param ids destination for the id of each record, 0 for an invalid record
+         */
+        virtual void read_record_ids(const header_t& header,
+                                     const char* buffer,
+                                     const size_t record_count,
+                                     std::vector<id_t>& ids)=0;
 
         /** Write a metric record to the given output stream
          *
@@ -25,7 +25,9 @@ namespace illumina { namespace interop { namespace io
             /** Flag indicating whether metric is split into multiple records in the InterOp file */
             MULTI_RECORD=MultiRecord,
             /** Flag to indicate the format is no longer supported */
-            IS_DEPRECATED=Deprecated
+            IS_DEPRECATED=Deprecated,
+            /** Flag indicating whether the layout defines a packed record for fixed_record_decoder */
+            FIXED_RECORD=0
         };
         /** Define a record size type */
         typedef ::uint8_t record_size_t;
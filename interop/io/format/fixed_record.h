@@ -0,0 +1,77 @@
+/** Straight-line decoding of fixed-size binary InterOp records
+ *
+ *  @file
+ *  @date 10/18/26
+ *  @version 1.0
+ *  @copyright GNU Public License.
+ */
+#pragma once
+
+#include <cstring>
+#include <cstddef>
+#include "interop/io/load_filter.h"
+
+namespace illumina { namespace interop { namespace io
+{
+    /** Decode blocks of fixed-size records directly from a raw byte buffer
+     *
+     * A layout opts in by setting FIXED_RECORD to 1 and defining:
+     *  - `fixed_record_t`: a packed struct that mirrors the bytes of a record, starting with the layout id
+     *  - `decode(record, metric)`: copy every field of the packed record into a metric
+     *
+     * Each record is copied into the packed struct with a single `memcpy`, and then decoded without any per-field
+     * stream calls or size checks.
+     */
+    template<class Layout>
+    struct fixed_record_decoder
+    {
+        /** Define the packed record type */
+        typedef typename Layout::fixed_record_t record_t;
+        enum
+        {
+            /** Size of a record in bytes */
+            RECORD_SIZE = sizeof(record_t)
+        };
+
+        /** Decode a block of records into a metric set
+         *
+         * This follows the same rules as reading one record at a time: invalid records and records not selected
+         * by the filter are skipped, a repeated id overwrites the earlier record and skipped metrics are not added.
+         *
+         * @param buffer start of the first record
+         * @param record_count number of records in the buffer
+         * @param metric_set destination set of metrics
+         * @param metric_offset_map map from metric id to offset in the metric set
+         * @param metric scratch metric used to compute the id
+         * @param filter skip records that are not selected by the filter
+         */
+        template<class MetricSet, class OffsetMap, class Metric>
+        static void decode(const char* buffer,
+                           const size_t record_count,
+                           MetricSet& metric_set,
+                           OffsetMap& metric_offset_map,
+                           Metric& metric,
+                           const load_filter& filter)
+        {
+            record_t record;
+            for(size_t i=0;i<record_count;++i, buffer+=RECORD_SIZE)
+            {
+                std::memcpy(&record, buffer, RECORD_SIZE);
+                if(!Layout::is_valid(record.id) || !filter.is_selected(record.id)) continue;
+                metric.set_base(record.id);
+                typename OffsetMap::iterator it = metric_offset_map.find(metric.id());
+                if(it != metric_offset_map.end())
+                {
+                    Layout::decode(record, metric_set[it->second]);
+                    continue;
+                }
+                const size_t offset = metric_offset_map.size();
+                if(offset >= metric_set.size()) metric_set.resize(offset+1);
+                metric_set[offset].set_base(record.id);
+                Layout::decode(record, metric_set[offset]);
+                if(Layout::skip_metric(metric_set[offset])) metric_set.resize(offset);
+                else metric_offset_map[metric.id()] = offset;
+            }
+        }
+    };
+}}}
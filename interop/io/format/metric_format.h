@@ -12,9 +12,12 @@
 #endif
 
 
+#include <algorithm>
+#include <cstring>
 #include "interop/util/exception.h"
 #include "interop/io/format/abstract_metric_format.h"
 #include "interop/io/format/generic_layout.h"
+#include "interop/io/format/fixed_record.h"
 #include "interop/io/format/stream_util.h"
 
 namespace illumina { namespace interop { namespace io
@@ -83,22 +86,68 @@ namespace illumina { namespace interop { namespace io
             read_header_impl(in, metric_set);
             return static_cast<size_t>(in.tellg()-beg)+version_byte_size;
         }
+        /** Read the id of each record in a block without decoding the rest of the record
+         *
+         * @param header metric set header
+         * @param buffer first byte of the first record
+         * @param record_count number of records in the block
+         * @param ids destination for the id of each record, 0 for an invalid record
+         */
+        void read_record_ids(const header_t& header,
+                             const char* buffer,
+                             const size_t record_count,
+                             std::vector<id_t>& ids)
+        {
+            const size_t size = record_size(header);
+            metric_t metric(header);
+            ids.assign(record_count, 0);
+            for(size_t i=0;i<record_count;++i, buffer+=size)
+            {
+                metric_id_t id;
+                std::memcpy(&id, buffer, sizeof(metric_id_t));
+                if(!Layout::is_valid(id)) continue;
+                metric.set_base(id);
+                ids[i] = metric.id();
+            }
+        }
 
         /** Read all the metrics into a metric set
          *
          * @param in input stream
          * @param metric_set destination set of metrics
          * @param file_size size of the file
+         * @param filter skip records that are not selected by the filter
          */
-        void read_metrics(std::istream& in, metric_set_t& metric_set, const size_t file_size)
+        void read_metrics(std::istream& in, metric_set_t& metric_set, const size_t file_size, const load_filter& filter)
         {
             const std::streamsize record_size = read_header_impl(in, metric_set);
             offset_map_t& metric_offset_map = metric_set.offset_map();
             metric_t metric(metric_set);
+            const bool is_filtered = filter.is_active();
             if(file_size > 0 && !Layout::MULTI_RECORD)
             {
-                const size_t record_count = static_cast<size_t>((file_size-header_size(metric_set))/record_size);
-                metric_set.resize(metric_set.size()+record_count);
+                // The number of selected records is unknown when filtering, so the set grows as records are kept
+                if(!is_filtered)
+                {
+                    const size_t record_count = static_cast<size_t>((file_size-header_size(metric_set))/record_size);
+                    metric_set.resize(metric_set.size()+record_count);
+                }
+                // Files holding a whole number of records are decoded in blocks without per-record checks
+                const size_t trusted_record_count = exact_record_count(metric_set, file_size, record_size);
+                if(trusted_record_count > 0)
+                {
+                    read_trusted_records(in, metric_set, metric, record_size, trusted_record_count, filter);
+                }
+                if(read_fixed_records(in,
+                                      metric_set,
+                                      metric,
+                                      record_size,
+                                      filter,
+                                      int_constant_type<Layout::FIXED_RECORD>::null()))
+                {
+                    metric_set.trim(metric_offset_map.size());
+                    return;
+                }
                 std::vector<char> buffer(static_cast<size_t>(record_size));
                 INTEROP_ASSERT(!buffer.empty());
                 while (in)
@@ -108,8 +157,8 @@ namespace illumina { namespace interop { namespace io
                     const std::streamsize count = in.gcount();
                     try
                     {
-                        if (!test_stream(in, metric_offset_map, count, record_size)) break;
-                        read_record(in_ptr, metric_set, metric_offset_map, metric, record_size);
+                        if (!test_stream(in, metric_offset_map, count, record_size, is_filtered)) break;
+                        read_record(in_ptr, metric_set, metric_offset_map, metric, record_size, filter);
                     }
                     catch(const incomplete_file_exception& ex)
                     {
@@ -122,7 +171,7 @@ namespace illumina { namespace interop { namespace io
             {
                 while (in)
                 {
-                    read_record(in, metric_set, metric_offset_map, metric, record_size);
+                    read_record(in, metric_set, metric_offset_map, metric, record_size, filter);
                 }
             }
             metric_set.trim(metric_offset_map.size());
@@ -229,6 +278,8 @@ namespace illumina { namespace interop { namespace io
     private:
         typedef typename int_constant_type<0>::pointer_t is_single_record_t;
         typedef typename int_constant_type<1>::pointer_t is_multi_record_t;
+        typedef typename int_constant_type<0>::pointer_t is_variable_record_t;
+        typedef typename int_constant_type<1>::pointer_t is_fixed_record_t;
         size_t buffer_size(const model::metric_base::metric_set<Metric>& metric_set, is_single_record_t)const
         {
             return header_size(metric_set) + record_size(metric_set)*metric_set.size();
@@ -239,14 +290,151 @@ namespace illumina { namespace interop { namespace io
         }
 
     private:
+        enum
+        {
+            /** Number of records read from the stream at one time */
+            BLOCK_RECORD_COUNT = 4096
+        };
+        size_t exact_record_count(const header_t& header, const size_t file_size, const std::streamsize record_size)const
+        {
+            const size_t header_byte_count = header_size(header);
+            if(file_size <= header_byte_count) return 0;
+            const size_t payload_size = file_size - header_byte_count;
+            if(payload_size % static_cast<size_t>(record_size) != 0) return 0;
+            return payload_size / static_cast<size_t>(record_size);
+        }
+        static void read_trusted_records(std::istream& in,
+                                         metric_set_t& metric_set,
+                                         metric_t& metric,
+                                         const std::streamsize record_size,
+                                         size_t record_count,
+                                         const load_filter& filter)
+        {
+            offset_map_t& metric_offset_map = metric_set.offset_map();
+            const size_t block_record_count = std::min(record_count, static_cast<size_t>(BLOCK_RECORD_COUNT));
+            std::vector<char> buffer(static_cast<size_t>(record_size)*block_record_count);
+            while (record_count > 0)
+            {
+                const size_t n = std::min(record_count, block_record_count);
+                in.read(&buffer.front(), static_cast<std::streamsize>(n)*record_size);
+                const std::streamsize count = in.gcount();
+                decode_block(&buffer.front(),
+                             static_cast<size_t>(count/record_size),
+                             metric_set,
+                             metric_offset_map,
+                             metric,
+                             record_size,
+                             filter,
+                             int_constant_type<Layout::FIXED_RECORD>::null());
+                // The stream was shorter than the file size
+                if(in.fail())
+                {
+                    test_last_block(in, metric_set, count, record_size, filter.is_active());
+                    return;
+                }
+                record_count -= n;
+            }
+        }
+        static void decode_block(char* buffer,
+                                 const size_t record_count,
+                                 metric_set_t& metric_set,
+                                 offset_map_t& metric_offset_map,
+                                 metric_t& metric,
+                                 const std::streamsize record_size,
+                                 const load_filter& filter,
+                                 is_variable_record_t)
+        {
+            for(size_t i=0;i<record_count;++i, buffer+=record_size)
+            {
+                char* in_ptr = buffer;
+                // The first record of each block keeps the record size check
+                read_record(in_ptr, metric_set, metric_offset_map, metric, record_size, filter, i > 0);
+            }
+        }
+        static void decode_block(char* buffer,
+                                 const size_t record_count,
+                                 metric_set_t& metric_set,
+                                 offset_map_t& metric_offset_map,
+                                 metric_t& metric,
+                                 const std::streamsize record_size,
+                                 const load_filter& filter,
+                                 is_fixed_record_t)
+        {
+            typedef fixed_record_decoder<Layout> decoder_t;
+            if(record_size == static_cast<std::streamsize>(decoder_t::RECORD_SIZE))
+                decoder_t::decode(buffer, record_count, metric_set, metric_offset_map, metric, filter);
+            else
+                decode_block(buffer,
+                             record_count,
+                             metric_set,
+                             metric_offset_map,
+                             metric,
+                             record_size,
+                             filter,
+                             int_constant_type<0>::null());
+        }
+        static bool read_fixed_records(std::istream&,
+                                       metric_set_t&,
+                                       metric_t&,
+                                       const std::streamsize,
+                                       const load_filter&,
+                                       is_variable_record_t)
+        {
+            return false;
+        }
+        static bool read_fixed_records(std::istream& in,
+                                       metric_set_t& metric_set,
+                                       metric_t& metric,
+                                       const std::streamsize record_size,
+                                       const load_filter& filter,
+                                       is_fixed_record_t)
+        {
+            typedef fixed_record_decoder<Layout> decoder_t;
+            // The record size in the file may be larger than the packed record, e.g. newer files with extra fields
+            if(record_size != static_cast<std::streamsize>(decoder_t::RECORD_SIZE)) return false;
+            offset_map_t& metric_offset_map = metric_set.offset_map();
+            std::vector<char> buffer(static_cast<size_t>(record_size)*BLOCK_RECORD_COUNT);
+            while (in)
+            {
+                in.read(&buffer.front(), static_cast<std::streamsize>(buffer.size()));
+                const std::streamsize count = in.gcount();
+                decoder_t::decode(&buffer.front(),
+                                  static_cast<size_t>(count/record_size),
+                                  metric_set,
+                                  metric_offset_map,
+                                  metric,
+                                  filter);
+                if(in.fail()) test_last_block(in, metric_set, count, record_size, filter.is_active());
+            }
+            return true;
+        }
+        static void test_last_block(std::istream& in,
+                                    metric_set_t& metric_set,
+                                    const std::streamsize count,
+                                    const std::streamsize record_size,
+                                    const bool is_filtered)
+        {
+            try
+            {
+                // Only a partial trailing record is left over, or nothing at all
+                test_stream(in, metric_set.offset_map(), count%record_size, record_size, is_filtered);
+            }
+            catch(const incomplete_file_exception& ex)
+            {
+                metric_set.trim(metric_set.offset_map().size());
+                throw ex;
+            }
+        }
         static bool test_stream(std::istream& in,
                          const offset_map_t& metric_offset_map,
                          const std::streamsize count,
-                         const std::streamsize record_size)
+                         const std::streamsize record_size,
+                         const bool is_filtered=false)
         {
             if (in.fail())
             {
-                if (count == 0 && !metric_offset_map.empty()) return false;
+                // A filter may legitimately skip every record in the file
+                if (count == 0 && (!metric_offset_map.empty() || is_filtered)) return false;
                 INTEROP_THROW(incomplete_file_exception, "Insufficient data read from the file, got: " << count
                                                          << " != expected: " << record_size << " for "
                                                          << Metric::prefix() <<  " "  << Metric::suffix()  <<  " v"
@@ -254,20 +442,63 @@ namespace illumina { namespace interop { namespace io
             }
             return true;
         }
-        static bool test_stream(const char*, const offset_map_t&, const std::streamsize, const std::streamsize)
+        static bool test_stream(const char*,
+                                const offset_map_t&,
+                                const std::streamsize,
+                                const std::streamsize,
+                                const bool=false)
         {return true;}
+        static std::streamsize skip_bytes(std::istream& in, const std::streamsize byte_count)
+        {
+            in.ignore(byte_count);
+            return in.gcount();
+        }
+        static std::streamsize skip_bytes(char*& in, const std::streamsize byte_count)
+        {
+            in += byte_count;
+            return byte_count;
+        }
+        template<typename InputStream>
+        static std::streamsize skip_record(InputStream& in,
+                                           metric_t&,
+                                           model::metric_base::metric_set<Metric>&,
+                                           const std::streamsize byte_count,
+                                           is_single_record_t)
+        {
+            return skip_bytes(in, byte_count);
+        }
+        template<typename InputStream>
+        static std::streamsize skip_record(InputStream& in,
+                                           metric_t& metric,
+                                           model::metric_base::metric_set<Metric>& metric_set,
+                                           const std::streamsize,
+                                           is_multi_record_t)
+        {
+            // Multi-record layouts may have variable length records, parse into a scratch metric
+            return Layout::map_stream(in, metric, metric_set, true);
+        }
         template<typename InputStream>
         static void read_record(InputStream& in,
                                 model::metric_base::metric_set<Metric>& metric_set,
                                 offset_map_t& metric_offset_map,
                                 metric_t& metric,
-                                const std::streamsize record_size)
+                                const std::streamsize record_size,
+                                const load_filter& filter,
+                                const bool is_trusted=false)
         {
             metric_id_t id;
             const std::streamsize read_byte_count = read_binary_with_count (in, id);
-            if(!test_stream(in, metric_offset_map, read_byte_count, record_size)) return;
+            if(!test_stream(in, metric_offset_map, read_byte_count, record_size, filter.is_active())) return;
             std::streamsize count=read_byte_count;
-            if (Layout::is_valid(id))
+            if (Layout::is_valid(id) && !filter.is_selected(id))
+            {
+                count += skip_record(in,
+                                     metric,
+                                     metric_set,
+                                     record_size-read_byte_count,
+                                     int_constant_type<Layout::MULTI_RECORD>::null());
+            }
+            else if (Layout::is_valid(id))
                 // TODO: Refactor tile metrics to move record type into layout id, then we can remove skip_metric,
                 // simplifiy all this logic
             {
@@ -298,6 +529,10 @@ namespace illumina { namespace interop { namespace io
                 count += Layout::map_stream(in, metric, metric_set, true);
                 //TODO: replace with skip function, simplify code, required for index metrics
             }
+            // The caller already checked the file holds a whole number of records, and the first record of the
+            // block passed the size check below
+            INTEROP_ASSERT(count == record_size);
+            if(is_trusted) return;
             if(!test_stream(in, metric_offset_map, count, record_size)) return;
             if (count != record_size)
             {
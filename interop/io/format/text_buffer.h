@@ -0,0 +1,241 @@
+/** Buffered text output for writing InterOp metrics in a text format
+ *
+ *  @file
+ *  @date 10/18/26
+ *  @version 1.0
+ *  @copyright GNU Public License.
+ */
+#pragma once
+
+#include <ostream>
+#include <locale>
+#include <vector>
+#include <cstdio>
+#include <algorithm>
+#include "interop/util/math.h"
+
+namespace illumina { namespace interop { namespace io
+{
+    /** Number formatting facet that writes numbers directly to the output
+     *
+     * The default facet converts every number through the locale machinery. This facet formats integers itself,
+     * and formats floating point numbers with a single `snprintf` using the precision of the stream. The output
+     * matches the classic "C" locale. Any formatting flag other than the defaults falls back to the default facet.
+     */
+    class fast_num_put : public std::num_put<char>
+    {
+    public:
+        /** Constructor
+         *
+         * @param refs reference count passed to std::locale::facet
+         */
+        explicit fast_num_put(const size_t refs=0) : std::num_put<char>(refs)
+        {
+        }
+
+    protected:
+        /** Write a signed integer
+         *
+         * @param out output iterator
+         * @param str stream holding the formatting flags
+         * @param fill fill character
+         * @param val value to write
+         * @return output iterator
+         */
+        iter_type do_put(iter_type out, std::ios_base& str, char_type fill, long val)const
+        {
+            if(!is_default_integer_format(str)) return std::num_put<char>::do_put(out, str, fill, val);
+            const unsigned long magnitude = val < 0 ? 0ul - static_cast<unsigned long>(val) :
+                                            static_cast<unsigned long>(val);
+            return write_integer(out, magnitude, val < 0);
+        }
+        /** Write an unsigned integer
+         *
+         * @param out output iterator
+         * @param str stream holding the formatting flags
+         * @param fill fill character
+         * @param val value to write
+         * @return output iterator
+         */
+        iter_type do_put(iter_type out, std::ios_base& str, char_type fill, unsigned long val)const
+        {
+            if(!is_default_integer_format(str)) return std::num_put<char>::do_put(out, str, fill, val);
+            return write_integer(out, val, false);
+        }
+        /** Write a floating point number
+         *
+         * @note float values are promoted to double by the output stream
+         *
+         * @param out output iterator
+         * @param str stream holding the formatting flags
+         * @param fill fill character
+         * @param val value to write
+         * @return output iterator
+         */
+        iter_type do_put(iter_type out, std::ios_base& str, char_type fill, double val)const
+        {
+            const std::ios_base::fmtflags unsupported = std::ios_base::floatfield | std::ios_base::showpos |
+                                                        std::ios_base::showpoint | std::ios_base::uppercase;
+            if(str.width() != 0 || (str.flags() & unsupported) != 0 || std::isnan(val) || std::isinf(val))
+                return std::num_put<char>::do_put(out, str, fill, val);
+            char buffer[64];
+            const int precision = str.precision() < 0 ? 6 : static_cast<int>(std::min<std::streamsize>(str.precision(), 40));
+            const int length = ::snprintf(buffer, sizeof(buffer), "%.*g", precision, val);
+            if(length <= 0 || length >= static_cast<int>(sizeof(buffer)))
+                return std::num_put<char>::do_put(out, str, fill, val);
+            return std::copy(buffer, buffer+length, out);
+        }
+
+    private:
+        static bool is_default_integer_format(const std::ios_base& str)
+        {
+            const std::ios_base::fmtflags base = str.flags() & std::ios_base::basefield;
+            return str.width() == 0 &&
+                   (base == std::ios_base::dec || base == 0) &&
+                   (str.flags() & (std::ios_base::showpos | std::ios_base::showbase)) == 0;
+        }
+        static iter_type write_integer(iter_type out, unsigned long val, const bool negative)
+        {
+            char buffer[32];
+            char* end = buffer+sizeof(buffer);
+            char* beg = end;
+            do
+            {
+                *--beg = static_cast<char>('0' + val % 10);
+                val /= 10;
+            } while(val != 0);
+            if(negative) *--beg = '-';
+            return std::copy(beg, end, out);
+        }
+    };
+
+    /** Growable character buffer for an output stream
+     *
+     * The buffer keeps its memory when cleared, so a single buffer can format many blocks of records.
+     */
+    class text_buffer : public std::streambuf
+    {
+    public:
+        /** Constructor
+         *
+         * @param capacity initial capacity in bytes
+         */
+        explicit text_buffer(const size_t capacity=1u << 20) : m_buffer(std::max<size_t>(capacity, 64))
+        {
+            clear();
+        }
+
+    public:
+        /** Discard the buffered text, but keep the memory
+         */
+        void clear()
+        {
+            setp(&m_buffer[0], &m_buffer[0]+m_buffer.size());
+        }
+        /** Get the start of the buffered text
+         *
+         * @return pointer to first character
+         */
+        const char* data()const
+        {
+            return pbase();
+        }
+        /** Get the number of buffered characters
+         *
+         * @return number of characters
+         */
+        size_t size()const
+        {
+            return static_cast<size_t>(pptr()-pbase());
+        }
+        /** Write the buffered text to an output stream and clear the buffer
+         *
+         * @param out destination stream
+         */
+        void flush_to(std::ostream& out)
+        {
+            out.write(data(), static_cast<std::streamsize>(size()));
+            clear();
+        }
+
+    protected:
+        /** Grow the buffer when it is full
+         *
+         * @param ch character that did not fit
+         * @return the character or eof
+         */
+        int_type overflow(int_type ch)
+        {
+            if(traits_type::eq_int_type(ch, traits_type::eof())) return traits_type::not_eof(ch);
+            const size_t used = size();
+            m_buffer.resize(m_buffer.size()*2);
+            setp(&m_buffer[0], &m_buffer[0]+m_buffer.size());
+            pbump(static_cast<int>(used));
+            *pptr() = traits_type::to_char_type(ch);
+            pbump(1);
+            return ch;
+        }
+        /** Write a sequence of characters, growing the buffer once if needed
+         *
+         * @param s characters to write
+         * @param n number of characters
+         * @return number of characters written
+         */
+        std::streamsize xsputn(const char_type* s, std::streamsize n)
+        {
+            const size_t count = static_cast<size_t>(n);
+            if(static_cast<size_t>(epptr()-pptr()) < count)
+            {
+                const size_t used = size();
+                m_buffer.resize(std::max(m_buffer.size()*2, used+count));
+                setp(&m_buffer[0], &m_buffer[0]+m_buffer.size());
+                pbump(static_cast<int>(used));
+            }
+            std::copy(s, s+count, pptr());
+            pbump(static_cast<int>(count));
+            return n;
+        }
+
+    private:
+        std::vector<char> m_buffer;
+    };
+
+    /** Output stream that formats text into a text_buffer using fast_num_put
+     */
+    class text_buffer_stream : public std::ostream
+    {
+    public:
+        /** Constructor
+         *
+         * @param capacity initial capacity of the buffer in bytes
+         */
+        explicit text_buffer_stream(const size_t capacity=1u << 20) : std::ostream(0), m_buffer(capacity)
+        {
+            rdbuf(&m_buffer);
+            imbue(std::locale(std::locale::classic(), new fast_num_put));
+        }
+
+    public:
+        /** Copy the formatting state, except the locale, from another stream
+         *
+         * @param other stream to copy the precision, width and flags from
+         */
+        void copy_format(const std::ostream& other)
+        {
+            flags(other.flags());
+            precision(other.precision());
+            width(other.width());
+        }
+        /** Get the text buffer
+         *
+         * @return text buffer
+         */
+        text_buffer& buffer()
+        {
+            return m_buffer;
+        }
+
+    private:
+        text_buffer m_buffer;
+    };
+}}}
@@ -0,0 +1,219 @@
+/** Filter records while reading binary InterOp files
+ *
+ * The filter is applied to each record after the record identifier is parsed, and before the
+ * remainder of the record is decoded or stored.
+ *
+ *  @file
+ *  @date 10/18/26
+ *  @version 1.0
+ *  @copyright GNU Public License.
+ */
+#pragma once
+
+#include <vector>
+#include <algorithm>
+#include "interop/util/cstdint.h"
+#include "interop/constants/enums.h"
+#include "interop/constants/typedefs.h"
+#include "interop/io/layout/base_metric.h"
+#include "interop/model/metric_base/base_metric.h"
+
+namespace illumina { namespace interop { namespace io
+{
+    /** Select a subset of lanes, tiles and cycles to load from binary InterOp files
+     *
+     * An empty selection loads everything. Records that describe a whole lane (tile number 0), e.g.
+     * q-metrics by lane, are kept when the lane is selected.
+     */
+    class load_filter
+    {
+    public:
+        /** Define an unsigned integer type */
+        typedef ::uint32_t uint_t;
+        /** Define a list of unsigned integers */
+        typedef std::vector<uint_t> uint_vector_t;
+
+    public:
+        /** Constructor
+         *
+         * @param lanes selected lanes
+         * @param first_cycle first cycle to load (0 means no limit)
+         * @param last_cycle last cycle to load (0 means no limit)
+         */
+        load_filter(const uint_vector_t& lanes=uint_vector_t(),
+                    const uint_t first_cycle=0,
+                    const uint_t last_cycle=0) :
+                m_first_cycle(first_cycle),
+                m_last_cycle(last_cycle),
+                m_naming_method(constants::UnknownTileNamingMethod)
+        {
+            this->lanes(lanes);
+        }
+
+    public:
+        /** Set the lanes to load
+         *
+         * @param lanes selected lanes
+         */
+        void lanes(const uint_vector_t& lanes)
+        {
+            m_lanes.clear();
+            for(uint_vector_t::const_iterator it = lanes.begin();it != lanes.end();++it)
+            {
+                if(*it >= m_lanes.size()) m_lanes.resize(*it+1, 0);
+                m_lanes[*it] = 1;
+            }
+        }
+        /** Set the tiles to load
+         *
+         * @param tiles selected tile numbers
+         */
+        void tiles(const uint_vector_t& tiles)
+        {
+            m_tiles = tiles;
+            std::sort(m_tiles.begin(), m_tiles.end());
+            m_tiles.erase(std::unique(m_tiles.begin(), m_tiles.end()), m_tiles.end());
+        }
+        /** Set the surface to load
+         *
+         * @param surface selected surface (0 loads all surfaces)
+         * @param naming_method tile naming method used to determine the surface from the tile number
+         */
+        void surface(const uint_t surface, const constants::tile_naming_method naming_method)
+        {
+            m_surfaces.clear();
+            if(surface > 0) m_surfaces.push_back(surface);
+            m_naming_method = naming_method;
+        }
+        /** Set the range of cycles to load
+         *
+         * @param first_cycle first cycle to load (0 means no limit)
+         * @param last_cycle last cycle to load (0 means no limit)
+         */
+        void cycle_range(const uint_t first_cycle, const uint_t last_cycle)
+        {
+            m_first_cycle = first_cycle;
+            m_last_cycle = last_cycle;
+        }
+
+    public:
+        /** Get the first cycle to load
+         *
+         * @return first cycle to load (0 means no limit)
+         */
+        uint_t first_cycle()const
+        {
+            return m_first_cycle;
+        }
+        /** Get the last cycle to load
+         *
+         * @return last cycle to load (0 means no limit)
+         */
+        uint_t last_cycle()const
+        {
+            return m_last_cycle;
+        }
+        /** Test if the filter selects a subset of the records
+         *
+         * @return true if any lane, tile, surface or cycle restriction is set
+         */
+        bool is_active()const
+        {
+            return !m_lanes.empty() || !m_tiles.empty() || !m_surfaces.empty() || m_first_cycle > 0 ||
+                   m_last_cycle > 0;
+        }
+        /** Test if a lane is selected
+         *
+         * @param lane lane number
+         * @return true if lane should be loaded
+         */
+        bool is_lane_selected(const uint_t lane)const
+        {
+            return m_lanes.empty() || (lane < m_lanes.size() && m_lanes[lane] != 0);
+        }
+        /** Test if a tile is selected
+         *
+         * @note records with tile number 0 describe the whole lane and are always selected
+         *
+         * @param tile tile number
+         * @return true if tile should be loaded
+         */
+        bool is_tile_selected(const uint_t tile)const
+        {
+            if(tile == 0) return true;
+            if(!m_tiles.empty() && !std::binary_search(m_tiles.begin(), m_tiles.end(), tile)) return false;
+            if(m_surfaces.empty()) return true;
+            const uint_t surface = model::metric_base::base_metric(1, tile).surface(m_naming_method);
+            return std::find(m_surfaces.begin(), m_surfaces.end(), surface) != m_surfaces.end();
+        }
+        /** Test if a cycle is selected
+         *
+         * @param cycle cycle number
+         * @return true if cycle should be loaded
+         */
+        bool is_cycle_selected(const size_t cycle)const
+        {
+            return (m_first_cycle == 0 || cycle >= m_first_cycle) && (m_last_cycle == 0 || cycle <= m_last_cycle);
+        }
+        /** Test if a per cycle file, e.g. C1.1, from a by cycle run folder should be loaded
+         *
+         * Only metrics with a cycle identifier are skipped, other metrics may hold cumulative data.
+         *
+         * @param cycle cycle number
+         * @return true if the file should be loaded
+         */
+        template<class MetricSet>
+        bool is_cycle_file_selected(const size_t cycle)const
+        {
+            return is_cycle_file_selected(cycle, MetricSet::base_t::null());
+        }
+        /** Test if the record identified by the layout id should be loaded
+         *
+         * @param id layout id for a tile record
+         * @return true if the record should be loaded
+         */
+        template<class T>
+        bool is_selected(const layout::base_metric<T>& id)const
+        {
+            return is_lane_selected(id.lane) && is_tile_selected(id.tile);
+        }
+        /** Test if the record identified by the layout id should be loaded
+         *
+         * @param id layout id for a tile record
+         * @return true if the record should be loaded
+         */
+        template<class T>
+        bool is_selected(const layout::base_read_metric<T>& id)const
+        {
+            return is_lane_selected(id.lane) && is_tile_selected(id.tile);
+        }
+        /** Test if the record identified by the layout id should be loaded
+         *
+         * @param id layout id for a cycle record
+         * @return true if the record should be loaded
+         */
+        template<class T>
+        bool is_selected(const layout::base_cycle_metric<T>& id)const
+        {
+            return is_cycle_selected(id.cycle) && is_lane_selected(id.lane) && is_tile_selected(id.tile);
+        }
+
+    private:
+        bool is_cycle_file_selected(const size_t cycle, const constants::base_cycle_t*)const
+        {
+            return is_cycle_selected(cycle);
+        }
+        bool is_cycle_file_selected(const size_t, const void*)const
+        {
+            return true;
+        }
+
+    private:
+        std::vector<unsigned char> m_lanes;
+        uint_vector_t m_tiles;
+        uint_vector_t m_surfaces;
+        uint_t m_first_cycle;
+        uint_t m_last_cycle;
+        constants::tile_naming_method m_naming_method;
+    };
+}}}
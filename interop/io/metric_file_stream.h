@@ -11,6 +11,8 @@
 #include "interop/util/exception.h"
 #include "interop/util/filesystem.h"
 #include "interop/io/format/stream_membuf.h"
+#include "interop/io/compressed_file.h"
+#include "interop/io/batch_file_reader.h"
 #include "interop/io/metric_stream.h"
 #include "interop/model/metric_base/metric_exceptions.h"
 
@@ -108,6 +110,47 @@ namespace illumina { namespace interop { namespace io
         std::istringstream in(buffer);
         return read_header(in, metrics);
     }
+    namespace detail
+    {
+        /** Read a gzip or zstd compressed copy of a binary InterOp file into the given metric set
+         *
+         * The records are decoded from a stream that is decompressed by a producer thread, so decoding overlaps
+         * with decompression. The decompressed size is not known up front, so each record is read from the stream.
+         *
+         * @param file_name name of the uncompressed InterOp file
+         * @param metrics metric set
+         * @param rebuild flag indicating whether to rebuild the lookup table
+         * @param filter skip records that are not selected by the filter
+         * @return true if a compressed copy of the file was found
+         * @throw bad_format_exception
+         * @throw incomplete_file_exception
+         */
+        template<class MetricSet>
+        bool read_compressed_interop(const std::string& file_name,
+                                     MetricSet& metrics,
+                                     const bool rebuild,
+                                     const load_filter& filter)
+        {
+            const std::string compressed_file_name = find_compressed_file(file_name);
+            if(compressed_file_name == "") return false;
+            compressed_filebuf sbuf(compressed_file_name);
+            std::istream in(&sbuf);
+            try
+            {
+                read_metrics(in, metrics, 0, rebuild, filter);
+            }
+            catch(const incomplete_file_exception&)
+            {
+                // The stream ended early because the compressed data is corrupt
+                if(sbuf.error() != "") INTEROP_THROW(bad_format_exception, sbuf.error());
+                throw;
+            }
+            if(sbuf.error() != "") INTEROP_THROW(bad_format_exception, sbuf.error());
+            if(!sbuf.is_complete())
+                INTEROP_THROW(incomplete_file_exception, "Compressed file ended early: " << compressed_file_name);
+            return true;
+        }
+    }
     /** Read the binary InterOp file into the given metric set
      *
      * @snippet src/examples/example1.cpp Reading a binary InterOp file
@@ -146,9 +189,57 @@ namespace illumina { namespace interop { namespace io
             file_name = interop_filename<MetricSet>(run_directory, !use_out);
             fin.open(file_name.c_str(), std::ios::binary);
         }
-        if(!fin.good()) INTEROP_THROW(file_not_found_exception, "File not found: " << file_name);
+        if(!fin.good())
+        {
+            const std::string preferred_file_name = interop_filename<MetricSet>(run_directory, use_out);
+            if(detail::read_compressed_interop(preferred_file_name, metrics, true, load_filter())) return;
+            if(detail::read_compressed_interop(file_name, metrics, true, load_filter())) return;
+            INTEROP_THROW(file_not_found_exception, "File not found: " << file_name);
+        }
         read_metrics(fin, metrics, static_cast<size_t>(file_size(file_name)));
     }
+    /** Read a subset of the binary InterOp file into the given metric set
+     *
+     * Records outside the lanes, tiles or cycles selected by the filter are skipped as soon as their identifier is
+     * read.
+     *
+     * @note The 'Out' suffix (parameter: use_out) is appended when we read the file. We excluded the Out in certain
+     * conditions when writing the file.
+     *
+     * @param run_directory file path to the run directory
+     * @param metrics metric set
+     * @param filter select the lanes, tiles and cycles to load
+     * @param use_out use the copied version
+     * @throw file_not_found_exception
+     * @throw bad_format_exception
+     * @throw incomplete_file_exception
+     */
+    template<class MetricSet>
+    void read_interop(const std::string& run_directory,
+                      MetricSet& metrics,
+                      const load_filter& filter,
+                      const bool use_out=true)   INTEROP_THROW_SPEC(
+                                                                        (   io::file_not_found_exception,
+                                                                            io::bad_format_exception,
+                                                                            io::incomplete_file_exception,
+                                                                            model::index_out_of_bounds_exception))
+    {
+        std::string file_name = interop_filename<MetricSet>(run_directory, use_out);
+        std::ifstream fin(file_name.c_str(), std::ios::binary);
+        if(!fin.good())
+        {
+            file_name = interop_filename<MetricSet>(run_directory, !use_out);
+            fin.open(file_name.c_str(), std::ios::binary);
+        }
+        if(!fin.good())
+        {
+            const std::string preferred_file_name = interop_filename<MetricSet>(run_directory, use_out);
+            if(detail::read_compressed_interop(preferred_file_name, metrics, true, filter)) return;
+            if(detail::read_compressed_interop(file_name, metrics, true, filter)) return;
+            INTEROP_THROW(file_not_found_exception, "File not found: " << file_name);
+        }
+        read_metrics(fin, metrics, static_cast<size_t>(file_size(file_name)), true, filter);
+    }
     /** Write the metric set to a binary InterOp file
      *
      * @note The 'Out' suffix (parameter: use_out) is appended when we read the file. We excluded the Out in certain
@@ -217,7 +308,7 @@ namespace illumina { namespace interop { namespace io
     {
         const std::string file_name = interop_filename<MetricSet>(run_directory, use_out);
         std::ifstream fin(file_name.c_str(), std::ios::binary);
-        if(!fin.good()) return false;
+        if(!fin.good()) return find_compressed_file(file_name) != "";
         return true;
     }
     /** List all possible InterOp file names
@@ -262,6 +353,8 @@ namespace illumina { namespace interop { namespace io
      * @param metrics metric set
      * @param last_cycle last cycle to check
      * @param use_out use the copied version
+     * @param filter select the lanes, tiles and cycles to load, cycle files outside the selection are not opened
+     * @param thread_count number of threads used to read the cycle files
      * @throw file_not_found_exception
      * @throw bad_format_exception
      * @throw incomplete_file_exception
@@ -270,29 +363,43 @@ namespace illumina { namespace interop { namespace io
     void read_interop_by_cycle(const std::string& run_directory,
                                MetricSet& metrics,
                                const size_t last_cycle,
-                               const bool use_out=true)
+                               const bool use_out=true,
+                               const load_filter& filter=load_filter(),
+                               const size_t thread_count=1)
     INTEROP_THROW_SPEC((interop::io::file_not_found_exception,
     interop::io::bad_format_exception,
     interop::io::incomplete_file_exception,
     model::index_out_of_bounds_exception))
     {
-        std::string incomplete_file_message;
+        // Up to thread_count cycle files are read ahead while each file is decoded in cycle order
+        std::vector<std::string> files;
+        files.reserve(last_cycle);
         for(size_t cycle=1;cycle <= last_cycle;++cycle)
         {
-            const std::string file_name = interop_filename<MetricSet>(run_directory, cycle, use_out);
-            const int64_t file_size_in_bytes = file_size(file_name);
-            if(file_size_in_bytes < 0) continue;
-            std::ifstream fin(file_name.c_str(), std::ios::binary);
-            if(fin.good())
+            if(!filter.is_cycle_file_selected<MetricSet>(cycle)) continue;
+            files.push_back(interop_filename<MetricSet>(run_directory, cycle, use_out));
+        }
+        batch_file_reader reader(files, thread_count);
+        std::vector<char> buffer;
+
+        std::string incomplete_file_message;
+        for(size_t i=0;i<files.size();++i)
+        {
+            try
             {
-                try
-                {
-                    read_metrics(fin, metrics, static_cast<size_t>(file_size_in_bytes), false);
-                }
-                catch(const incomplete_file_exception& ex)
+                if(!reader.next(buffer))
                 {
-                    incomplete_file_message = ex.what();
+                    detail::read_compressed_interop(files[i], metrics, false, filter);
+                    continue;
                 }
+                char* begin = buffer.empty() ? 0 : &buffer.front();
+                detail::membuf sbuf(begin, begin + buffer.size());
+                std::istream in(&sbuf);
+                read_metrics(in, metrics, buffer.size(), false, filter);
+            }
+            catch(const incomplete_file_exception& ex)
+            {
+                incomplete_file_message = ex.what();
             }
         }
         metrics.rebuild_index();
@@ -317,12 +424,12 @@ namespace illumina { namespace interop { namespace io
     {
         std::string file_name = interop_filename<MetricSet>(run_directory, use_out);
         std::ifstream fin(file_name.c_str(), std::ios::binary);
-        if(fin.good()) return true;
+        if(fin.good() || find_compressed_file(file_name) != "") return true;
         for(size_t cycle=1;cycle <= last_cycle;++cycle)
         {
             file_name = interop_filename<MetricSet>(run_directory, cycle, use_out);
             fin.open(file_name.c_str(), std::ios::binary);
-            if(fin.good()) return true;
+            if(fin.good() || find_compressed_file(file_name) != "") return true;
         }
         return false;
     }
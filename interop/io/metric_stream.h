@@ -11,6 +11,7 @@
 #include "interop/util/exception.h"
 #include "interop/io/format/metric_format_factory.h"
 #include "interop/io/format/text_format_factory.h"
+#include "interop/io/format/text_buffer.h"
 #include "interop/io/paths.h"
 #include "interop/util/filesystem.h"
 #include "interop/util/assert.h"
@@ -94,9 +95,14 @@ namespace illumina { namespace interop { namespace io
      * @param metrics metric set
      * @param file_size number of bytes in the file
      * @param rebuild flag indicating whether to rebuild the lookup table
+     * @param filter skip records that are not selected by the filter
      */
     template<class MetricSet>
-    void read_metrics(std::istream &in, MetricSet &metrics, const size_t file_size, const bool rebuild=true)
+    void read_metrics(std::istream &in,
+                      MetricSet &metrics,
+                      const size_t file_size,
+                      const bool rebuild=true,
+                      const load_filter& filter=load_filter())
     {
         typedef typename MetricSet::metric_type metric_t;
         typedef metric_format_factory<metric_t> factory_t;
@@ -114,7 +120,7 @@ namespace illumina { namespace interop { namespace io
         metrics.set_version(static_cast< ::int16_t>(version));
         try
         {
-            format_map[version]->read_metrics(in, metrics, file_size);
+            format_map[version]->read_metrics(in, metrics, file_size, filter);
         }
         catch(const incomplete_file_exception& ex)
         {
@@ -192,6 +198,34 @@ namespace illumina { namespace interop { namespace io
     }
 
 
+    /** Read the id of each record in a block of records without decoding the rest of each record
+     *
+     * @param header metric set header
+     * @param buffer first byte of the first record
+     * @param record_count number of records in the block
+     * @param ids destination for the id of each record, 0 for an invalid record
+     * @param version version of the format
+     */
+    template<class MetricSet>
+    void read_record_ids(const MetricSet& header,
+                         const char* buffer,
+                         const size_t record_count,
+                         std::vector<typename MetricSet::metric_type::id_t>& ids,
+                         ::int16_t version=-1)
+    {
+        typedef typename MetricSet::metric_type metric_t;
+        typedef metric_format_factory<metric_t> factory_type;
+        typedef typename factory_type::metric_format_map metric_format_map;
+        metric_format_map &format_map = factory_type::metric_formats();
+        if(version < 1) version = header.version();
+        if (format_map.find(version) == format_map.end())
+            INTEROP_THROW(bad_format_exception, "No format found to read file with version: "
+                    << version <<  " of " << format_map.size());
+
+        INTEROP_ASSERT(format_map[version]);
+        format_map[version]->read_record_ids(header, buffer, record_count, ids);
+    }
+
     /** Get the size of a metric file header
      *
      * @param metric_set set of metrics
@@ -364,6 +398,75 @@ namespace illumina { namespace interop { namespace io
             format->write_metric(out, *it, metrics, sep, eol, missing);
 
     }
+    /** Write a set of metrics to a text output stream, formatting blocks of records into memory buffers
+     *
+     * Each block of records is formatted into a text_buffer_stream, then written to the output in a single call.
+     * When more than one thread is requested, the blocks are formatted in parallel and written in order. The text
+     * is the same as write_text for a stream using the classic locale.
+     *
+     * @param out output stream
+     * @param metrics set of metrics
+     * @param channel_names list of channel names
+     * @param thread_count number of threads used to format the records
+     * @param version version of the InterOp to write (if less than 0, get from metric set)
+     * @param sep column separator
+     * @param eol row separator
+     * @param missing missing value indicator
+     * @param block_size number of records formatted into a buffer before it is written
+     */
+    template<class MetricSet>
+    static void write_text_buffered(std::ostream &out,
+                                    const MetricSet &metrics,
+                                    const std::vector<std::string>& channel_names,
+                                    const size_t thread_count=1,
+                                    ::int16_t version = -1,
+                                    const char sep=',',
+                                    const char eol='\n',
+                                    const char missing='-',
+                                    const size_t block_size=8192)
+    {
+        typedef typename MetricSet::metric_type metric_type;
+        typedef text_format_factory<metric_type> factory_type;
+        typedef typename factory_type::abstract_text_format_t* abstract_text_format_pointer_t;
+
+        factory_type &factory = factory_type::instance();
+        abstract_text_format_pointer_t format = factory.find(version);
+        if (format == 0)
+            INTEROP_THROW(bad_format_exception,
+                          "No format found to write file with version: "
+                                  << version <<  " of " << factory.size()
+                                  << " for " << metric_type::prefix() << "" << metric_type::suffix()
+                                  << " with " << metrics.size() << " metrics");
+        INTEROP_ASSERT(format);
+        INTEROP_ASSERT(block_size > 0);
+        format->write_header(out, metrics, channel_names, sep, eol);
+        const int block_count = static_cast<int>((metrics.size() + block_size - 1) / block_size);
+        if (block_count == 0) return;
+        const int used_threads = static_cast<int>(std::max<size_t>(1, std::min<size_t>(thread_count, block_count)));
+        (void)used_threads;
+#ifdef _OPENMP
+#pragma omp parallel num_threads(used_threads)
+#endif
+        {
+            text_buffer_stream buffer;
+            buffer.copy_format(out);
+#ifdef _OPENMP
+#pragma omp for ordered schedule(static, 1)
+#endif
+            for (int block = 0; block < block_count; ++block)
+            {
+                const size_t first = static_cast<size_t>(block) * block_size;
+                const size_t last = std::min(first + block_size, metrics.size());
+                for (typename MetricSet::const_iterator it = metrics.begin() + first, end = metrics.begin() + last;
+                     it != end; ++it)
+                    format->write_metric(buffer, *it, metrics, sep, eol, missing);
+#ifdef _OPENMP
+#pragma omp ordered
+#endif
+                buffer.buffer().flush_to(out);
+            }
+        }
+    }
 
     /** Generate a file name from a run directory and the metric type for by cycle InterOps
      *
@@ -0,0 +1,398 @@
+/** Sidecar index of record offsets for random access into binary InterOp files
+ *
+ * The index maps the lane, tile and cycle of each record to its position in the InterOp file. It is written next to
+ * the InterOp file with an ".idx" suffix, and holds the size and modification time of the InterOp file, so it is
+ * rebuilt when the InterOp file changes.
+ *
+ * Only formats with a single fixed-size record per metric can be indexed. Other formats, e.g. the tile metrics or
+ * the index metrics, fall back to reading the whole file with a load filter.
+ *
+ * A saved index is mapped into memory rather than parsed, and the selected lanes and tiles are found with a binary
+ * search, so only the pages of the index that hold the selected entries are read.
+ *
+ *  @file
+ *  @date 10/18/26
+ *  @version 1.0
+ *  @copyright GNU Public License.
+ */
+#pragma once
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <vector>
+#include "interop/util/cstdint.h"
+#include "interop/util/filesystem.h"
+#include "interop/io/metric_file_stream.h"
+
+namespace illumina { namespace interop { namespace io
+{
+    /** Index of the records in a binary InterOp file
+     *
+     * @note On POSIX systems a saved index is memory mapped, otherwise it is read into memory
+     */
+    class record_index
+    {
+    public:
+        /** Location of a single record */
+        struct entry
+        {
+            /** Lane number */
+            ::uint32_t lane;
+            /** Tile number */
+            ::uint32_t tile;
+            /** Cycle number, 0 for metrics without a cycle */
+            ::uint32_t cycle;
+            /** Position of the record in the file, counted in records after the header */
+            ::uint64_t record;
+            /** Order by lane, tile, cycle and then position in the file
+             *
+             * @param rhs entry to compare
+             * @return true if this entry comes first
+             */
+            bool operator<(const entry& rhs)const
+            {
+                if(lane != rhs.lane) return lane < rhs.lane;
+                if(tile != rhs.tile) return tile < rhs.tile;
+                if(cycle != rhs.cycle) return cycle < rhs.cycle;
+                return record < rhs.record;
+            }
+        };
+        /** Define a vector of entries */
+        typedef std::vector<entry> entry_vector_t;
+        /** Define a vector of record positions */
+        typedef std::vector< ::uint64_t > record_vector_t;
+
+    public:
+        /** Constructor
+         */
+        record_index();
+        /** Destructor
+         */
+        ~record_index();
+
+    private:
+        record_index(const record_index&);
+        record_index& operator=(const record_index&);
+
+    public:
+        /** Start a new index for an InterOp file
+         *
+         * @param source_size size of the InterOp file in bytes
+         * @param source_time modification time of the InterOp file
+         * @param header_size number of bytes before the first record
+         * @param record_size number of bytes in each record
+         */
+        void reset(const ::int64_t source_size,
+                   const ::int64_t source_time,
+                   const size_t header_size,
+                   const size_t record_size);
+        /** Add the location of a record
+         *
+         * @param lane lane number
+         * @param tile tile number
+         * @param cycle cycle number, 0 for metrics without a cycle
+         * @param record position of the record in the file
+         */
+        void add(const ::uint32_t lane, const ::uint32_t tile, const ::uint32_t cycle, const ::uint64_t record);
+        /** Sort the entries by lane, tile and cycle
+         */
+        void sort();
+        /** Open a saved index
+         *
+         * Only the header is read, the entries are read from the mapped file as they are searched.
+         *
+         * @param file_name name of the index file
+         * @return false if the index file is missing or not a valid index
+         */
+        bool read(const std::string& file_name);
+        /** Release a saved index and clear the entries
+         */
+        void close();
+        /** Write the index to a file
+         *
+         * @param file_name name of the index file
+         * @return false if the index file could not be written
+         */
+        bool write(const std::string& file_name)const;
+        /** Test if the index matches the current size and modification time of the InterOp file
+         *
+         * @param file_name name of the InterOp file
+         * @return true if the index is up to date
+         */
+        bool is_current(const std::string& file_name)const;
+        /** Read the header and the selected records of the InterOp file
+         *
+         * Consecutive records are read together, and each run of records is read at its offset in the file
+         * without reading the records in between.
+         *
+         * @param file_name name of the InterOp file
+         * @param records sorted positions of the records to read
+         * @param buffer destination for the header followed by the selected records
+         * @return false if the file could not be opened or is shorter than the index expects
+         */
+        bool read_records(const std::string& file_name, const record_vector_t& records, std::vector<char>& buffer)const;
+        /** Select the records that match a load filter
+         *
+         * @param filter select the lanes, tiles and cycles to load
+         * @param records destination for the sorted positions of the selected records
+         */
+        template<class MetricSet>
+        void select(const load_filter& filter, record_vector_t& records)const
+        {
+            records.clear();
+            // Metrics without a cycle, or a filter without a first cycle, start at the first entry of each tile
+            const ::uint32_t first_cycle = filter.template is_cycle_file_selected<MetricSet>(0) ? 0 :
+                                           static_cast< ::uint32_t >(filter.first_cycle());
+            const size_t count = size();
+            for(size_t i=0;i<count;)
+            {
+                const entry first = at(i);
+                if(!filter.is_lane_selected(first.lane))
+                {
+                    i = next_lane(i, count, first.lane);
+                    continue;
+                }
+                const size_t last = next_tile(i, count, first.lane, first.tile);
+                if(filter.is_tile_selected(first.tile))
+                {
+                    for(size_t j=lower_bound(i, last, first.lane, first.tile, first_cycle);j<last;++j)
+                    {
+                        const entry e = at(j);
+                        // Cycles are sorted, so the first cycle past the selection ends the tile
+                        if(!filter.template is_cycle_file_selected<MetricSet>(e.cycle)) break;
+                        records.push_back(e.record);
+                    }
+                }
+                i = last;
+            }
+            std::sort(records.begin(), records.end());
+        }
+        /** Get the number of indexed records
+         *
+         * @return number of indexed records
+         */
+        size_t size()const
+        {
+            return m_data != 0 ? m_entry_count : m_entries.size();
+        }
+        /** Get an indexed record
+         *
+         * @param i index of the entry, in order of lane, tile and cycle
+         * @return entry
+         */
+        entry at(const size_t i)const;
+        /** Get the number of bytes before the first record
+         *
+         * @return header size in bytes
+         */
+        size_t header_size()const
+        {
+            return static_cast<size_t>(m_header_size);
+        }
+        /** Get the number of bytes in each record
+         *
+         * @return record size in bytes
+         */
+        size_t record_size()const
+        {
+            return static_cast<size_t>(m_record_size);
+        }
+
+    private:
+        /** Find the first entry in a range that is not before the given lane, tile and cycle
+         *
+         * @param first first entry in the range
+         * @param last end of the range
+         * @param lane lane number
+         * @param tile tile number
+         * @param cycle cycle number
+         * @return index of the entry, or last if every entry comes first
+         */
+        size_t lower_bound(size_t first,
+                           size_t last,
+                           const ::uint32_t lane,
+                           const ::uint32_t tile,
+                           const ::uint32_t cycle)const;
+        /** Find the first entry of the next lane
+         *
+         * @param first first entry of the current lane
+         * @param last end of the entries
+         * @param lane current lane number
+         * @return index of the entry, or last if there is no following lane
+         */
+        size_t next_lane(const size_t first, const size_t last, const ::uint32_t lane)const;
+        /** Find the first entry of the next tile
+         *
+         * @param first first entry of the current tile
+         * @param last end of the entries
+         * @param lane current lane number
+         * @param tile current tile number
+         * @return index of the entry, or last if there is no following tile
+         */
+        size_t next_tile(const size_t first, const size_t last, const ::uint32_t lane, const ::uint32_t tile)const;
+
+    private:
+        ::int64_t m_source_size;
+        ::int64_t m_source_time;
+        ::uint64_t m_header_size;
+        ::uint64_t m_record_size;
+        entry_vector_t m_entries;
+        const char* m_data;
+        size_t m_entry_count;
+        void* m_map;
+        size_t m_map_size;
+        std::vector<char> m_buffer;
+    };
+
+    /** Get the name of the sidecar index for an InterOp file
+     *
+     * @param file_name name of the InterOp file
+     * @return name of the index file
+     */
+    inline std::string record_index_filename(const std::string& file_name)
+    {
+        return file_name + ".idx";
+    }
+
+    namespace detail
+    {
+        /** Get the cycle from the id of a metric with a cycle
+         *
+         * @param id unique lane/tile/cycle id
+         * @return cycle number
+         */
+        template<class Metric>
+        ::uint32_t record_cycle(const typename Metric::id_t id, const constants::base_cycle_t*)
+        {
+            return static_cast< ::uint32_t >(Metric::cycle_from_id(id));
+        }
+        /** Get the cycle from the id of a metric without a cycle
+         *
+         * @return 0
+         */
+        template<class Metric>
+        ::uint32_t record_cycle(const typename Metric::id_t, const void*)
+        {
+            return 0;
+        }
+    }
+
+    /** Build the index of the records in a binary InterOp file
+     *
+     * Only the id at the start of each record is read. Invalid records are not indexed, and a partial record at the
+     * end of the file is ignored.
+     *
+     * @param file_name name of the InterOp file
+     * @param index destination index
+     * @return false if the file is missing, empty or has a format that cannot be indexed
+     * @throw bad_format_exception
+     */
+    template<class MetricSet>
+    bool build_record_index(const std::string& file_name, record_index& index)
+    INTEROP_THROW_SPEC((interop::io::bad_format_exception))
+    {
+        typedef typename MetricSet::metric_type metric_t;
+        typedef typename metric_t::id_t id_t;
+        const ::int64_t source_size = file_size(file_name);
+        const ::int64_t source_time = file_modification_time(file_name);
+        if(source_size <= 0) return false;
+        std::vector<char> data(static_cast<size_t>(source_size));
+        {
+            std::ifstream fin(file_name.c_str(), std::ios::binary);
+            if(!fin.good()) return false;
+            fin.read(&data.front(), static_cast<std::streamsize>(data.size()));
+            if(static_cast<size_t>(fin.gcount()) != data.size()) return false;
+        }
+
+        MetricSet header;
+        {
+            detail::membuf sbuf(&data.front(), &data.front() + data.size());
+            std::istream in(&sbuf);
+            try
+            {
+                read_header(in, header);
+            }
+            catch(const incomplete_file_exception&)
+            {
+                return false;
+            }
+        }
+        if(is_multi_record(header, header.version())) return false;
+        const size_t header_size = io::header_size(header, header.version());
+        const size_t record_size = io::record_size<metric_t>(header, header.version());
+        if(record_size == 0 || header_size > data.size()) return false;
+
+        index.reset(source_size, source_time, header_size, record_size);
+        const size_t record_count = (data.size() - header_size) / record_size;
+        std::vector<id_t> ids;
+        if(record_count > 0) read_record_ids(header, &data[header_size], record_count, ids);
+        for(size_t i=0;i<ids.size();++i)
+        {
+            if(ids[i] == 0) continue;
+            index.add(static_cast< ::uint32_t >(metric_t::lane_from_id(ids[i])),
+                      static_cast< ::uint32_t >(metric_t::tile_from_id(ids[i])),
+                      detail::record_cycle<metric_t>(ids[i], MetricSet::base_t::null()),
+                      static_cast< ::uint64_t >(i));
+        }
+        index.sort();
+        return true;
+    }
+
+    /** Read only the records of a binary InterOp file that are selected by a load filter
+     *
+     * The sidecar index is read if it is up to date, otherwise it is built and written next to the InterOp file.
+     * If the index cannot be written, e.g. the run folder is read only, it is still used for this read. Only the
+     * header and the selected records are read from the InterOp file, so the cost scales with the number of
+     * selected records rather than the size of the run.
+     *
+     * Formats that cannot be indexed, and missing files, fall back to `read_interop`.
+     *
+     * @note The modification time has a resolution of one second
+     *
+     * @param run_directory file path to the run directory
+     * @param metrics metric set
+     * @param filter select the lanes, tiles and cycles to load
+     * @param use_out use the copied version
+     * @return true if the records were read through the index, false if the whole file was read instead
+     * @throw file_not_found_exception
+     * @throw bad_format_exception
+     * @throw incomplete_file_exception
+     */
+    template<class MetricSet>
+    bool read_interop_indexed(const std::string& run_directory,
+                              MetricSet& metrics,
+                              const load_filter& filter=load_filter(),
+                              const bool use_out=true)
+    INTEROP_THROW_SPEC((interop::io::file_not_found_exception,
+    interop::io::bad_format_exception,
+    interop::io::incomplete_file_exception,
+    model::index_out_of_bounds_exception))
+    {
+        const std::string file_name = interop_filename<MetricSet>(run_directory, use_out);
+        const std::string index_file = record_index_filename(file_name);
+        record_index index;
+        if(!index.read(index_file) || !index.is_current(file_name))
+        {
+            if(!build_record_index<MetricSet>(file_name, index))
+            {
+                read_interop(run_directory, metrics, filter, use_out);
+                return false;
+            }
+            index.write(index_file);
+        }
+        record_index::record_vector_t records;
+        index.select<MetricSet>(filter, records);
+        std::vector<char> buffer;
+        if(!index.read_records(file_name, records, buffer))
+        {
+            read_interop(run_directory, metrics, filter, use_out);
+            return false;
+        }
+        detail::membuf sbuf(&buffer.front(), &buffer.front() + buffer.size());
+        std::istream in(&sbuf);
+        read_metrics(in, metrics, buffer.size(), true, filter);
+        return true;
+    }
+}}}
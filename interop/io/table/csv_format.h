@@ -6,8 +6,13 @@
  *  @copyright GNU Public License.
  */
 #pragma once
+#include <vector>
+#include <cstring>
+#include <cstdlib>
 #include "interop/util/lexical_cast.h"
 #include "interop/util/math.h"
+#include "interop/util/exception.h"
+#include "interop/io/stream_exceptions.h"
 
 
 namespace illumina { namespace interop { namespace io {  namespace  table
@@ -74,6 +79,357 @@ namespace illumina { namespace interop { namespace io {  namespace  table
             read_value(in, *beg, buf, delim);
         }
     }
+    /** Reads a stream in large blocks that always end on a line boundary
+     *
+     * This avoids a string copy per line and per cell. The block is only valid until the next call to read_block.
+     */
+    class csv_block_reader
+    {
+    public:
+        /** Constructor
+         *
+         * @param in input stream
+         * @param block_size number of bytes read from the stream at a time
+         */
+        csv_block_reader(std::istream& in, const size_t block_size=1u << 20) :
+                m_in(in), m_block_size(block_size), m_begin(0), m_end(0)
+        {
+        }
+
+    public:
+        /** Read the next block of complete lines
+         *
+         * The last line of the stream need not end with a newline.
+         *
+         * @param beg start of the block
+         * @param end end of the block
+         * @return false if the stream has no more data
+         */
+        bool read_block(const char*& beg, const char*& end)
+        {
+            // Move the partial line left over from the last block to the front of the buffer
+            const size_t leftover = m_end - m_begin;
+            if(leftover > 0 && m_begin > 0) std::memmove(&m_buffer[0], &m_buffer[m_begin], leftover);
+            m_begin = 0;
+            m_end = leftover;
+            for(;;)
+            {
+                if(m_buffer.size() < m_end + m_block_size) m_buffer.resize(m_end + m_block_size);
+                const size_t search_from = m_end;
+                if(m_in.good())
+                {
+                    m_in.read(&m_buffer[m_end], static_cast<std::streamsize>(m_block_size));
+                    m_end += static_cast<size_t>(m_in.gcount());
+                }
+                if(!m_in.good())
+                {
+                    if(m_end == 0) return false;
+                    beg = &m_buffer[0];
+                    end = beg + m_end;
+                    m_begin = m_end;
+                    return true;
+                }
+                const char* last_newline = find_last_newline(&m_buffer[search_from], &m_buffer[0]+m_end);
+                if(last_newline != 0)
+                {
+                    beg = &m_buffer[0];
+                    end = last_newline + 1;
+                    m_begin = static_cast<size_t>(end - beg);
+                    return true;
+                }
+                // Line is longer than a block, keep reading
+            }
+        }
+
+    private:
+        static const char* find_last_newline(const char* beg, const char* end)
+        {
+            while(end != beg)
+            {
+                --end;
+                if(*end == '\n') return end;
+            }
+            return 0;
+        }
+
+    private:
+        std::istream& m_in;
+        size_t m_block_size;
+        std::vector<char> m_buffer;
+        size_t m_begin;
+        size_t m_end;
+    };
+
+    namespace detail
+    {
+        /** Test if a cell ends with the given lower case suffix, ignoring case
+         *
+         * @param beg start of the cell
+         * @param end end of the cell
+         * @param suffix three character lower case suffix
+         * @return true if the cell ends with the suffix
+         */
+        inline bool ends_with_nocase(const char* beg, const char* end, const char* suffix)
+        {
+            if(end - beg < 3) return false;
+            return ::tolower(end[-3]) == suffix[0] && ::tolower(end[-2]) == suffix[1] && ::tolower(end[-1]) == suffix[2];
+        }
+        /** Parse a floating point number from a cell without a copy
+         *
+         * This takes the exact fast path when the value has at most 15 significant digits and a small exponent,
+         * which covers the values written by write_csv. Otherwise, it returns false.
+         *
+         * @param beg start of the cell
+         * @param end end of the cell
+         * @param value destination value
+         * @return true if the value was parsed exactly
+         */
+        inline bool parse_double_fast(const char* beg, const char* end, double& value)
+        {
+            static const double powers_of_ten[] = {1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+                                                   1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22};
+            const int max_power = 22;
+            const int max_digits = 15;
+            while(beg != end && (*beg == ' ' || *beg == '\t')) ++beg;
+            bool negative = false;
+            if(beg != end && (*beg == '-' || *beg == '+'))
+            {
+                negative = *beg == '-';
+                ++beg;
+            }
+            ::uint64_t mantissa = 0;
+            int digits = 0;
+            int exponent = 0;
+            bool has_digits = false;
+            for(;beg != end && *beg >= '0' && *beg <= '9';++beg)
+            {
+                has_digits = true;
+                if(mantissa == 0 && *beg == '0') continue;
+                if(++digits > max_digits) return false;
+                mantissa = mantissa*10 + static_cast< ::uint64_t >(*beg - '0');
+            }
+            if(beg != end && *beg == '.')
+            {
+                for(++beg;beg != end && *beg >= '0' && *beg <= '9';++beg)
+                {
+                    has_digits = true;
+                    --exponent;
+                    if(mantissa == 0 && *beg == '0') continue;
+                    if(++digits > max_digits) return false;
+                    mantissa = mantissa*10 + static_cast< ::uint64_t >(*beg - '0');
+                }
+            }
+            if(!has_digits) return false;
+            if(beg != end && (*beg == 'e' || *beg == 'E'))
+            {
+                ++beg;
+                bool negative_exponent = false;
+                if(beg != end && (*beg == '-' || *beg == '+'))
+                {
+                    negative_exponent = *beg == '-';
+                    ++beg;
+                }
+                if(beg == end || *beg < '0' || *beg > '9') return false;
+                int exponent_value = 0;
+                for(;beg != end && *beg >= '0' && *beg <= '9';++beg)
+                {
+                    exponent_value = exponent_value*10 + (*beg - '0');
+                    if(exponent_value > 2*max_power) return false;
+                }
+                exponent += negative_exponent ? -exponent_value : exponent_value;
+            }
+            if(beg != end && *beg != '\r') return false;
+            if(exponent < -max_power || exponent > max_power) return false;
+            // Both the mantissa and the power of ten are exact doubles, so one multiply or divide rounds correctly
+            value = static_cast<double>(mantissa);
+            if(exponent < 0) value /= powers_of_ten[-exponent];
+            else value *= powers_of_ten[exponent];
+            if(negative) value = -value;
+            return true;
+        }
+        /** Parse a value from a cell
+         *
+         * @param beg start of the cell
+         * @param end end of the cell
+         * @param value destination value
+         */
+        template<typename T>
+        void parse_value(const char* beg, const char* end, T& value)
+        {
+            value = util::lexical_cast<T>(std::string(beg, end));
+        }
+        /** Parse a floating point value from a cell, with the same result as lexical_cast
+         *
+         * @param beg start of the cell
+         * @param end end of the cell
+         * @param value destination value
+         */
+        template<typename T>
+        void parse_floating_point(const char* beg, const char* end, T& value)
+        {
+            double tmp;
+            if(ends_with_nocase(beg, end, "nan")) value = std::numeric_limits<T>::quiet_NaN();
+            else if(ends_with_nocase(beg, end, "inf")) value = std::numeric_limits<T>::infinity();
+            else if(parse_double_fast(beg, end, tmp)) value = static_cast<T>(tmp);
+            else value = util::lexical_cast<T>(std::string(beg, end));
+        }
+        /** Parse a float from a cell
+         *
+         * @param beg start of the cell
+         * @param end end of the cell
+         * @param value destination value
+         */
+        inline void parse_value(const char* beg, const char* end, float& value)
+        {
+            parse_floating_point(beg, end, value);
+        }
+        /** Parse a double from a cell
+         *
+         * @param beg start of the cell
+         * @param end end of the cell
+         * @param value destination value
+         */
+        inline void parse_value(const char* beg, const char* end, double& value)
+        {
+            parse_floating_point(beg, end, value);
+        }
+        /** Parse the cells of a single line and append them to the values
+         *
+         * This follows read_csv_line: an empty cell is missing, and a trailing comma does not add a cell.
+         *
+         * @param beg start of the line
+         * @param end end of the line, without the newline
+         * @param values destination vector
+         * @param missing sentinel for missing values
+         * @return number of values appended
+         */
+        template<typename T>
+        size_t parse_csv_line(const char* beg, const char* end, std::vector<T>& values, const T missing)
+        {
+            size_t count = 0;
+            while(beg != end)
+            {
+                const char* comma = static_cast<const char*>(std::memchr(beg, ',', static_cast<size_t>(end-beg)));
+                const char* cell_end = comma == 0 ? end : comma;
+                if(beg == cell_end) values.push_back(missing);
+                else
+                {
+                    values.push_back(T());
+                    parse_value(beg, cell_end, values.back());
+                }
+                ++count;
+                beg = comma == 0 ? end : comma+1;
+            }
+            return count;
+        }
+        /** Parse a block of complete lines into a row major table
+         *
+         * @param beg start of the block
+         * @param end end of the block
+         * @param column_count expected number of values in each non-empty line
+         * @param data destination table
+         * @param missing sentinel for missing values
+         * @return number of rows appended
+         * @throws bad_format_exception when a line does not have one value per column
+         */
+        template<typename T>
+        size_t parse_csv_rows(const char* beg, const char* end, const size_t column_count, std::vector<T>& data,
+                              const T missing)
+        {
+            size_t row_count = 0;
+            while(beg != end)
+            {
+                const char* newline = static_cast<const char*>(std::memchr(beg, '\n', static_cast<size_t>(end-beg)));
+                const char* line_end = newline == 0 ? end : newline;
+                const size_t value_count = parse_csv_line(beg, line_end, data, missing);
+                beg = newline == 0 ? end : newline+1;
+                if(value_count == 0) continue;
+                if(value_count != column_count)
+                {
+                    INTEROP_THROW(io::bad_format_exception, "Number of values does not match number of columns - "
+                                                            << value_count << " != " << column_count);
+                }
+                ++row_count;
+            }
+            return row_count;
+        }
+    }
+
+    /** Read the remaining lines of a CSV stream into a row major table
+     *
+     * The stream is read in large blocks and each cell is parsed in place, without a string copy. Empty lines are
+     * skipped. With more than one thread, each block is split on line boundaries and the parts are parsed in
+     * parallel, then appended in order.
+     *
+     * @param in input stream
+     * @param column_count expected number of values in each line
+     * @param data destination table, values are appended
+     * @param missing sentinel for missing values
+     * @param thread_count number of threads used to parse each block
+     * @return number of rows read
+     * @throws bad_format_exception when a line does not have one value per column
+     */
+    template<typename T>
+    size_t read_csv_rows(std::istream& in,
+                         const size_t column_count,
+                         std::vector<T>& data,
+                         const T missing=T(),
+                         const size_t thread_count=1)
+    {
+        const size_t block_size = thread_count > 1 ? (thread_count << 22) : (1u << 20);
+        csv_block_reader reader(in, block_size);
+        size_t row_count = 0;
+        const char* beg;
+        const char* end;
+        std::vector< std::vector<T> > part_data(thread_count > 1 ? thread_count : 0);
+        std::vector<size_t> part_rows(part_data.size());
+        while(reader.read_block(beg, end))
+        {
+            if(thread_count <= 1)
+            {
+                row_count += detail::parse_csv_rows(beg, end, column_count, data, missing);
+                continue;
+            }
+            // Split the block into one part per thread on line boundaries
+            std::vector<const char*> part_begin(thread_count+1, end);
+            part_begin[0] = beg;
+            for(size_t i=1;i<thread_count;++i)
+            {
+                const char* split = std::max(part_begin[i-1], beg + (end-beg)*static_cast<std::ptrdiff_t>(i)/
+                                                                   static_cast<std::ptrdiff_t>(thread_count));
+                const char* newline = split == end ? 0 :
+                                      static_cast<const char*>(std::memchr(split, '\n', static_cast<size_t>(end-split)));
+                part_begin[i] = newline == 0 ? end : newline+1;
+            }
+            std::string error;
+#ifdef _OPENMP
+#           pragma omp parallel for default(shared) num_threads(static_cast<int>(thread_count))
+#endif
+            for(int i=0;i<static_cast<int>(thread_count);++i)
+            {
+                part_data[i].clear();
+                try
+                {
+                    part_rows[i] = detail::parse_csv_rows(part_begin[i], part_begin[i+1], column_count, part_data[i],
+                                                          missing);
+                }
+                catch(const io::bad_format_exception& ex)
+                {
+#ifdef _OPENMP
+#                   pragma omp critical(CSVReadError)
+#endif
+                    if(error.empty()) error = ex.what();
+                }
+            }
+            if(!error.empty()) throw io::bad_format_exception(error);
+            for(size_t i=0;i<thread_count;++i)
+            {
+                data.insert(data.end(), part_data[i].begin(), part_data[i].end());
+                row_count += part_rows[i];
+            }
+        }
+        return row_count;
+    }
     /** Ignore non-float values
      *
      * @todo: Make this work for any floating point type
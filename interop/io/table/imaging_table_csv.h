@@ -63,31 +63,34 @@ namespace illumina { namespace interop { namespace model { namespace table
      *
      * @param in input stream
      * @param table imaging table
-     * @return input stream
+     * @param thread_count number of threads used to parse the rows
+     * @throws io::bad_format_exception when a row does not have one value per column
      */
-    inline std::istream &operator>>(std::istream &in, imaging_table &table)
+    inline void read_imaging_table(std::istream &in, imaging_table &table, const size_t thread_count=1)
     {
         imaging_table::column_vector_t cols;
         io::table::read_csv_line(in, cols);
-        if (!in.good()) return in;
+        if (!in.good()) return;
         logic::table::populate_column_offsets(cols);
 
         const size_t column_count = logic::table::count_table_columns(cols);
-        size_t row_count = 0;
         imaging_table::data_vector_t data;
-        imaging_table::data_vector_t values;
-        values.reserve(column_count);
-        while (!in.eof())
-        {
-            io::table::read_csv_line(in, values, std::numeric_limits<float>::quiet_NaN());
-            if (values.empty()) continue;
-            INTEROP_RANGE_CHECK_NE(column_count, values.size(), io::bad_format_exception,
-                                   "Number of values does not match number of columns");
-            data.resize(data.size()+column_count);
-            std::copy(values.begin(), values.end(), data.begin()+data.size()-column_count);
-            ++row_count;
-        }
+        const size_t row_count = io::table::read_csv_rows(in,
+                                                          column_count,
+                                                          data,
+                                                          std::numeric_limits<float>::quiet_NaN(),
+                                                          thread_count);
         table.set_data(row_count, cols, data);
+    }
+    /** Read an imaging table from an input stream in the CSV format
+     *
+     * @param in input stream
+     * @param table imaging table
+     * @return input stream
+     */
+    inline std::istream &operator>>(std::istream &in, imaging_table &table)
+    {
+        read_imaging_table(in, table);
         return in;
     }
     /** Write the imaging table to the output stream in the CSV format
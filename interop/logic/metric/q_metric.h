@@ -296,5 +296,28 @@ namespace illumina { namespace interop { namespace logic { namespace metric
                                   model::metric_base::metric_set<model::metrics::q_by_lane_metric>& bylane,
                                   const constants::instrument_type instrument)
                                         INTEROP_THROW_SPEC((model::index_out_of_bounds_exception));
+    /** Derive the collapsed, by lane and cumulative Q-metrics in a single sweep
+     *
+     * The records of each tile are visited in cycle order. Each lane is processed in parallel when OpenMP is
+     * available. This gives the same result as calling create_collapse_q_metrics, create_q_metrics_by_lane and
+     * populate_cumulative_distribution for each set.
+     *
+     * @note Nothing is derived and false is returned if the records of a tile are not stored in cycle order, or a
+     * record is duplicated. The caller should then fall back to the separate functions above.
+     *
+     * @param metric_set Q-metrics
+     * @param collapsed empty collapsed Q-metrics
+     * @param bylane empty bylane Q-metrics
+     * @param instrument instrument type
+     * @param populate_tile_cumulative if false, skip the cumulative histograms of the Q-metrics
+     * @return true if the metrics were derived
+     * @throws index_out_of_bounds_exception
+     */
+    bool derive_q_metrics(model::metric_base::metric_set<model::metrics::q_metric>& metric_set,
+                          model::metric_base::metric_set<model::metrics::q_collapsed_metric>& collapsed,
+                          model::metric_base::metric_set<model::metrics::q_by_lane_metric>& bylane,
+                          const constants::instrument_type instrument,
+                          const bool populate_tile_cumulative=true)
+                                        INTEROP_THROW_SPEC((model::index_out_of_bounds_exception));
 }}}}
 
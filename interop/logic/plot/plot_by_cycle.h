@@ -24,7 +24,7 @@ namespace illumina { namespace interop { namespace logic { namespace plot
      * @param data output plot data
      * @param skip_empty set false for testing purposes
      */
-    void plot_by_cycle(model::metrics::run_metrics& metrics,
+    void plot_by_cycle(const model::metrics::run_metrics& metrics,
                        const constants::metric_type type,
                        const model::plot::filter_options& options,
                        model::plot::plot_data<model::plot::candle_stick_point>& data,
@@ -45,7 +45,7 @@ namespace illumina { namespace interop { namespace logic { namespace plot
      * @param data output plot data
      * @param skip_empty set false for testing purposes
      */
-    void plot_by_cycle(model::metrics::run_metrics& metrics,
+    void plot_by_cycle(const model::metrics::run_metrics& metrics,
                        const std::string& metric_name,
                        const model::plot::filter_options& options,
                        model::plot::plot_data<model::plot::candle_stick_point>& data,
@@ -28,7 +28,7 @@ namespace illumina { namespace interop { namespace logic { namespace plot
      * @param tile_buffer preallocated memory for tile ids
      * @param skip_empty set false for testing purposes
      */
-    void plot_flowcell_map(model::metrics::run_metrics& metrics,
+    void plot_flowcell_map(const model::metrics::run_metrics& metrics,
                                   const constants::metric_type type,
                                   const model::plot::filter_options& options,
                                   model::plot::flowcell_data& data,
@@ -51,7 +51,7 @@ namespace illumina { namespace interop { namespace logic { namespace plot
      * @param id_buffer_size size of the buffer
      * @param skip_empty set false for testing purposes
      */
-    inline void plot_flowcell_map2(model::metrics::run_metrics& metrics,
+    inline void plot_flowcell_map2(const model::metrics::run_metrics& metrics,
                            const constants::metric_type type,
                            const model::plot::filter_options& options,
                            model::plot::flowcell_data& data,
@@ -80,7 +80,7 @@ namespace illumina { namespace interop { namespace logic { namespace plot
      * @param tile_buffer preallocated memory for tile ids
      * @param skip_empty set false for testing purposes
      */
-    void plot_flowcell_map(model::metrics::run_metrics& metrics,
+    void plot_flowcell_map(const model::metrics::run_metrics& metrics,
                                   const std::string& metric_name,
                                   const model::plot::filter_options& options,
                                   model::plot::flowcell_data& data,
@@ -103,7 +103,7 @@ namespace illumina { namespace interop { namespace logic { namespace plot
      * @param id_buffer_size size of the buffer
      * @param skip_empty set false for testing purposes
      */
-    inline void plot_flowcell_map2(model::metrics::run_metrics& metrics,
+    inline void plot_flowcell_map2(const model::metrics::run_metrics& metrics,
                            const std::string& metric_name,
                            const model::plot::filter_options& options,
                            model::plot::flowcell_data& data,
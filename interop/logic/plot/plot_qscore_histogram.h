@@ -24,7 +24,7 @@ namespace illumina { namespace interop { namespace logic { namespace plot {
      * @param data output plot data
      * @param boundary index of bin to create the boundary sub plots (0 means do nothing)
      */
-    void plot_qscore_histogram(model::metrics::run_metrics& metrics,
+    void plot_qscore_histogram(const model::metrics::run_metrics& metrics,
                                const model::plot::filter_options& options,
                                model::plot::plot_data<model::plot::bar_point>& data,
                                const size_t boundary=0)
@@ -7,6 +7,8 @@
  */
 #pragma once
 
+#include <vector>
+#include <algorithm>
 #include "interop/util/map.h"
 #include "interop/logic/summary/map_cycle_to_read.h"
 #include "interop/model/metric_base/metric_set.h"
@@ -23,10 +25,106 @@ namespace illumina { namespace interop { namespace logic { namespace summary
     typedef std::vector<std::vector<model::run::cycle_range> > cycle_range_vector2d_t;
 
 
+    /** Dense index over the tiles of one or more metric sets
+     *
+     * Each distinct lane and tile pair is given an index in [0, size()), ordered by lane then tile. This replaces
+     * hashing the tile id when accumulating values by tile.
+     */
+    class dense_tile_index
+    {
+    public:
+        /** Unsigned integer type */
+        typedef ::uint32_t uint_t;
+        /** Vector of tile numbers */
+        typedef std::vector<uint_t> id_vector;
+
+    public:
+        /** Constructor */
+        dense_tile_index() : m_lane_offsets(1, 0)
+        {
+        }
+
+    public:
+        /** Add the tiles of a metric set to the index
+         *
+         * @note records with lane 0 are ignored
+         *
+         * @param metrics metric set
+         */
+        template<class MetricSet>
+        void add(const MetricSet& metrics)
+        {
+            const size_t max_lane = metrics.max_lane();
+            if(max_lane >= m_tiles_by_lane.size()) m_tiles_by_lane.resize(max_lane+1);
+            for(size_t lane=1;lane<=max_lane;++lane)
+            {
+                const id_vector tiles = metrics.tile_numbers_for_lane(static_cast<uint_t>(lane));
+                if(tiles.empty()) continue;
+                id_vector& merged = m_tiles_by_lane[lane];
+                const size_t previous_size = merged.size();
+                merged.insert(merged.end(), tiles.begin(), tiles.end());
+                std::inplace_merge(merged.begin(), merged.begin()+previous_size, merged.end());
+                merged.erase(std::unique(merged.begin(), merged.end()), merged.end());
+            }
+            m_lane_offsets.assign(m_tiles_by_lane.size()+1, 0);
+            for(size_t lane=0;lane<m_tiles_by_lane.size();++lane)
+                m_lane_offsets[lane+1] = m_lane_offsets[lane] + m_tiles_by_lane[lane].size();
+        }
+        /** Get the number of indexed tiles
+         *
+         * @return number of tiles
+         */
+        size_t size()const
+        {
+            return m_lane_offsets.back();
+        }
+        /** Get one past the highest indexed lane number
+         *
+         * @return one past the highest lane number
+         */
+        size_t lane_end()const
+        {
+            return m_tiles_by_lane.size();
+        }
+        /** Get the index of the first tile of a lane
+         *
+         * The tiles of the lane have indices in [lane_offset(lane), lane_offset(lane+1))
+         *
+         * @param lane lane number
+         * @return index of the first tile of the lane
+         */
+        size_t lane_offset(const size_t lane)const
+        {
+            return lane < m_lane_offsets.size() ? m_lane_offsets[lane] : size();
+        }
+        /** Get the index of a tile
+         *
+         * @param lane lane number
+         * @param tile tile number
+         * @return index of the tile, or size() if the tile is not indexed
+         */
+        size_t index_of(const uint_t lane, const uint_t tile)const
+        {
+            if(lane == 0 || lane >= m_tiles_by_lane.size()) return size();
+            const id_vector& tiles = m_tiles_by_lane[lane];
+            id_vector::const_iterator it = std::lower_bound(tiles.begin(), tiles.end(), tile);
+            if(it == tiles.end() || *it != tile) return size();
+            return m_lane_offsets[lane] + static_cast<size_t>(it-tiles.begin());
+        }
+
+    private:
+        std::vector<id_vector> m_tiles_by_lane;
+        std::vector<size_t> m_lane_offsets;
+    };
+
     /** Summarize the cycle state for a particular metric
+     *
+     * The tile index must include every tile of both metric sets. It may be shared between calls for several
+     * metric sets, see `summarize_run_metrics`.
      *
      * @param tile_metrics tile metric set
      * @param cycle_metrics a cycle based metric set
+     * @param tile_index dense index over the tiles of the tile and cycle metrics
      * @param cycle_to_read map between the current cycle and read information
      * @param set_cycle_state_fun callback to set the cycle state
      * @param run run summary
@@ -34,6 +132,7 @@ namespace illumina { namespace interop { namespace logic { namespace summary
     template<typename Metric>
     void summarize_cycle_state(const model::metric_base::metric_set <model::metrics::tile_metric> &tile_metrics,
                                const model::metric_base::metric_set <Metric> &cycle_metrics,
+                               const dense_tile_index& tile_index,
                                const read_cycle_vector_t &cycle_to_read,
                                set_cycle_state_func_t set_cycle_state_fun,
                                model::summary::run_summary &run) INTEROP_THROW_SPEC((model::index_out_of_bounds_exception))
@@ -41,16 +140,22 @@ namespace illumina { namespace interop { namespace logic { namespace summary
         typedef model::run::cycle_range cycle_range;
         typedef typename model::metric_base::metric_set<model::metrics::tile_metric>::const_iterator const_tile_iterator;
         typedef typename model::metric_base::metric_set<Metric>::const_iterator const_metric_iterator;
+        typedef dense_tile_index::uint_t uint_t;
         cycle_range_vector2d_t summary_by_lane_read(run.size(), std::vector<cycle_range>(run.lane_count()));
 
-        typedef model::metrics::tile_metric::id_t id_t;
-        typedef INTEROP_UNORDERED_MAP(id_t, cycle_range) cycle_range_tile_t;
-        typedef INTEROP_UNORDERED_MAP(id_t, size_t) max_tile_map_t;
-        typedef typename max_tile_map_t::const_iterator const_max_tile_iterator;
-        typedef std::vector<cycle_range_tile_t> cycle_range_by_read_tile_t;
-        cycle_range_by_read_tile_t tmp(summary_by_lane_read.size());
-        max_tile_map_t tmp_by_tile;
+        // Cycle range for each tile and read stored at [tile_index*read_count + read]
+        const size_t read_count = summary_by_lane_read.size();
+        const size_t tile_count = tile_index.size();
+        std::vector<cycle_range> range_by_tile_read(tile_count*read_count);
+        std::vector<bool> has_tile_read(tile_count*read_count, false);
+        std::vector<size_t> max_cycle_by_tile(tile_count, 0);
+        std::vector<bool> has_tile(tile_count, false);
         cycle_range overall_cycle_state;
+
+        // Records are grouped by tile in most files, so only look up the index when the tile changes
+        uint_t last_lane = 0;
+        uint_t last_tile = 0;
+        size_t offset = tile_count;
         for (const_metric_iterator cycle_metric_it = cycle_metrics.begin(), cycle_metric_end = cycle_metrics.end();
              cycle_metric_it != cycle_metric_end; ++cycle_metric_it)
         {
@@ -59,45 +164,58 @@ namespace illumina { namespace interop { namespace logic { namespace summary
             INTEROP_BOUNDS_CHECK(cycle_metric_it->cycle()-1, cycle_to_read.size(), "Cycle exceeds number of cycles in RunInfo.xml");
             const read_cycle &read = cycle_to_read[cycle_metric_it->cycle() - 1];
             if (read.number == 0) continue;
-            INTEROP_ASSERT((read.number - 1) < tmp.size());
-
-            const id_t id = cycle_metric_it->tile_hash();
-            tmp[read.number - 1][id].update(cycle_metric_it->cycle());
-            typename max_tile_map_t::iterator it = tmp_by_tile.find(id);
-            if (it == tmp_by_tile.end())
-                tmp_by_tile[id] = cycle_metric_it->cycle();
-            else it->second = std::max(static_cast<size_t>(cycle_metric_it->cycle()), it->second);
+            INTEROP_ASSERT((read.number - 1) < read_count);
+
+            if(cycle_metric_it->lane() != last_lane || cycle_metric_it->tile() != last_tile)
+            {
+                last_lane = cycle_metric_it->lane();
+                last_tile = cycle_metric_it->tile();
+                offset = tile_index.index_of(last_lane, last_tile);
+            }
+            if(offset == tile_count) continue;
+            const size_t index = offset*read_count + read.number - 1;
+            range_by_tile_read[index].update(cycle_metric_it->cycle());
+            has_tile_read[index] = true;
+            max_cycle_by_tile[offset] = std::max(static_cast<size_t>(cycle_metric_it->cycle()), max_cycle_by_tile[offset]);
+            has_tile[offset] = true;
         }
 
         // Tile exists, but nothing was written out for that metric on any cycle
         for (const_tile_iterator tile_it = tile_metrics.begin(), tile_end = tile_metrics.end();
              tile_it != tile_end; ++tile_it)
         {
+            const size_t tile_offset = tile_index.index_of(tile_it->lane(), tile_it->tile());
+            if(tile_offset == tile_count) continue;
             size_t cycle_for_tile = 0;
-            const id_t id = model::metric_base::base_metric::create_id(tile_it->lane(), tile_it->tile());
-            for (size_t read_index = 0; read_index < tmp.size(); ++read_index)
+            for (size_t read_index = 0; read_index < read_count; ++read_index)
             {
-                if (tmp[read_index].find(tile_it->tile_hash()) == tmp[read_index].end())
+                const size_t index = tile_offset*read_count + read_index;
+                if (!has_tile_read[index])
                 {
-                    tmp[read_index][id].update(run[read_index].read().first_cycle() - 1);
-                    tmp_by_tile[id] = 0;
+                    range_by_tile_read[index].update(run[read_index].read().first_cycle() - 1);
+                    has_tile_read[index] = true;
                 }
                 else
                 {
-                    cycle_for_tile = tmp[read_index][id].last_cycle();
+                    cycle_for_tile = range_by_tile_read[index].last_cycle();
                 }
             }
-            tmp_by_tile[id] = cycle_for_tile;
+            max_cycle_by_tile[tile_offset] = cycle_for_tile;
+            has_tile[tile_offset] = true;
         }
-        for (size_t read = 0; read < tmp.size(); ++read)
+        for (size_t lane = 1; lane < tile_index.lane_end(); ++lane)
         {
-            INTEROP_ASSERT(read < summary_by_lane_read.size());
-            for (typename cycle_range_tile_t::const_iterator it = tmp[read].begin(), end = tmp[read].end();
-                 it != end; ++it)
+            const size_t lane_index = lane - 1;
+            INTEROP_ASSERT(lane_index < run.lane_count() || tile_index.lane_offset(lane) == tile_index.lane_offset(lane+1));
+            if(lane_index >= run.lane_count()) continue;
+            for (size_t tile_offset = tile_index.lane_offset(lane); tile_offset < tile_index.lane_offset(lane+1); ++tile_offset)
             {
-                const size_t lane = static_cast<size_t>(model::metric_base::base_metric::lane_from_id(it->first) - 1);
-                INTEROP_ASSERT(lane < summary_by_lane_read[read].size());
-                summary_by_lane_read[read][lane].update(it->second.last_cycle());
+                for (size_t read = 0; read < read_count; ++read)
+                {
+                    const size_t index = tile_offset*read_count + read;
+                    if(!has_tile_read[index]) continue;
+                    summary_by_lane_read[read][lane_index].update(range_by_tile_read[index].last_cycle());
+                }
             }
         }
 
@@ -112,12 +230,33 @@ namespace illumina { namespace interop { namespace logic { namespace summary
                 (run[read][lane].cycle_state().*set_cycle_state_fun)(cycle_range_within_read);
             }
         }
-        for (const_max_tile_iterator range_it = tmp_by_tile.begin(), range_end = tmp_by_tile.end();
-             range_it != range_end;
-             ++range_it)
-            overall_cycle_state.update(range_it->second);
+        for (size_t tile_offset = 0; tile_offset < tile_count; ++tile_offset)
+        {
+            if(has_tile[tile_offset]) overall_cycle_state.update(max_cycle_by_tile[tile_offset]);
+        }
         (run.cycle_state().*set_cycle_state_fun)(overall_cycle_state);
     }
 
+    /** Summarize the cycle state for a particular metric
+     *
+     * @param tile_metrics tile metric set
+     * @param cycle_metrics a cycle based metric set
+     * @param cycle_to_read map between the current cycle and read information
+     * @param set_cycle_state_fun callback to set the cycle state
+     * @param run run summary
+     */
+    template<typename Metric>
+    void summarize_cycle_state(const model::metric_base::metric_set <model::metrics::tile_metric> &tile_metrics,
+                               const model::metric_base::metric_set <Metric> &cycle_metrics,
+                               const read_cycle_vector_t &cycle_to_read,
+                               set_cycle_state_func_t set_cycle_state_fun,
+                               model::summary::run_summary &run) INTEROP_THROW_SPEC((model::index_out_of_bounds_exception))
+    {
+        dense_tile_index tile_index;
+        tile_index.add(tile_metrics);
+        tile_index.add(cycle_metrics);
+        summarize_cycle_state(tile_metrics, cycle_metrics, tile_index, cycle_to_read, set_cycle_state_fun, run);
+    }
+
 }}}}
 
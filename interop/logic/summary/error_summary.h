@@ -17,6 +17,7 @@
 #include "interop/logic/summary/cycle_state_summary.h"
 #include "interop/model/metrics/error_metric.h"
 #include "interop/model/summary/run_summary.h"
+#include "interop/model/run/flowcell_layout.h"
 #include "interop/logic/metric/tile_metric.h"
 
 
@@ -88,7 +89,7 @@ namespace illumina { namespace interop { namespace logic { namespace summary
      * @param end iterator to end of a collection of error metrics
      * @param max_cycle maximum cycle to take
      * @param cycle_to_read map that takes a cycle and returns the read-number cycle-in-read pair
-     * @param naming_method tile naming convention
+     * @param layout flowcell layout holding the tile geometry
      * @param read_lane_cache destination cache by read then by lane a collection of errors
      * @param read_lane_surface_cache source cache by read then by lane then by surface a collection of errors
      */
@@ -97,7 +98,7 @@ namespace illumina { namespace interop { namespace logic { namespace summary
                                   I end,
                                   const size_t max_cycle,
                                   const std::vector<read_cycle> &cycle_to_read,
-                                  const constants::tile_naming_method naming_method,
+                                  const model::run::flowcell_layout& layout,
                                   summary_by_lane_read<float> &read_lane_cache,
                                   summary_by_lane_read<float> &read_lane_surface_cache)
     INTEROP_THROW_SPEC((model::index_out_of_bounds_exception))
@@ -118,24 +119,31 @@ namespace illumina { namespace interop { namespace logic { namespace summary
             if (read.cycle_within_read > max_cycle || read.is_last_cycle_in_read) continue;
             tmp[read_number][key].update_error(beg->error_rate());
         }
-        for (size_t read = 0; read < tmp.size(); ++read)
+        // The first pass counts the values in each read and lane, the second pass stores them
+        for (size_t pass = 0; pass < 2; ++pass)
         {
-            for (typename error_tile_t::const_iterator ebeg = tmp[read].begin(), eend = tmp[read].end();
-                 ebeg != eend; ++ebeg)
+            for (size_t read = 0; read < tmp.size(); ++read)
             {
-                INTEROP_ASSERT(read < read_lane_cache.read_count());
-                const size_t lane = ebeg->first.first - 1;
-                INTEROP_BOUNDS_CHECK(lane, read_lane_cache.lane_count(), "Lane exceeds number of lanes in RunInfo.xml");
-                if(max_cycle < std::numeric_limits<size_t>::max() && ebeg->second.max_cycle() < max_cycle) continue;
-                if(ebeg->second.is_empty()) continue;
-                const float err_avg = ebeg->second.average();
-                read_lane_cache(read, lane).push_back(err_avg);
-                if(read_lane_surface_cache.surface_count() < 2) continue;
-                const ::uint32_t surface = logic::metric::surface(static_cast< ::uint32_t >(ebeg->first.second), naming_method);
-                INTEROP_ASSERT(surface <= read_lane_surface_cache.surface_count());
-                INTEROP_ASSERT(surface > 0);
-                read_lane_surface_cache(read, lane, surface-1).push_back(err_avg);
+                for (typename error_tile_t::const_iterator ebeg = tmp[read].begin(), eend = tmp[read].end();
+                     ebeg != eend; ++ebeg)
+                {
+                    INTEROP_ASSERT(read < read_lane_cache.read_count());
+                    const size_t lane = ebeg->first.first - 1;
+                    INTEROP_BOUNDS_CHECK(lane, read_lane_cache.lane_count(), "Lane exceeds number of lanes in RunInfo.xml");
+                    if(max_cycle < std::numeric_limits<size_t>::max() && ebeg->second.max_cycle() < max_cycle) continue;
+                    if(ebeg->second.is_empty()) continue;
+                    const float err_avg = ebeg->second.average();
+                    read_lane_cache.push_back(read, lane, 0, err_avg);
+                    if(read_lane_surface_cache.surface_count() < 2) continue;
+                    const ::uint32_t surface = layout.geometry(static_cast< ::uint32_t >(ebeg->first.second)).surface();
+                    INTEROP_ASSERT(surface <= read_lane_surface_cache.surface_count());
+                    INTEROP_ASSERT(surface > 0);
+                    read_lane_surface_cache.push_back(read, lane, surface-1, err_avg);
+                }
             }
+            if(pass > 0) continue;
+            read_lane_cache.allocate();
+            read_lane_surface_cache.allocate();
         }
     }
 
@@ -199,7 +207,7 @@ namespace illumina { namespace interop { namespace logic { namespace summary
      * @param beg iterator to start of a collection of error metrics
      * @param end iterator to end of a collection of error metrics
      * @param cycle_to_read map cycle to the read number and cycle within read number
-     * @param naming_method tile naming convention
+     * @param layout flowcell layout holding the tile geometry
      * @param run destination run summary
      * @param skip_median skip the median calculation
      */
@@ -207,7 +215,7 @@ namespace illumina { namespace interop { namespace logic { namespace summary
     void summarize_error_metrics(I beg,
                                  I end,
                                  const read_cycle_vector_t &cycle_to_read,
-                                 const constants::tile_naming_method naming_method,
+                                 const model::run::flowcell_layout& layout,
                                  model::summary::run_summary &run,
                                  const bool skip_median=false) INTEROP_THROW_SPEC((model::index_out_of_bounds_exception))
     {
@@ -218,8 +226,8 @@ namespace illumina { namespace interop { namespace logic { namespace summary
         if (beg == end) return;
         if (run.size() == 0) return;
         const size_t surface_count = run.surface_count();
-        summary_by_lane_read_t read_lane_cache(run, std::distance(beg, end));
-        summary_by_lane_read_t read_lane_surface_cache(run, std::distance(beg, end), surface_count);
+        summary_by_lane_read_t read_lane_cache(run);
+        summary_by_lane_read_t read_lane_surface_cache(run, surface_count);
 
         cycle_functor_pair_t cycle_functor_pairs[] = {
                 cycle_functor_pair_t(35u, &model::summary::stat_summary::error_rate_35),
@@ -233,7 +241,7 @@ namespace illumina { namespace interop { namespace logic { namespace summary
                                      end,
                                      cycle_functor_pairs[i].first,
                                      cycle_to_read,
-                                     naming_method,
+                                     layout,
                                      read_lane_cache,
                                      read_lane_surface_cache);
             error_summary_from_cache(read_lane_cache,
@@ -250,7 +258,7 @@ namespace illumina { namespace interop { namespace logic { namespace summary
                                  end,
                                  std::numeric_limits<size_t>::max(),
                                  cycle_to_read,
-                                 naming_method,
+                                 layout,
                                  read_lane_cache,
                                  read_lane_surface_cache);
 
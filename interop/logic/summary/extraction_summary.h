@@ -14,6 +14,7 @@
 #include "interop/model/metrics/extraction_metric.h"
 #include "interop/logic/summary/map_cycle_to_read.h"
 #include "interop/model/summary/run_summary.h"
+#include "interop/model/run/flowcell_layout.h"
 
 
 namespace illumina { namespace interop { namespace logic { namespace summary
@@ -29,7 +30,7 @@ namespace illumina { namespace interop { namespace logic { namespace summary
      * @param end iterator to end of a collection of extraction metrics
      * @param cycle_to_read map cycle to the read number and cycle within read number
      * @param channel channel to use for intensity reporting
-     * @param naming_method tile naming convention
+     * @param layout flowcell layout holding the tile geometry
      * @param run destination run summary
      * @param skip_median skip the median calculation
      */
@@ -38,7 +39,7 @@ namespace illumina { namespace interop { namespace logic { namespace summary
                                       I end,
                                       const read_cycle_vector_t &cycle_to_read,
                                       const size_t channel,
-                                      const constants::tile_naming_method naming_method,
+                                      const model::run::flowcell_layout& layout,
                                       model::summary::run_summary &run,
                                       const bool skip_median=false) INTEROP_THROW_SPEC((model::index_out_of_bounds_exception))
     {
@@ -47,22 +48,29 @@ namespace illumina { namespace interop { namespace logic { namespace summary
         if (beg == end) return;
         if (run.size() == 0)return;
         const size_t surface_count = run.surface_count();
-        summary_by_lane_read_t read_lane_cache(run, std::distance(beg, end));
-        summary_by_lane_read_t read_lane_surface_cache(run, std::distance(beg, end), surface_count);
+        summary_by_lane_read_t read_lane_cache(run);
+        summary_by_lane_read_t read_lane_surface_cache(run, surface_count);
 
-        for (; beg != end; ++beg)
+        // The first pass counts the values in each read and lane, the second pass stores them
+        for (size_t pass = 0; pass < 2; ++pass)
         {
-            INTEROP_BOUNDS_CHECK(beg->cycle() - 1, cycle_to_read.size(), "Cycle exceeds total cycles from Reads in the RunInfo.xml");
-            const size_t read = cycle_to_read[beg->cycle() - 1].number - 1;
-            if (cycle_to_read[beg->cycle() - 1].cycle_within_read > 1) continue;
-            INTEROP_ASSERT(read < read_lane_cache.read_count());
-            const size_t lane = beg->lane() - 1;
-            INTEROP_BOUNDS_CHECK(lane, read_lane_cache.lane_count(), "Lane exceeds number of lanes in RunInfo.xml");
-            read_lane_cache(read, lane).push_back(beg->max_intensity(channel));
-            if(surface_count < 2) continue;
-            const size_t surface = beg->surface(naming_method);
-            INTEROP_ASSERT(surface > 0);
-            read_lane_surface_cache(read, lane, surface-1).push_back(beg->max_intensity(channel));
+            for (I it = beg; it != end; ++it)
+            {
+                INTEROP_BOUNDS_CHECK(it->cycle() - 1, cycle_to_read.size(), "Cycle exceeds total cycles from Reads in the RunInfo.xml");
+                const size_t read = cycle_to_read[it->cycle() - 1].number - 1;
+                if (cycle_to_read[it->cycle() - 1].cycle_within_read > 1) continue;
+                INTEROP_ASSERT(read < read_lane_cache.read_count());
+                const size_t lane = it->lane() - 1;
+                INTEROP_BOUNDS_CHECK(lane, read_lane_cache.lane_count(), "Lane exceeds number of lanes in RunInfo.xml");
+                read_lane_cache.push_back(read, lane, 0, it->max_intensity(channel));
+                if(surface_count < 2) continue;
+                const size_t surface = layout.geometry(it->tile()).surface();
+                INTEROP_ASSERT(surface > 0);
+                read_lane_surface_cache.push_back(read, lane, surface-1, it->max_intensity(channel));
+            }
+            if(pass > 0) continue;
+            read_lane_cache.allocate();
+            read_lane_surface_cache.allocate();
         }
 
         float first_cycle_intensity = 0;
@@ -15,6 +15,7 @@
 #include "interop/model/metrics/phasing_metric.h"
 #include "interop/logic/summary/map_cycle_to_read.h"
 #include "interop/model/summary/run_summary.h"
+#include "interop/model/run/flowcell_layout.h"
 
 
 namespace illumina { namespace interop { namespace logic { namespace summary
@@ -30,47 +31,60 @@ namespace illumina { namespace interop { namespace logic { namespace summary
      * @param beg iterator to start of a collection of dynamic phasing metrics
      * @param end iterator to end of a collection of dynamic phasing metrics
      * @param run destination run summary
-     * @param naming_method tile naming convention
+     * @param layout flowcell layout holding the tile geometry
      * @param skip_median skip the median calculation
      */
     template<typename I>
     void summarize_phasing_metrics(I beg,
                                    I end,
                                    model::summary::run_summary &run,
-                                   const constants::tile_naming_method naming_method,
+                                   const model::run::flowcell_layout& layout,
                                    const bool skip_median=false) INTEROP_THROW_SPEC((model::index_out_of_bounds_exception))
     {
         typedef summary_by_lane_read<float> summary_by_lane_read_t;
         if (beg == end) return;
         if (run.size() == 0)return;
         const size_t surface_count = run.surface_count();
-        summary_by_lane_read_t phasing_slope(run, std::distance(beg, end));
-        summary_by_lane_read_t phasing_offset(run, std::distance(beg, end));
-        summary_by_lane_read_t prephasing_slope(run, std::distance(beg, end));
-        summary_by_lane_read_t prephasing_offset(run, std::distance(beg, end));
+        summary_by_lane_read_t phasing_slope(run);
+        summary_by_lane_read_t phasing_offset(run);
+        summary_by_lane_read_t prephasing_slope(run);
+        summary_by_lane_read_t prephasing_offset(run);
 
-        summary_by_lane_read_t phasing_slope_surface(run, std::distance(beg, end), surface_count);
-        summary_by_lane_read_t phasing_offset_surface(run, std::distance(beg, end), surface_count);
-        summary_by_lane_read_t prephasing_slope_surface(run, std::distance(beg, end), surface_count);
-        summary_by_lane_read_t prephasing_offset_surface(run, std::distance(beg, end), surface_count);
+        summary_by_lane_read_t phasing_slope_surface(run, surface_count);
+        summary_by_lane_read_t phasing_offset_surface(run, surface_count);
+        summary_by_lane_read_t prephasing_slope_surface(run, surface_count);
+        summary_by_lane_read_t prephasing_offset_surface(run, surface_count);
 
-        for (; beg != end; ++beg)
+        // The first pass counts the values in each read and lane, the second pass stores them
+        for (size_t pass = 0; pass < 2; ++pass)
         {
-            const size_t read = beg->read() - 1;
-            INTEROP_ASSERT(read < phasing_slope.read_count());
-            const size_t lane = beg->lane() - 1;
-            INTEROP_BOUNDS_CHECK(lane, phasing_slope.lane_count(), "Lane exceeds number of lanes in RunInfo.xml");
-            phasing_slope(read, lane).push_back(beg->phasing_slope());
-            phasing_offset(read, lane).push_back(beg->phasing_offset());
-            prephasing_slope(read, lane).push_back(beg->prephasing_slope());
-            prephasing_offset(read, lane).push_back(beg->prephasing_offset());
+            for (I it = beg; it != end; ++it)
+            {
+                const size_t read = it->read() - 1;
+                INTEROP_ASSERT(read < phasing_slope.read_count());
+                const size_t lane = it->lane() - 1;
+                INTEROP_BOUNDS_CHECK(lane, phasing_slope.lane_count(), "Lane exceeds number of lanes in RunInfo.xml");
+                phasing_slope.push_back(read, lane, 0, it->phasing_slope());
+                phasing_offset.push_back(read, lane, 0, it->phasing_offset());
+                prephasing_slope.push_back(read, lane, 0, it->prephasing_slope());
+                prephasing_offset.push_back(read, lane, 0, it->prephasing_offset());
 
-            if(surface_count < 2) continue;
-            const size_t surface = beg->surface(naming_method);
-            phasing_slope_surface(read, lane, surface-1).push_back(beg->phasing_slope());
-            phasing_offset_surface(read, lane, surface-1).push_back(beg->phasing_offset());
-            prephasing_slope_surface(read, lane, surface-1).push_back(beg->prephasing_slope());
-            prephasing_offset_surface(read, lane, surface-1).push_back(beg->prephasing_offset());
+                if(surface_count < 2) continue;
+                const size_t surface = layout.geometry(it->tile()).surface();
+                phasing_slope_surface.push_back(read, lane, surface-1, it->phasing_slope());
+                phasing_offset_surface.push_back(read, lane, surface-1, it->phasing_offset());
+                prephasing_slope_surface.push_back(read, lane, surface-1, it->prephasing_slope());
+                prephasing_offset_surface.push_back(read, lane, surface-1, it->prephasing_offset());
+            }
+            if(pass > 0) continue;
+            phasing_slope.allocate();
+            phasing_offset.allocate();
+            prephasing_slope.allocate();
+            prephasing_offset.allocate();
+            phasing_slope_surface.allocate();
+            phasing_offset_surface.allocate();
+            prephasing_slope_surface.allocate();
+            prephasing_offset_surface.allocate();
         }
 
         for (size_t read = 0; read < run.size(); ++read)
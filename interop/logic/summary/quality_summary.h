@@ -14,6 +14,7 @@
 #include "interop/logic/summary/map_cycle_to_read.h"
 #include "interop/model/metrics/q_metric.h"
 #include "interop/model/summary/run_summary.h"
+#include "interop/model/run/flowcell_layout.h"
 
 namespace illumina { namespace interop { namespace logic { namespace summary
 {
@@ -164,14 +165,14 @@ namespace illumina { namespace interop { namespace logic { namespace summary
     * @param beg iterator to start of a collection of collapsed q metrics
     * @param end iterator to end of a collection of collapsed q metrics
     * @param cycle_to_read map cycle to the read number and cycle within read number
-    * @param naming_method tile naming convention
+    * @param layout flowcell layout holding the tile geometry
     * @param run destination run summary
     */
     template<typename I>
     void summarize_collapsed_quality_metrics(I beg,
                                              I end,
                                              const read_cycle_vector_t& cycle_to_read,
-                                             const constants::tile_naming_method naming_method,
+                                             const model::run::flowcell_layout& layout,
                                              model::summary::run_summary &run)
                                              INTEROP_THROW_SPEC(( model::index_out_of_bounds_exception ))
     {
@@ -193,7 +194,7 @@ namespace illumina { namespace interop { namespace logic { namespace summary
             read_lane_cache.add(*beg, read_number, lane);
 
             if(surface_count < 2) continue;
-            const size_t surface = beg->surface(naming_method);
+            const size_t surface = layout.geometry(beg->tile()).surface();
             INTEROP_ASSERT(surface > 0);
             read_lane_surface_cache.add(*beg, read_number, lane, surface-1);
         }
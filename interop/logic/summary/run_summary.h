@@ -25,7 +25,7 @@ namespace illumina { namespace interop { namespace logic { namespace summary
      * @param skip_median skip the median calculation
      * @param trim flag indicating whether to trim the summary model (default: true)
      */
-    void summarize_run_metrics(model::metrics::run_metrics& metrics,
+    void summarize_run_metrics(const model::metrics::run_metrics& metrics,
                                model::summary::run_summary& summary,
                                const bool skip_median=false,
                                const bool trim=true)
@@ -26,68 +26,172 @@ namespace illumina { namespace interop { namespace logic { namespace summary
         for (; beg != end; ++beg) beg->reserve(n);
     }
 
-    /** Collection of values organized by read, then lane per read
+    /** Collection of values organized by read, then lane per read, then surface per lane
+     *
+     * The values are stored in a single buffer, where each read, lane and surface owns a contiguous bucket. The
+     * buffer is filled in two passes over the same values:
+     *  1. Each value is counted with `push_back` (or `count`)
+     *  2. `allocate` sizes the buffer and computes the offset of each bucket
+     *  3. Each value is stored with `push_back`
+     *
+     * Memory is proportional to the number of values added, rather than reserving the maximum number of values in
+     * every bucket.
      */
     template<typename T>
     class summary_by_lane_read
     {
     public:
         /** Vector of values */
-        typedef std::vector<T> vector_t; // TODO: Speed up with 2d vector?
-        /** Vector of vector of values */
-        typedef std::vector<vector_t> vector2d_t;
-        /** Vector of vector of vector of values */
-        typedef std::vector<vector2d_t> vector3d_t;
+        typedef std::vector<T> vector_t;
         /** Iterator to vector of values */
+        typedef typename vector_t::iterator iterator;
+        /** Constant iterator to vector of values */
         typedef typename vector_t::const_iterator const_iterator;
-        /** Iterator over read vector (vector of vector of vector of values) */
-        typedef typename vector3d_t::iterator read_iterator;
         /** Constant reference to value */
         typedef typename vector_t::const_reference const_reference;
 
+        /** Contiguous range of values for a single read, lane and surface
+         */
+        class bucket
+        {
+        public:
+            /** Constructor
+             *
+             * @param beg iterator to start of bucket
+             * @param end iterator to end of bucket
+             */
+            bucket(iterator beg, iterator end) : m_begin(beg), m_end(end){}
+
+        public:
+            /** Get iterator to start of bucket
+             *
+             * @return iterator to start of bucket
+             */
+            iterator begin()const
+            {
+                return m_begin;
+            }
+            /** Get iterator to end of bucket
+             *
+             * @return iterator to end of bucket
+             */
+            iterator end()const
+            {
+                return m_end;
+            }
+            /** Get number of values in the bucket
+             *
+             * @return number of values
+             */
+            size_t size()const
+            {
+                return static_cast<size_t>(m_end-m_begin);
+            }
+            /** Test if the bucket is empty
+             *
+             * @return true if there are no values
+             */
+            bool empty()const
+            {
+                return m_begin == m_end;
+            }
+
+        private:
+            iterator m_begin;
+            iterator m_end;
+        };
 
     public:
         /** Constructor
          *
          * @param run run summary
-         * @param n maximum number of values expected
          * @param surface_count number of surfaces
          */
-        summary_by_lane_read(const model::summary::run_summary &run, const ptrdiff_t n, const size_t surface_count=1) :
-                m_summary_by_lane_read(run.size(), vector2d_t(run.lane_count()*std::max(static_cast<size_t>(1),surface_count))),
+        summary_by_lane_read(const model::summary::run_summary &run, const size_t surface_count=1) :
+                m_read_count(run.size()),
                 m_lane_count(run.lane_count()),
-                m_surface_count(std::max(static_cast<size_t>(1),surface_count))
+                m_surface_count(std::max(static_cast<size_t>(1),surface_count)),
+                m_offsets(m_read_count*m_lane_count*m_surface_count+1, 0),
+                m_is_allocated(false)
         {
-            for (read_iterator beg = m_summary_by_lane_read.begin(), end = m_summary_by_lane_read.end();
-                 beg != end; ++beg)
-                reserve(beg->begin(), beg->end(), n);
         }
 
     public:
-        /** Access vector of values at given read and lane
+        /** Count a value for the given read, lane and surface
+         *
+         * @note must be called before allocate
          *
          * @param read read index (0-indexed)
          * @param lane lane index (0-indexed)
          * @param surface surface index (0-indexed)
-         * @return vector of values
+         * @param n number of values to count
          */
-        vector_t &operator()(const size_t read, const size_t lane, const size_t surface=0)
+        void count(const size_t read, const size_t lane, const size_t surface=0, const size_t n=1)
         {
-            INTEROP_ASSERTMSG(surface < m_surface_count, surface << " < " << m_surface_count);
-            INTEROP_ASSERTMSG(read < m_summary_by_lane_read.size(), read << " < " << m_summary_by_lane_read.size());
-            const size_t offset = lane*m_surface_count+surface;
-            INTEROP_ASSERTMSG(offset < m_summary_by_lane_read[read].size(),
-                              offset << " < " << m_summary_by_lane_read[read].size());
-            return m_summary_by_lane_read[read][offset];
+            INTEROP_ASSERT(!m_is_allocated);
+            m_offsets[index_of(read, lane, surface)+1] += n;
+        }
+        /** Add a value to the given read, lane and surface
+         *
+         * Before allocate is called, the value is only counted, afterwards it is stored.
+         *
+         * @param read read index (0-indexed)
+         * @param lane lane index (0-indexed)
+         * @param surface surface index (0-indexed)
+         * @param value value to add
+         */
+        void push_back(const size_t read, const size_t lane, const size_t surface, const_reference value)
+        {
+            const size_t index = index_of(read, lane, surface);
+            if (!m_is_allocated)
+            {
+                ++m_offsets[index+1];
+                return;
+            }
+            INTEROP_ASSERTMSG(m_fill[index] < m_offsets[index+1], "More values added than counted");
+            m_values[m_fill[index]] = value;
+            ++m_fill[index];
+        }
+        /** Allocate a single buffer for all the counted values
+         */
+        void allocate()
+        {
+            INTEROP_ASSERT(!m_is_allocated);
+            for (size_t i = 1; i < m_offsets.size(); ++i) m_offsets[i] += m_offsets[i-1];
+            m_values.resize(m_offsets.back());
+            m_fill.assign(m_offsets.begin(), m_offsets.end()-1);
+            m_is_allocated = true;
+        }
+        /** Test if the buffer was allocated
+         *
+         * @return true if allocate was called since construction or the last call to clear
+         */
+        bool is_allocated()const
+        {
+            return m_is_allocated;
+        }
+        /** Access the values stored for the given read and lane
+         *
+         * @param read read index (0-indexed)
+         * @param lane lane index (0-indexed)
+         * @param surface surface index (0-indexed)
+         * @return range of values
+         */
+        bucket operator()(const size_t read, const size_t lane, const size_t surface=0)
+        {
+            if (!m_is_allocated) return bucket(m_values.end(), m_values.end());
+            const size_t index = index_of(read, lane, surface);
+            return bucket(m_values.begin()+m_offsets[index], m_values.begin()+m_fill[index]);
         }
 
-        /** Clear the vector of values in each read/lane
+        /** Clear the values and counts in each read/lane, but keep the memory
          */
         void clear()
         {
-            for (read_iterator beg = m_summary_by_lane_read.begin(), end = m_summary_by_lane_read.end();
-                 beg != end; ++beg)
-                clear(beg->begin(), beg->end());
+            std::fill(m_offsets.begin(), m_offsets.end(), 0);
+            m_values.clear();
+            m_fill.clear();
+            m_is_allocated = false;
         }
 
         /** Size of vector
@@ -96,7 +200,7 @@ namespace illumina { namespace interop { namespace logic { namespace summary
          */
         size_t size() const
         {
-            return m_summary_by_lane_read.size();
+            return m_read_count;
         }
 
         /** Size of read vector
@@ -105,7 +209,7 @@ namespace illumina { namespace interop { namespace logic { namespace summary
          */
         size_t read_count() const
         {
-            return m_summary_by_lane_read.size();
+            return m_read_count;
         }
 
         /** Number of lanes
@@ -126,19 +230,27 @@ namespace illumina { namespace interop { namespace logic { namespace summary
         }
 
     private:
-        template<typename I>
-        static void clear(I beg, I end)
+        size_t index_of(const size_t read, const size_t lane, const size_t surface)const
         {
-            for (; beg != end; ++beg) beg->clear();
+            INTEROP_ASSERTMSG(surface < m_surface_count, surface << " < " << m_surface_count);
+            INTEROP_ASSERTMSG(read < m_read_count, read << " < " << m_read_count);
+            INTEROP_ASSERTMSG(lane < m_lane_count, lane << " < " << m_lane_count);
+            return (read*m_lane_count+lane)*m_surface_count+surface;
         }
 
     private:
-        vector3d_t m_summary_by_lane_read;
+        size_t m_read_count;
         size_t m_lane_count;
         size_t m_surface_count;
+        std::vector<size_t> m_offsets;
+        std::vector<size_t> m_fill;
+        vector_t m_values;
+        bool m_is_allocated;
     };
 
     /** Calculate the mean, standard deviation (stddev) and median over a collection of values
+     *
+     * The mean and stddev are calculated by one fused kernel, and the median by selection on the same values.
      *
      * @param beg iterator to start of collection
      * @param end iterator to end of collection
@@ -149,12 +261,17 @@ namespace illumina { namespace interop { namespace logic { namespace summary
     void summarize(I beg, I end, S &stat, const bool skip_median)
     {
         if (beg == end) return;
-        stat.mean(util::mean<float>(beg, end));
-        stat.stddev(std::sqrt(util::variance_with_mean<float>(beg, end, stat.mean())));
-        if(!skip_median) stat.median(util::median_interpolated<float>(beg, end));
+        float mean_val;
+        float variance_val;
+        util::mean_variance(beg, end, mean_val, variance_val, util::op::operator_none(), false);
+        stat.mean(mean_val);
+        stat.stddev(std::sqrt(variance_val));
+        if(!skip_median) stat.median(util::median_interpolated_select<float>(beg, end));
     }
 
     /** Calculate the mean, standard deviation (stddev) and median over a collection of values
+     *
+     * The mean and stddev are calculated by one fused kernel, and the median by selection on the same values.
      *
      * @param beg iterator to start of collection
      * @param end iterator to end of collection
@@ -167,12 +284,18 @@ namespace illumina { namespace interop { namespace logic { namespace summary
     void summarize(I beg, I end, S &stat, BinaryOp op, Compare comp, const bool skip_median)
     {
         if (beg == end) return;
-        stat.mean(util::mean<float>(beg, end, op));
-        stat.stddev(std::sqrt(util::variance_with_mean<float>(beg, end, stat.mean(), op)));
-        if(!skip_median) stat.median(util::median_interpolated<float>(beg, end, comp, op));
+        float mean_val;
+        float variance_val;
+        util::mean_variance(beg, end, mean_val, variance_val, op, false);
+        stat.mean(mean_val);
+        stat.stddev(std::sqrt(variance_val));
+        if(!skip_median) stat.median(util::median_interpolated_select<float>(beg, end, comp, op));
     }
 
     /** Calculate the mean, standard deviation (stddev) and median over a collection of values, ignoring NaNs
+     *
+     * The mean and stddev are calculated by one fused kernel that skips NaNs. The NaNs are only moved out of the
+     * collection when the median is required, and the median is found by selection on the remaining values.
      *
      * @param beg iterator to start of collection
      * @param end iterator to end of collection
@@ -187,13 +310,18 @@ namespace illumina { namespace interop { namespace logic { namespace summary
     {
         stat.clear();
         if (beg == end) return 0;
-        end = util::remove_nan(beg, end, op);
-        if (beg == end) return 0;
-        stat.mean(util::mean<float>(beg, end, op));
-        INTEROP_ASSERT(!std::isnan(stat.mean()));
-        stat.stddev(std::sqrt(util::variance_with_mean<float>(beg, end, stat.mean(), op)));
-        if(!skip_median) stat.median(util::median_interpolated<float>(beg, end, comp, op));
-        return size_t(std::distance(beg, end));
+        float mean_val;
+        float variance_val;
+        const size_t non_nan = util::mean_variance(beg, end, mean_val, variance_val, op, true);
+        if (non_nan == 0) return 0;
+        INTEROP_ASSERT(!std::isnan(mean_val));
+        stat.mean(mean_val);
+        stat.stddev(std::sqrt(variance_val));
+        if(skip_median) return non_nan;
+        if (non_nan < static_cast<size_t>(std::distance(beg, end)))
+            end = std::partition(beg, end, util::op::nan_check<BinaryOp>(op));
+        stat.median(util::median_interpolated_select<float>(beg, end, comp, op));
+        return non_nan;
     }
 
     /** Safe divide
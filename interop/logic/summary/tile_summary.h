@@ -8,11 +8,14 @@
 #pragma once
 
 #include <vector>
+#include <iterator>
+#include <limits>
 #include "interop/util/exception.h"
 #include "interop/model/model_exceptions.h"
 #include "interop/logic/summary/summary_statistics.h"
 #include "interop/model/metrics/tile_metric.h"
 #include "interop/model/summary/run_summary.h"
+#include "interop/model/run/flowcell_layout.h"
 
 namespace illumina { namespace interop { namespace logic { namespace summary
 {
@@ -38,14 +41,109 @@ namespace illumina { namespace interop { namespace logic { namespace summary
      }
 
 
+    /** Values of a tile metric required by the summary
+     *
+     * This avoids copying the whole tile metric, including its read metrics, into the summary cache.
+     */
+    class tile_summary_projection
+    {
+    public:
+        /** Constructor
+         *
+         * @param metric tile metric
+         */
+        tile_summary_projection(const model::metrics::tile_metric& metric) :
+                m_cluster_density(metric.cluster_density()),
+                m_cluster_density_pf(metric.cluster_density_pf()),
+                m_cluster_count(metric.cluster_count()),
+                m_cluster_count_pf(metric.cluster_count_pf()),
+                m_percent_pf(metric.percent_pf())
+        {
+        }
+
+    public:
+        /** @sa model::metrics::tile_metric::cluster_density
+         * @return cluster density
+         */
+        float cluster_density()const{return m_cluster_density;}
+        /** @sa model::metrics::tile_metric::cluster_density_pf
+         * @return cluster density passing filter
+         */
+        float cluster_density_pf()const{return m_cluster_density_pf;}
+        /** @sa model::metrics::tile_metric::cluster_count
+         * @return cluster count
+         */
+        float cluster_count()const{return m_cluster_count;}
+        /** @sa model::metrics::tile_metric::cluster_count_pf
+         * @return cluster count passing filter
+         */
+        float cluster_count_pf()const{return m_cluster_count_pf;}
+        /** @sa model::metrics::tile_metric::percent_pf
+         * @return percent of clusters passing filter
+         */
+        float percent_pf()const{return m_percent_pf;}
+
+    private:
+        float m_cluster_density;
+        float m_cluster_density_pf;
+        float m_cluster_count;
+        float m_cluster_count_pf;
+        float m_percent_pf;
+    };
+    /** Values of a read metric required by the summary
+     *
+     * This avoids copying the whole read metric into the summary cache.
+     */
+    class read_summary_projection
+    {
+    public:
+        /** Constructor
+         */
+        read_summary_projection() :
+                m_percent_aligned(std::numeric_limits<float>::quiet_NaN()),
+                m_percent_phasing(std::numeric_limits<float>::quiet_NaN()),
+                m_percent_prephasing(std::numeric_limits<float>::quiet_NaN())
+        {
+        }
+        /** Constructor
+         *
+         * @param metric read metric
+         */
+        read_summary_projection(const model::metrics::read_metric& metric) :
+                m_percent_aligned(metric.percent_aligned()),
+                m_percent_phasing(metric.percent_phasing()),
+                m_percent_prephasing(metric.percent_prephasing())
+        {
+        }
+
+    public:
+        /** @sa model::metrics::read_metric::percent_aligned
+         * @return percent aligned
+         */
+        float percent_aligned()const{return m_percent_aligned;}
+        /** @sa model::metrics::read_metric::percent_phasing
+         * @return percent phasing
+         */
+        float percent_phasing()const{return m_percent_phasing;}
+        /** @sa model::metrics::read_metric::percent_prephasing
+         * @return percent prephasing
+         */
+        float percent_prephasing()const{return m_percent_prephasing;}
+
+    private:
+        float m_percent_aligned;
+        float m_percent_phasing;
+        float m_percent_prephasing;
+    };
+
      /** Use the cached data to update a stat summary
      *
-     * @param tile_data cached tile data
+     * @param tile_data cached tile data, either tile metrics or projections of tile metrics
      * @param stat_summary destination stat summary to update
      * @param skip_median skip the median calculation
      */
-    template<class TileVector>
-    void update_tile_summary_from_cache(std::vector<TileVector>& tile_data,
+    template<class TileSummary>
+    void update_tile_summary_from_cache(std::vector<TileSummary>& tile_data,
                                         model::summary::stat_summary& stat_summary,
                                         const bool skip_median)
     {
@@ -53,92 +151,110 @@ namespace illumina { namespace interop { namespace logic { namespace summary
         nan_summarize(tile_data.begin(),
                   tile_data.end(),
                   stat,
-                  util::op::const_member_function(&model::metrics::tile_metric::cluster_density),
-                  util::op::const_member_function_less(&model::metrics::tile_metric::cluster_density),
+                  util::op::const_member_function(&TileSummary::cluster_density),
+                  util::op::const_member_function_less(&TileSummary::cluster_density),
                   skip_median);
         stat_summary.density(stat);
         stat.clear();
         nan_summarize(tile_data.begin(),
                   tile_data.end(),
                   stat,
-                  util::op::const_member_function(&model::metrics::tile_metric::cluster_density_pf),
-                  util::op::const_member_function_less(&model::metrics::tile_metric::cluster_density_pf),
+                  util::op::const_member_function(&TileSummary::cluster_density_pf),
+                  util::op::const_member_function_less(&TileSummary::cluster_density_pf),
                   skip_median);
         stat_summary.density_pf(stat);
         stat.clear();
         nan_summarize(tile_data.begin(),
                   tile_data.end(),
                   stat,
-                  util::op::const_member_function(&model::metrics::tile_metric::cluster_count),
-                  util::op::const_member_function_less(&model::metrics::tile_metric::cluster_count),
+                  util::op::const_member_function(&TileSummary::cluster_count),
+                  util::op::const_member_function_less(&TileSummary::cluster_count),
                   skip_median);
         stat_summary.cluster_count(stat);
         stat.clear();
         nan_summarize(tile_data.begin(),
                   tile_data.end(),
                   stat,
-                  util::op::const_member_function(&model::metrics::tile_metric::cluster_count_pf),
-                  util::op::const_member_function_less(&model::metrics::tile_metric::cluster_count_pf),
+                  util::op::const_member_function(&TileSummary::cluster_count_pf),
+                  util::op::const_member_function_less(&TileSummary::cluster_count_pf),
                   skip_median);
         stat_summary.cluster_count_pf(stat);
         stat.clear();
         nan_summarize(tile_data.begin(),
                   tile_data.end(),
                   stat,
-                  util::op::const_member_function(&model::metrics::tile_metric::percent_pf),
-                  util::op::const_member_function_less(&model::metrics::tile_metric::percent_pf),
+                  util::op::const_member_function(&TileSummary::percent_pf),
+                  util::op::const_member_function_less(&TileSummary::percent_pf),
                   skip_median);
         stat_summary.percent_pf(stat);
         stat_summary.reads(std::accumulate(tile_data.begin(),
                                            tile_data.end(),
                                            float(0),
                                            util::op::const_member_function(
-                                                   &model::metrics::tile_metric::cluster_count)));
+                                                   &TileSummary::cluster_count)));
         stat_summary.reads_pf(std::accumulate(tile_data.begin(),
                                               tile_data.end(),
                                               float(0),
                                               util::op::const_member_function(
-                                                      &model::metrics::tile_metric::cluster_count_pf)));
+                                                      &TileSummary::cluster_count_pf)));
     }
     /** Update the stat summary with cached read metrics
      *
-     * @param read_data_cache read metric cache
+     * @param beg iterator to start of read metric cache, either read metrics or projections of read metrics
+     * @param end iterator to end of read metric cache
      * @param stat_summary stat summary
      * @param skip_median skip the median calculation
      * @return number of non-NaN aligned entries
      */
-    inline size_t update_read_summary(summary_by_lane_read<model::metrics::read_metric>::vector_t& read_data_cache,
+    template<class I>
+    size_t update_read_summary(I beg,
+                               I end,
                                model::summary::stat_summary& stat_summary,
                                const bool skip_median)
     {
+        typedef typename std::iterator_traits<I>::value_type ReadSummary;
         model::summary::metric_stat stat;
-        const size_t non_nan = nan_summarize(read_data_cache.begin(),
-                                             read_data_cache.end(),
+        const size_t non_nan = nan_summarize(beg,
+                                             end,
                                              stat,
                                              util::op::const_member_function(
-                                                     &model::metrics::read_metric::percent_aligned),
+                                                     &ReadSummary::percent_aligned),
                                              util::op::const_member_function_less(
-                                                     &model::metrics::read_metric::percent_aligned),
+                                                     &ReadSummary::percent_aligned),
                                              skip_median);
         stat_summary.percent_aligned(stat);
         stat.clear();
-        nan_summarize(read_data_cache.begin(),
-                      read_data_cache.end(),
+        nan_summarize(beg,
+                      end,
                       stat,
-                      util::op::const_member_function(&model::metrics::read_metric::percent_prephasing),
-                      util::op::const_member_function_less(&model::metrics::read_metric::percent_prephasing),
+                      util::op::const_member_function(&ReadSummary::percent_prephasing),
+                      util::op::const_member_function_less(&ReadSummary::percent_prephasing),
                       skip_median);
         stat_summary.prephasing(stat);
         stat.clear();
-        nan_summarize(read_data_cache.begin(),
-                      read_data_cache.end(),
+        nan_summarize(beg,
+                      end,
                       stat,
-                      util::op::const_member_function(&model::metrics::read_metric::percent_phasing),
-                      util::op::const_member_function_less(&model::metrics::read_metric::percent_phasing),
+                      util::op::const_member_function(&ReadSummary::percent_phasing),
+                      util::op::const_member_function_less(&ReadSummary::percent_phasing),
                       skip_median);
         stat_summary.phasing(stat);
         return non_nan;
     }
+    /** Update the stat summary with cached read metrics
+     *
+     * @param read_data_cache read metric cache, either read metrics or projections of read metrics
+     * @param stat_summary stat summary
+     * @param skip_median skip the median calculation
+     * @return number of non-NaN aligned entries
+     */
+    template<class ReadSummary>
+    size_t update_read_summary(std::vector<ReadSummary>& read_data_cache,
+                               model::summary::stat_summary& stat_summary,
+                               const bool skip_median)
+    {
+        return update_read_summary(read_data_cache.begin(), read_data_cache.end(), stat_summary, skip_median);
+    }
     /** Summarize a collection tile metrics
     *
     * @sa model::summary::lane_summary::density
@@ -157,55 +273,81 @@ namespace illumina { namespace interop { namespace logic { namespace summary
     *
     * @param beg iterator to start of a collection of tile metrics
     * @param end iterator to end of a collection of tile metrics
-    * @param naming_method tile naming convention
+    * @param layout flowcell layout holding the tile geometry
     * @param run destination run summary
     * @param skip_median skip the median calculation
     */
     template<typename I>
     void summarize_tile_metrics(I beg,
                                 I end,
-                                const constants::tile_naming_method naming_method,
+                                const model::run::flowcell_layout& layout,
                                 model::summary::run_summary &run,
                                 const bool skip_median=false)
                                     INTEROP_THROW_SPEC((model::index_out_of_bounds_exception))
     {
         typedef typename model::metrics::tile_metric::read_metric_vector read_metric_vector_t;
         typedef typename read_metric_vector_t::const_iterator const_read_metric_iterator;
-        typedef std::vector<model::metrics::tile_metric> tile_vector_t;
+        typedef std::vector<tile_summary_projection> tile_vector_t;
         typedef std::vector<tile_vector_t> tile_by_lane_vector_t;
+        typedef typename summary_by_lane_read<read_summary_projection>::bucket read_bucket_t;
 
         if (beg == end) return;
         if (run.size() == 0)return;
         const size_t surface_count = run.surface_count();
-        const ptrdiff_t n = std::distance(beg, end);
+        summary_by_lane_read<read_summary_projection> read_data_by_lane_read(run);
+        summary_by_lane_read<read_summary_projection> read_data_by_surface_lane_read(run, surface_count);
 
+        // Count the tiles and reads in each lane and surface, so each cache is allocated once
+        std::vector<size_t> count_by_lane(run.lane_count(), 0);
+        std::vector<size_t> count_by_lane_surface(run.lane_count()*surface_count, 0);
+        for (I it = beg; it != end; ++it)
+        {
+            const size_t lane = it->lane() - 1;
+            INTEROP_BOUNDS_CHECK(lane, count_by_lane.size(), "Lane exceeds number of lanes in RunInfo.xml");
+            ++count_by_lane[lane];
+            const size_t surface = surface_count < 2 ? 0 : layout.geometry(it->tile()).surface();
+            INTEROP_ASSERT(surface_count < 2 || surface > 0);
+            for (const_read_metric_iterator rb = it->read_metrics().begin(), re = it->read_metrics().end();
+                 rb != re; ++rb)
+            {
+                const size_t read = rb->read() - 1;
+                INTEROP_BOUNDS_CHECK(read, read_data_by_lane_read.read_count(), "Read exceeds number of reads in RunInfo.xml");
+                read_data_by_lane_read.count(read, lane);
+                if(surface_count < 2) continue;
+                read_data_by_surface_lane_read.count(read, lane, surface-1);
+            }
+            if(surface_count < 2) continue;
+            ++count_by_lane_surface[lane*surface_count+(surface-1)];
+        }
+        read_data_by_lane_read.allocate();
+        read_data_by_surface_lane_read.allocate();
         tile_by_lane_vector_t tile_data_by_lane(run.lane_count());
-        reserve(tile_data_by_lane.begin(), tile_data_by_lane.end(), n);
+        for (size_t lane = 0; lane < tile_data_by_lane.size(); ++lane)
+            tile_data_by_lane[lane].reserve(count_by_lane[lane]);
         tile_by_lane_vector_t tile_data_by_lane_surface(run.lane_count()*surface_count);
-        reserve(tile_data_by_lane_surface.begin(), tile_data_by_lane_surface.end(), n);
-
-        summary_by_lane_read<model::metrics::read_metric> read_data_by_lane_read(run, n);
-        summary_by_lane_read<model::metrics::read_metric> read_data_by_surface_lane_read(run, n, surface_count);
+        for (size_t index = 0; index < tile_data_by_lane_surface.size(); ++index)
+            tile_data_by_lane_surface[index].reserve(count_by_lane_surface[index]);
 
         for (; beg != end; ++beg)
         {
-            const size_t surface = beg->surface(naming_method);
+            const size_t surface = layout.geometry(beg->tile()).surface();
             INTEROP_ASSERT(surface > 0);
             const size_t lane = beg->lane() - 1;
-            INTEROP_BOUNDS_CHECK(lane, tile_data_by_lane.size(), "Lane exceeds number of lanes in RunInfo.xml");
-            tile_data_by_lane[beg->lane() - 1].push_back(*beg);// TODO: make more efficient by copying only tile data
+            const tile_summary_projection tile_data(*beg);
+            tile_data_by_lane[lane].push_back(tile_data);
             for (const_read_metric_iterator rb = beg->read_metrics().begin(), re = beg->read_metrics().end();
                  rb != re; ++rb)
             {
                 const size_t read = rb->read() - 1;
                 INTEROP_BOUNDS_CHECK(read, read_data_by_lane_read.read_count(), "Read exceeds number of reads in RunInfo.xml");
-                read_data_by_lane_read(read, lane).push_back(*rb);
+                const read_summary_projection read_data(*rb);
+                read_data_by_lane_read.push_back(read, lane, 0, read_data);
                 if(surface_count < 2) continue;
-                read_data_by_surface_lane_read(read, lane, surface-1).push_back(*rb);
+                read_data_by_surface_lane_read.push_back(read, lane, surface-1, read_data);
             }
             if(surface_count < 2) continue;
             const size_t index = lane*surface_count+(surface-1);
-            tile_data_by_lane_surface[index].push_back(*beg);// TODO: make more efficient by copying only tile data
+            tile_data_by_lane_surface[index].push_back(tile_data);
         }
 
 
@@ -262,7 +404,9 @@ namespace illumina { namespace interop { namespace logic { namespace summary
             for (size_t lane = 0; lane < run[read].size(); ++lane)
             {
                 INTEROP_ASSERT(lane < run[0].size());
-                const size_t non_nan = update_read_summary(read_data_by_lane_read(read, lane),
+                const read_bucket_t bucket = read_data_by_lane_read(read, lane);
+                const size_t non_nan = update_read_summary(bucket.begin(),
+                                                           bucket.end(),
                                                            run[read][lane],
                                                            skip_median);
                 if(non_nan == 0) continue;
@@ -272,9 +416,11 @@ namespace illumina { namespace interop { namespace logic { namespace summary
                 if(surface_count < 2) continue;
                 for(size_t surface=0;surface<surface_count;++surface)
                 {
-                    update_read_summary(read_data_by_surface_lane_read(read, lane, surface),
-                                     run[read][lane][surface],
-                                     skip_median);
+                    const read_bucket_t surface_bucket = read_data_by_surface_lane_read(read, lane, surface);
+                    update_read_summary(surface_bucket.begin(),
+                                        surface_bucket.end(),
+                                        run[read][lane][surface],
+                                        skip_median);
                 }
             }
             run[read].summary().percent_aligned(divide(percent_aligned_by_read, float(total_by_read)));
@@ -297,13 +443,13 @@ namespace illumina { namespace interop { namespace logic { namespace summary
      *
      * @param beg iterator to start of a collection of extended tile metrics
      * @param end iterator to end of a collection of extended tile metrics
-     * @param naming_method tile naming convention
+     * @param layout flowcell layout holding the tile geometry
      * @param run destination run summary
      */
     template<typename I>
     void summarize_extended_tile_metrics(I beg,
                                          I end,
-                                         const constants::tile_naming_method naming_method,
+                                         const model::run::flowcell_layout& layout,
                                          model::summary::run_summary &run)
     INTEROP_THROW_SPEC((model::index_out_of_bounds_exception))
     {
@@ -320,7 +466,7 @@ namespace illumina { namespace interop { namespace logic { namespace summary
 
         for (; beg != end; ++beg)
         {
-            const size_t surface = beg->surface(naming_method);
+            const size_t surface = layout.geometry(beg->tile()).surface();
             INTEROP_ASSERT(surface > 0);
             const size_t lane = beg->lane() - 1;
             INTEROP_BOUNDS_CHECK(lane, tile_data_by_lane.size(), "Lane exceeds number of lanes in RunInfo.xml");
@@ -15,6 +15,7 @@
 #include <numeric>
 #include <utility>
 #include "interop/util/map.h"
+#include "interop/util/radix_sort.h"
 #include "interop/util/exception.h"
 #include "interop/model/metric_base/base_cycle_metric.h"
 #include "interop/model/metric_base/base_read_metric.h"
@@ -32,7 +33,12 @@ namespace illumina { namespace interop { namespace model { namespace metric_base
 
     /** Metric set holds a collection metrics
      *
-     * This class holds a map that maps a unique id to the metric.
+     * This class holds a map that maps a unique id to the metric. It also keeps a catalog of the lanes, tiles and
+     * cycles, which is updated on insert and rebuilt by rebuild_index. If the records are modified in place, call
+     * rebuild_index to refresh the catalog.
+     *
+     * The records may also be partitioned by lane and cycle, see partition_by_lane_cycle. Then lane_range and
+     * cycle_range return the records of a lane or a lane and cycle without a copy.
      */
     template<typename T>
     class metric_set : public T::header_type
@@ -73,6 +79,8 @@ namespace illumina { namespace interop { namespace model { namespace metric_base
         typedef typename metric_array_t::const_iterator const_iterator;
         /** Metric iterator */
         typedef typename metric_array_t::iterator iterator;
+        /** Range of metrics [first, second) */
+        typedef std::pair<const_iterator, const_iterator> const_range_t;
         enum
         {
             /** Group type enum */
@@ -87,7 +95,8 @@ namespace illumina { namespace interop { namespace model { namespace metric_base
          * @param version version of the file format
          */
         metric_set(const ::int16_t version )
-                : header_type(header_type::default_header()), m_version(version), m_data_source_exists(false)
+                : header_type(header_type::default_header()), m_version(version), m_data_source_exists(false),
+                  m_is_catalog_current(true), m_is_partitioned(false), m_generation(0)
         { }
         /** Constructor
          *
@@ -95,7 +104,8 @@ namespace illumina { namespace interop { namespace model { namespace metric_base
          * @param version version of the file format
          */
         metric_set(const header_type &header = header_type::default_header(), const ::int16_t version = 0)
-                : header_type(header), m_version(version), m_data_source_exists(false)
+                : header_type(header), m_version(version), m_data_source_exists(false), m_is_catalog_current(true),
+                  m_is_partitioned(false), m_generation(0)
         { }
 
         /** Constructor
@@ -108,7 +118,10 @@ namespace illumina { namespace interop { namespace model { namespace metric_base
                 header_type(header),
                 m_data(vec),
                 m_version(version),
-                m_data_source_exists(false)
+                m_data_source_exists(false),
+                m_is_catalog_current(false),
+                m_is_partitioned(false),
+                m_generation(vec.empty() ? 0 : 1)
         {
             rebuild_index(true);
         }
@@ -174,33 +187,143 @@ namespace illumina { namespace interop { namespace model { namespace metric_base
         }
 
         /** Get start of metric collection
+         *
+         * @note The records may be modified through the iterator, so this drops the lane and cycle partition
          *
          * @return iterator to start of metric collection
          */
         iterator begin()
         {
+            m_is_partitioned = false;
             return m_data.begin();
         }
 
         /** Get end of metric collection
+         *
+         * @note The records may be modified through the iterator, so this drops the lane and cycle partition
          *
          * @return iterator to end of metric collection
          */
         iterator end()
         {
+            m_is_partitioned = false;
             return m_data.end();
         }
 
-        /** Sort the metric collection
+        /** Sort the metric collection by id
+         *
+         * The records are ordered with a radix sort over their packed ids, then moved into place once.
+         *
+         * @param thread_count number of threads used to order the ids
+         */
+        void sort(const size_t thread_count=1)
+        {
+            m_is_partitioned = false;
+            ++m_generation;
+            std::vector<size_t> order;
+            util::radix_sort_order(m_data.begin(), m_data.end(), to_id, order, thread_count);
+            util::apply_permutation(m_data.begin(), order);
+        }
+        /** Sort the metric collection by lane, then cycle, then tile and build the lane and cycle offset tables
+         *
+         * This enables lane_range and cycle_range. The partition is dropped when records are added, removed or
+         * sorted, or when the records are accessed for modification. `run_metrics` partitions each metric set
+         * after it is loaded.
+         *
+         * @note The lookup table is updated with the new offsets if it is not empty
+         */
+        void partition_by_lane_cycle()
+        {
+            std::stable_sort(m_data.begin(), m_data.end(), lane_cycle_less());
+            if(!m_id_map.empty())
+            {
+                for(size_t offset=0;offset<m_data.size();++offset)
+                    m_id_map[m_data[offset].id()] = offset;
+            }
+            m_lane_offsets.clear();
+            m_cycle_offsets.clear();
+            const size_t lane_count = m_data.empty() ? 0 : static_cast<size_t>(m_data.back().lane())+1;
+            uint_t max_cycle = 0;
+            for(const_iterator b = m_data.begin(), e = m_data.end(); b != e; ++b)
+                max_cycle = std::max(max_cycle, cycle_of(*b, base_t::null()));
+            const size_t cycle_count = m_data.empty() ? 0 : static_cast<size_t>(max_cycle)+1;
+            m_lane_offsets.resize(lane_count+1, 0);
+            m_cycle_offsets.assign(lane_count, std::vector<size_t>(cycle_count+1, 0));
+            size_t offset = 0;
+            for(size_t lane=0;lane<lane_count;++lane)
+            {
+                m_lane_offsets[lane] = offset;
+                for(size_t cycle=0;cycle<cycle_count;++cycle)
+                {
+                    m_cycle_offsets[lane][cycle] = offset;
+                    while(offset < m_data.size() && m_data[offset].lane() == lane &&
+                          cycle_of(m_data[offset], base_t::null()) == cycle)
+                        ++offset;
+                }
+                m_cycle_offsets[lane][cycle_count] = offset;
+            }
+            m_lane_offsets[lane_count] = offset;
+            INTEROP_ASSERT(offset == m_data.size());
+            m_is_partitioned = true;
+            ++m_generation;
+        }
+        /** Test if the metric collection is partitioned by lane and cycle
+         *
+         * @return true if partition_by_lane_cycle was called after the last change to the records
+         */
+        bool is_partitioned()const
+        {
+            return m_is_partitioned;
+        }
+        /** Get the generation of the records
+         *
+         * The generation is incremented by every operation that adds, removes or reorders the records, so a value
+         * derived from the records is current while the generation it was derived from is unchanged.
+         *
+         * @return generation of the records
+         */
+        size_t generation()const
+        {
+            return m_generation;
+        }
+        /** Get the range of metrics for a lane without copying
+         *
+         * @note Requires partition_by_lane_cycle
+         *
+         * @param lane lane number
+         * @return range of metrics, empty if the lane has no metrics
+         */
+        const_range_t lane_range(const uint_t lane)const INTEROP_THROW_SPEC((model::index_out_of_bounds_exception))
+        {
+            if(!m_is_partitioned)
+                INTEROP_THROW( index_out_of_bounds_exception, "Metric set not partitioned: Run partition_by_lane_cycle() on this metric_set" );
+            if(static_cast<size_t>(lane)+1 >= m_lane_offsets.size()) return const_range_t(end(), end());
+            return const_range_t(begin()+m_lane_offsets[lane], begin()+m_lane_offsets[lane+1]);
+        }
+        /** Get the range of metrics for a lane and cycle without copying
          *
+         * @note Requires partition_by_lane_cycle
+         * @note Metrics without a cycle identifier are all listed under cycle 0
+         *
+         * @param lane lane number
+         * @param cycle cycle number
+         * @return range of metrics, empty if the lane has no metrics for the cycle
          */
-        void sort()
+        const_range_t cycle_range(const uint_t lane, const uint_t cycle)const
+                                                        INTEROP_THROW_SPEC((model::index_out_of_bounds_exception))
         {
-            std::sort(m_data.begin(), m_data.end());
+            if(!m_is_partitioned)
+                INTEROP_THROW( index_out_of_bounds_exception, "Metric set not partitioned: Run partition_by_lane_cycle() on this metric_set" );
+            if(lane >= m_cycle_offsets.size()) return const_range_t(end(), end());
+            const std::vector<size_t>& offsets = m_cycle_offsets[lane];
+            if(static_cast<size_t>(cycle)+1 >= offsets.size()) return const_range_t(end(), end());
+            return const_range_t(begin()+offsets[cycle], begin()+offsets[cycle+1]);
         }
 
     public:
         /** Rebuild the index map and update the cycle state
+         *
+         * This also rebuilds the lane, tile and cycle catalog.
          *
          * @note This function clears the lookup table for most metrics if update_ids is false (exceptions are Tile and DynamicPhasing
          *
@@ -208,8 +331,9 @@ namespace illumina { namespace interop { namespace model { namespace metric_base
          */
         void rebuild_index(const bool update_ids=false)
         {
+            rebuild_catalog();
             size_t offset = 0;
-            for (const_iterator b = begin(), e = end(); b != e; ++b)
+            for (const_iterator b = m_data.begin(), e = m_data.end(); b != e; ++b)
             {
                 if(update_ids)
                 {
@@ -237,6 +361,11 @@ namespace illumina { namespace interop { namespace model { namespace metric_base
          */
         void resize(const size_t n)
         {
+            if(n != m_data.size())
+            {
+                m_is_catalog_current = m_is_partitioned = false;
+                ++m_generation;
+            }
             m_data.resize(n, metric_type(*this));
         }
         /** Reserve the number of places in the metric vector
@@ -253,6 +382,11 @@ namespace illumina { namespace interop { namespace model { namespace metric_base
          */
         void trim(const size_t n)
         {
+            if(n != m_data.size())
+            {
+                m_is_catalog_current = m_is_partitioned = false;
+                ++m_generation;
+            }
             m_data.resize(n);
         }
 
@@ -278,6 +412,9 @@ namespace illumina { namespace interop { namespace model { namespace metric_base
 
             T::header_type::update_max_cycle(metric);
             m_data.push_back(metric);
+            m_is_partitioned = false;
+            ++m_generation;
+            if(m_is_catalog_current) add_to_catalog(metric);
         }
 
         /** Remove a metric from the metric set
@@ -287,11 +424,29 @@ namespace illumina { namespace interop { namespace model { namespace metric_base
         void remove(iterator &it)
         {
             INTEROP_ASSERT(size() > 0);
+            m_is_partitioned = false;
             std::iter_swap(it, m_data.rbegin());
             trim(size()-1);
         }
 
+        /** Remove every metric that matches the predicate
+         *
+         * Unlike remove, this keeps the order of the remaining metrics.
+         *
+         * @param pred unary predicate that returns true for a metric to remove
+         * @return number of metrics removed
+         */
+        template<class UnaryPredicate>
+        size_t remove_if(UnaryPredicate pred)
+        {
+            const size_t n = size();
+            trim(static_cast<size_t>(std::remove_if(m_data.begin(), m_data.end(), pred) - m_data.begin()));
+            return n - size();
+        }
+
         /** Get a metric at the given index
+         *
+         * @note The record may be modified through the reference, so this drops the lane and cycle partition
          *
          * @param n index
          * @return metric
@@ -299,6 +454,7 @@ namespace illumina { namespace interop { namespace model { namespace metric_base
         metric_type &operator[](const size_t n) INTEROP_THROW_SPEC((model::index_out_of_bounds_exception))
         {
             INTEROP_BOUNDS_CHECK(n, m_data.size(), "Index out of bounds");
+            m_is_partitioned = false;
             return m_data[n];
         }
 
@@ -322,6 +478,7 @@ namespace illumina { namespace interop { namespace model { namespace metric_base
         metric_type &at(const size_t n) INTEROP_THROW_SPEC((model::index_out_of_bounds_exception))
         {
             INTEROP_BOUNDS_CHECK(n, m_data.size(), "Index out of bounds");
+            m_is_partitioned = false;
             return m_data[n];
         }
 
@@ -368,6 +525,13 @@ namespace illumina { namespace interop { namespace model { namespace metric_base
          */
         id_vector lanes() const
         {
+            if(m_is_catalog_current)
+            {
+                id_vector lane_numbers;
+                for(size_t lane=0;lane<m_record_count_by_lane.size();++lane)
+                    if(m_record_count_by_lane[lane] > 0) lane_numbers.push_back(static_cast<uint_t>(lane));
+                return lane_numbers;
+            }
             id_set_t id_set;
             std::transform(begin(), end(), std::inserter(id_set, id_set.begin()), to_lane);
             return id_vector(id_set.begin(), id_set.end());
@@ -379,6 +543,11 @@ namespace illumina { namespace interop { namespace model { namespace metric_base
          */
         size_t lane_count() const
         {
+            if(m_is_catalog_current)
+            {
+                return static_cast<size_t>(m_record_count_by_lane.size() -
+                        std::count(m_record_count_by_lane.begin(), m_record_count_by_lane.end(), size_t(0)));
+            }
             return lanes().size();
         }
 
@@ -388,6 +557,12 @@ namespace illumina { namespace interop { namespace model { namespace metric_base
          */
         size_t max_lane() const
         {
+            if(m_is_catalog_current)
+            {
+                for(size_t lane=m_record_count_by_lane.size();lane > 0;--lane)
+                    if(m_record_count_by_lane[lane-1] > 0) return lane-1;
+                return 0;
+            }
             size_t lane_max = 0;
             for (const_iterator b = begin(); b != end(); ++b)
                 lane_max = std::max(lane_max, static_cast<size_t>(b->lane()));
@@ -401,6 +576,8 @@ namespace illumina { namespace interop { namespace model { namespace metric_base
          */
         id_vector tile_numbers_for_lane(const uint_t lane) const
         {
+            if(m_is_catalog_current)
+                return lane < m_tiles_by_lane.size() ? m_tiles_by_lane[lane] : id_vector();
             id_set_t tile_number_set;
             populate_tile_numbers_for_lane(tile_number_set, lane);
             id_vector tile_numbers(tile_number_set.begin(), tile_number_set.end());
@@ -415,6 +592,12 @@ namespace illumina { namespace interop { namespace model { namespace metric_base
          */
         void populate_tile_numbers_for_lane(id_set_t& tile_number_set, const uint_t lane) const
         {
+            if(m_is_catalog_current)
+            {
+                if(lane < m_tiles_by_lane.size())
+                    tile_number_set.insert(m_tiles_by_lane[lane].begin(), m_tiles_by_lane[lane].end());
+                return;
+            }
             transform_if(begin(),
                          end(),
                          std::inserter(tile_number_set, tile_number_set.begin()),
@@ -435,6 +618,17 @@ namespace illumina { namespace interop { namespace model { namespace metric_base
                                                     const uint_t surface,
                                                     const constants::tile_naming_method naming_convention) const
         {
+            if(m_is_catalog_current)
+            {
+                if(lane >= m_tiles_by_lane.size()) return;
+                const id_vector& tiles = m_tiles_by_lane[lane];
+                for(typename id_vector::const_iterator it = tiles.begin();it != tiles.end();++it)
+                {
+                    if(base_metric(lane, *it).surface(naming_convention) == surface)
+                        tile_number_set.insert(tile_number_set.end(), *it);
+                }
+                return;
+            }
             transform_if(begin(),
                          end(),
                          std::inserter(tile_number_set, tile_number_set.begin()),
@@ -449,6 +643,12 @@ namespace illumina { namespace interop { namespace model { namespace metric_base
         id_vector tile_numbers() const
         {
             id_set_t tile_number_set;
+            if(m_is_catalog_current)
+            {
+                for(size_t lane=0;lane<m_tiles_by_lane.size();++lane)
+                    tile_number_set.insert(m_tiles_by_lane[lane].begin(), m_tiles_by_lane[lane].end());
+                return id_vector(tile_number_set.begin(), tile_number_set.end());
+            }
             transform(begin(),
                          end(),
                          std::inserter(tile_number_set, tile_number_set.begin()),
@@ -476,12 +676,17 @@ namespace illumina { namespace interop { namespace model { namespace metric_base
          */
         void metrics_for_lane(metric_array_t& lane_metrics, const uint_t lane) const
         {
-            lane_metrics.reserve(size());
+            if(m_is_partitioned)
+            {
+                const const_range_t range = lane_range(lane);
+                lane_metrics.insert(lane_metrics.end(), range.first, range.second);
+                return;
+            }
+            lane_metrics.reserve(lane_metrics.size()+record_count_for_lane(lane));
             copy_if(begin(),
                     end(),
                     std::back_inserter(lane_metrics),
                     lane_equals(lane));
-            metric_array_t(lane_metrics).swap(lane_metrics); // Shrink to fit
         }
 
         /** Get a list of all cycles listed in the metric set
@@ -491,6 +696,13 @@ namespace illumina { namespace interop { namespace model { namespace metric_base
          */
         id_vector cycles() const
         {
+            if(m_is_catalog_current)
+            {
+                id_vector cycle_numbers;
+                for(size_t cycle=0;cycle<m_record_count_by_cycle.size();++cycle)
+                    if(m_record_count_by_cycle[cycle] > 0) cycle_numbers.push_back(static_cast<uint_t>(cycle));
+                return cycle_numbers;
+            }
             id_set_t cycle_set;
             cycles(cycle_set);
             return id_vector(cycle_set.begin(), cycle_set.end());
@@ -507,6 +719,31 @@ namespace illumina { namespace interop { namespace model { namespace metric_base
             return metrics_for_cycle(cycle, base_t::null());
         }
 
+        /** Get the number of records for the specified lane
+         *
+         * @param lane lane number
+         * @return number of records
+         */
+        size_t record_count_for_lane(const uint_t lane) const
+        {
+            if(m_is_catalog_current)
+                return lane < m_record_count_by_lane.size() ? m_record_count_by_lane[lane] : 0;
+            return static_cast<size_t>(std::count_if(begin(), end(), lane_equals(lane)));
+        }
+
+        /** Get the number of records for the specified cycle
+         *
+         * @note Returns 0 for metrics that do not have a cycle identifier
+         * @param cycle cycle number
+         * @return number of records
+         */
+        size_t record_count_for_cycle(const uint_t cycle) const
+        {
+            if(m_is_catalog_current)
+                return cycle < m_record_count_by_cycle.size() ? m_record_count_by_cycle[cycle] : 0;
+            return record_count_for_cycle(cycle, base_t::null());
+        }
+
     public:
         /** Number of metrics in the metric set
          *
@@ -542,6 +779,11 @@ namespace illumina { namespace interop { namespace model { namespace metric_base
             m_data.clear();
             m_version=0;
             m_data_source_exists=false;
+            clear_catalog();
+            m_is_partitioned = false;
+            m_lane_offsets.clear();
+            m_cycle_offsets.clear();
+            ++m_generation;
         }
 
         /** Get the metrics in a vector
@@ -628,6 +870,7 @@ namespace illumina { namespace interop { namespace model { namespace metric_base
                                                           (m_id_map.size()) << " == data: " <<
                                                           (size()) << " for metric: " << prefix());
             INTEROP_ASSERT(it->second < size());
+            m_is_partitioned = false;
             return m_data[it->second];
         }
         /** Find index of metric given the id. If not found, return number of metrics
@@ -737,12 +980,27 @@ namespace illumina { namespace interop { namespace model { namespace metric_base
         metric_array_t metrics_for_cycle(const uint_t cycle, const constants::base_cycle_t*) const
         {
             metric_array_t cycle_metrics;
-            cycle_metrics.reserve(size());
+            if(m_is_partitioned)
+            {
+                size_t count = 0;
+                for(uint_t lane=0;lane<m_cycle_offsets.size();++lane)
+                {
+                    const const_range_t range = cycle_range(lane, cycle);
+                    count += static_cast<size_t>(range.second-range.first);
+                }
+                cycle_metrics.reserve(count);
+                for(uint_t lane=0;lane<m_cycle_offsets.size();++lane)
+                {
+                    const const_range_t range = cycle_range(lane, cycle);
+                    cycle_metrics.insert(cycle_metrics.end(), range.first, range.second);
+                }
+                return cycle_metrics;
+            }
+            cycle_metrics.reserve(record_count_for_cycle(cycle));
             copy_if(begin(),
                     end(),
                     std::back_inserter(cycle_metrics),
                     cycle_equals(cycle));
-            metric_array_t(cycle_metrics).swap(cycle_metrics); // Shrink to fit
             return cycle_metrics;
         }
 
@@ -751,6 +1009,72 @@ namespace illumina { namespace interop { namespace model { namespace metric_base
             return metric_array_t();
         }
 
+        size_t record_count_for_cycle(const uint_t cycle, const constants::base_cycle_t*) const
+        {
+            return static_cast<size_t>(std::count_if(begin(), end(), cycle_equals(cycle)));
+        }
+
+        size_t record_count_for_cycle(const uint_t, const void *) const
+        {
+            return 0;
+        }
+
+        static uint_t cycle_of(const metric_type& metric, const constants::base_cycle_t*)
+        {
+            return metric.cycle();
+        }
+
+        static uint_t cycle_of(const metric_type&, const void*)
+        {
+            return 0;
+        }
+
+        void clear_catalog()
+        {
+            m_record_count_by_lane.clear();
+            m_tiles_by_lane.clear();
+            m_record_count_by_cycle.clear();
+            m_is_catalog_current = true;
+        }
+
+        void rebuild_catalog()
+        {
+            clear_catalog();
+            for (const_iterator b = m_data.begin(), e = m_data.end(); b != e; ++b)
+                add_to_catalog(*b);
+        }
+
+        void add_to_catalog(const metric_type& metric)
+        {
+            const size_t lane = static_cast<size_t>(metric.lane());
+            if(lane >= m_record_count_by_lane.size())
+            {
+                m_record_count_by_lane.resize(lane+1, 0);
+                m_tiles_by_lane.resize(lane+1);
+            }
+            ++m_record_count_by_lane[lane];
+            id_vector& tiles = m_tiles_by_lane[lane];
+            const uint_t tile = metric.tile();
+            if(tiles.empty() || tiles.back() < tile) tiles.push_back(tile); // Records are commonly sorted by tile
+            else
+            {
+                typename id_vector::iterator it = std::lower_bound(tiles.begin(), tiles.end(), tile);
+                if(*it != tile) tiles.insert(it, tile);
+            }
+            add_cycle_to_catalog(metric, base_t::null());
+        }
+
+        void add_cycle_to_catalog(const metric_type& metric, const constants::base_cycle_t*)
+        {
+            const size_t cycle = static_cast<size_t>(metric.cycle());
+            if(cycle >= m_record_count_by_cycle.size()) m_record_count_by_cycle.resize(cycle+1, 0);
+            ++m_record_count_by_cycle[cycle];
+        }
+
+        void add_cycle_to_catalog(const metric_type&, const void*)
+        {
+        }
+
 
     private:
         static id_t to_id(const metric_type &metric)
@@ -854,6 +1178,18 @@ namespace illumina { namespace interop { namespace model { namespace metric_base
             const constants::tile_naming_method m_naming_convention;
         };
 
+        struct lane_cycle_less
+        {
+            bool operator()(const metric_type &lhs, const metric_type &rhs) const
+            {
+                if(lhs.lane() != rhs.lane()) return lhs.lane() < rhs.lane();
+                const uint_t lhs_cycle = cycle_of(lhs, base_t::null());
+                const uint_t rhs_cycle = cycle_of(rhs, base_t::null());
+                if(lhs_cycle != rhs_cycle) return lhs_cycle < rhs_cycle;
+                return lhs.tile() < rhs.tile();
+            }
+        };
+
         struct cycle_equals
         {
             cycle_equals(uint_t cycle) : m_cycle(cycle)
@@ -876,6 +1212,22 @@ namespace illumina { namespace interop { namespace model { namespace metric_base
         // TODO: remove the following
         /** Map unique identifiers to the index of the metric */
         offset_map_t m_id_map;
+        /** Number of records for each lane */
+        std::vector<size_t> m_record_count_by_lane;
+        /** Sorted tile numbers for each lane */
+        std::vector<id_vector> m_tiles_by_lane;
+        /** Number of records for each cycle */
+        std::vector<size_t> m_record_count_by_cycle;
+        /** True if the catalog above matches the records */
+        bool m_is_catalog_current;
+        /** Offset of the first record of each lane, followed by the number of records */
+        std::vector<size_t> m_lane_offsets;
+        /** Offset of the first record of each cycle for each lane, followed by the end of the lane */
+        std::vector< std::vector<size_t> > m_cycle_offsets;
+        /** True if the records are partitioned by lane and cycle */
+        bool m_is_partitioned;
+        /** Incremented by every operation that adds, removes or reorders the records */
+        size_t m_generation;
     };
 
     /** Get metric set for a given metric set */
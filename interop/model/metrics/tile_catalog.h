@@ -0,0 +1,253 @@
+/** Catalog of the tiles present in each metric set
+ *
+ * The catalog lists the distinct tiles of each lane once, and records which metric groups have data for each tile
+ * as a bitset. Queries over lanes, surfaces and groups then avoid rescanning the records.
+ *
+ *  @file
+ *  @date 10/18/26
+ *  @version 1.0
+ *  @copyright GNU Public License.
+ */
+#pragma once
+
+#include <vector>
+#include <algorithm>
+#include "interop/util/cstdint.h"
+#include "interop/constants/enums.h"
+#include "interop/model/metric_base/base_metric.h"
+
+namespace illumina { namespace interop { namespace model { namespace metrics
+{
+    /** Catalog of the distinct (lane, surface, tile) triples present in each metric group
+     *
+     * The catalog is filled in two steps: each metric set is added, then the catalog is built for a tile naming
+     * method.
+     */
+    class tile_catalog
+    {
+    public:
+        /** Unsigned integer type */
+        typedef ::uint32_t uint_t;
+        /** Vector of tile numbers */
+        typedef std::vector<uint_t> id_vector;
+        /** Vector of metric groups */
+        typedef std::vector<constants::metric_group> group_vector_t;
+
+    private:
+        typedef ::uint64_t key_t;
+        typedef std::vector<key_t> key_vector_t;
+        typedef std::vector<bool> bitset_t;
+
+    public:
+        /** Constructor */
+        tile_catalog() : m_naming_method(constants::UnknownTileNamingMethod), m_is_built(false)
+        {
+        }
+
+    public:
+        /** Clear the catalog
+         */
+        void clear()
+        {
+            m_keys_by_group.clear();
+            m_generation.clear();
+            m_tiles_by_lane.clear();
+            m_surfaces_by_lane.clear();
+            m_groups_by_lane.clear();
+            m_naming_method = constants::UnknownTileNamingMethod;
+            m_is_built = false;
+        }
+        /** Add the tiles of a metric set to the catalog
+         *
+         * @param metrics metric set
+         */
+        template<class MetricSet>
+        void add(const MetricSet& metrics)
+        {
+            const size_t group = static_cast<size_t>(MetricSet::TYPE);
+            if(group >= m_keys_by_group.size())
+            {
+                m_keys_by_group.resize(group+1);
+                m_generation.resize(group+1, 0);
+            }
+            key_vector_t& keys = m_keys_by_group[group];
+            keys.clear();
+            keys.reserve(metrics.size());
+            for(typename MetricSet::const_iterator it = metrics.begin();it != metrics.end();++it)
+            {
+                if(it->lane() == 0) continue;
+                keys.push_back(to_key(it->lane(), it->tile()));
+            }
+            std::sort(keys.begin(), keys.end());
+            keys.erase(std::unique(keys.begin(), keys.end()), keys.end());
+            m_generation[group] = metrics.generation();
+            m_is_built = false;
+        }
+        /** Build the catalog from the tiles added for each metric set
+         *
+         * @param naming_method tile naming method used to determine the surface of each tile
+         */
+        void build(const constants::tile_naming_method naming_method)
+        {
+            m_naming_method = naming_method;
+            m_tiles_by_lane.clear();
+            m_surfaces_by_lane.clear();
+            m_groups_by_lane.clear();
+            for(size_t group=0;group<m_keys_by_group.size();++group)
+            {
+                for(key_vector_t::const_iterator it = m_keys_by_group[group].begin();
+                    it != m_keys_by_group[group].end();++it)
+                {
+                    const size_t lane_index = to_lane(*it)-1;
+                    if(lane_index >= m_tiles_by_lane.size()) m_tiles_by_lane.resize(lane_index+1);
+                    m_tiles_by_lane[lane_index].push_back(to_tile(*it));
+                }
+            }
+            m_surfaces_by_lane.resize(m_tiles_by_lane.size());
+            m_groups_by_lane.resize(m_tiles_by_lane.size());
+            for(size_t lane_index=0;lane_index<m_tiles_by_lane.size();++lane_index)
+            {
+                id_vector& tiles = m_tiles_by_lane[lane_index];
+                std::sort(tiles.begin(), tiles.end());
+                tiles.erase(std::unique(tiles.begin(), tiles.end()), tiles.end());
+                m_surfaces_by_lane[lane_index].resize(tiles.size());
+                for(size_t i=0;i<tiles.size();++i)
+                    m_surfaces_by_lane[lane_index][i] =
+                            metric_base::base_metric(static_cast<uint_t>(lane_index+1), tiles[i]).surface(naming_method);
+                m_groups_by_lane[lane_index].assign(m_keys_by_group.size(), bitset_t(tiles.size(), false));
+            }
+            for(size_t group=0;group<m_keys_by_group.size();++group)
+            {
+                for(key_vector_t::const_iterator it = m_keys_by_group[group].begin();
+                    it != m_keys_by_group[group].end();++it)
+                {
+                    const size_t lane_index = to_lane(*it)-1;
+                    m_groups_by_lane[lane_index][group][index_of(lane_index, to_tile(*it))] = true;
+                }
+            }
+            m_is_built = true;
+        }
+
+    public:
+        /** Test if the catalog has been built
+         *
+         * @return true if build was called after the last metric set was added
+         */
+        bool is_built()const
+        {
+            return m_is_built;
+        }
+        /** Get the tile naming method used to build the catalog
+         *
+         * @return tile naming method
+         */
+        constants::tile_naming_method naming_method()const
+        {
+            return m_naming_method;
+        }
+        /** Get the generation of the metric set when it was added to the catalog
+         *
+         * @param group metric group
+         * @return generation of the metric set
+         */
+        size_t generation(const constants::metric_group group)const
+        {
+            const size_t index = static_cast<size_t>(group);
+            return index < m_generation.size() ? m_generation[index] : 0;
+        }
+        /** Get the highest lane number with any tile
+         *
+         * @return highest lane number
+         */
+        size_t lane_count()const
+        {
+            return m_tiles_by_lane.size();
+        }
+        /** Get the sorted list of distinct tile numbers for a lane
+         *
+         * @param lane lane number
+         * @return sorted tile numbers
+         */
+        const id_vector& tile_numbers_for_lane(const size_t lane)const
+        {
+            static const id_vector empty;
+            if(lane == 0 || lane > m_tiles_by_lane.size()) return empty;
+            return m_tiles_by_lane[lane-1];
+        }
+        /** Test if a metric group has data for a tile
+         *
+         * @param group metric group
+         * @param lane lane number
+         * @param tile tile number
+         * @return true if the metric group has at least one record for the tile
+         */
+        bool contains(const constants::metric_group group, const size_t lane, const uint_t tile)const
+        {
+            if(lane == 0 || lane > m_tiles_by_lane.size()) return false;
+            const size_t lane_index = lane-1;
+            const size_t group_index = static_cast<size_t>(group);
+            if(group_index >= m_groups_by_lane[lane_index].size()) return false;
+            const id_vector& tiles = m_tiles_by_lane[lane_index];
+            id_vector::const_iterator it = std::lower_bound(tiles.begin(), tiles.end(), tile);
+            if(it == tiles.end() || *it != tile) return false;
+            return m_groups_by_lane[lane_index][group_index][static_cast<size_t>(it-tiles.begin())];
+        }
+        /** Count the tiles of a lane and surface where any of the given metric groups have data
+         *
+         * @param groups metric groups
+         * @param lane lane number
+         * @param surface surface number (0 counts all surfaces)
+         * @return number of tiles
+         */
+        size_t tile_count(const group_vector_t& groups, const size_t lane, const uint_t surface=0)const
+        {
+            if(lane == 0 || lane > m_tiles_by_lane.size()) return 0;
+            const size_t lane_index = lane-1;
+            const std::vector<bitset_t>& present = m_groups_by_lane[lane_index];
+            const id_vector& surfaces = m_surfaces_by_lane[lane_index];
+            size_t count = 0;
+            for(size_t i=0;i<surfaces.size();++i)
+            {
+                if(surface != 0 && surfaces[i] != surface) continue;
+                for(group_vector_t::const_iterator it = groups.begin();it != groups.end();++it)
+                {
+                    const size_t group_index = static_cast<size_t>(*it);
+                    if(group_index < present.size() && present[group_index][i])
+                    {
+                        ++count;
+                        break;
+                    }
+                }
+            }
+            return count;
+        }
+
+    private:
+        static key_t to_key(const uint_t lane, const uint_t tile)
+        {
+            return (static_cast<key_t>(lane) << 32) | static_cast<key_t>(tile);
+        }
+        static uint_t to_lane(const key_t key)
+        {
+            return static_cast<uint_t>(key >> 32);
+        }
+        static uint_t to_tile(const key_t key)
+        {
+            return static_cast<uint_t>(key & 0xFFFFFFFFu);
+        }
+        size_t index_of(const size_t lane_index, const uint_t tile)const
+        {
+            const id_vector& tiles = m_tiles_by_lane[lane_index];
+            return static_cast<size_t>(std::lower_bound(tiles.begin(), tiles.end(), tile)-tiles.begin());
+        }
+
+    private:
+        std::vector<key_vector_t> m_keys_by_group;
+        std::vector<size_t> m_generation;
+        std::vector<id_vector> m_tiles_by_lane;
+        std::vector<id_vector> m_surfaces_by_lane;
+        std::vector< std::vector<bitset_t> > m_groups_by_lane;
+        constants::tile_naming_method m_naming_method;
+        bool m_is_built;
+    };
+}}}}
@@ -0,0 +1,209 @@
+/** Filter options compiled against the layout of a run
+ *
+ *  @file
+ *  @date 10/18/26
+ *  @version 1.0
+ *  @copyright GNU Public License.
+ */
+#pragma once
+
+#include <vector>
+#include <limits>
+#include <utility>
+#include "interop/constants/typedefs.h"
+#include "interop/model/run/flowcell_layout.h"
+
+namespace illumina { namespace interop { namespace model { namespace plot
+{
+    /** Filter options compiled into a tile mask and a cycle range
+     *
+     * A mask is built by filter_options::compile. It holds one flag for each tile in the tile geometry table of the
+     * flowcell layout, so a record is tested with a lane comparison, a tile lookup and a cycle comparison.
+     *
+     * @note The mask refers to the flowcell layout it was compiled against, which must outlive the mask.
+     */
+    class filter_mask
+    {
+    public:
+        /** ID type - Range: 1-N - All: 0*/
+        typedef ::uint32_t id_t;
+
+    public:
+        /** Constructor for a mask that keeps every record
+         */
+        filter_mask() :
+                m_layout(0),
+                m_lane(0),
+                m_surface(0),
+                m_tile_number(0),
+                m_swath(0),
+                m_section(0),
+                m_first_cycle(0),
+                m_last_cycle(std::numeric_limits<id_t>::max()),
+                m_all_tiles(true)
+        {}
+        /** Constructor
+         *
+         * @param layout flowcell layout holding the tile geometry table
+         * @param lane lane number (0 for all)
+         * @param surface surface number (0 for all)
+         * @param tile_number tile number (0 for all)
+         * @param swath swath number (0 for all)
+         * @param section section number (0 for all)
+         * @param cycle cycle number (0 for all)
+         */
+        filter_mask(const run::flowcell_layout& layout,
+                    const id_t lane,
+                    const id_t surface,
+                    const id_t tile_number,
+                    const id_t swath,
+                    const id_t section,
+                    const id_t cycle) :
+                m_layout(&layout),
+                m_lane(lane),
+                m_surface(surface),
+                m_tile_number(tile_number),
+                m_swath(swath),
+                m_section(section),
+                m_first_cycle(cycle),
+                m_last_cycle(cycle == 0 ? std::numeric_limits<id_t>::max() : cycle),
+                m_all_tiles(surface == 0 && tile_number == 0 && swath == 0 && section == 0)
+        {
+            if(m_all_tiles) return;
+            m_tile_mask.resize(layout.tile_geometry_count());
+            for(size_t index = 0; index < m_tile_mask.size(); ++index)
+                m_tile_mask[index] = valid_geometry(layout.geometry_at(index)) ? 1 : 0;
+        }
+
+    public:
+        /** Test if the lane and tile of a metric pass the filter
+         *
+         * @param metric any metric type
+         * @return true if the tile should not be filtered
+         */
+        template<class Metric>
+        bool valid_tile(const Metric &metric) const
+        {
+            return valid_lane(metric.lane()) && valid_tile_id(metric.tile());
+        }
+
+        /** Test if the lane, tile and cycle of a metric pass the filter
+         *
+         * @param metric any metric type
+         * @return true if the tile should not be filtered
+         */
+        template<class Metric>
+        bool valid_tile_cycle(const Metric &metric) const
+        {
+            typedef typename Metric::base_t base_t;
+            return valid_tile(metric) && valid_cycle(metric, base_t::null());
+        }
+
+        /** Test if the lane passes the filter
+         *
+         * @param lane lane number
+         * @return true if the lane should not be filtered
+         */
+        bool valid_lane(const id_t lane) const
+        {
+            return m_lane == 0 || m_lane == lane;
+        }
+
+        /** Test if the tile passes the filter
+         *
+         * @param tile tile id
+         * @return true if the tile should not be filtered
+         */
+        bool valid_tile_id(const id_t tile) const
+        {
+            if(m_all_tiles) return true;
+            const size_t index = m_layout->tile_index(tile);
+            if(index < m_tile_mask.size()) return m_tile_mask[index] != 0;
+            return valid_geometry(m_layout->geometry(tile));
+        }
+
+        /** Test if the cycle passes the filter
+         *
+         * @param cycle cycle number
+         * @return true if the cycle should not be filtered
+         */
+        bool valid_cycle(const id_t cycle) const
+        {
+            return cycle >= m_first_cycle && cycle <= m_last_cycle;
+        }
+
+        /** Get the first cycle that passes the filter
+         *
+         * @return first cycle
+         */
+        id_t first_cycle() const
+        {
+            return m_first_cycle;
+        }
+
+        /** Get the last cycle that passes the filter
+         *
+         * @return last cycle
+         */
+        id_t last_cycle() const
+        {
+            return m_last_cycle;
+        }
+
+        /** Test if every tile of a lane passes the filter
+         *
+         * @return true if no tile is filtered
+         */
+        bool all_tiles() const
+        {
+            return m_all_tiles;
+        }
+
+        /** Get the range of records that may pass the lane filter
+         *
+         * If the metric set is partitioned by lane and a single lane is selected, then only the records of that lane
+         * are returned, otherwise the whole set is returned.
+         *
+         * @param metrics set of metric records
+         * @return range of records
+         */
+        template<class MetricSet>
+        std::pair<typename MetricSet::const_iterator, typename MetricSet::const_iterator>
+        select(const MetricSet& metrics) const
+        {
+            if(m_lane != 0 && metrics.is_partitioned()) return metrics.lane_range(m_lane);
+            return std::make_pair(metrics.begin(), metrics.end());
+        }
+
+    private:
+        bool valid_geometry(const run::tile_geometry& geometry) const
+        {
+            return (m_surface == 0 || m_surface == geometry.surface()) &&
+                   (m_tile_number == 0 || m_tile_number == geometry.number()) &&
+                   (m_swath == 0 || m_swath == geometry.swath()) &&
+                   (m_section == 0 || m_section == geometry.section());
+        }
+        template<class Metric>
+        bool valid_cycle(const Metric &metric, const constants::base_cycle_t*) const
+        {
+            return valid_cycle(metric.cycle());
+        }
+        template<class Metric>
+        bool valid_cycle(const Metric &, const void*) const
+        {
+            return true;
+        }
+
+    private:
+        const run::flowcell_layout* m_layout;
+        id_t m_lane;
+        id_t m_surface;
+        id_t m_tile_number;
+        id_t m_swath;
+        id_t m_section;
+        id_t m_first_cycle;
+        id_t m_last_cycle;
+        bool m_all_tiles;
+        std::vector< ::uint8_t > m_tile_mask;
+    };
+}}}}
@@ -18,6 +18,7 @@
 #include "interop/logic/utils/metric_type_ext.h"
 #include "interop/logic/utils/channel.h"
 #include "interop/model/run/info.h"
+#include "interop/model/plot/filter_mask.h"
 
 
 namespace illumina { namespace interop { namespace model { namespace plot
@@ -181,6 +182,18 @@ namespace illumina { namespace interop { namespace model { namespace plot
                               "Invalid filter option channel for metric " << constants::to_string(type));
             //all_cycles
         }
+        /** Compile the lane, tile and cycle filters against the layout of a run
+         *
+         * The compiled mask tests a record with a tile lookup in place of the chain of predicates.
+         *
+         * @note the mask refers to the flowcell layout of the run info, which must outlive the mask
+         * @param run_info run info holding the flowcell layout
+         * @return filter mask
+         */
+        filter_mask compile(const run::info& run_info) const
+        {
+            return filter_mask(run_info.flowcell(), m_lane, m_surface, m_tile_number, m_swath, m_section, m_cycle);
+        }
         /** Test if metric is a valid tile
          *
          * @param metric any metric type
@@ -208,6 +221,44 @@ namespace illumina { namespace interop { namespace model { namespace plot
             return valid_tile(metric) && valid_cycle(metric, base_t::null());
         }
 
+        /** Test if metric is a valid tile, looking up the tile geometry in the flowcell layout
+         *
+         * @param metric any metric type
+         * @param layout flowcell layout holding the tile geometry table
+         * @return true if the tile should not be filtered
+         */
+        template<class Metric>
+        bool valid_tile(const Metric &metric, const run::flowcell_layout& layout) const
+        {
+            return valid_lane(metric.lane()) && valid_tile_geometry(layout.geometry(metric.tile()));
+        }
+
+        /** Test if metric is a valid tile and cycle, looking up the tile geometry in the flowcell layout
+         *
+         * @param metric any metric type
+         * @param layout flowcell layout holding the tile geometry table
+         * @return true if the tile should not be filtered
+         */
+        template<class Metric>
+        bool valid_tile_cycle(const Metric &metric, const run::flowcell_layout& layout) const
+        {
+            typedef typename Metric::base_t base_t;
+            return valid_tile(metric, layout) && valid_cycle(metric, base_t::null());
+        }
+
+        /** Test if the geometry of a tile is valid
+         *
+         * @param geometry surface, swath, section and number of a tile
+         * @return true if the tile should not be filtered
+         */
+        bool valid_tile_geometry(const run::tile_geometry& geometry) const
+        {
+            return valid_surface(geometry.surface()) &&
+                   valid_tile_number(geometry.number()) &&
+                   valid_swath(geometry.swath()) &&
+                   valid_section(geometry.section());
+        }
+
         /** Test if metric is a valid read
          *
          * @param metric any metric type
@@ -9,7 +9,10 @@
 
 #include <string>
 #include <vector>
+#include <algorithm>
 #include "interop/constants/enums.h"
+#include "interop/model/metric_base/base_metric.h"
+#include "interop/model/run/tile_geometry.h"
 
 namespace illumina { namespace interop { namespace model { namespace run
 {
@@ -57,6 +60,7 @@ namespace illumina { namespace interop { namespace model { namespace run
             {
                 m_surface_list.push_back(surface_index);
             }
+            update_tile_geometry();
         }
 
     public:
@@ -193,6 +197,52 @@ namespace illumina { namespace interop { namespace model { namespace run
             return tiles_per_lane()*swath_count()*surface_count()*lane_count();
         }
 
+        /** Get the geometry of a tile
+         *
+         * Tiles covered by the layout are looked up in a table built with the layout, any other tile id is decoded.
+         *
+         * @param tile tile id
+         * @return geometry of the tile
+         */
+        tile_geometry geometry(const uint_t tile) const
+        {
+            const size_t index = tile_index(tile);
+            if (index < m_tile_geometry.size()) return m_tile_geometry[index];
+            return decode_tile_geometry(tile);
+        }
+
+        /** Get the dense index of a tile in the tile geometry table
+         *
+         * @param tile tile id
+         * @return index of the tile, or tile_geometry_count() if the tile is not covered by the layout
+         */
+        size_t tile_index(const uint_t tile) const
+        {
+            if (tile >= m_tile_index.size()) return m_tile_geometry.size();
+            return m_tile_index[tile];
+        }
+
+        /** Get the geometry of a tile by its dense index
+         *
+         * @param index dense index of the tile, less than tile_geometry_count()
+         * @return geometry of the tile
+         */
+        const tile_geometry& geometry_at(const size_t index) const
+        {
+            INTEROP_ASSERT(index < m_tile_geometry.size());
+            return m_tile_geometry[index];
+        }
+
+        /** Get the number of tiles in the tile geometry table
+         *
+         * @note this covers both surfaces of every swath, section and tile number in the layout
+         * @return number of tiles in the table
+         */
+        size_t tile_geometry_count() const
+        {
+            return m_tile_geometry.size();
+        }
+
         /** Set the tile naming method
          *
          * @param naming_method tile naming method
@@ -200,6 +250,7 @@ namespace illumina { namespace interop { namespace model { namespace run
         void set_naming_method(const constants::tile_naming_method naming_method)
         {
             m_naming_method = naming_method;
+            update_tile_geometry();
         }
         /** Set number of lanes
          *
@@ -219,19 +270,28 @@ namespace illumina { namespace interop { namespace model { namespace run
          * @param swath_count number of swathes
          */
         void swath_count(const uint_t swath_count)
-        { m_swath_count = swath_count; }
+        {
+            m_swath_count = swath_count;
+            update_tile_geometry();
+        }
         /** Set number of tiles
          *
          * @param tile_count number of tiles
          */
         void tile_count(const uint_t tile_count)
-        { m_tile_count = tile_count; }
+        {
+            m_tile_count = tile_count;
+            update_tile_geometry();
+        }
         /** Set number of sections per lane
          *
          * @param count number of sections per lane
          */
         void sections_per_lane(const uint_t count)
-        { m_sections_per_lane = count; }
+        {
+            m_sections_per_lane = count;
+            update_tile_geometry();
+        }
         /** Set number of lanes per section
          *
          * @param count number of lanes per section
@@ -239,6 +299,69 @@ namespace illumina { namespace interop { namespace model { namespace run
         void lanes_per_section(const uint_t count)
         { m_lanes_per_section = count; }
 
+    private:
+        /** Build the tile geometry table and the lookup from tile id to dense index
+         *
+         * The table holds every tile id the naming method can encode within the swath and tile counts of
+         * the layout, for both surfaces.
+         */
+        void update_tile_geometry()
+        {
+            m_tile_geometry.clear();
+            m_tile_index.clear();
+            if (m_naming_method != constants::FiveDigit && m_naming_method != constants::FourDigit) return;
+            if (m_swath_count == 0 || m_tile_count == 0 || m_sections_per_lane == 0) return;
+            const bool five_digit = m_naming_method == constants::FiveDigit;
+            const uint_t surface_count = 2;
+            const uint_t swath_count = std::min<uint_t>(m_swath_count, 9);
+            const uint_t section_count = five_digit ? 9 : 1;
+            const uint_t tile_count = std::min<uint_t>(m_tile_count, 99);
+            const uint_t swath_base = five_digit ? 1000 : 100;
+            const uint_t surface_base = swath_base * 10;
+            const size_t count = static_cast<size_t>(surface_count) * swath_count * section_count * tile_count;
+
+            m_tile_index.assign(surface_count * surface_base + swath_count * swath_base + 100 * section_count + 100,
+                                static_cast< ::uint16_t >(count));
+            m_tile_geometry.reserve(count);
+            for (uint_t surface = 1; surface <= surface_count; ++surface)
+            {
+                for (uint_t swath = 1; swath <= swath_count; ++swath)
+                {
+                    for (uint_t section = five_digit ? 1 : 0; section <= (five_digit ? section_count : 0); ++section)
+                    {
+                        for (uint_t number = 1; number <= tile_count; ++number)
+                        {
+                            const uint_t tile = surface * surface_base + swath * swath_base + section * 100 + number;
+                            m_tile_index[tile] = static_cast< ::uint16_t >(m_tile_geometry.size());
+                            m_tile_geometry.push_back(decode_tile_geometry(tile));
+                        }
+                    }
+                }
+            }
+        }
+        /** Decode the geometry of a tile from the tile id
+         *
+         * @param tile tile id
+         * @return geometry of the tile
+         */
+        tile_geometry decode_tile_geometry(const uint_t tile) const
+        {
+            const metric_base::base_metric metric(1, tile);
+            const uint_t row_count = m_sections_per_lane * m_tile_count;
+            const uint_t row = m_sections_per_lane == 0 ? 0 :
+                               metric.physical_location_row(m_naming_method, m_sections_per_lane, m_tile_count);
+            const uint_t location =
+                    metric.physical_location_column(m_naming_method, m_swath_count, false) * row_count + row;
+            const uint_t location_all_surfaces =
+                    metric.physical_location_column(m_naming_method, m_swath_count, true) * row_count + row;
+            return tile_geometry(metric.surface(m_naming_method),
+                                 metric.swath(m_naming_method),
+                                 metric.section(m_naming_method),
+                                 metric.number(m_naming_method),
+                                 location,
+                                 location_all_surfaces);
+        }
+
     private:
         tile_naming_method_t m_naming_method;
         uint_t m_lane_count;
@@ -250,6 +373,8 @@ namespace illumina { namespace interop { namespace model { namespace run
         str_vector_t m_tiles;
         std::string m_barcode;
         std::vector<uint_t> m_surface_list;
+        std::vector<tile_geometry> m_tile_geometry;
+        std::vector< ::uint16_t > m_tile_index;
 
         friend class info;
     };
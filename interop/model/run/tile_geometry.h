@@ -0,0 +1,92 @@
+/** Geometry of a tile on the flow cell
+ *
+ *  @file
+ *  @date 10/18/26
+ *  @version 1.0
+ *  @copyright GNU Public License.
+ */
+#pragma once
+
+#include "interop/constants/typedefs.h"
+
+namespace illumina { namespace interop { namespace model { namespace run
+{
+    /** Geometry of a tile decoded from the tile id
+     *
+     * This holds the surface, swath, section and tile number encoded in a tile id, along with the physical
+     * location of the tile within a lane.
+     */
+    class tile_geometry
+    {
+    public:
+        /** Define an unsigned int */
+        typedef ::uint32_t uint_t;
+
+    public:
+        /** Constructor
+         *
+         * @param surface surface of the tile
+         * @param swath swath of the tile
+         * @param section section of the tile
+         * @param number number of the tile
+         * @param location index of the physical location of the tile within a surface
+         * @param location_all_surfaces index of the physical location of the tile within all surfaces
+         */
+        tile_geometry(const uint_t surface = 0,
+                      const uint_t swath = 0,
+                      const uint_t section = 0,
+                      const uint_t number = 0,
+                      const uint_t location = 0,
+                      const uint_t location_all_surfaces = 0) :
+                m_surface(surface), m_swath(swath), m_section(section), m_number(number),
+                m_location(location), m_location_all_surfaces(location_all_surfaces)
+        {}
+
+    public:
+        /** Get the surface of the tile
+         *
+         * @return surface number
+         */
+        uint_t surface() const
+        { return m_surface; }
+
+        /** Get the swath of the tile
+         *
+         * @return swath number
+         */
+        uint_t swath() const
+        { return m_swath; }
+
+        /** Get the section of the tile
+         *
+         * @return section number
+         */
+        uint_t section() const
+        { return m_section; }
+
+        /** Get the number of the tile
+         *
+         * @return tile number
+         */
+        uint_t number() const
+        { return m_number; }
+
+        /** Get the index of the physical location of the tile within a lane
+         *
+         * @param all_surfaces layout all surfaces of the flowcell
+         * @return index of the physical location within a lane
+         */
+        size_t physical_location_index(const bool all_surfaces) const
+        {
+            return all_surfaces ? m_location_all_surfaces : m_location;
+        }
+
+    private:
+        uint_t m_surface;
+        uint_t m_swath;
+        uint_t m_section;
+        uint_t m_number;
+        uint_t m_location;
+        uint_t m_location_all_surfaces;
+    };
+}}}}
@@ -29,6 +29,7 @@
 #include "interop/model/metrics/q_by_lane_metric.h"
 #include "interop/model/metrics/q_collapsed_metric.h"
 #include "interop/model/metrics/tile_metric.h"
+#include "interop/model/metrics/tile_catalog.h"
 
 namespace illumina { namespace interop { namespace model { namespace metrics
 {
@@ -92,7 +93,7 @@ namespace illumina { namespace interop { namespace model { namespace metrics
     public:
         /** Constructor
          */
-        run_metrics()
+        run_metrics() : m_lazy_thread_count(1), m_is_lazy(false), m_is_lazy_parameters_read(false), m_low_memory(false)
         {
         }
 
@@ -103,7 +104,11 @@ namespace illumina { namespace interop { namespace model { namespace metrics
          */
         run_metrics(const run::info &run_info, const run::parameters &run_param = run::parameters()) :
                 m_run_info(run_info),
-                m_run_parameters(run_param)
+                m_run_parameters(run_param),
+                m_lazy_thread_count(1),
+                m_is_lazy(false),
+                m_is_lazy_parameters_read(false),
+                m_low_memory(false)
         {
         }
 
@@ -137,6 +142,69 @@ namespace illumina { namespace interop { namespace model { namespace metrics
         model::invalid_run_info_exception,
         model::invalid_run_info_cycle_exception,
         model::invalid_parameter));
+        /** Read a subset of the binary metrics and XML files from the run folder
+         *
+         * Records outside the lanes, tiles or cycles selected by the filter are skipped while reading, so memory and
+         * time scale with the selection. For by cycle run folders, cycle files outside the selection are not opened.
+         *
+         * The cumulative q-score histograms need every earlier cycle, so the q-metrics, including q_by_lane_metric
+         * and q_collapsed_metric, are read from the first cycle of the run when the filter starts at a later cycle.
+         * The records before the selected cycles are removed once the cumulative histograms are populated, so the
+         * cumulative values, and any Q30 derived from them, match a full read.
+         *
+         * @note invalid_run_info_cycle_exception and invalid_tile_list_exception can be safely caught and ignored
+         *
+         * @param run_folder run folder path
+         * @param filter select the lanes, tiles and cycles to load
+         * @param thread_count number of threads to use for network loading
+         */
+        void read(const std::string &run_folder, const io::load_filter& filter, const size_t thread_count=1)
+        INTEROP_THROW_SPEC((xml::xml_file_not_found_exception,
+        xml::bad_xml_format_exception,
+        xml::empty_xml_format_exception,
+        xml::missing_xml_element_exception,
+        xml::xml_parse_exception,
+        io::file_not_found_exception,
+        io::bad_format_exception,
+        io::incomplete_file_exception,
+        model::invalid_channel_exception,
+        model::index_out_of_bounds_exception,
+        model::invalid_tile_naming_method,
+        model::invalid_tile_list_exception,
+        model::invalid_run_info_exception,
+        model::invalid_run_info_cycle_exception,
+        model::invalid_parameter));
+        /** Read the records selected by a filter using the sidecar record index of each InterOp file
+         *
+         * Each aggregated InterOp file gets an index, written next to it on first use, that maps the lane, tile and
+         * cycle of each record to its offset. Only the selected records are then read from disk, so drilling down
+         * to a single tile costs time proportional to the records of that tile rather than the whole run. The
+         * index is rebuilt when the size or modification time of the InterOp file changes.
+         *
+         * The q-metrics are filtered by cycle as in `read` with a load filter.
+         *
+         * @see io::read_interop_indexed
+         * @note invalid_run_info_cycle_exception and invalid_tile_list_exception can be safely caught and ignored
+         *
+         * @param run_folder run folder path
+         * @param filter select the lanes, tiles and cycles to load
+         */
+        void read_indexed(const std::string &run_folder, const io::load_filter& filter)
+        INTEROP_THROW_SPEC((xml::xml_file_not_found_exception,
+        xml::bad_xml_format_exception,
+        xml::empty_xml_format_exception,
+        xml::missing_xml_element_exception,
+        xml::xml_parse_exception,
+        io::file_not_found_exception,
+        io::bad_format_exception,
+        io::incomplete_file_exception,
+        model::invalid_channel_exception,
+        model::index_out_of_bounds_exception,
+        model::invalid_tile_naming_method,
+        model::invalid_tile_list_exception,
+        model::invalid_run_info_exception,
+        model::invalid_run_info_cycle_exception,
+        model::invalid_parameter));
         /** Read binary metrics and XML files from the run folder
          *
          * @note invalid_run_info_cycle_exception and invalid_tile_list_exception can be safely caught and ignored
@@ -166,6 +234,89 @@ namespace illumina { namespace interop { namespace model { namespace metrics
         model::invalid_run_info_cycle_exception,
         model::invalid_parameter));
 
+        /** Read XML files from the run folder and defer reading each metric set until it is loaded
+         *
+         * In this lazy mode, `load(group)` reads the InterOp file(s) for a metric group, along with the groups it
+         * depends on (see logic::utils::list_metrics_to_load). Derived metric sets, e.g. q_collapsed_metric,
+         * q_by_lane_metric and dynamic_phasing_metric, are populated when their source metric sets are loaded.
+         * Only the InterOp files a report actually touches are read from disk.
+         *
+         * @note Lazy mode ends when `clear()` or `read()` is called
+         * @note `get<T>()` does not load, a metric set that has not been loaded is empty
+         *
+         * @param run_folder run folder path
+         * @param thread_count number of threads to use for network loading
+         */
+        void read_lazy(const std::string &run_folder, const size_t thread_count=1)
+        INTEROP_THROW_SPEC((xml::xml_file_not_found_exception,
+        xml::bad_xml_format_exception,
+        xml::empty_xml_format_exception,
+        xml::missing_xml_element_exception,
+        xml::xml_parse_exception));
+        /** Test if metric sets are read on first access
+         *
+         * @return true if metric sets are read on first access
+         */
+        bool is_lazy()const
+        {
+            return m_is_lazy;
+        }
+        /** Read a metric group, and the groups it depends on, if it has not already been read in lazy mode
+         *
+         * Only the newly read metric sets are finalized. This does nothing when lazy mode is not enabled.
+         *
+         * @note This modifies the metric sets, and must not be called while another thread reads this object
+         *
+         * @param group metric group
+         */
+        void load(const constants::metric_group group) INTEROP_THROW_SPEC((
+        xml::xml_file_not_found_exception,
+        xml::bad_xml_format_exception,
+        xml::empty_xml_format_exception,
+        xml::missing_xml_element_exception,
+        xml::xml_parse_exception,
+        io::file_not_found_exception,
+        io::bad_format_exception,
+        io::incomplete_file_exception,
+        model::invalid_channel_exception,
+        model::index_out_of_bounds_exception,
+        model::invalid_tile_naming_method,
+        model::invalid_tile_list_exception,
+        model::invalid_run_info_exception,
+        model::invalid_run_info_cycle_exception,
+        model::invalid_parameter));
+
+        /** Read binary metrics and XML files from a bundle file
+         *
+         * The bundle is opened once and memory mapped, and each metric set is decoded directly from its section.
+         * The same rules apply as reading a run folder: by cycle sections are only read when no aggregated
+         * InterOp section is found, and incomplete sections are ignored.
+         *
+         * The q-metrics are filtered by cycle as in `read` with a load filter.
+         *
+         * @see write_bundle
+         * @note invalid_run_info_cycle_exception and invalid_tile_list_exception can be safely caught and ignored
+         *
+         * @param bundle_file bundle file path
+         * @param filter select the lanes, tiles and cycles to load
+         */
+        void read_bundle(const std::string &bundle_file, const io::load_filter& filter=io::load_filter())
+        INTEROP_THROW_SPEC((xml::xml_file_not_found_exception,
+        xml::bad_xml_format_exception,
+        xml::empty_xml_format_exception,
+        xml::missing_xml_element_exception,
+        xml::xml_parse_exception,
+        io::file_not_found_exception,
+        io::bad_format_exception,
+        io::incomplete_file_exception,
+        model::invalid_channel_exception,
+        model::index_out_of_bounds_exception,
+        model::invalid_tile_naming_method,
+        model::invalid_tile_list_exception,
+        model::invalid_run_info_exception,
+        model::invalid_run_info_cycle_exception,
+        model::invalid_parameter));
+
         /** Read XML files: RunInfo.xml and possibly RunParameters.xml
          *
          * @param run_folder run folder path
@@ -213,6 +364,57 @@ namespace illumina { namespace interop { namespace model { namespace metrics
         model::invalid_run_info_cycle_exception,
         model::invalid_parameter));
 
+        /** Set whether to reduce memory used by the q-metrics
+         *
+         * In low memory mode, `finalize_after_load` does not populate the cumulative q-score histogram for each
+         * q_metric record, which takes twice the memory of the raw histogram. Accumulated values remain available
+         * from the q_collapsed_metric and q_by_lane_metric sets, which are always derived. The raw q_metric
+         * histograms are kept, since the imaging table and the cycle state summary depend on them.
+         *
+         * @note q_metric::percent_over_qscore_cumulative and related functions cannot be used in low memory mode
+         * @note This setting is not reset by `clear()`
+         *
+         * @param low_memory true to enable low memory mode
+         */
+        void low_memory(const bool low_memory)
+        {
+            m_low_memory = low_memory;
+        }
+        /** Test if low memory mode is enabled
+         *
+         * @return true if the cumulative q-score histograms are not populated for each q_metric record
+         */
+        bool low_memory()const
+        {
+            return m_low_memory;
+        }
+        /** Get the catalog of the tiles present in each metric set
+         *
+         * The catalog is built by `finalize_after_load` and `update_catalog`, and is never rebuilt by this accessor.
+         * Use `is_catalog_current` to test whether a metric set has changed since.
+         *
+         * @note In lazy mode, the catalog only covers the metric groups loaded so far
+         *
+         * @return tile catalog
+         */
+        const tile_catalog& catalog()const;
+        /** Test if the catalog matches the current metric sets
+         *
+         * The catalog records the generation of each metric set, which is incremented by every operation that adds,
+         * removes or reorders records.
+         *
+         * @return true if no metric set or the tile naming method has changed since the catalog was built
+         */
+        bool is_catalog_current()const;
+        /** Rebuild the catalog if any metric set or the tile naming method has changed since it was built
+         */
+        void update_catalog();
+        /** Build a catalog of the tiles present in each metric set
+         *
+         * @param catalog destination catalog
+         */
+        void populate_catalog(tile_catalog& catalog)const;
+
         /** Test if all metrics are empty
          *
          * @return true if all metrics are empty
@@ -318,6 +520,7 @@ namespace illumina { namespace interop { namespace model { namespace metrics
         {
             //static_assert( )
             m_metrics.get< T >() = metrics;
+            m_tile_catalog.clear();
         }
         /** Get a metric set
          *
@@ -349,7 +552,7 @@ namespace illumina { namespace interop { namespace model { namespace metrics
         template<class T>
         metric_base::metric_set<T> &get_metric_set()
         {
-            return m_metrics.get<metric_base::metric_set<T> >();
+            return get<T>();
         }
 
     public:
@@ -383,8 +586,12 @@ namespace illumina { namespace interop { namespace model { namespace metrics
          * @param run_folder run folder path
          * @param last_cycle last cycle of run
          * @param thread_count number of threads to use for network loading
+         * @param filter select the lanes, tiles and cycles to load
          */
-        void read_metrics(const std::string &run_folder, const size_t last_cycle, const size_t thread_count) INTEROP_THROW_SPEC((
+        void read_metrics(const std::string &run_folder,
+                          const size_t last_cycle,
+                          const size_t thread_count,
+                          const io::load_filter& filter=io::load_filter()) INTEROP_THROW_SPEC((
         io::file_not_found_exception,
         io::bad_format_exception,
         io::incomplete_file_exception));
@@ -400,12 +607,14 @@ namespace illumina { namespace interop { namespace model { namespace metrics
          * @param valid_to_load boolean vector indicating which files to load
          * @param thread_count number of threads to use for network loading
          * @param skip_loaded skip metrics that are already loaded
+         * @param filter select the lanes, tiles and cycles to load
          */
         void read_metrics(const std::string &run_folder,
                           const size_t last_cycle,
                           const std::vector<unsigned char>& valid_to_load,
                           const size_t thread_count,
-                          const bool skip_loaded=false) INTEROP_THROW_SPEC((
+                          const bool skip_loaded=false,
+                          const io::load_filter& filter=io::load_filter()) INTEROP_THROW_SPEC((
         io::file_not_found_exception,
         io::bad_format_exception,
         io::incomplete_file_exception,
@@ -420,6 +629,19 @@ namespace illumina { namespace interop { namespace model { namespace metrics
         io::bad_format_exception));
 
 
+        /** Write binary metrics and the XML files of the run folder to a single bundle file
+         *
+         * Each non-empty metric set is written as an aggregated InterOp section. RunInfo.xml and RunParameters.xml
+         * are copied from the run folder when they exist.
+         *
+         * @see read_bundle
+         * @param bundle_file bundle file path
+         * @param run_folder run folder path holding the XML files
+         */
+        void write_bundle(const std::string &bundle_file, const std::string &run_folder)const INTEROP_THROW_SPEC((
+        io::file_not_found_exception,
+        io::bad_format_exception));
+
         /** Read a single metric set from a binary buffer
          *
          * @param group metric set to write
@@ -515,17 +737,31 @@ namespace illumina { namespace interop { namespace model { namespace metrics
          */
         void populate_id_map(cycle_metric_map_t &map) const;
         /** Sort the metrics by id
+         *
+         * @param thread_count number of threads used to order the ids of each metric set
          */
-        void sort();
+        void sort(const size_t thread_count=1);
 
         /** Clear all the metrics
          */
          void clear();
 
+    private:
+        void finalize_groups(const std::vector<unsigned char>& groups, size_t count, const size_t first_cycle);
+
     private:
         metric_list_t m_metrics;
         run::info m_run_info;
         run::parameters m_run_parameters;
+        // Lazy loading state
+        std::string m_lazy_run_folder;
+        size_t m_lazy_thread_count;
+        std::vector<unsigned char> m_lazy_loaded;
+        bool m_is_lazy;
+        bool m_is_lazy_parameters_read;
+        bool m_low_memory;
+        // Derived from the metric sets
+        tile_catalog m_tile_catalog;
 
     };
 
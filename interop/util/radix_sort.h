@@ -0,0 +1,144 @@
+/** Radix sort by an unsigned integer key
+ *
+ * The sort computes a permutation over an index array, so records that own heap memory are only moved once, when
+ * the permutation is applied.
+ *
+ *  @file
+ *  @date 10/18/26
+ *  @version 1.0
+ *  @copyright GNU Public License.
+ */
+#pragma once
+
+#include <vector>
+#include <cstddef>
+#include <iterator>
+#include <algorithm>
+#include "interop/util/cstdint.h"
+
+namespace illumina { namespace interop { namespace util
+{
+    /** Compute the permutation that sorts a collection by an unsigned 64-bit key
+     *
+     * This is a stable least-significant-digit radix sort over 8-bit digits. Digits that are the same for every
+     * key are skipped, so a packed metric id only pays for the bits that vary, e.g. the reserved bits are never
+     * sorted.
+     *
+     * Each pass is split into contiguous blocks: every thread counts the digits of its own block, then scatters its
+     * block to precomputed offsets, which keeps the sort stable for any number of threads.
+     *
+     * @note OpenMP is used if available, otherwise thread_count is ignored
+     *
+     * @param beg iterator to start of collection
+     * @param end iterator to end of collection
+     * @param key_of function that takes one value and returns its key
+     * @param order destination permutation, where order[i] is the index of the ith smallest value
+     * @param thread_count number of threads
+     */
+    template<typename I, typename KeyOp>
+    void radix_sort_order(I beg,
+                          I end,
+                          KeyOp key_of,
+                          std::vector<size_t>& order,
+                          const size_t thread_count=1)
+    {
+        typedef ::uint64_t key_t;
+        enum
+        {
+            DIGIT_BIT_COUNT = 8,
+            DIGIT_COUNT = 1 << DIGIT_BIT_COUNT,
+            KEY_BIT_COUNT = 64
+        };
+        const size_t n = static_cast<size_t>(std::distance(beg, end));
+        order.resize(n);
+        for (size_t i = 0; i < n; ++i) order[i] = i;
+        if (n < 2) return;
+
+        std::vector<key_t> keys(n);
+        key_t varying_bits = 0;
+        {
+            size_t i = 0;
+            for (I it = beg; it != end; ++it, ++i)
+            {
+                keys[i] = static_cast<key_t>(key_of(*it));
+                varying_bits |= keys[i] ^ keys[0];
+            }
+        }
+        if (varying_bits == 0) return;
+
+        const size_t block_count = std::max(static_cast<size_t>(1), std::min(thread_count, n / DIGIT_COUNT + 1));
+        const size_t block_size = (n + block_count - 1) / block_count;
+        std::vector<key_t> keys_tmp(n);
+        std::vector<size_t> order_tmp(n);
+        std::vector<size_t> offsets(block_count * DIGIT_COUNT);
+        for (size_t shift = 0; shift < KEY_BIT_COUNT; shift += DIGIT_BIT_COUNT)
+        {
+            if (((varying_bits >> shift) & (DIGIT_COUNT - 1)) == 0) continue;
+            std::fill(offsets.begin(), offsets.end(), 0);
+#ifdef _OPENMP
+#           pragma omp parallel for default(shared) num_threads(static_cast<int>(block_count))
+#endif
+            for (int block = 0; block < static_cast<int>(block_count); ++block)
+            {
+                size_t* count = &offsets[static_cast<size_t>(block) * DIGIT_COUNT];
+                const size_t first = static_cast<size_t>(block) * block_size;
+                const size_t last = std::min(first + block_size, n);
+                for (size_t i = first; i < last; ++i) ++count[(keys[i] >> shift) & (DIGIT_COUNT - 1)];
+            }
+            size_t sum = 0;
+            for (size_t digit = 0; digit < DIGIT_COUNT; ++digit)
+            {
+                for (size_t block = 0; block < block_count; ++block)
+                {
+                    const size_t count = offsets[block * DIGIT_COUNT + digit];
+                    offsets[block * DIGIT_COUNT + digit] = sum;
+                    sum += count;
+                }
+            }
+#ifdef _OPENMP
+#           pragma omp parallel for default(shared) num_threads(static_cast<int>(block_count))
+#endif
+            for (int block = 0; block < static_cast<int>(block_count); ++block)
+            {
+                size_t* offset = &offsets[static_cast<size_t>(block) * DIGIT_COUNT];
+                const size_t first = static_cast<size_t>(block) * block_size;
+                const size_t last = std::min(first + block_size, n);
+                for (size_t i = first; i < last; ++i)
+                {
+                    const size_t dest = offset[(keys[i] >> shift) & (DIGIT_COUNT - 1)]++;
+                    keys_tmp[dest] = keys[i];
+                    order_tmp[dest] = order[i];
+                }
+            }
+            keys.swap(keys_tmp);
+            order.swap(order_tmp);
+        }
+    }
+
+    /** Reorder a collection in place so the ith value is the value previously at order[i]
+     *
+     * Each cycle of the permutation is followed once, so every value is swapped into place exactly once.
+     *
+     * @note the permutation is consumed, on return order[i] == i
+     *
+     * @param beg random access iterator to start of collection
+     * @param order permutation, where order[i] is the index of the value that belongs at i
+     */
+    template<typename I>
+    void apply_permutation(I beg, std::vector<size_t>& order)
+    {
+        using std::swap;
+        for (size_t i = 0; i < order.size(); ++i)
+        {
+            size_t current = i;
+            while (order[current] != i)
+            {
+                const size_t next = order[current];
+                swap(*(beg + current), *(beg + next));
+                order[current] = current;
+                current = next;
+            }
+            order[current] = current;
+        }
+    }
+}}}
@@ -16,6 +16,8 @@
 #include <limits>
 #include <numeric>
 #include <algorithm>
+#include <functional>
+#include <iterator>
 #include "interop/util/assert.h"
 #include "interop/util/math.h"
 
@@ -467,7 +469,6 @@ namespace illumina { namespace interop { namespace util
         return interpolate_linear(y1, y2, x1, x2, static_cast<float>(percentile));
     }
 
-// TODO: median using nth_element
     /** Sort NaNs to the end of the collection return iterator to first NaN value
      *
      * @param beg iterator to start of collection
@@ -555,8 +556,56 @@ namespace illumina { namespace interop { namespace util
         return percentile_sorted<F>(beg, end, 50, op);
     }
 
+    /** Calculate the median of the collection using selection rather than sorting
+     *
+     * This gives the same value as median_interpolated, but only partially orders the collection.
+     *
+     * @note this will change the underlying array!
+     *
+     * @param beg iterator to start of collection
+     * @param end iterator to end of collection
+     * @param comp comparator between two types
+     * @param op function that takes one value and returns another value
+     * @return interpolated median of the collection
+     */
+    template<typename F, typename I, typename Compare, typename Op>
+    F median_interpolated_select(I beg, I end, Compare comp, Op op)
+    {
+        INTEROP_ASSERT(beg != end);
+        const size_t percentile = 50;
+        const size_t n = static_cast<size_t>(std::distance(beg, end));
+        if (n == 0) return std::numeric_limits<F>::quiet_NaN();
+        size_t nth_index = percentile * n / 100;
+        if ((n * percentile / 100.0f - nth_index) < 0.5f)
+        {
+            if (nth_index == 0) return op(*std::min_element(beg, end, comp));
+            nth_index--;
+        }
+        if (nth_index >= (n - 1)) return op(*std::max_element(beg, end, comp));
+        I nth = beg + nth_index;
+        std::nth_element(beg, nth, end, comp);
+        const F y1 = op(*nth);
+        const F y2 = op(*std::min_element(nth + 1, end, comp));
+        const F x1 = 100.0f * (nth_index + 0.5f) / n;
+        const F x2 = 100.0f * (nth_index + 0.5f + 1) / n;
+        return interpolate_linear(y1, y2, x1, x2, static_cast<float>(percentile));
+    }
+    /** Calculate the median of the collection using selection rather than sorting
+     *
+     * @note this will change the underlying array!
+     *
+     * @param beg iterator to start of collection
+     * @param end iterator to end of collection
+     * @return interpolated median of the collection
+     */
+    template<typename F, typename I>
+    F median_interpolated_select(I beg, I end)
+    {
+        typedef typename std::iterator_traits<I>::value_type value_t;
+        return median_interpolated_select<F>(beg, end, std::less<value_t>(), op::operator_none());
+    }
+
     //TODO: remove_nan
-    // TODO:  nan_median using nth_element
 
     /** Estimate the mean of values in a given collection
      *
@@ -754,6 +803,56 @@ namespace illumina { namespace interop { namespace util
         return variance_with_mean<R>(beg, end, mean, op::operator_none());
     }
 
+    /** Estimate the mean and variance of values in a given collection
+     *
+     * This replaces calling mean and variance_with_mean separately, and gives the same result. The first pass
+     * counts and sums the values, the second accumulates the squared deviations from the mean. Neither pass
+     * calls std::distance or allocates memory, and NaN values are optionally skipped in place rather than removed.
+     *
+     * Usage:
+     *  std::vector<float> values = {0,1,2,3};
+     *  float mean_val, var_val;
+     *  mean_variance(values.begin(), values.end(), mean_val, var_val, op::operator_none(), false);
+     *
+     * @param beg iterator to start of collection
+     * @param end iterator to end of collection
+     * @param mean_val destination mean (0 for an empty collection)
+     * @param variance_val destination variance (0 for less than two values)
+     * @param op function that takes one value and returns another value
+     * @param skip_nan skip NaN values, otherwise a NaN propagates to the mean and variance
+     * @return number of values included in the mean and variance
+     */
+    template<typename R, typename I, typename UnaryOp>
+    size_t mean_variance(I beg, I end, R& mean_val, R& variance_val, UnaryOp op, const bool skip_nan)
+    {
+        mean_val = 0;
+        variance_val = 0;
+        size_t n = 0;
+        R sum = 0;
+        for (I it = beg; it != end; ++it)
+        {
+            const R val = static_cast<R>(op(*it));
+            if (skip_nan && std::isnan(val)) continue;
+            sum += val;
+            ++n;
+        }
+        if (n == 0) return 0;
+        mean_val = sum / R(n);
+        if (n <= 1) return n;
+        R sum2 = 0;
+        R sum3 = 0;
+        for (; beg != end; ++beg)
+        {
+            const R val = static_cast<R>(op(*beg));
+            if (skip_nan && std::isnan(val)) continue;
+            const R diff = val - mean_val;
+            sum2 += diff * diff;
+            sum3 += diff;
+        }
+        variance_val = (sum2 - sum3 * sum3 / R(n)) / R(n - 1);
+        return n;
+    }
+
 }}}
 
 
@@ -10,6 +10,11 @@
  *
  * The InterOp files will be written to the current working directory into a sub folder called InterOp. All the records
  * will be sorted so two InterOp files can be compared with Linux `diff`.
+ *
+ * To pack the aggregated InterOp files along with RunInfo.xml and RunParameters.xml into a single bundle file, which
+ * can be read with `run_metrics::read_bundle`, run as follows:
+ *
+ *      $ aggregate 140131_1287_0851_A01n401drr --bundle=140131_1287_0851_A01n401drr.bundle
  */
 
 #include <iostream>
@@ -83,9 +88,11 @@ int main(int argc, const char** argv)
     std::cout << "# Version: " << INTEROP_VERSION << std::endl;
 
     size_t max_tile_number=0;
+    std::string bundle_file;
     util::option_parser description;
     description
-            (max_tile_number, "max-tile", "Maximum tile number to include");
+            (max_tile_number, "max-tile", "Maximum tile number to include")
+            (bundle_file, "bundle", "Write a single bundle file instead of the InterOp folder");
     if(description.is_help_requested(argc, argv))
     {
         std::cout << "Usage: " << io::basename(argv[0]) << " run_folder [--option1=value1] [--option2=value2]" << std::endl;
@@ -110,7 +117,7 @@ int main(int argc, const char** argv)
     std::cout << "# Run Folder: " << run_name << std::endl;
     int ret = read_run_metrics(input_file.c_str(), run, thread_count);
     if(ret != SUCCESS) return ret;
-    io::mkdir("InterOp");
+    if(bundle_file == "") io::mkdir("InterOp");
     run.sort();
     zero_extraction_time(run.get<extraction_metric>().begin(), run.get<extraction_metric>().end());
     if(max_tile_number > 0)
@@ -128,7 +135,8 @@ int main(int argc, const char** argv)
         }
         std::cout << subset.get<model::metrics::extraction_metric>().size() << ", " << run.get<model::metrics::extraction_metric>().size() << std::endl;
         try{
-            subset.write_metrics(".");
+            if(bundle_file != "") subset.write_bundle(bundle_file, input_file);
+            else subset.write_metrics(".");
         }
         catch(const std::exception& ex)
         {
@@ -140,7 +148,8 @@ int main(int argc, const char** argv)
     else
     {
         try{
-            run.write_metrics(".");
+            if(bundle_file != "") run.write_bundle(bundle_file, input_file);
+            else run.write_metrics(".");
         }
         catch(const std::exception& ex)
         {
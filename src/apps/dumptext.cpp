@@ -110,6 +110,9 @@
  *
  *      --subset=n (where `n` is an integer greater than 0)
  *          This option selects the first `n` records and displays only those.
+ *
+ *      --threads=n (where `n` is an integer greater than 0)
+ *          This option formats blocks of records on `n` threads. The output is the same for any number of threads.
  */
 
 #include <iostream>
@@ -132,8 +135,10 @@ struct metric_writer
      *
      * @param out output stream
      * @param channels list of channel names
+     * @param thread_count number of threads used to format records
      */
-    metric_writer(std::ostream& out, const std::vector<std::string>& channels) : m_out(out), m_channel_names(channels){}
+    metric_writer(std::ostream& out, const std::vector<std::string>& channels, const size_t thread_count) :
+            m_out(out), m_channel_names(channels), m_thread_count(thread_count){}
     /** Function operator overload to write data
      *
      * @param metrics set of metrics
@@ -142,11 +147,12 @@ struct metric_writer
     void operator()(const MetricSet& metrics)const
     {
         if(metrics.empty()) return;
-        io::write_text(m_out, metrics, m_channel_names);
+        io::write_text_buffered(m_out, metrics, m_channel_names, m_thread_count);
     }
 private:
     std::ostream& m_out;
     std::vector<std::string> m_channel_names;
+    size_t m_thread_count;
 
 };
 /** Copy of subset of metrics
@@ -186,9 +192,10 @@ int main(int argc, const char** argv)
         //print_help(std::cout);
         return INVALID_ARGUMENTS;
     }
-    const size_t thread_count = 1;
+    size_t thread_count = 1;
 
     const char eol = '\n';
+    std::ios::sync_with_stdio(false);
 
     std::cout << "# Version: " << INTEROP_VERSION << std::endl;
 
@@ -197,7 +204,8 @@ int main(int argc, const char** argv)
     util::option_parser description;
     description
             (subset_count, "subset", "Number of metrics to subsample")
-            (metric_name, "metric", "Name of metric to load, e.g. --metric=Tile to load TileMetricsOut.bin");
+            (metric_name, "metric", "Name of metric to load, e.g. --metric=Tile to load TileMetricsOut.bin")
+            (thread_count, "threads", "Number of threads used to format records");
     if(description.is_help_requested(argc, argv))
     {
         std::cout << "Usage: " << io::basename(argv[0]) << " run_folder [--option1=value1] [--option2=value2]" << std::endl;
@@ -213,6 +221,7 @@ int main(int argc, const char** argv)
         std::cerr << ex.what() << std::endl;
         return INVALID_ARGUMENTS;
     }
+    if(thread_count == 0) thread_count = 1;
     std::vector<unsigned char> valid_to_load;
     if("" != metric_name)
     {
@@ -236,7 +245,7 @@ int main(int argc, const char** argv)
                         read_run_metrics(argv[i], run, thread_count) :
                         read_run_metrics(argv[i], run, valid_to_load, thread_count);
         if(ret != SUCCESS) return ret;
-        metric_writer write_metrics(std::cout, run.run_info().channels());
+        metric_writer write_metrics(std::cout, run.run_info().channels(), thread_count);
         if( subset_count > 0 )
         {
             run_metrics subset;
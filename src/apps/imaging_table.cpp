@@ -11,6 +11,10 @@
  *
  * In this sample, 9166157_221Bin2R0I is a run folder and the summary is written to the standard output.
  *
+ * Several run folders may be given at once. Up to `--threads` run folders are processed at the same time, and
+ * `--max-memory` limits the total size (in megabytes) of the InterOp files loaded at once. The output of each run
+ * is written as soon as the run completes.
+ *
  *      # Run Folder: 9166157_221Bin2R0I
  *      Lane,Tile,Cycle,Read,Cycle Within Read,Density(k/mm2),Density Pf(k/mm2),Cluster Count (k),Cluster Count Pf (k),% Pass Filter,% Aligned,% Phasing,% Prephasing,Error Rate,%>= Q20,%>= Q30,P90|A,P90|C,P90|G,P90|T,% No Calls,% Base|A,% Base|C,% Base|G,% Base|T,Fwhm|A,Fwhm|C,Fwhm|G,Fwhm|T,Corrected|A,Corrected|C,Corrected|G,Corrected|T,Called|A,Called|C,Called|G,Called|T,Signal To Noise,Time,Surface,Swath,Tile Number
  *      1,1101,1,1,1,2353.8,864,6470,2375,36.7,97.6,0,0.131,0.29,95.2,5.07,246,419,274,587,63.3,12.6,25,21.1,41.3,2.2,2.38,2.23,2.26,117,95,103,117,386,369,382,394,0,9.85889e+18,1,1,1
@@ -25,32 +29,37 @@
 #include "interop/model/run_metrics.h"
 #include "interop/logic/table/create_imaging_table.h"
 #include "interop/io/table/imaging_table_csv.h"
+#include "interop/util/option_parser.h"
 #include "interop/version.h"
 #include "inc/application.h"
 
 using namespace illumina::interop::model::metrics;
 using namespace illumina::interop;
 
-int main(int argc, char** argv)
+/** Read a single run folder and write its imaging table
+ */
+struct imaging_table_processor
 {
-    if (argc == 0)
+    /** Constructor
+     */
+    imaging_table_processor()
     {
-        std::cerr << "No arguments specified!" << std::endl;
-        return INVALID_ARGUMENTS;
+        logic::table::list_imaging_table_metrics_to_load(m_valid_to_load);
     }
-    const size_t thread_count = 1;
-
-    std::cout << "# Version: " << INTEROP_VERSION << std::endl;
-
-// @ [Reporting Imaging Metrics in C++]
-    std::vector<unsigned char> valid_to_load;
-
-    logic::table::list_imaging_table_metrics_to_load(valid_to_load);
-    for (int i = 1; i < argc; i++)
+    /** Read a single run folder and write its imaging table
+     *
+     * @param run_folder run folder
+     * @param out output stream for the imaging table
+     * @param err output stream for error messages
+     * @return exit code
+     */
+    int operator()(const std::string& run_folder, std::ostream& out, std::ostream& err)const
     {
+        const size_t thread_count = 1;
+// @ [Reporting Imaging Metrics in C++]
         run_metrics run;
-        std::cout << "# Run Folder: " << io::basename(argv[i]) << std::endl;
-        int ret = read_run_metrics(argv[i], run, valid_to_load, thread_count);
+        out << "# Run Folder: " << io::basename(run_folder) << std::endl;
+        int ret = read_run_metrics(run_folder.c_str(), run, m_valid_to_load, thread_count, true, err);
         if (ret != SUCCESS) return ret;
 
 #ifdef INTEROP_TEST_CSHARP_BINDING
@@ -71,12 +80,49 @@ int main(int argc, char** argv)
         }
         catch(const std::exception& ex)
         {
-            std::cerr << ex.what() << std::endl;
+            err << ex.what() << std::endl;
             return UNEXPECTED_EXCEPTION;
         }
-        std::cout << table << std::endl;
-    }
+        out << table << std::endl;
 // @ [Reporting Imaging Metrics in C++]
-    return SUCCESS;
+        return SUCCESS;
+    }
+
+private:
+    std::vector<unsigned char> m_valid_to_load;
+};
+
+int main(int argc, const char** argv)
+{
+    if (argc == 0)
+    {
+        std::cerr << "No arguments specified!" << std::endl;
+        return INVALID_ARGUMENTS;
+    }
+    size_t thread_count = 1;
+    size_t memory_cap_mb = 0;
+
+    util::option_parser description;
+    add_batch_options(description, thread_count, memory_cap_mb);
+    if(description.is_help_requested(argc, argv))
+    {
+        std::cout << "Usage: " << io::basename(argv[0]) << " run_folder [--option1=value1] [--option2=value2]" << std::endl;
+        description.display_help(std::cout);
+        return SUCCESS;
+    }
+    try
+    {
+        description.parse(argc, argv);
+        description.check_for_unknown_options(argc, argv);
+    }
+    catch(const util::option_exception& ex)
+    {
+        std::cerr << ex.what() << std::endl;
+        return INVALID_ARGUMENTS;
+    }
+
+    std::cout << "# Version: " << INTEROP_VERSION << std::endl;
+    const std::vector<std::string> run_folders(argv+1, argv+argc);
+    return process_run_folders(run_folders, imaging_table_processor(), thread_count, memory_cap_mb*1024*1024);
 }
 
@@ -8,7 +8,18 @@
  *  @copyright GNU Public License.
  */
 #pragma once
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+#ifdef WIN32
+#include <windows.h>
+#else
+#include <unistd.h>
+#endif
+#include <iostream>
+#include <sstream>
 #include "interop/model/run_metrics.h"
+#include "interop/util/filesystem.h"
 
 
 /** Exit codes that can be produced by the application
@@ -39,12 +50,14 @@ enum exit_codes
  * @param metrics run metrics
  * @param thread_count number of threads to use for network loading
  * @param check_empty if true return an error if the metrics are empty
+ * @param err output stream for error messages
  * @return exit code
  */
 inline int read_run_metrics(const char* filename,
                             illumina::interop::model::metrics::run_metrics& metrics,
                             const size_t thread_count,
-                            const bool check_empty=true)
+                            const bool check_empty=true,
+                            std::ostream& err=std::cerr)
 {
     using namespace illumina::interop;
     using namespace illumina::interop::model;
@@ -54,31 +67,31 @@ inline int read_run_metrics(const char* filename,
     }
     catch(const xml::xml_file_not_found_exception& ex)
     {
-        std::cerr << ex.what() << std::endl;
+        err << ex.what() << std::endl;
         return MISSING_RUNINFO_XML;
     }
     catch(const xml::xml_parse_exception& ex)
     {
-        std::cerr << ex.what() << std::endl;
+        err << ex.what() << std::endl;
         return MALFORMED_XML;
     }
     catch(const io::bad_format_exception& ex)
     {
-        std::cerr << ex.what() << std::endl;
+        err << ex.what() << std::endl;
         return BAD_FORMAT;
     }
     catch(const model::invalid_run_info_cycle_exception& ex)
     {
-        std::cerr << ex.what() << std::endl;
+        err << ex.what() << std::endl;
     }
     catch(const std::exception& ex)
     {
-        std::cerr << ex.what() << std::endl;
+        err << ex.what() << std::endl;
         return UNEXPECTED_EXCEPTION;
     }
     if(check_empty && metrics.empty())
     {
-        std::cerr << "No InterOp files found" << std::endl;
+        err << "No InterOp files found" << std::endl;
         return EMPTY_INTEROP;
     }
     return SUCCESS;
@@ -92,13 +105,15 @@ inline int read_run_metrics(const char* filename,
  * @param valid_to_load list of metrics that are valid to load
  * @param thread_count number of threads to use for network loading
  * @param check_empty if true return an error if the metrics are empty
+ * @param err output stream for error messages
  * @return exit code
  */
 inline int read_run_metrics(const char* filename,
                             illumina::interop::model::metrics::run_metrics& metrics,
                             const std::vector<unsigned char>& valid_to_load,
                             const size_t thread_count,
-                            const bool check_empty=true)
+                            const bool check_empty=true,
+                            std::ostream& err=std::cerr)
 {
 // @ [Reading a subset of run metrics in C++]
     using namespace illumina::interop;
@@ -110,33 +125,209 @@ inline int read_run_metrics(const char* filename,
     }
     catch(const xml::xml_file_not_found_exception& ex)
     {
-        std::cerr << ex.what() << std::endl;
+        err << ex.what() << std::endl;
         return MISSING_RUNINFO_XML;
     }
     catch(const xml::xml_parse_exception& ex)
     {
-        std::cerr << ex.what() << std::endl;
+        err << ex.what() << std::endl;
         return MALFORMED_XML;
     }
     catch(const io::bad_format_exception& ex)
     {
-        std::cerr << ex.what() << std::endl;
+        err << ex.what() << std::endl;
         return BAD_FORMAT;
     }
     catch(const model::invalid_run_info_cycle_exception& ex)
     {
-        std::cerr << ex.what() << std::endl;
+        err << ex.what() << std::endl;
     }
     catch(const std::exception& ex)
     {
-        std::cerr << ex.what() << std::endl;
+        err << ex.what() << std::endl;
         return UNEXPECTED_EXCEPTION;
     }
     if(check_empty && metrics.empty())
     {
-        std::cerr << "No InterOp files found" << std::endl;
+        err << "No InterOp files found" << std::endl;
         return EMPTY_INTEROP;
     }
 // @ [Reading a subset of run metrics in C++]
     return SUCCESS;
 }
+
+/** Estimate the memory required to load a run folder
+ *
+ * The estimate is the total size of the aggregated InterOp files in the run folder. If there are none, RunInfo.xml
+ * is read to list the by cycle InterOp files, and the estimate is their total size.
+ *
+ * @param run_folder run folder containing RunInfo.xml and InterOps
+ * @return estimated number of bytes
+ */
+inline size_t estimate_run_memory(const std::string& run_folder)
+{
+    using namespace illumina::interop;
+    std::vector<std::string> files;
+    model::metrics::run_metrics metrics;
+    size_t total = 0;
+    for(int use_out=0;use_out<2;++use_out)
+    {
+        metrics.list_filenames(files, run_folder, false, use_out != 0);
+        for(std::vector<std::string>::const_iterator it = files.begin();it != files.end();++it)
+        {
+            const ::int64_t file_size = io::file_size(*it);
+            if(file_size > 0) total += static_cast<size_t>(file_size);
+        }
+    }
+    if(total > 0) return total;
+    try
+    {
+        metrics.read_run_info(run_folder);
+        metrics.list_filenames(files, run_folder, true);
+    }
+    catch(const std::exception&)
+    {
+        return total;
+    }
+    for(std::vector<std::string>::const_iterator it = files.begin();it != files.end();++it)
+    {
+        const ::int64_t file_size = io::file_size(*it);
+        if(file_size > 0) total += static_cast<size_t>(file_size);
+    }
+    return total;
+}
+
+/** Wait until the memory of a run fits under the memory cap, then reserve it
+ *
+ * Runs are admitted in run folder order, so a large run is not starved by the smaller runs after it. A run is
+ * always admitted when no other run is in flight.
+ *
+ * @param index index of the run folder
+ * @param memory estimated memory of the run
+ * @param memory_cap maximum estimated memory of the runs in flight
+ * @param next_index index of the next run folder to admit
+ * @param memory_in_flight estimated memory of the runs in flight
+ */
+inline void reserve_run_memory(const size_t index,
+                               const size_t memory,
+                               const size_t memory_cap,
+                               size_t& next_index,
+                               size_t& memory_in_flight)
+{
+    for(;;)
+    {
+        bool is_reserved = false;
+#ifdef _OPENMP
+#       pragma omp critical(RunMemory)
+#endif
+        {
+            if(next_index == index && (memory_in_flight == 0 || memory_in_flight+memory <= memory_cap))
+            {
+                memory_in_flight += memory;
+                ++next_index;
+                is_reserved = true;
+            }
+        }
+        if(is_reserved) return;
+#ifdef WIN32
+        Sleep(1);
+#else
+        usleep(1000);
+#endif
+    }
+}
+
+/** Process a batch of run folders with a bounded number of threads
+ *
+ * Each thread takes the next run folder as soon as it finishes the previous one, so a slow run only holds up
+ * its own thread. Before a run is read, its estimated memory is reserved, and the run waits while the runs in
+ * flight would exceed `memory_cap` (a single run is always allowed). The output of each run is buffered and
+ * written to the output streams as soon as the run completes.
+ *
+ * The processor must provide: `int operator()(const std::string& run_folder, std::ostream& out, std::ostream& err)`
+ *
+ * @param run_folders list of run folders
+ * @param processor function object that reads and reports a single run folder
+ * @param thread_count maximum number of runs processed at once
+ * @param memory_cap maximum estimated number of bytes of InterOp data loaded at once (0 means no limit)
+ * @param out output stream for reports
+ * @param err output stream for error messages
+ * @return exit code of the first run that failed, in run folder order, otherwise SUCCESS
+ */
+template<class Processor>
+int process_run_folders(const std::vector<std::string>& run_folders,
+                        const Processor& processor,
+                        const size_t thread_count,
+                        const size_t memory_cap,
+                        std::ostream& out=std::cout,
+                        std::ostream& err=std::cerr)
+{
+    std::vector<int> exit_codes(run_folders.size(), SUCCESS);
+    std::vector<size_t> memory(run_folders.size(), 0);
+    if(memory_cap > 0)
+    {
+        for(size_t i=0;i<run_folders.size();++i)
+            memory[i] = estimate_run_memory(run_folders[i]);
+    }
+    size_t max_thread_count = thread_count < run_folders.size() ? thread_count : run_folders.size();
+    if(max_thread_count == 0) max_thread_count = 1;
+    size_t next_index = 0;
+    size_t memory_in_flight = 0;
+#ifdef _OPENMP
+#   pragma omp parallel for default(shared) num_threads(static_cast<int>(max_thread_count)) schedule(dynamic, 1)
+#else
+    (void)max_thread_count;
+#endif
+    for(int i=0;i<static_cast<int>(run_folders.size());++i)
+    {
+        if(memory_cap > 0)
+            reserve_run_memory(static_cast<size_t>(i), memory[i], memory_cap, next_index, memory_in_flight);
+        std::ostringstream run_out;
+        std::ostringstream run_err;
+        try
+        {
+            exit_codes[i] = processor(run_folders[i], run_out, run_err);
+        }
+        catch(const std::exception& ex)
+        {
+            run_err << ex.what() << std::endl;
+            exit_codes[i] = UNEXPECTED_EXCEPTION;
+        }
+        if(memory_cap > 0)
+        {
+#ifdef _OPENMP
+#           pragma omp critical(RunMemory)
+#endif
+            memory_in_flight -= memory[i];
+        }
+#ifdef _OPENMP
+#       pragma omp critical(WriteRunOutput)
+#endif
+        {
+            out << run_out.str();
+            out.flush();
+            err << run_err.str();
+        }
+    }
+    for(size_t i=0;i<exit_codes.size();++i)
+        if(exit_codes[i] != SUCCESS) return exit_codes[i];
+    return SUCCESS;
+}
+
+/** Add options to control batch processing of run folders
+ *
+ * This adds the following options to the parser:
+ *   - `--threads=<count>`: Number of run folders to process at once
+ *   - `--max-memory=<megabytes>`: Limit on the InterOp data loaded at once
+ *
+ * @param description option parser
+ * @param thread_count number of run folders to process at once
+ * @param memory_cap_mb limit on the InterOp data loaded at once in megabytes
+ */
+template<class OptionParser>
+void add_batch_options(OptionParser& description, size_t& thread_count, size_t& memory_cap_mb)
+{
+    description
+            (thread_count, "threads", "Number of run folders to process at once")
+            (memory_cap_mb, "max-memory", "Limit on the size in megabytes of InterOp data loaded at once, 0 is unlimited");
+}
@@ -0,0 +1,174 @@
+/** Write the SAV indexing table as text
+ *
+ * This is a private header file shared by the applications.
+ *
+ *  @file
+ *  @date 10/18/26
+ *  @version 1.0
+ *  @copyright GNU Public License.
+ */
+#pragma once
+#include <iostream>
+#include <iomanip>
+#include "interop/util/lexical_cast.h"
+#include "interop/model/summary/index_flowcell_summary.h"
+
+namespace index_summary_report
+{
+using namespace illumina::interop::model;
+using namespace illumina::interop::model::summary;
+using namespace illumina::interop;
+
+/** Take a collection of strings and print them using a fixed width
+ *
+ * @param out output stream
+ * @param beg iterator to start of collection
+ * @param end iterator to end of collection
+ * @param width of fill characters around string
+ * @param fillch fill character (space by default)
+ */
+template<typename I>
+void print_array(std::ostream& out, I beg, I end, const size_t width, const char fillch)
+{
+    std::ios::fmtflags f( out.flags() );
+    for(I start=beg;beg != end;++beg)
+    {
+        if(fillch != 0)
+        {
+            out << " ";
+            out.width(width);
+            out.fill(fillch);
+            out << std::left << *beg;
+        }
+        else
+        {
+            if(beg != start) out << ",";
+            out << *beg;
+        }
+    }
+    out.flags(f);
+    out << std::endl;
+}
+/** Get number of elements in stack array
+ *
+ * @return number of elements
+ */
+template<size_t N>
+size_t size_of(const char*(&)[N])
+{
+    return N;
+}
+/** Take a array of strings and print them using a fixed width
+ *
+ * @param out output stream
+ * @param values array of string values
+ * @param width of fill characters around string
+ * @param fillch fill character (space by default)
+ */
+template<size_t N>
+void print_array(std::ostream& out, const char*(&values)[N], const size_t width, const char fillch)
+{
+    print_array(out, values, values+N, width, fillch);
+}
+/** Take a array of strings and print them using a fixed width
+ *
+ * @param out output stream
+ * @param values array of string values
+ * @param width of fill characters around string
+ * @param fillch fill character (space by default)
+ */
+template<size_t N>
+void print_array(std::ostream& out, std::string(&values)[N], const size_t width, const char fillch)
+{
+    print_array(out, values, values+N, width, fillch);
+}
+/** Take a vector of strings and print them using a fixed width
+ *
+ * @param out output stream
+ * @param values vector of string values
+ * @param width of fill characters around string
+ * @param fillch fill character (space by default)
+ */
+inline void print_array(std::ostream& out, const std::vector<std::string>& values, const size_t width, const char fillch)
+{
+    print_array(out, values.begin(), values.end(), width, fillch);
+}
+/** Format a floating point value to the given width and precision as a string
+ *
+ * @param val to format as a string
+ * @param width width of number
+ * @param precision number of values after decimal
+ * @param scale to divide number
+ * @return string representation of value
+ */
+inline std::string format(const float val, const int width, const int precision, const float scale=1)
+{
+    return util::format(val/scale, width, precision);
+}
+/** Format cycle range as a string
+ *
+ * @param rng range to format as a string
+ * @return string representation of cycle range
+ */
+inline std::string format(const model::run::cycle_range& rng)
+{
+    if(rng.first_cycle()==rng.last_cycle()) return util::lexical_cast<std::string>(rng.first_cycle());
+    return util::lexical_cast<std::string>(rng.first_cycle()) + " - " + util::lexical_cast<std::string>(rng.last_cycle());
+}
+
+inline std::string format_read(const run::read_info& read)
+{
+    return "Read "+util::lexical_cast<std::string>(read.number()) + (read.is_index() ? " (I)" : "");
+}
+
+inline void populate_index(const index_count_summary& summary, std::vector<std::string>& values)
+{
+    values[0] = format(static_cast<float>(summary.id()), 0, 0);
+    values[1] = summary.sample_id();
+    values[2] = summary.project_name();
+    values[3] = summary.index1();
+    values[4] = summary.index2();
+    values[5] = format(summary.fraction_mapped(), 0, 4);
+}
+
+inline void print_summary(std::ostream& out, const index_lane_summary& summary, const bool csv_format)
+{
+    const size_t width=15;
+    const char fillch = csv_format ? 0 : ' ';
+    const char* flowcell_header[] = {"Total Reads", "PF Reads", "% Read Identified (PF)", "CV", "Min", "Max"};
+    print_array(out, flowcell_header, width, fillch);
+    std::vector<std::string> values(size_of(flowcell_header));
+    values[0] = format(static_cast<float>(summary.total_reads()), 0, 0);
+    values[1] = format(static_cast<float>(summary.total_pf_reads()), 0, 0);
+    values[2] = format(summary.total_fraction_mapped_reads(), 0, 4);
+    values[3] = format(summary.mapped_reads_cv(), 0, 4);
+    values[4] = format(summary.min_mapped_reads(), 0, 4);
+    values[5] = format(summary.max_mapped_reads(), 0, 4);
+    print_array(out, values, width, fillch);
+
+    const char* index_header[] = {"Index Number", "Sample Id", "Project", "Index 1 (I7)", "Index 2 (I5)", "% Read Identified (PF)"};
+    values.resize(size_of(index_header));
+    print_array(out, index_header, width, fillch);
+    for(size_t index=0;index<summary.size();++index)
+    {
+        populate_index(summary[index], values);
+        print_array(out, values, width, fillch);
+    }
+}
+
+/** Print the summary metrics to the given output stream
+ *
+ * @param out output stream
+ * @param summary summary metrics
+ * @param csv_format if true, write in CSV format
+ */
+
+inline void print_summary(std::ostream& out, const index_flowcell_summary& summary, const bool csv_format)
+{
+    for(size_t lane=0;lane<summary.size();++lane)
+    {
+        out << "Lane " << lane+1 << "\n";
+        print_summary(out, summary[lane], csv_format);
+    }
+}
+}
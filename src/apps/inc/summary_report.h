@@ -0,0 +1,286 @@
+/** Write the SAV summary table as text
+ *
+ * This is a private header file shared by the applications.
+ *
+ *  @file
+ *  @date 10/18/26
+ *  @version 1.0
+ *  @copyright GNU Public License.
+ */
+#pragma once
+#include <iostream>
+#include <iomanip>
+#include "interop/util/math.h"
+#include "interop/util/length_of.h"
+#include "interop/util/lexical_cast.h"
+#include "interop/model/summary/run_summary.h"
+
+namespace run_summary_report
+{
+using namespace illumina::interop::model::metric_base;
+using namespace illumina::interop::model;
+using namespace illumina::interop::model::summary;
+using namespace illumina::interop;
+
+/** Take a collection of strings and print them using a fixed width
+ *
+ * @param out output stream
+ * @param beg iterator to start of collection
+ * @param end iterator to end of collection
+ * @param width of fill characters around string
+ * @param fillch fill character (space by default)
+ */
+template<typename I>
+void print_array(std::ostream& out, I beg, I end, const size_t width, const char fillch)
+{
+    std::ios::fmtflags f( out.flags() );
+    if(beg != end)
+    {
+        if(fillch != 0)
+        {
+            out.width(width);
+            out.fill(fillch);
+            out << std::left << *beg;
+        }
+        else out << *beg;
+        ++beg;
+    }
+    for(;beg != end;++beg)
+    {
+        out << ",";
+        if(fillch != 0)
+        {
+            out.width(width);
+            out.fill(fillch);
+            out << std::left << *beg;
+        }
+        else out << *beg;
+    }
+    out.flags(f);
+    out << std::endl;
+}
+/** Take a array of strings and print them using a fixed width
+ *
+ * @param out output stream
+ * @param values array of string values
+ * @param width of fill characters around string
+ * @param fillch fill character (space by default)
+ */
+template<size_t N>
+void print_array(std::ostream& out, const char*(&values)[N], const size_t width, const char fillch)
+{
+    print_array(out, values, values+N, width, fillch);
+}
+/** Take a array of strings and print them using a fixed width
+ *
+ * @param out output stream
+ * @param values array of string values
+ * @param width of fill characters around string
+ * @param fillch fill character (space by default)
+ */
+template<size_t N>
+void print_array(std::ostream& out, std::string(&values)[N], const size_t width, const char fillch)
+{
+    print_array(out, values, values+N, width, fillch);
+}
+/** Take a vector of strings and print them using a fixed width
+ *
+ * @param out output stream
+ * @param values vector of string values
+ * @param width of fill characters around string
+ * @param fillch fill character (space by default)
+ */
+inline void print_array(std::ostream& out, const std::vector<std::string>& values, const size_t width, const char fillch)
+{
+    print_array(out, values.begin(), values.end(), width, fillch);
+}
+/** Format a floating point value to the given width and precision as a string
+ *
+ * @param val to format as a string
+ * @param width width of number
+ * @param precision number of values after decimal
+ * @param scale to divide number
+ * @return string representation of value
+ */
+inline std::string format(const float val, const int width, const int precision, const float scale=1)
+{
+    return util::format(val/scale, width, precision);
+}
+/** Format a struct of statistics to the given width and precision as a string
+ *
+ * @param stat struct to format as a string
+ * @param width width of number
+ * @param precision number of values after decimal
+ * @param scale to divide number
+ * @return string representation of stat
+ */
+inline std::string format(const metric_stat& stat, const int width, const int precision, const float scale=1)
+{
+    // TODO replace +/- with unicode: \u00B1
+    // Probably requires replace std::string with a wide character string
+    // Also need to check if you are on a ancient terminal
+    return util::format(stat.mean()/scale, width, precision) + " +/- " + util::format(stat.stddev()/scale, width, precision);
+}
+/** Format cycle range as a string
+ *
+ * @param rng range to format as a string
+ * @return string representation of cycle range
+ */
+inline std::string format(const model::run::cycle_range& rng)
+{
+    if(rng.first_cycle()==rng.last_cycle()) return util::lexical_cast<std::string>(rng.first_cycle());
+    return util::lexical_cast<std::string>(rng.first_cycle()) + " - " + util::lexical_cast<std::string>(rng.last_cycle());
+}
+inline void summarize(const metric_summary& summary, std::vector<std::string>& values)
+{
+    // format(value, width in spaces, number of values after decimal, multiplier)
+    size_t i=1;
+    values[i++] = util::format(summary.yield_g(), 3, 2);
+    values[i++] = util::format(summary.projected_yield_g(), 3, 2);
+    values[i++] = util::format(summary.percent_aligned(), 3, 2);
+    values[i++] = util::format(summary.error_rate(), 3, 2);
+    values[i++] = util::lexical_cast<std::string>(long(summary.first_cycle_intensity()+0.5));
+    values[i++] = util::format(summary.percent_gt_q30(), 3, 2);
+    values[i++] = util::format(summary.percent_occupied(), 3, 2);
+    if(i != values.size()) INTEROP_THROW(std::runtime_error, "There is a bug in the program, columns do not match header");
+}
+inline void summarize(const surface_summary& summary, std::vector<std::string>& values, const size_t lane)
+{
+    size_t i=0;
+    values[i++] = util::lexical_cast<std::string>(lane);
+    values[i++] = util::lexical_cast<std::string>(summary.surface());
+    values[i++] = util::lexical_cast<std::string>(summary.tile_count());
+
+    // format(value, width in spaces, number of values after decimal, multiplier)
+    values[i++] = format(summary.density(), 0, 0, 1e3);
+    values[i++] = format(summary.percent_pf(), 0, 2);
+    values[i++] = util::format(summary.phasing().mean(), 3, 3) + " / " + util::format(summary.prephasing().mean(), 3, 3);
+
+
+    values[i++] = util::format(summary.phasing_slope().mean(), 3, 3) + " / "
+                  + util::format(summary.phasing_offset().mean(), 3, 3);
+    values[i++] = util::format(summary.prephasing_slope().mean(), 3, 3) + " / "
+                  + util::format(summary.prephasing_offset().mean(), 3, 3);
+
+    values[i++] = format(summary.reads(), 0, 2, 1e6);
+    values[i++] = format(summary.reads_pf(), 0, 2, 1e6);
+    values[i++] = format(summary.percent_gt_q30(), 0, 2);
+    values[i++] = format(summary.yield_g(), 0, 2);
+    values[i++] = "-";
+    values[i++] = format(summary.percent_aligned(), 0, 2);
+    values[i++] = format(summary.error_rate(), 0, 2);
+    values[i++] = format(summary.error_rate_35(), 0, 2);
+    values[i++] = format(summary.error_rate_75(), 0, 2);
+    values[i++] = format(summary.error_rate_100(), 0, 2);
+    values[i++] = format(summary.percent_occupied(), 0, 2);
+    values[i++] = format(summary.first_cycle_intensity(), 0, 0);
+    INTEROP_ASSERT(i==values.size());
+    if(i != values.size()) INTEROP_THROW(std::runtime_error, "There is a bug in the program, columns do not match header");
+}
+inline void summarize(const lane_summary& summary, std::vector<std::string>& values)
+{
+    size_t i=0;
+    values[i++] = util::lexical_cast<std::string>(summary.lane());
+    values[i++] = "-";
+    values[i++] = util::lexical_cast<std::string>(summary.tile_count());
+
+    // format(value, width in spaces, number of values after decimal, multiplier)
+    values[i++] = format(summary.density(), 0, 0, 1e3);
+    values[i++] = format(summary.percent_pf(), 0, 2);
+    values[i++] = util::format(summary.phasing().mean(), 3, 3) + " / " + util::format(summary.prephasing().mean(), 3, 3);
+
+    values[i++] = util::format(summary.phasing_slope().mean(), 3, 3) + " / "
+                + util::format(summary.phasing_offset().mean(), 3, 3);
+    values[i++] = util::format(summary.prephasing_slope().mean(), 3, 3) + " / "
+                + util::format(summary.prephasing_offset().mean(), 3, 3);
+    values[i++] = format(summary.reads(), 0, 2, 1e6);
+    values[i++] = format(summary.reads_pf(), 0, 2, 1e6);
+    values[i++] = format(summary.percent_gt_q30(), 0, 2);
+    values[i++] = format(summary.yield_g(), 0, 2);
+    values[i++] = format(summary.cycle_state().error_cycle_range());
+    values[i++] = format(summary.percent_aligned(), 0, 2);
+    values[i++] = format(summary.error_rate(), 0, 2);
+    values[i++] = format(summary.error_rate_35(), 0, 2);
+    values[i++] = format(summary.error_rate_75(), 0, 2);
+    values[i++] = format(summary.error_rate_100(), 0, 2);
+    values[i++] = format(summary.percent_occupied(), 0, 2);
+    values[i++] = format(summary.first_cycle_intensity(), 0, 0);
+    INTEROP_ASSERT(i==values.size());
+    if(i != values.size()) INTEROP_THROW(std::runtime_error, "There is a bug in the program, columns do not match header");
+}
+inline std::string format_read(const run::read_info& read)
+{
+    return "Read "+util::lexical_cast<std::string>(read.number()) + (read.is_index() ? " (I)" : "");
+}
+
+/** Print the summary metrics to the given output stream
+ *
+ * @param out output stream
+ * @param summary summary metrics
+ * @param information_level level of information to print
+ * @param csv_format if true, write in CSV format
+ */
+
+inline void print_summary(std::ostream& out, const run_summary& summary, const size_t information_level, const bool csv_format)
+{
+    const size_t width=15;
+    const char fillch = csv_format ? 0 : ' ';
+    const char* read_header[] = {"Level", "Yield", "Projected Yield", "Aligned", "Error Rate", "Intensity C1", "%>=Q30", "% Occupied"};
+    print_array(out, read_header, width, fillch);
+    std::vector<std::string> values(util::length_of(read_header));
+    INTEROP_ASSERT(values.size()>=1);
+    if( information_level >= 2)
+    {
+        for (size_t read = 0; read < summary.size(); ++read)
+        {
+            values[0] = format_read(summary[read].read());
+            summarize(summary[read].summary(), values);
+            print_array(out, values, width, fillch);
+        }
+    }
+    if( information_level >= 1)
+    {
+        values[0] = "Non-indexed";
+        summarize(summary.nonindex_summary(), values);
+        print_array(out, values, width, fillch);
+    }
+    values[0]="Total";
+    summarize(summary.total_summary(), values);
+    print_array(out, values, width, fillch);
+    out<< "\n\n";
+
+    if( information_level >= 3)
+    {
+        const char *lane_header[] = {"Lane", "Surface", "Tiles", "Density", "Cluster PF", "Legacy Phasing/Prephasing Rate",
+                                     "Phasing  slope/offset", "Prephasing slope/offset",
+                                     "Reads", "Reads PF", "%>=Q30", "Yield", "Cycles Error", "Aligned", "Error",
+                                     "Error (35)", "Error (75)", "Error (100)", "% Occupied", "Intensity C1"};
+        values.resize(util::length_of(lane_header));
+        for (size_t read = 0; read < summary.size(); ++read)
+        {
+            out << format_read(summary[read].read()) << std::endl;
+            print_array(out, lane_header, width, fillch);
+            for (size_t lane = 0; lane < summary.lane_count(); ++lane)
+            {
+                INTEROP_ASSERT(summary[read][lane].tile_count() > 0);
+                summarize(summary[read][lane], values);
+                print_array(out, values, width, fillch);
+                if (summary.surface_count() > 1 && information_level >= 4)
+                {
+                    for (size_t surface = 0; surface < summary.surface_count(); ++surface)
+                    {
+                        summarize(summary[read][lane][surface], values, summary[read][lane].lane());
+                        print_array(out, values, width, fillch);
+                    }
+                }
+            }
+        }
+    }
+    if( information_level >= 5)
+    {
+        out << "Extracted: " << format(summary.cycle_state().extracted_cycle_range()) << "\n";
+        out << "Called: " << format(summary.cycle_state().called_cycle_range()) << "\n";
+        out << "Scored: " << format(summary.cycle_state().qscored_cycle_range()) << "\n";
+    }
+}
+}
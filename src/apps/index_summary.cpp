@@ -21,6 +21,10 @@
  *      2               WU_1_spike      NA              AAGAGGCA        ACTGCATA        1.5316
  *      ...
  *
+ * Several run folders may be given at once. Up to `--threads` run folders are processed at the same time, and
+ * `--max-memory` limits the total size (in megabytes) of the InterOp files loaded at once. The output of each run
+ * is written as soon as the run completes.
+ *
  * The InterOp sub folder may contain any of the following files:
  *
  *  - IndexMetricsOut.bin
@@ -49,6 +53,7 @@
 #include "interop/util/option_parser.h"
 #include "interop/version.h"
 #include "inc/application.h"
+#include "inc/index_summary_report.h"
 
 using namespace illumina::interop::model::metrics;
 using namespace illumina::interop::model::metric_base;
@@ -57,52 +62,30 @@ using namespace illumina::interop::model::summary;
 using namespace illumina::interop::logic::summary;
 using namespace illumina::interop;
 
-/** Print the summary metrics to the given output stream
- *
- * @param out output stream
- * @param summary summary metrics
- * @param csv_format if true, write in CSV format
+/** Read a single run folder and write its index summary
  */
-void print_summary(std::ostream& out, const index_flowcell_summary& summary, const bool csv_format);
-
-int main(int argc, const char** argv)
+struct index_summary_processor
 {
-    if(argc == 0)
-    {
-        std::cerr << "No arguments specified!" << std::endl;
-        //print_help(std::cout);
-        return INVALID_ARGUMENTS;
-    }
-    const size_t thread_count = 1;
-    int csv_format = 0;
-
-    util::option_parser description;
-    description
-            (csv_format, "csv", "Format output as CSV only");
-    if(description.is_help_requested(argc, argv))
+    /** Constructor
+     *
+     * @param csv_format if true, write in CSV format
+     */
+    index_summary_processor(const bool csv_format) : m_csv_format(csv_format)
     {
-        std::cout << "Usage: " << io::basename(argv[0]) << " run_folder [--option1=value1] [--option2=value2]" << std::endl;
-        description.display_help(std::cout);
-        return SUCCESS;
+        logic::utils::list_index_metrics_to_load(m_valid_to_load); // Only load the InterOp files required
     }
-    try
-    {
-        description.parse(argc, argv);
-        description.check_for_unknown_options(argc, argv);
-    }
-    catch(const util::option_exception& ex)
-    {
-        std::cerr << ex.what() << std::endl;
-        return INVALID_ARGUMENTS;
-    }
-
-    std::vector<unsigned char> valid_to_load;
-    logic::utils::list_index_metrics_to_load(valid_to_load); // Only load the InterOp files required
-    std::cout << "# Version: " << INTEROP_VERSION << std::endl;
-    for(int i=1;i<argc;i++)
+    /** Read a single run folder and write its index summary
+     *
+     * @param run_folder run folder
+     * @param out output stream for the index summary
+     * @param err output stream for error messages
+     * @return exit code
+     */
+    int operator()(const std::string& run_folder, std::ostream& out, std::ostream& err)const
     {
+        const size_t thread_count = 1;
         run_metrics run;
-        int ret = read_run_metrics(argv[i], run, valid_to_load, thread_count);
+        int ret = read_run_metrics(run_folder.c_str(), run, m_valid_to_load, thread_count, true, err);
         if (ret != SUCCESS) return ret;
         index_flowcell_summary summary;
         try
@@ -111,167 +94,62 @@ int main(int argc, const char** argv)
         }
         catch(const std::exception& ex)
         {
-            std::cerr << ex.what() << std::endl;
+            err << ex.what() << std::endl;
             return UNEXPECTED_EXCEPTION;
         }
         summary.sort();
         try
         {
-            print_summary(std::cout, summary, csv_format > 0);
+            index_summary_report::print_summary(out, summary, m_csv_format);
         }
         catch(const std::exception& ex)
         {
-            std::cerr << ex.what() << std::endl;
+            err << ex.what() << std::endl;
             return UNEXPECTED_EXCEPTION;
         }
+        return SUCCESS;
     }
-    return SUCCESS;
-}
 
-/** Take a collection of strings and print them using a fixed width
- *
- * @param out output stream
- * @param beg iterator to start of collection
- * @param end iterator to end of collection
- * @param width of fill characters around string
- * @param fillch fill character (space by default)
- */
-template<typename I>
-void print_array(std::ostream& out, I beg, I end, const size_t width, const char fillch)
+private:
+    std::vector<unsigned char> m_valid_to_load;
+    bool m_csv_format;
+};
+
+int main(int argc, const char** argv)
 {
-    std::ios::fmtflags f( out.flags() );
-    for(I start=beg;beg != end;++beg)
+    if(argc == 0)
     {
-        if(fillch != 0)
-        {
-            out << " ";
-            out.width(width);
-            out.fill(fillch);
-            out << std::left << *beg;
-        }
-        else
-        {
-            if(beg != start) out << ",";
-            out << *beg;
-        }
+        std::cerr << "No arguments specified!" << std::endl;
+        //print_help(std::cout);
+        return INVALID_ARGUMENTS;
     }
-    out.flags(f);
-    out << std::endl;
-}
-/** Get number of elements in stack array
- *
- * @return number of elements
- */
-template<size_t N>
-size_t size_of(const char*(&)[N])
-{
-    return N;
-}
-/** Take a array of strings and print them using a fixed width
- *
- * @param out output stream
- * @param values array of string values
- * @param width of fill characters around string
- * @param fillch fill character (space by default)
- */
-template<size_t N>
-void print_array(std::ostream& out, const char*(&values)[N], const size_t width, const char fillch)
-{
-    print_array(out, values, values+N, width, fillch);
-}
-/** Take a array of strings and print them using a fixed width
- *
- * @param out output stream
- * @param values array of string values
- * @param width of fill characters around string
- * @param fillch fill character (space by default)
- */
-template<size_t N>
-void print_array(std::ostream& out, std::string(&values)[N], const size_t width, const char fillch)
-{
-    print_array(out, values, values+N, width, fillch);
-}
-/** Take a vector of strings and print them using a fixed width
- *
- * @param out output stream
- * @param values vector of string values
- * @param width of fill characters around string
- * @param fillch fill character (space by default)
- */
-void print_array(std::ostream& out, const std::vector<std::string>& values, const size_t width, const char fillch)
-{
-    print_array(out, values.begin(), values.end(), width, fillch);
-}
-/** Format a floating point value to the given width and precision as a string
- *
- * @param val to format as a string
- * @param width width of number
- * @param precision number of values after decimal
- * @param scale to divide number
- * @return string representation of value
- */
-std::string format(const float val, const int width, const int precision, const float scale=1)
-{
-    return util::format(val/scale, width, precision);
-}
-/** Format cycle range as a string
- *
- * @param rng range to format as a string
- * @return string representation of cycle range
- */
-std::string format(const model::run::cycle_range& rng)
-{
-    if(rng.first_cycle()==rng.last_cycle()) return util::lexical_cast<std::string>(rng.first_cycle());
-    return util::lexical_cast<std::string>(rng.first_cycle()) + " - " + util::lexical_cast<std::string>(rng.last_cycle());
-}
-
-std::string format_read(const run::read_info& read)
-{
-    return "Read "+util::lexical_cast<std::string>(read.number()) + (read.is_index() ? " (I)" : "");
-}
-
-void populate_index(const index_count_summary& summary, std::vector<std::string>& values)
-{
-    values[0] = format(static_cast<float>(summary.id()), 0, 0);
-    values[1] = summary.sample_id();
-    values[2] = summary.project_name();
-    values[3] = summary.index1();
-    values[4] = summary.index2();
-    values[5] = format(summary.fraction_mapped(), 0, 4);
-}
-
-void print_summary(std::ostream& out, const index_lane_summary& summary, const bool csv_format)
-{
-    const size_t width=15;
-    const char fillch = csv_format ? 0 : ' ';
-    const char* flowcell_header[] = {"Total Reads", "PF Reads", "% Read Identified (PF)", "CV", "Min", "Max"};
-    print_array(out, flowcell_header, width, fillch);
-    std::vector<std::string> values(size_of(flowcell_header));
-    values[0] = format(static_cast<float>(summary.total_reads()), 0, 0);
-    values[1] = format(static_cast<float>(summary.total_pf_reads()), 0, 0);
-    values[2] = format(summary.total_fraction_mapped_reads(), 0, 4);
-    values[3] = format(summary.mapped_reads_cv(), 0, 4);
-    values[4] = format(summary.min_mapped_reads(), 0, 4);
-    values[5] = format(summary.max_mapped_reads(), 0, 4);
-    print_array(out, values, width, fillch);
+    size_t thread_count = 1;
+    size_t memory_cap_mb = 0;
+    int csv_format = 0;
 
-    const char* index_header[] = {"Index Number", "Sample Id", "Project", "Index 1 (I7)", "Index 2 (I5)", "% Read Identified (PF)"};
-    values.resize(size_of(index_header));
-    print_array(out, index_header, width, fillch);
-    for(size_t index=0;index<summary.size();++index)
+    util::option_parser description;
+    description
+            (csv_format, "csv", "Format output as CSV only");
+    add_batch_options(description, thread_count, memory_cap_mb);
+    if(description.is_help_requested(argc, argv))
     {
-        populate_index(summary[index], values);
-        print_array(out, values, width, fillch);
+        std::cout << "Usage: " << io::basename(argv[0]) << " run_folder [--option1=value1] [--option2=value2]" << std::endl;
+        description.display_help(std::cout);
+        return SUCCESS;
     }
-}
-
-void print_summary(std::ostream& out, const index_flowcell_summary& summary, const bool csv_format)
-{
-    for(size_t lane=0;lane<summary.size();++lane)
+    try
     {
-        out << "Lane " << lane+1 << "\n";
-        print_summary(out, summary[lane], csv_format);
+        description.parse(argc, argv);
+        description.check_for_unknown_options(argc, argv);
+    }
+    catch(const util::option_exception& ex)
+    {
+        std::cerr << ex.what() << std::endl;
+        return INVALID_ARGUMENTS;
     }
-}
-
 
+    std::cout << "# Version: " << INTEROP_VERSION << std::endl;
+    const std::vector<std::string> run_folders(argv+1, argv+argc);
+    return process_run_folders(run_folders, index_summary_processor(csv_format > 0), thread_count,
+                               memory_cap_mb*1024*1024);
+}
@@ -0,0 +1,375 @@
+/** @page report Generate several reports from a single load of the run
+ *
+ * This application writes any combination of the summary table, the indexing table, the imaging table and
+ * the gnuplot scripts from the plot applications, while reading the InterOp files only once.
+ *
+ * ### Running the Program
+ *
+ * The program runs as follows:
+ *
+ *      $ report 140131_1287_0851_A01n401drr --summary=1 --imaging-table=1 --plot-by-cycle=Intensity
+ *
+ * In this sample, 140131_1287_0851_A01n401drr is a run folder and the reports are written to the standard output
+ * in the order they are listed below:
+ *
+ *  - `--summary=1`: SAV summary table (see `summary`)
+ *  - `--index-summary=1`: SAV indexing table (see `index-summary`)
+ *  - `--imaging-table=1`: SAV imaging table (see `imaging_table`)
+ *  - `--plot-by-cycle=<metric>`: By cycle plot (see `plot_by_cycle`)
+ *  - `--plot-by-lane=<metric>`: By lane plot (see `plot_by_lane`)
+ *  - `--plot-flowcell=<metric>`: Flowcell heat map (see `plot_flowcell`)
+ *  - `--plot-qscore-histogram=1`: Q-score histogram (see `plot_qscore_histogram`)
+ *  - `--plot-qscore-heatmap=1`: Q-score heat map (see `plot_qscore_heatmap`)
+ *
+ * Only the InterOp files required by the requested reports are loaded. Up to `--threads` reports are generated
+ * at the same time from the loaded run.
+ *
+ * ### Error Handling
+ *
+ *  The `report` program will print an error to the error stream and return an error code (any number except 0)
+ *  when an error occurs. A run folder or report that fails does not prevent the remaining run folders and reports
+ *  from being written.
+ */
+
+#include <iostream>
+#include <sstream>
+#include "interop/io/metric_file_stream.h"
+#include "interop/logic/summary/run_summary.h"
+#include "interop/logic/summary/index_summary.h"
+#include "interop/logic/table/create_imaging_table.h"
+#include "interop/io/table/imaging_table_csv.h"
+#include "interop/logic/plot/plot_by_cycle.h"
+#include "interop/logic/plot/plot_by_lane.h"
+#include "interop/logic/plot/plot_flowcell_map.h"
+#include "interop/logic/plot/plot_qscore_histogram.h"
+#include "interop/logic/plot/plot_qscore_heatmap.h"
+#include "interop/io/plot/gnuplot.h"
+#include "interop/logic/metric/q_metric.h"
+#include "interop/logic/metric/index_metric.h"
+#include "interop/logic/metric/dynamic_phasing_metric.h"
+#include "interop/version.h"
+#include "inc/application.h"
+#include "inc/plot_options.h"
+#include "inc/summary_report.h"
+#include "inc/index_summary_report.h"
+
+using namespace illumina::interop::model::metrics;
+using namespace illumina::interop;
+
+/** Type of report to generate */
+enum report_type
+{
+    /** SAV summary table */
+    SummaryReport,
+    /** SAV indexing table */
+    IndexSummaryReport,
+    /** SAV imaging table */
+    ImagingTableReport,
+    /** By cycle plot */
+    PlotByCycleReport,
+    /** By lane plot */
+    PlotByLaneReport,
+    /** Flowcell heat map */
+    PlotFlowcellReport,
+    /** Q-score histogram */
+    PlotQScoreHistogramReport,
+    /** Q-score heat map */
+    PlotQScoreHeatmapReport
+};
+
+/** Single report requested on the command line
+ */
+struct report_request
+{
+    /** Constructor
+     *
+     * @param type type of report
+     * @param metric_name name of the metric to plot
+     */
+    report_request(const report_type type, const std::string& metric_name="") :
+            m_type(type), m_metric_name(metric_name){}
+    /** Type of report */
+    report_type m_type;
+    /** Name of the metric to plot */
+    std::string m_metric_name;
+};
+
+/** Add the InterOp files required by a report to the list of files to load
+ *
+ * @param request report request
+ * @param valid_to_load list of metric groups to load
+ */
+void list_report_metrics_to_load(const report_request& request, std::vector<unsigned char>& valid_to_load)
+{
+    switch(request.m_type)
+    {
+        case SummaryReport:
+            logic::utils::list_summary_metrics_to_load(valid_to_load);
+            break;
+        case IndexSummaryReport:
+            logic::utils::list_index_metrics_to_load(valid_to_load);
+            break;
+        case ImagingTableReport:
+            logic::table::list_imaging_table_metrics_to_load(valid_to_load);
+            break;
+        case PlotByCycleReport:
+        case PlotByLaneReport:
+        case PlotFlowcellReport:
+            logic::utils::list_metrics_to_load(request.m_metric_name, valid_to_load);
+            break;
+        case PlotQScoreHistogramReport:
+        case PlotQScoreHeatmapReport:
+            logic::utils::list_metrics_to_load(constants::Q, valid_to_load);
+            break;
+    }
+}
+
+/** Derive the metrics the reports would otherwise derive on demand
+ *
+ * This is done once, before the reports share the run, so that no report writes to the run.
+ *
+ * @param run loaded run metrics
+ */
+void prepare_run_for_reports(run_metrics& run)
+{
+    if(!run.get<q_metric>().empty())
+    {
+        if(run.get<q_collapsed_metric>().empty())
+            logic::metric::create_collapse_q_metrics(run.get<q_metric>(), run.get<q_collapsed_metric>());
+        if(run.get<q_by_lane_metric>().empty())
+            logic::metric::create_q_metrics_by_lane(run.get<q_metric>(),
+                                                    run.get<q_by_lane_metric>(),
+                                                    run.run_parameters().instrument_type());
+    }
+    if(!run.get<phasing_metric>().empty() && run.get<dynamic_phasing_metric>().empty())
+    {
+        logic::summary::read_cycle_vector_t cycle_to_read;
+        logic::summary::map_read_to_cycle_number(run.run_info().reads().begin(),
+                                                 run.run_info().reads().end(),
+                                                 cycle_to_read);
+        logic::metric::populate_dynamic_phasing_metrics(run.get<phasing_metric>(),
+                                                        cycle_to_read,
+                                                        run.get<dynamic_phasing_metric>(),
+                                                        run.get<tile_metric>());
+    }
+    logic::metric::populate_indices(run.get<tile_metric>(), run.get<index_metric>());
+    run.update_catalog();
+}
+
+/** Write a single report for a loaded run
+ *
+ * @note the run is shared by all reports and only read from
+ *
+ * @param request report request
+ * @param run loaded run metrics
+ * @param run_name name of the run folder
+ * @param options filter options for plots
+ * @param information_level level of information in the summary table
+ * @param csv_format if true, write tables in CSV format
+ * @param out output stream for the report
+ */
+void write_report(const report_request& request,
+                  const run_metrics& run,
+                  const std::string& run_name,
+                  const model::plot::filter_options& options,
+                  const size_t information_level,
+                  const bool csv_format,
+                  std::ostream& out)
+{
+    io::plot::gnuplot_writer plot_writer;
+    switch(request.m_type)
+    {
+        case SummaryReport:
+        {
+            const bool skip_median_calculation=true;
+            model::summary::run_summary summary;
+            logic::summary::summarize_run_metrics(run, summary, skip_median_calculation);
+            run_summary_report::print_summary(out, summary, information_level, csv_format);
+            break;
+        }
+        case IndexSummaryReport:
+        {
+            model::summary::index_flowcell_summary summary;
+            logic::summary::summarize_index_metrics(run, summary);
+            summary.sort();
+            index_summary_report::print_summary(out, summary, csv_format);
+            break;
+        }
+        case ImagingTableReport:
+        {
+            model::table::imaging_table table;
+            logic::table::create_imaging_table(run, table);
+            out << table << std::endl;
+            break;
+        }
+        case PlotByCycleReport:
+        {
+            model::plot::plot_data<model::plot::candle_stick_point> data;
+            logic::plot::plot_by_cycle(run, request.m_metric_name, options, data);
+            if(data.size() == 0) break;
+            plot_writer.write_chart(out, data, plot_image_name(request.m_metric_name+"-by-cycle",
+                                                               run_name,
+                                                               request.m_metric_name));
+            break;
+        }
+        case PlotByLaneReport:
+        {
+            model::plot::plot_data<model::plot::candle_stick_point> data;
+            logic::plot::plot_by_lane(run, request.m_metric_name, options, data);
+            if(data.size() == 0) break;
+            plot_writer.write_chart(out, data, plot_image_name(request.m_metric_name+"-by-lane", run_name));
+            break;
+        }
+        case PlotFlowcellReport:
+        {
+            model::plot::flowcell_data data;
+            logic::plot::plot_flowcell_map(run, request.m_metric_name, options, data);
+            if(data.length() == 0) break;
+            plot_writer.write_flowcell(out, data, plot_image_name("flowcell-"+request.m_metric_name, run_name));
+            break;
+        }
+        case PlotQScoreHistogramReport:
+        {
+            model::plot::plot_data<model::plot::bar_point> data;
+            logic::plot::plot_qscore_histogram(run, options, data, 30u /*show the q30 boundary */);
+            if(data.size() == 0) break;
+            plot_writer.write_chart(out, data, plot_image_name("q-histogram", run_name));
+            break;
+        }
+        case PlotQScoreHeatmapReport:
+        {
+            model::plot::heatmap_data data;
+            logic::plot::plot_qscore_heatmap(run, options, data);
+            if(data.length() == 0) break;
+            plot_writer.write_heatmap(out, data, plot_image_name("q-heat-map", run_name));
+            break;
+        }
+    }
+}
+
+int main(int argc, const char** argv)
+{
+    if(argc == 0)
+    {
+        std::cerr << "No arguments specified!" << std::endl;
+        return INVALID_ARGUMENTS;
+    }
+    size_t thread_count = 1;
+    size_t information_level=5;
+    int csv_format=0;
+    int summary=0;
+    int index_summary=0;
+    int imaging_table=0;
+    int qscore_histogram=0;
+    int qscore_heatmap=0;
+    std::string by_cycle_metric;
+    std::string by_lane_metric;
+    std::string flowcell_metric;
+
+    model::plot::filter_options options(constants::UnknownTileNamingMethod);
+    util::option_parser description;
+    description
+            (summary, "summary", "Write the summary table")
+            (index_summary, "index-summary", "Write the indexing table")
+            (imaging_table, "imaging-table", "Write the imaging table")
+            (by_cycle_metric, "plot-by-cycle", "Metric to plot by cycle")
+            (by_lane_metric, "plot-by-lane", "Metric to plot by lane")
+            (flowcell_metric, "plot-flowcell", "Metric to plot over the flowcell")
+            (qscore_histogram, "plot-qscore-histogram", "Plot the q-score histogram")
+            (qscore_heatmap, "plot-qscore-heatmap", "Plot the q-score heat map")
+            (information_level, "level", "Level of summary information: 0: total, 1: non-index, 2: Read, 3: Lane, 4: Surface")
+            (csv_format, "csv", "Format tables as CSV only")
+            (thread_count, "threads", "Number of reports to generate at once");
+    add_filter_options(description, options);
+    if(description.is_help_requested(argc, argv))
+    {
+        std::cout << "Usage: " << io::basename(argv[0]) << " run_folder [--option1=value1] [--option2=value2]" << std::endl;
+        description.display_help(std::cout);
+        return SUCCESS;
+    }
+    try
+    {
+        description.parse(argc, argv);
+        description.check_for_unknown_options(argc, argv);
+    }
+    catch(const util::option_exception& ex)
+    {
+        std::cerr << ex.what() << std::endl;
+        return INVALID_ARGUMENTS;
+    }
+
+    std::vector<report_request> requests;
+    if(summary) requests.push_back(report_request(SummaryReport));
+    if(index_summary) requests.push_back(report_request(IndexSummaryReport));
+    if(imaging_table) requests.push_back(report_request(ImagingTableReport));
+    if(by_cycle_metric != "") requests.push_back(report_request(PlotByCycleReport, by_cycle_metric));
+    if(by_lane_metric != "") requests.push_back(report_request(PlotByLaneReport, by_lane_metric));
+    if(flowcell_metric != "") requests.push_back(report_request(PlotFlowcellReport, flowcell_metric));
+    if(qscore_histogram) requests.push_back(report_request(PlotQScoreHistogramReport));
+    if(qscore_heatmap) requests.push_back(report_request(PlotQScoreHeatmapReport));
+    if(requests.empty())
+    {
+        std::cerr << "No reports requested" << std::endl;
+        return INVALID_ARGUMENTS;
+    }
+
+    std::vector<unsigned char> valid_to_load;
+    try
+    {
+        for(size_t i=0;i<requests.size();++i)
+            list_report_metrics_to_load(requests[i], valid_to_load); // Only load the InterOp files required
+    }
+    catch(const std::exception& ex)
+    {
+        std::cerr << ex.what() << std::endl;
+        return INVALID_ARGUMENTS;
+    }
+
+    std::cout << "# Version: " << INTEROP_VERSION << std::endl;
+    int exit_code = SUCCESS;
+    for(int i=1;i<argc;i++)
+    {
+        run_metrics run;
+        const std::string run_name = io::basename(argv[i]);
+        std::cout << "# Run Folder: " << run_name << std::endl;
+        const int ret = read_run_metrics(argv[i], run, valid_to_load, thread_count);
+        if(ret != SUCCESS)
+        {
+            // Report the remaining run folders
+            if(exit_code == SUCCESS) exit_code = ret;
+            continue;
+        }
+        options.tile_naming_method(run.run_info().flowcell().naming_method());
+        prepare_run_for_reports(run);
+        const run_metrics& shared_run = run;
+
+        std::vector<std::string> outputs(requests.size());
+        std::vector<std::string> errors(requests.size());
+        std::vector<int> exit_codes(requests.size(), SUCCESS);
+#ifdef _OPENMP
+#       pragma omp parallel for default(shared) num_threads(static_cast<int>(thread_count)) schedule(dynamic)
+#endif
+        for(int r=0;r<static_cast<int>(requests.size());++r)
+        {
+            std::ostringstream out;
+            try
+            {
+                write_report(requests[r], shared_run, run_name, options, information_level, csv_format!=0, out);
+            }
+            catch(const std::exception& ex)
+            {
+                errors[r] = ex.what();
+                exit_codes[r] = UNEXPECTED_EXCEPTION;
+            }
+            outputs[r] = out.str();
+        }
+        for(size_t r=0;r<requests.size();++r)
+        {
+            std::cout << outputs[r];
+            if(exit_codes[r] == SUCCESS) continue;
+            std::cerr << errors[r] << std::endl;
+            if(exit_code == SUCCESS) exit_code = exit_codes[r];
+        }
+    }
+    return exit_code;
+}
@@ -99,6 +99,8 @@ METRICS_EXCEPTION_WRAPPER(WRAP_EXCEPTION)
     %ignore illumina::interop::model::metric_base::metric_set<metric_t>::populate_tile_numbers_for_lane_surface;
     %ignore illumina::interop::model::metric_base::metric_set<metric_t>::offset_map;
     %ignore illumina::interop::model::metric_base::metric_set<metric_t>::remove;
+    %ignore illumina::interop::model::metric_base::metric_set<metric_t>::lane_range;
+    %ignore illumina::interop::model::metric_base::metric_set<metric_t>::cycle_range;
 
     %apply size_t { std::map< std::size_t, metric_t >::size_type };
     %apply uint64_t { metric_base::metric_set<metric_t>::id_t };
@@ -83,6 +83,7 @@ PLOT_EXCEPTION_WRAPPER(WRAP_EXCEPTION)
 %ignore illumina::interop::model::plot::flowcell_data::tile_id(size_t const,size_t const);
 RENAME_TEMPLATE_OPERATOR_CONST(illumina::interop::model::plot::heatmap_data);
 %ignore illumina::interop::model::plot::filter_options::option_iterator;
+%ignore illumina::interop::model::plot::filter_options::compile;
 
 %include "interop/model/plot/axes.h"
 %include "interop/model/plot/filter_options.h"
@@ -27,6 +27,7 @@
 #include "interop/interop.h"
 #include "interop/model/run/cycle_range.h"
 #include "interop/model/run/read_info.h"
+#include "interop/model/run/tile_geometry.h"
 #include "interop/model/run/flowcell_layout.h"
 #include "interop/model/run/image_dimensions.h"
 #include "interop/model/run/info.h"
@@ -80,6 +81,7 @@ RUN_EXCEPTION_WRAPPER(WRAP_EXCEPTION)
 %include "interop/constants/enum_description.h"
 %include "interop/model/run/cycle_range.h"
 %include "interop/model/run/read_info.h"
+%include "interop/model/run/tile_geometry.h"
 %include "interop/model/run/flowcell_layout.h"
 %include "interop/model/run/image_dimensions.h"
 %include "interop/model/run/info.h"
@@ -93,8 +93,12 @@ RUN_METRICS_EXCEPTION_WRAPPER(WRAP_EXCEPTION)
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
 %{
+#include "interop/io/load_filter.h"
+#include "interop/model/metrics/tile_catalog.h"
 #include "interop/model/run_metrics.h"
 %}
+%include "interop/io/load_filter.h"
+%include "interop/model/metrics/tile_catalog.h"
 %include "interop/model/run_metrics.h"
 
 %define WRAP_RUN_METRICS(metric_t)
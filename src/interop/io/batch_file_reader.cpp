@@ -0,0 +1,263 @@
+/** Read many small files into memory concurrently
+ *
+ *  @file
+ *  @date 10/18/26
+ *  @version 1.0
+ *  @copyright GNU Public License.
+ */
+
+#include "interop/io/batch_file_reader.h"
+
+#include <algorithm>
+#ifdef WIN32
+#include <fstream>
+#include "interop/util/filesystem.h"
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#endif
+#ifdef INTEROP_HAS_PTHREAD
+#include <pthread.h>
+#endif
+
+namespace illumina { namespace interop { namespace io
+{
+    namespace detail
+    {
+        /** Read a whole file into memory
+         *
+         * @param file_name name of the file
+         * @param buffer destination for the bytes of the file
+         * @return false if the file could not be opened
+         */
+        static bool read_whole_file(const std::string& file_name, std::vector<char>& buffer)
+        {
+            buffer.clear();
+#ifdef WIN32
+            std::ifstream fin(file_name.c_str(), std::ios::binary);
+            if(!fin.good()) return false;
+            const ::int64_t size = file_size(file_name);
+            if(size < 0) return false;
+            buffer.resize(static_cast<size_t>(size));
+            if(!buffer.empty()) fin.read(&buffer.front(), static_cast<std::streamsize>(buffer.size()));
+            buffer.resize(static_cast<size_t>(fin.gcount()));
+#else
+            const int fd = ::open(file_name.c_str(), O_RDONLY);
+            if(fd < 0) return false;
+            struct stat buf;
+            if(::fstat(fd, &buf) != 0)
+            {
+                ::close(fd);
+                return false;
+            }
+            buffer.resize(static_cast<size_t>(buf.st_size));
+            size_t count = 0;
+            while(count < buffer.size())
+            {
+                const ssize_t n = ::read(fd, &buffer[count], buffer.size() - count);
+                if(n <= 0) break;
+                count += static_cast<size_t>(n);
+            }
+            buffer.resize(count);
+            ::close(fd);
+#endif
+            return true;
+        }
+
+        /** Read files in order through a pool of threads and a bounded window of files read ahead
+         *
+         * Without pthreads, each file is read when the caller asks for it.
+         */
+        class batch_file_reader_impl
+        {
+        public:
+            /** Constructor
+             *
+             * @param files names of the files to read
+             * @param thread_count number of threads, and number of files read ahead
+             */
+            batch_file_reader_impl(const std::vector<std::string>& files, const size_t thread_count) :
+                    m_files(files),
+                    m_next(0)
+#ifdef INTEROP_HAS_PTHREAD
+                    , m_buffers(files.size())
+                    , m_state(files.size(), PENDING)
+                    , m_window(std::max(thread_count, static_cast<size_t>(1)))
+                    , m_next_read(0)
+                    , m_is_cancelled(false)
+#endif
+            {
+#ifdef INTEROP_HAS_PTHREAD
+                pthread_mutex_init(&m_mutex, 0);
+                pthread_cond_init(&m_is_ready, 0);
+                pthread_cond_init(&m_not_full, 0);
+                // A single thread reads on the calling thread, as does a pool where no thread could be started
+                const size_t num_threads = thread_count > 1 ? std::min(thread_count, files.size()) : 0;
+                m_threads.reserve(num_threads);
+                for(size_t i=0;i<num_threads;++i)
+                {
+                    pthread_t thread;
+                    if(pthread_create(&thread, 0, &batch_file_reader_impl::run, this) != 0) break;
+                    m_threads.push_back(thread);
+                }
+#else
+                (void)thread_count;
+#endif
+            }
+            /** Destructor
+             *
+             * Stops the threads if not all files were read
+             */
+            ~batch_file_reader_impl()
+            {
+#ifdef INTEROP_HAS_PTHREAD
+                pthread_mutex_lock(&m_mutex);
+                m_is_cancelled = true;
+                pthread_cond_broadcast(&m_not_full);
+                pthread_mutex_unlock(&m_mutex);
+                for(size_t i=0;i<m_threads.size();++i) pthread_join(m_threads[i], 0);
+                pthread_cond_destroy(&m_not_full);
+                pthread_cond_destroy(&m_is_ready);
+                pthread_mutex_destroy(&m_mutex);
+#endif
+            }
+
+        public:
+            /** Get the bytes of the next file
+             *
+             * @param buffer destination for the bytes of the file
+             * @return false if the file could not be opened, or there are no more files
+             */
+            bool next(std::vector<char>& buffer)
+            {
+                if(m_next >= m_files.size())
+                {
+                    buffer.clear();
+                    return false;
+                }
+#ifdef INTEROP_HAS_PTHREAD
+                if(m_threads.empty()) return read_whole_file(m_files[m_next++], buffer);
+                pthread_mutex_lock(&m_mutex);
+                while(m_state[m_next] == PENDING) pthread_cond_wait(&m_is_ready, &m_mutex);
+                const bool exists = m_state[m_next] == EXISTS;
+                buffer.swap(m_buffers[m_next]);
+                std::vector<char>().swap(m_buffers[m_next]);
+                ++m_next;
+                pthread_cond_broadcast(&m_not_full);
+                pthread_mutex_unlock(&m_mutex);
+                return exists;
+#else
+                return read_whole_file(m_files[m_next++], buffer);
+#endif
+            }
+
+        private:
+#ifdef INTEROP_HAS_PTHREAD
+            /** Read files until all files are read or the reader stops
+             *
+             * Each thread takes the next unread file, waiting while the window of files read ahead is full.
+             *
+             * @param self pointer to the reader
+             * @return null
+             */
+            static void* run(void* self)
+            {
+                batch_file_reader_impl& reader = *static_cast<batch_file_reader_impl*>(self);
+                std::vector<char> buffer;
+                pthread_mutex_lock(&reader.m_mutex);
+                for(;;)
+                {
+                    while(!reader.m_is_cancelled && reader.m_next_read < reader.m_files.size() &&
+                          reader.m_next_read >= reader.m_next + reader.m_window)
+                        pthread_cond_wait(&reader.m_not_full, &reader.m_mutex);
+                    if(reader.m_is_cancelled || reader.m_next_read >= reader.m_files.size()) break;
+                    const size_t index = reader.m_next_read++;
+                    pthread_mutex_unlock(&reader.m_mutex);
+                    const bool exists = read_whole_file(reader.m_files[index], buffer);
+                    pthread_mutex_lock(&reader.m_mutex);
+                    reader.m_buffers[index].swap(buffer);
+                    reader.m_state[index] = exists ? EXISTS : MISSING;
+                    pthread_cond_broadcast(&reader.m_is_ready);
+                }
+                pthread_mutex_unlock(&reader.m_mutex);
+                return 0;
+            }
+#endif
+
+        private:
+            batch_file_reader_impl(const batch_file_reader_impl&);
+            batch_file_reader_impl& operator=(const batch_file_reader_impl&);
+
+        private:
+#ifdef INTEROP_HAS_PTHREAD
+            enum file_state{PENDING, EXISTS, MISSING};
+#endif
+            const std::vector<std::string> m_files;
+            size_t m_next;
+#ifdef INTEROP_HAS_PTHREAD
+            std::vector< std::vector<char> > m_buffers;
+            std::vector<file_state> m_state;
+            size_t m_window;
+            size_t m_next_read;
+            bool m_is_cancelled;
+            std::vector<pthread_t> m_threads;
+            pthread_mutex_t m_mutex;
+            pthread_cond_t m_is_ready;
+            pthread_cond_t m_not_full;
+#endif
+        };
+    }
+
+    /** Constructor
+     *
+     * @param files names of the files to read
+     * @param thread_count number of threads, and number of files read ahead
+     */
+    batch_file_reader::batch_file_reader(const std::vector<std::string>& files, const size_t thread_count) :
+            m_reader(new detail::batch_file_reader_impl(files, thread_count))
+    {
+    }
+    /** Destructor */
+    batch_file_reader::~batch_file_reader()
+    {
+        delete m_reader;
+    }
+    /** Get the bytes of the next file
+     *
+     * @param buffer destination for the bytes of the file
+     * @return false if the file could not be opened, or there are no more files
+     */
+    bool batch_file_reader::next(std::vector<char>& buffer)
+    {
+        return m_reader->next(buffer);
+    }
+
+    /** Read a list of files into memory
+     *
+     * @param files names of the files to read
+     * @param buffers destination for the bytes of each file, in the same order as files
+     * @param exists destination flag for each file, 0 if the file could not be opened
+     * @param thread_count number of threads
+     */
+    void read_files(const std::vector<std::string>& files,
+                    std::vector< std::vector<char> >& buffers,
+                    std::vector<unsigned char>& exists,
+                    const size_t thread_count)
+    {
+        buffers.assign(files.size(), std::vector<char>());
+        exists.assign(files.size(), 0);
+        const int file_count = static_cast<int>(files.size());
+#ifdef _OPENMP
+        const int num_threads = static_cast<int>(std::max(std::min(thread_count, files.size()),
+                                                          static_cast<size_t>(1)));
+#       pragma omp parallel for default(shared) num_threads(num_threads) schedule(dynamic) if(num_threads > 1)
+#else
+        (void)thread_count;
+#endif
+        for(int i=0;i<file_count;++i)
+        {
+            exists[i] = detail::read_whole_file(files[i], buffers[i]) ? 1 : 0;
+        }
+    }
+}}}
@@ -0,0 +1,308 @@
+/** Read and write a run folder packed into a single bundle file
+ *
+ *  @file
+ *  @date 10/18/26
+ *  @version 1.0
+ *  @copyright GNU Public License.
+ */
+
+#include "interop/io/bundle.h"
+
+#include <fstream>
+#include <cstring>
+#include <algorithm>
+#include "interop/util/filesystem.h"
+
+#ifndef WIN32
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#endif
+
+namespace illumina { namespace interop { namespace io
+{
+    namespace detail
+    {
+        /** Magic number at the start of every bundle */
+        static const char BUNDLE_MAGIC[] = "IOPBNDL1";
+        /** Number of bytes in the magic number */
+        static const size_t BUNDLE_MAGIC_SIZE = 8;
+        /** Current version of the bundle format */
+        static const ::uint32_t BUNDLE_VERSION = 1;
+        /** Size of the fixed header: magic, version and section count */
+        static const size_t BUNDLE_HEADER_SIZE = BUNDLE_MAGIC_SIZE + 4 + 4;
+        /** Size of the fixed part of each table of contents entry: name length, offset and size */
+        static const size_t BUNDLE_ENTRY_SIZE = 4 + 8 + 8;
+
+        /** Append a little endian integer to a byte string
+         *
+         * @param out destination byte string
+         * @param val integer value
+         * @param n number of bytes
+         */
+        static void write_le(std::string& out, const ::uint64_t val, const size_t n)
+        {
+            for(size_t i=0;i<n;++i) out += static_cast<char>((val >> (8*i)) & 0xff);
+        }
+        /** Read a little endian integer
+         *
+         * @param ptr pointer to the first byte
+         * @param n number of bytes
+         * @return integer value
+         */
+        static ::uint64_t read_le(const char* ptr, const size_t n)
+        {
+            ::uint64_t val = 0;
+            for(size_t i=0;i<n;++i) val |= static_cast< ::uint64_t >(static_cast<unsigned char>(ptr[i])) << (8*i);
+            return val;
+        }
+        /** Round an offset up to the next section boundary
+         *
+         * @param offset offset in bytes
+         * @return aligned offset
+         */
+        static ::uint64_t align_section(const ::uint64_t offset)
+        {
+            const ::uint64_t alignment = bundle_writer::SECTION_ALIGNMENT;
+            return (offset + alignment - 1) / alignment * alignment;
+        }
+    }
+
+    /** Normalize a section name to use '/' as the path separator
+     *
+     * @param name path relative to the run folder
+     * @return section name
+     */
+    std::string bundle_section_name(const std::string& name)
+    {
+        std::string section_name = name;
+        std::replace(section_name.begin(), section_name.end(), '\\', '/');
+        return section_name;
+    }
+
+    /** Add a section from memory
+     *
+     * @param name section name, a path relative to the run folder
+     * @param data bytes of the section
+     * @param size number of bytes
+     */
+    void bundle_writer::add(const std::string& name, const char* data, const size_t size)
+    {
+        m_sections.push_back(section());
+        m_sections.back().name = bundle_section_name(name);
+        m_sections.back().data.assign(data, size);
+    }
+    /** Add a section read from a file when the bundle is written
+     *
+     * @param name section name, a path relative to the run folder
+     * @param file_name name of the file to copy
+     */
+    void bundle_writer::add_file(const std::string& name, const std::string& file_name)
+    {
+        m_sections.push_back(section());
+        m_sections.back().name = bundle_section_name(name);
+        m_sections.back().file_name = file_name;
+    }
+    /** Write all the sections to a bundle file
+     *
+     * @param file_name name of the bundle file
+     * @throw file_not_found_exception
+     * @throw bad_format_exception
+     */
+    void bundle_writer::write(const std::string& file_name)const INTEROP_THROW_SPEC((file_not_found_exception,
+                                                                                      bad_format_exception))
+    {
+        std::vector< ::uint64_t > sizes(m_sections.size());
+        ::uint64_t toc_size = detail::BUNDLE_HEADER_SIZE;
+        for(size_t i=0;i<m_sections.size();++i)
+        {
+            toc_size += detail::BUNDLE_ENTRY_SIZE + m_sections[i].name.size();
+            if(m_sections[i].file_name.empty())
+            {
+                sizes[i] = m_sections[i].data.size();
+                continue;
+            }
+            const ::int64_t size = file_size(m_sections[i].file_name);
+            if(size < 0) INTEROP_THROW(file_not_found_exception, "File not found: " << m_sections[i].file_name);
+            sizes[i] = static_cast< ::uint64_t >(size);
+        }
+
+        std::string toc(detail::BUNDLE_MAGIC, detail::BUNDLE_MAGIC_SIZE);
+        detail::write_le(toc, detail::BUNDLE_VERSION, 4);
+        detail::write_le(toc, m_sections.size(), 4);
+        std::vector< ::uint64_t > offsets(m_sections.size());
+        ::uint64_t offset = detail::align_section(toc_size);
+        for(size_t i=0;i<m_sections.size();++i)
+        {
+            offsets[i] = offset;
+            detail::write_le(toc, m_sections[i].name.size(), 4);
+            toc += m_sections[i].name;
+            detail::write_le(toc, offsets[i], 8);
+            detail::write_le(toc, sizes[i], 8);
+            offset = detail::align_section(offset + sizes[i]);
+        }
+
+        std::ofstream fout(file_name.c_str(), std::ios::binary);
+        if(!fout.good()) INTEROP_THROW(file_not_found_exception, "Unable to open bundle for writing: " << file_name);
+        fout.write(toc.c_str(), static_cast<std::streamsize>(toc.size()));
+        ::uint64_t position = toc.size();
+        const std::string padding(bundle_writer::SECTION_ALIGNMENT, '\0');
+        std::vector<char> buffer;
+        for(size_t i=0;i<m_sections.size();++i)
+        {
+            fout.write(padding.c_str(), static_cast<std::streamsize>(offsets[i] - position));
+            if(m_sections[i].file_name.empty())
+            {
+                fout.write(m_sections[i].data.c_str(), static_cast<std::streamsize>(sizes[i]));
+            }
+            else
+            {
+                std::ifstream fin(m_sections[i].file_name.c_str(), std::ios::binary);
+                buffer.resize(static_cast<size_t>(sizes[i]));
+                if(!buffer.empty()) fin.read(&buffer.front(), static_cast<std::streamsize>(buffer.size()));
+                if(static_cast< ::uint64_t >(fin.gcount()) != sizes[i])
+                    INTEROP_THROW(bad_format_exception, "File changed while writing bundle: "
+                            << m_sections[i].file_name);
+                if(!buffer.empty()) fout.write(&buffer.front(), static_cast<std::streamsize>(buffer.size()));
+            }
+            position = offsets[i] + sizes[i];
+        }
+        if(!fout.good()) INTEROP_THROW(bad_format_exception, "Unable to write bundle: " << file_name);
+    }
+
+    /** Constructor
+     */
+    bundle_reader::bundle_reader() : m_data(0), m_size(0), m_is_mapped(false)
+    {
+    }
+    /** Destructor
+     */
+    bundle_reader::~bundle_reader()
+    {
+        close();
+    }
+    /** Open a bundle file and read the table of contents
+     *
+     * @param file_name name of the bundle file
+     * @throw file_not_found_exception
+     * @throw bad_format_exception
+     */
+    void bundle_reader::open(const std::string& file_name) INTEROP_THROW_SPEC((file_not_found_exception,
+                                                                               bad_format_exception))
+    {
+        close();
+        const ::int64_t size = file_size(file_name);
+        if(size < 0) INTEROP_THROW(file_not_found_exception, "Bundle not found: " << file_name);
+        m_size = static_cast<size_t>(size);
+#ifndef WIN32
+        const int fd = ::open(file_name.c_str(), O_RDONLY);
+        if(fd < 0) INTEROP_THROW(file_not_found_exception, "Unable to open bundle: " << file_name);
+        if(m_size > 0)
+        {
+            void* data = ::mmap(0, m_size, PROT_READ, MAP_PRIVATE, fd, 0);
+            if(data != MAP_FAILED)
+            {
+                m_data = static_cast<char*>(data);
+                m_is_mapped = true;
+            }
+        }
+        ::close(fd);
+#endif
+        if(!m_is_mapped)
+        {
+            std::ifstream fin(file_name.c_str(), std::ios::binary);
+            if(!fin.good()) INTEROP_THROW(file_not_found_exception, "Unable to open bundle: " << file_name);
+            m_buffer.resize(m_size);
+            if(!m_buffer.empty()) fin.read(&m_buffer.front(), static_cast<std::streamsize>(m_buffer.size()));
+            m_buffer.resize(static_cast<size_t>(fin.gcount()));
+            m_size = m_buffer.size();
+            m_data = m_buffer.empty() ? 0 : &m_buffer.front();
+        }
+
+        if(m_size < detail::BUNDLE_HEADER_SIZE ||
+           std::memcmp(m_data, detail::BUNDLE_MAGIC, detail::BUNDLE_MAGIC_SIZE) != 0)
+        {
+            close();
+            INTEROP_THROW(bad_format_exception, "Not an InterOp bundle: " << file_name);
+        }
+        const ::uint64_t version = detail::read_le(m_data+detail::BUNDLE_MAGIC_SIZE, 4);
+        if(version != detail::BUNDLE_VERSION)
+        {
+            close();
+            INTEROP_THROW(bad_format_exception, "Unsupported bundle version: " << version << " for " << file_name);
+        }
+        const ::uint64_t section_count = detail::read_le(m_data+detail::BUNDLE_MAGIC_SIZE+4, 4);
+        size_t position = detail::BUNDLE_HEADER_SIZE;
+        for(::uint64_t i=0;i<section_count;++i)
+        {
+            if(m_size - position < 4) break;
+            const size_t name_length = static_cast<size_t>(detail::read_le(m_data+position, 4));
+            if(m_size - position - 4 < name_length + 16) break;
+            const std::string name(m_data+position+4, name_length);
+            position += 4 + name_length;
+            const ::uint64_t offset = detail::read_le(m_data+position, 8);
+            const ::uint64_t section_size = detail::read_le(m_data+position+8, 8);
+            position += 16;
+            if(offset > m_size || section_size > m_size - offset)
+            {
+                close();
+                INTEROP_THROW(bad_format_exception, "Section " << name << " extends past the end of the bundle: "
+                        << file_name);
+            }
+            m_sections[name] = section_range_t(offset, section_size);
+        }
+        if(m_sections.size() != section_count)
+        {
+            close();
+            INTEROP_THROW(bad_format_exception, "Table of contents is incomplete or repeats a section: " << file_name);
+        }
+    }
+    /** Release the bundle file
+     */
+    void bundle_reader::close()
+    {
+#ifndef WIN32
+        if(m_is_mapped) ::munmap(m_data, m_size);
+#endif
+        m_is_mapped = false;
+        m_data = 0;
+        m_size = 0;
+        m_sections.clear();
+        std::vector<char>().swap(m_buffer);
+    }
+    /** Find a section by name
+     *
+     * @param name section name, a path relative to the run folder
+     * @param data destination pointer to the first byte of the section
+     * @param size destination number of bytes in the section
+     * @return true if the section was found
+     */
+    bool bundle_reader::find(const std::string& name, const char*& data, size_t& size)const
+    {
+        section_map_t::const_iterator it = m_sections.find(bundle_section_name(name));
+        if(it == m_sections.end()) return false;
+        data = m_data + it->second.first;
+        size = static_cast<size_t>(it->second.second);
+        return true;
+    }
+    /** Test if the bundle has a section
+     *
+     * @param name section name, a path relative to the run folder
+     * @return true if the section was found
+     */
+    bool bundle_reader::contains(const std::string& name)const
+    {
+        return m_sections.find(bundle_section_name(name)) != m_sections.end();
+    }
+    /** List the names of all the sections
+     *
+     * @param names destination section names
+     */
+    void bundle_reader::list_sections(std::vector<std::string>& names)const
+    {
+        names.clear();
+        names.reserve(m_sections.size());
+        for(section_map_t::const_iterator it = m_sections.begin();it != m_sections.end();++it)
+            names.push_back(it->first);
+    }
+}}}
@@ -0,0 +1,804 @@
+/** Read gzip or zstd compressed InterOp files
+ *
+ *  @file
+ *  @date 10/18/26
+ *  @version 1.0
+ *  @copyright GNU Public License.
+ */
+
+#include "interop/io/compressed_file.h"
+
+#include <fstream>
+#include <cstring>
+#include <limits>
+#include <deque>
+#include <algorithm>
+#include "interop/util/filesystem.h"
+
+#ifdef INTEROP_HAS_ZLIB
+#include <zlib.h>
+#endif
+#ifdef INTEROP_HAS_ZSTD
+#include <zstd.h>
+#endif
+#ifdef INTEROP_HAS_PTHREAD
+#include <pthread.h>
+#endif
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+namespace illumina { namespace interop { namespace io
+{
+    namespace detail
+    {
+        /** Size of each chunk of decompressed data handed to the reader */
+        static const size_t DECOMPRESS_CHUNK_SIZE = 1u << 20;
+        /** Number of compressed bytes read from the file at one time */
+        static const size_t INPUT_CHUNK_SIZE = 1u << 18;
+        /** Largest amount of compressed data held while looking for complete members */
+        static const size_t MAX_PENDING_SIZE = 1u << 24;
+        /** Number of decompressed chunks the producer thread may run ahead of the reader */
+        static const size_t CHUNK_QUEUE_SIZE = 4;
+
+        /** Get the number of threads to use
+         *
+         * A thread count of 0 inside a parallel region uses one thread, as the files are already read concurrently.
+         *
+         * @param thread_count requested number of threads, 0 for the OpenMP default
+         * @return number of threads
+         */
+        static int thread_count_or_default(const size_t thread_count)
+        {
+#ifdef _OPENMP
+            if(thread_count == 0) return omp_in_parallel() ? 1 : omp_get_max_threads();
+#endif
+            return static_cast<int>(std::max(thread_count, static_cast<size_t>(1)));
+        }
+
+#ifdef INTEROP_HAS_ZLIB
+        /** Read a little endian integer
+         *
+         * @param ptr pointer to the first byte
+         * @param n number of bytes
+         * @return integer value
+         */
+        static size_t read_le(const unsigned char* ptr, const size_t n)
+        {
+            size_t val = 0;
+            for(size_t i=n;i>0;--i) val = (val << 8) | ptr[i-1];
+            return val;
+        }
+        /** Clamp a size to the range of a zlib length
+         *
+         * @param n size in bytes
+         * @return size that fits in uInt
+         */
+        static uInt zlib_length(const size_t n)
+        {
+            return static_cast<uInt>(std::min(n, static_cast<size_t>(std::numeric_limits<uInt>::max())));
+        }
+        /** Find the complete BGZF members at the start of gzip data
+         *
+         * A BGZF member stores its compressed size in the 'BC' extra field and its uncompressed size in the
+         * trailer, so every member can be located and inflated independently.
+         *
+         * @param data compressed data
+         * @param size number of bytes of compressed data
+         * @param offsets destination offset of each member, with the end of the last complete member appended
+         * @param output_offsets destination offset of the output of each member, with the total size appended
+         * @return false if a member is not a BGZF member
+         */
+        static bool find_bgzf_members(const char* data,
+                                      const size_t size,
+                                      std::vector<size_t>& offsets,
+                                      std::vector<size_t>& output_offsets)
+        {
+            const size_t header_size = 12;
+            const size_t trailer_size = 8;
+            const unsigned char* beg = reinterpret_cast<const unsigned char*>(data);
+            offsets.assign(1, 0);
+            output_offsets.assign(1, 0);
+            while(offsets.back() < size)
+            {
+                const unsigned char* member = beg + offsets.back();
+                const size_t remaining = size - offsets.back();
+                if(remaining < header_size) break;
+                if(member[0] != 0x1f || member[1] != 0x8b || member[2] != 8 || (member[3] & 4) == 0) return false;
+                const size_t extra_size = read_le(member+10, 2);
+                if(header_size + extra_size > remaining) break;
+                size_t member_size = 0;
+                for(size_t field = 0; field + 4 <= extra_size;)
+                {
+                    const unsigned char* sub = member + header_size + field;
+                    const size_t sub_size = read_le(sub+2, 2);
+                    if(sub[0] == 'B' && sub[1] == 'C' && sub_size == 2) member_size = read_le(sub+4, 2) + 1;
+                    field += 4 + sub_size;
+                }
+                if(member_size < header_size + extra_size + trailer_size) return false;
+                if(member_size > remaining) break;
+                offsets.push_back(offsets.back() + member_size);
+                output_offsets.push_back(output_offsets.back() + read_le(member + member_size - 4, 4));
+            }
+            return true;
+        }
+        /** Inflate one gzip member with a known output size
+         *
+         * @param in compressed member
+         * @param in_size size of the compressed member
+         * @param out destination
+         * @param out_size uncompressed size of the member
+         * @return true if the member was inflated to exactly the expected size
+         */
+        static bool inflate_member(const char* in, const size_t in_size, char* out, const size_t out_size)
+        {
+            z_stream stream;
+            std::memset(&stream, 0, sizeof(stream));
+            if(inflateInit2(&stream, 15+16) != Z_OK) return false;
+            stream.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(in));
+            stream.avail_in = zlib_length(in_size);
+            stream.next_out = reinterpret_cast<Bytef*>(out);
+            stream.avail_out = zlib_length(out_size);
+            const int status = inflate(&stream, Z_FINISH);
+            const bool is_complete = status == Z_STREAM_END && stream.total_out == out_size;
+            inflateEnd(&stream);
+            return is_complete;
+        }
+#endif
+
+#ifdef INTEROP_HAS_ZSTD
+        /** Find the complete zstd frames at the start of zstd data
+         *
+         * @param data compressed data
+         * @param size number of bytes of compressed data
+         * @param offsets destination offset of each frame, with the end of the last complete frame appended
+         * @param output_offsets destination offset of the output of each frame, with the total size appended
+         * @return false if a frame does not record its content size
+         */
+        static bool find_zstd_frames(const char* data,
+                                     const size_t size,
+                                     std::vector<size_t>& offsets,
+                                     std::vector<size_t>& output_offsets)
+        {
+            offsets.assign(1, 0);
+            output_offsets.assign(1, 0);
+            while(offsets.back() < size)
+            {
+                const char* frame = data+offsets.back();
+                const size_t remaining = size - offsets.back();
+                const unsigned long long content_size = ZSTD_getFrameContentSize(frame, remaining);
+                if(content_size == ZSTD_CONTENTSIZE_UNKNOWN) return false;
+                const size_t frame_size = ZSTD_findFrameCompressedSize(frame, remaining);
+                // The frame, or its header, is not complete yet
+                if(ZSTD_isError(frame_size) || content_size == ZSTD_CONTENTSIZE_ERROR) break;
+                offsets.push_back(offsets.back() + frame_size);
+                output_offsets.push_back(output_offsets.back() + static_cast<size_t>(content_size));
+            }
+            return true;
+        }
+#endif
+
+        /** Supported compression formats */
+        enum compression_format
+        {
+            NoCompression,
+            GzipCompression,
+            ZstdCompression
+        };
+
+        /** Decompress a gzip or zstd file one chunk at a time
+         *
+         * The compressed file is read in chunks as well, so neither the compressed nor the decompressed file is held
+         * in memory.
+         */
+        class chunk_decompressor
+        {
+        public:
+            /** Constructor
+             *
+             * @param file_name name of the compressed file
+             * @param thread_count number of threads for BGZF members or zstd frames
+             * @throw file_not_found_exception
+             * @throw bad_format_exception
+             */
+            chunk_decompressor(const std::string& file_name, const int thread_count) :
+                    m_file_name(file_name),
+                    m_file(file_name.c_str(), std::ios::binary),
+                    m_offset(0),
+                    m_is_eof(false),
+                    m_is_member_end(true),
+                    m_format(NoCompression),
+                    m_thread_count(thread_count),
+                    m_is_split(thread_count > 1)
+#ifdef INTEROP_HAS_ZSTD
+                    , m_zstd(0)
+#endif
+            {
+                if(!m_file.good()) INTEROP_THROW(file_not_found_exception, "File not found: " << file_name);
+                read_input();
+                if(m_input.empty()) return;
+                const unsigned char gzip_magic[] = {0x1f, 0x8b};
+                const unsigned char zstd_magic[] = {0x28, 0xb5, 0x2f, 0xfd};
+                if(has_magic(gzip_magic, sizeof(gzip_magic)))
+                {
+#ifdef INTEROP_HAS_ZLIB
+                    std::memset(&m_zlib, 0, sizeof(m_zlib));
+                    if(inflateInit2(&m_zlib, 15+16) != Z_OK)
+                        INTEROP_THROW(bad_format_exception, "Cannot initialize zlib for " << file_name);
+                    m_format = GzipCompression;
+                    return;
+#else
+                    INTEROP_THROW(bad_format_exception, "Reading gzip compressed files is not supported by this build: "
+                            << file_name);
+#endif
+                }
+                if(has_magic(zstd_magic, sizeof(zstd_magic)))
+                {
+#ifdef INTEROP_HAS_ZSTD
+                    m_zstd = ZSTD_createDStream();
+                    if(m_zstd == 0) INTEROP_THROW(bad_format_exception, "Cannot initialize zstd for " << file_name);
+                    ZSTD_initDStream(m_zstd);
+                    m_format = ZstdCompression;
+                    return;
+#else
+                    INTEROP_THROW(bad_format_exception, "Reading zstd compressed files is not supported by this build: "
+                            << file_name);
+#endif
+                }
+                INTEROP_THROW(bad_format_exception, "Unknown compression format: " << file_name);
+            }
+            /** Destructor */
+            ~chunk_decompressor()
+            {
+#ifdef INTEROP_HAS_ZLIB
+                if(m_format == GzipCompression) inflateEnd(&m_zlib);
+#endif
+#ifdef INTEROP_HAS_ZSTD
+                if(m_zstd != 0) ZSTD_freeDStream(m_zstd);
+#endif
+            }
+
+        public:
+            /** Decompress the next chunk of the file
+             *
+             * @param chunk destination for the decompressed bytes, may be empty if the chunk held only empty members
+             * @return false if the end of the file was reached
+             * @throw bad_format_exception
+             */
+            bool next(std::vector<char>& chunk)
+            {
+                chunk.clear();
+                if(m_is_split && next_members(chunk)) return true;
+                if(m_is_split) return false;
+                return next_stream(chunk);
+            }
+            /** Test if the compressed data was complete
+             *
+             * @return false if the data ended inside a gzip member or zstd frame
+             */
+            bool is_complete()const
+            {
+                return m_is_member_end;
+            }
+
+        private:
+            /** Read the next chunk of compressed data, dropping the data already consumed
+             *
+             * @return false if the end of the file was reached
+             */
+            bool read_input()
+            {
+                if(m_is_eof) return false;
+                m_input.erase(m_input.begin(), m_input.begin()+m_offset);
+                m_offset = 0;
+                const size_t size = m_input.size();
+                m_input.resize(size + INPUT_CHUNK_SIZE);
+                m_file.read(&m_input[size], static_cast<std::streamsize>(INPUT_CHUNK_SIZE));
+                const size_t count = static_cast<size_t>(m_file.gcount());
+                m_input.resize(size + count);
+                if(count < INPUT_CHUNK_SIZE) m_is_eof = true;
+                return count > 0;
+            }
+            /** Test if the file starts with a magic number
+             *
+             * @param magic magic number
+             * @param n length of the magic number
+             * @return true if the file starts with the magic number
+             */
+            bool has_magic(const unsigned char* magic, const size_t n)const
+            {
+                return m_input.size() >= n && std::memcmp(&m_input.front(), magic, n) == 0;
+            }
+            /** Find the complete members or frames at the start of the pending compressed data
+             *
+             * @param offsets destination offset of each member relative to the pending data
+             * @param output_offsets destination offset of the output of each member
+             * @return false if the data cannot be split into members
+             */
+            bool find_members(std::vector<size_t>& offsets, std::vector<size_t>& output_offsets)const
+            {
+                const char* data = m_input.empty() ? 0 : &m_input.front()+m_offset;
+                const size_t size = m_input.size()-m_offset;
+#ifdef INTEROP_HAS_ZLIB
+                if(m_format == GzipCompression) return find_bgzf_members(data, size, offsets, output_offsets);
+#endif
+#ifdef INTEROP_HAS_ZSTD
+                if(m_format == ZstdCompression) return find_zstd_frames(data, size, offsets, output_offsets);
+#endif
+                (void)data;
+                (void)size;
+                offsets.assign(1, 0);
+                output_offsets.assign(1, 0);
+                return m_format == NoCompression;
+            }
+            /** Decompress the next group of BGZF members or zstd frames in parallel
+             *
+             * Falls back to the streaming decoder for the rest of the file when the data cannot be split, or when a
+             * member fails to decompress, so the streaming decoder reports the error.
+             *
+             * @param chunk destination for the decompressed bytes
+             * @return false if the end of the file was reached or the rest of the file must be streamed
+             */
+            bool next_members(std::vector<char>& chunk)
+            {
+                std::vector<size_t> offsets;
+                std::vector<size_t> output_offsets;
+                while(true)
+                {
+                    if(!find_members(offsets, output_offsets))
+                    {
+                        m_is_split = false;
+                        return false;
+                    }
+                    if(output_offsets.back() >= DECOMPRESS_CHUNK_SIZE || m_is_eof) break;
+                    if(m_input.size()-m_offset >= MAX_PENDING_SIZE) break;
+                    read_input();
+                }
+                const int member_count = static_cast<int>(offsets.size()-1);
+                if(member_count == 0)
+                {
+                    // A truncated member is left over, the streaming decoder reports how much could be read
+                    if(m_offset < m_input.size()) m_is_split = false;
+                    return false;
+                }
+                chunk.resize(output_offsets.back());
+                const char* data = &m_input.front()+m_offset;
+                int failed = 0;
+#ifdef _OPENMP
+#               pragma omp parallel for default(shared) num_threads(m_thread_count) schedule(dynamic) reduction(+:failed)
+#endif
+                for(int i=0;i<member_count;++i)
+                {
+                    const size_t output_size = output_offsets[i+1]-output_offsets[i];
+                    if(output_size == 0) continue;
+                    if(!decompress_member(data+offsets[i],
+                                          offsets[i+1]-offsets[i],
+                                          &chunk.front()+output_offsets[i],
+                                          output_size)) ++failed;
+                }
+                if(failed > 0)
+                {
+                    chunk.clear();
+                    m_is_split = false;
+                    return false;
+                }
+                m_offset += offsets.back();
+                return true;
+            }
+            /** Decompress a single BGZF member or zstd frame with a known output size
+             *
+             * @param in compressed member
+             * @param in_size size of the compressed member
+             * @param out destination
+             * @param out_size uncompressed size of the member
+             * @return true if the member was decompressed to exactly the expected size
+             */
+            bool decompress_member(const char* in, const size_t in_size, char* out, const size_t out_size)const
+            {
+#ifdef INTEROP_HAS_ZLIB
+                if(m_format == GzipCompression) return inflate_member(in, in_size, out, out_size);
+#endif
+#ifdef INTEROP_HAS_ZSTD
+                if(m_format == ZstdCompression)
+                {
+                    const size_t written = ZSTD_decompress(out, out_size, in, in_size);
+                    return !ZSTD_isError(written) && written == out_size;
+                }
+#endif
+                (void)in;
+                (void)in_size;
+                (void)out;
+                (void)out_size;
+                return false;
+            }
+            /** Decompress the next chunk with the streaming decoder
+             *
+             * @param chunk destination for the decompressed bytes
+             * @return false if the end of the file was reached
+             */
+            bool next_stream(std::vector<char>& chunk)
+            {
+                chunk.resize(DECOMPRESS_CHUNK_SIZE);
+                size_t size = 0;
+#ifdef INTEROP_HAS_ZLIB
+                if(m_format == GzipCompression) size = inflate_chunk(chunk);
+#endif
+#ifdef INTEROP_HAS_ZSTD
+                if(m_format == ZstdCompression) size = decompress_zstd_chunk(chunk);
+#endif
+                chunk.resize(size);
+                return size > 0;
+            }
+#ifdef INTEROP_HAS_ZLIB
+            /** Inflate gzip data, which may hold several concatenated members, into a chunk
+             *
+             * @param chunk destination for the decompressed bytes
+             * @return number of bytes decompressed
+             */
+            size_t inflate_chunk(std::vector<char>& chunk)
+            {
+                size_t size = 0;
+                while(size < chunk.size())
+                {
+                    if(m_offset == m_input.size() && !read_input()) break;
+                    if(m_is_member_end)
+                    {
+                        inflateReset(&m_zlib); // Concatenated members
+                        m_is_member_end = false;
+                    }
+                    const uInt in_size = zlib_length(m_input.size() - m_offset);
+                    const uInt out_size = zlib_length(chunk.size() - size);
+                    m_zlib.next_in = reinterpret_cast<Bytef*>(&m_input.front()+m_offset);
+                    m_zlib.avail_in = in_size;
+                    m_zlib.next_out = reinterpret_cast<Bytef*>(&chunk.front()+size);
+                    m_zlib.avail_out = out_size;
+                    const int status = inflate(&m_zlib, Z_NO_FLUSH);
+                    m_offset += in_size - m_zlib.avail_in;
+                    size += out_size - m_zlib.avail_out;
+                    if(status == Z_STREAM_END) m_is_member_end = true;
+                    else if(status != Z_OK && status != Z_BUF_ERROR)
+                        INTEROP_THROW(bad_format_exception, "Corrupt gzip data in " << m_file_name);
+                    else if(m_zlib.avail_in == in_size && m_zlib.avail_out == out_size) break;
+                }
+                return size;
+            }
+#endif
+#ifdef INTEROP_HAS_ZSTD
+            /** Decompress zstd data, which may hold several frames, into a chunk
+             *
+             * @param chunk destination for the decompressed bytes
+             * @return number of bytes decompressed
+             */
+            size_t decompress_zstd_chunk(std::vector<char>& chunk)
+            {
+                size_t size = 0;
+                while(size < chunk.size())
+                {
+                    // The decoder may still hold output after the last of the input was consumed
+                    if(m_offset == m_input.size() && !read_input() && m_is_member_end) break;
+                    ZSTD_inBuffer input = {m_input.empty() ? 0 : &m_input.front(), m_input.size(), m_offset};
+                    ZSTD_outBuffer output = {&chunk.front()+size, chunk.size()-size, 0};
+                    const size_t hint = ZSTD_decompressStream(m_zstd, &output, &input);
+                    if(ZSTD_isError(hint))
+                        INTEROP_THROW(bad_format_exception, "Corrupt zstd data in " << m_file_name << ": "
+                                                            << ZSTD_getErrorName(hint));
+                    const bool is_stalled = input.pos == m_offset && output.pos == 0;
+                    m_offset = input.pos;
+                    size += output.pos;
+                    m_is_member_end = hint == 0;
+                    if(is_stalled && m_is_eof) break;
+                }
+                return size;
+            }
+#endif
+
+        private:
+            chunk_decompressor(const chunk_decompressor&);
+            chunk_decompressor& operator=(const chunk_decompressor&);
+
+        private:
+            std::string m_file_name;
+            std::ifstream m_file;
+            std::vector<char> m_input;
+            size_t m_offset;
+            bool m_is_eof;
+            bool m_is_member_end;
+            compression_format m_format;
+            int m_thread_count;
+            bool m_is_split;
+#ifdef INTEROP_HAS_ZLIB
+            z_stream m_zlib;
+#endif
+#ifdef INTEROP_HAS_ZSTD
+            ZSTD_DStream* m_zstd;
+#endif
+        };
+
+        /** Read a compressed file through a producer thread and a bounded queue of decompressed chunks
+         *
+         * Without pthreads, each chunk is decompressed when the reader asks for it.
+         */
+        class compressed_file_reader
+        {
+        public:
+            /** Constructor
+             *
+             * @param file_name name of the compressed file
+             * @param thread_count number of threads for BGZF members or zstd frames
+             * @throw file_not_found_exception
+             * @throw bad_format_exception
+             */
+            compressed_file_reader(const std::string& file_name, const int thread_count) :
+                    m_decompressor(file_name, thread_count)
+#ifdef INTEROP_HAS_PTHREAD
+                    , m_is_started(false)
+                    , m_is_done(false)
+                    , m_is_cancelled(false)
+                    , m_is_complete(true)
+#endif
+            {
+#ifdef INTEROP_HAS_PTHREAD
+                pthread_mutex_init(&m_mutex, 0);
+                pthread_cond_init(&m_not_empty, 0);
+                pthread_cond_init(&m_not_full, 0);
+                // If no thread can be started, each chunk is decompressed on the reader thread instead
+                m_is_started = pthread_create(&m_thread, 0, &compressed_file_reader::run, this) == 0;
+#endif
+            }
+            /** Destructor
+             *
+             * Stops the producer thread if the file was not read to the end
+             */
+            ~compressed_file_reader()
+            {
+#ifdef INTEROP_HAS_PTHREAD
+                if(m_is_started)
+                {
+                    pthread_mutex_lock(&m_mutex);
+                    m_is_cancelled = true;
+                    pthread_cond_broadcast(&m_not_full);
+                    pthread_mutex_unlock(&m_mutex);
+                    pthread_join(m_thread, 0);
+                }
+                pthread_cond_destroy(&m_not_full);
+                pthread_cond_destroy(&m_not_empty);
+                pthread_mutex_destroy(&m_mutex);
+#endif
+            }
+
+        public:
+            /** Get the next chunk of decompressed data
+             *
+             * @param chunk destination for the decompressed bytes
+             * @return false if the end of the file was reached
+             * @throw bad_format_exception
+             */
+            bool next(std::vector<char>& chunk)
+            {
+#ifdef INTEROP_HAS_PTHREAD
+                if(!m_is_started) return next_inline(chunk);
+                pthread_mutex_lock(&m_mutex);
+                while(m_chunks.empty() && !m_is_done) pthread_cond_wait(&m_not_empty, &m_mutex);
+                if(m_chunks.empty())
+                {
+                    const std::string error = m_error;
+                    pthread_mutex_unlock(&m_mutex);
+                    if(error != "") INTEROP_THROW(bad_format_exception, error);
+                    return false;
+                }
+                chunk.swap(m_chunks.front());
+                m_chunks.pop_front();
+                pthread_cond_signal(&m_not_full);
+                pthread_mutex_unlock(&m_mutex);
+                return true;
+#else
+                return next_inline(chunk);
+#endif
+            }
+            /** Test if the compressed data was complete
+             *
+             * @return false if the data ended inside a gzip member or zstd frame
+             */
+            bool is_complete()const
+            {
+#ifdef INTEROP_HAS_PTHREAD
+                if(m_is_started) return m_is_complete;
+#endif
+                return m_decompressor.is_complete();
+            }
+
+        private:
+            /** Decompress the next non-empty chunk on the calling thread
+             *
+             * @param chunk destination for the decompressed bytes
+             * @return false if the end of the file was reached
+             */
+            bool next_inline(std::vector<char>& chunk)
+            {
+                while(m_decompressor.next(chunk))
+                {
+                    if(!chunk.empty()) return true;
+                }
+                return false;
+            }
+#ifdef INTEROP_HAS_PTHREAD
+            /** Decompress the file into the queue until the end of the file or the reader stops
+             *
+             * @param self pointer to the reader
+             * @return null
+             */
+            static void* run(void* self)
+            {
+                compressed_file_reader& reader = *static_cast<compressed_file_reader*>(self);
+                std::vector<char> chunk;
+                std::string error;
+                try
+                {
+                    while(reader.m_decompressor.next(chunk))
+                    {
+                        if(chunk.empty()) continue;
+                        if(!reader.push(chunk)) break;
+                    }
+                }
+                catch(const std::exception& ex)
+                {
+                    error = ex.what();
+                }
+                pthread_mutex_lock(&reader.m_mutex);
+                reader.m_is_done = true;
+                reader.m_is_complete = reader.m_decompressor.is_complete();
+                reader.m_error = error;
+                pthread_cond_broadcast(&reader.m_not_empty);
+                pthread_mutex_unlock(&reader.m_mutex);
+                return 0;
+            }
+            /** Add a chunk to the queue, waiting while the queue is full
+             *
+             * @param chunk decompressed bytes, swapped into the queue
+             * @return false if the reader stopped
+             */
+            bool push(std::vector<char>& chunk)
+            {
+                pthread_mutex_lock(&m_mutex);
+                while(m_chunks.size() >= CHUNK_QUEUE_SIZE && !m_is_cancelled)
+                    pthread_cond_wait(&m_not_full, &m_mutex);
+                const bool is_cancelled = m_is_cancelled;
+                if(!is_cancelled)
+                {
+                    m_chunks.push_back(std::vector<char>());
+                    m_chunks.back().swap(chunk);
+                    pthread_cond_signal(&m_not_empty);
+                }
+                pthread_mutex_unlock(&m_mutex);
+                return !is_cancelled;
+            }
+#endif
+
+        private:
+            compressed_file_reader(const compressed_file_reader&);
+            compressed_file_reader& operator=(const compressed_file_reader&);
+
+        private:
+            chunk_decompressor m_decompressor;
+#ifdef INTEROP_HAS_PTHREAD
+            pthread_t m_thread;
+            pthread_mutex_t m_mutex;
+            pthread_cond_t m_not_empty;
+            pthread_cond_t m_not_full;
+            std::deque< std::vector<char> > m_chunks;
+            bool m_is_started;
+            bool m_is_done;
+            bool m_is_cancelled;
+            bool m_is_complete;
+            std::string m_error;
+#endif
+        };
+    }
+
+    /** Test if files with the given compression extension can be read
+     *
+     * @param extension file extension, either ".gz" or ".zst"
+     * @return true if the library was built with support for the extension
+     */
+    bool is_compression_supported(const std::string& extension)
+    {
+#ifdef INTEROP_HAS_ZLIB
+        if(extension == ".gz") return true;
+#endif
+#ifdef INTEROP_HAS_ZSTD
+        if(extension == ".zst") return true;
+#endif
+        (void)extension;
+        return false;
+    }
+    /** Find a compressed copy of a file
+     *
+     * The extensions ".gz" and ".zst" are checked in that order, but only if the library supports them.
+     *
+     * @param file_name name of the uncompressed file
+     * @return name of the compressed copy or an empty string if none was found
+     */
+    std::string find_compressed_file(const std::string& file_name)
+    {
+        const char* extensions[] = {".gz", ".zst"};
+        for(size_t i=0;i<sizeof(extensions)/sizeof(extensions[0]);++i)
+        {
+            if(!is_compression_supported(extensions[i])) continue;
+            const std::string compressed_file_name = file_name + extensions[i];
+            if(is_file_readable(compressed_file_name)) return compressed_file_name;
+        }
+        return "";
+    }
+    /** Constructor
+     *
+     * @param file_name name of the compressed file
+     * @param thread_count number of threads for BGZF members or zstd frames, 0 uses the OpenMP default
+     */
+    compressed_filebuf::compressed_filebuf(const std::string& file_name, const size_t thread_count)
+                                                                        INTEROP_THROW_SPEC((file_not_found_exception,
+                                                                                bad_format_exception)) :
+            m_reader(new detail::compressed_file_reader(file_name, detail::thread_count_or_default(thread_count)))
+    {
+        setg(0, 0, 0);
+    }
+    /** Destructor */
+    compressed_filebuf::~compressed_filebuf()
+    {
+        delete m_reader;
+    }
+    /** Test if the compressed data was complete
+     *
+     * @return false if the compressed data ended early
+     */
+    bool compressed_filebuf::is_complete()const
+    {
+        return m_reader->is_complete();
+    }
+    /** Get the error raised while decompressing
+     *
+     * @return error message or an empty string
+     */
+    const std::string& compressed_filebuf::error()const
+    {
+        return m_error;
+    }
+    /** Get the next chunk of decompressed data
+     *
+     * An error is kept rather than thrown, as the input stream would swallow it.
+     *
+     * @return next character or eof
+     */
+    compressed_filebuf::int_type compressed_filebuf::underflow()
+    {
+        if(gptr() < egptr()) return traits_type::to_int_type(*gptr());
+        if(m_error != "") return traits_type::eof();
+        try
+        {
+            if(!m_reader->next(m_chunk)) return traits_type::eof();
+        }
+        catch(const bad_format_exception& ex)
+        {
+            m_error = ex.what();
+            return traits_type::eof();
+        }
+        setg(&m_chunk.front(), &m_chunk.front(), &m_chunk.front()+m_chunk.size());
+        return traits_type::to_int_type(*gptr());
+    }
+    /** Decompress a gzip or zstd file into memory
+     *
+     * @param file_name name of the compressed file
+     * @param buffer destination for the decompressed bytes
+     * @param thread_count number of threads, 0 uses the OpenMP default
+     * @return false if the compressed data ended early, the bytes decompressed so far are kept
+     */
+    bool read_compressed_file(const std::string& file_name, std::vector<char>& buffer, const size_t thread_count)
+                                                                        INTEROP_THROW_SPEC((file_not_found_exception,
+                                                                                bad_format_exception))
+    {
+        detail::chunk_decompressor decompressor(file_name, detail::thread_count_or_default(thread_count));
+        buffer.clear();
+        std::vector<char> chunk;
+        while(decompressor.next(chunk)) buffer.insert(buffer.end(), chunk.begin(), chunk.end());
+        return decompressor.is_complete();
+    }
+}}}
@@ -0,0 +1,367 @@
+/** Sidecar index of record offsets for random access into binary InterOp files
+ *
+ *  @file
+ *  @date 10/18/26
+ *  @version 1.0
+ *  @copyright GNU Public License.
+ */
+
+#include "interop/io/record_index.h"
+
+#include <limits>
+
+#ifndef WIN32
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+namespace illumina { namespace interop { namespace io
+{
+    namespace detail
+    {
+        /** Magic number at the start of every record index */
+        static const char RECORD_INDEX_MAGIC[] = "IOPRIDX1";
+        /** Number of bytes in the magic number */
+        static const size_t RECORD_INDEX_MAGIC_SIZE = 8;
+        /** Size of the fixed header: magic, source size, source time, header size, record size and entry count */
+        static const size_t RECORD_INDEX_HEADER_SIZE = RECORD_INDEX_MAGIC_SIZE + 5*8;
+        /** Size of each entry: lane, tile, cycle and record */
+        static const size_t RECORD_INDEX_ENTRY_SIZE = 3*4 + 8;
+
+        /** Append a little endian integer to a byte string
+         *
+         * @param out destination byte string
+         * @param val integer value
+         * @param n number of bytes
+         */
+        static void append_le(std::string& out, const ::uint64_t val, const size_t n)
+        {
+            for(size_t i=0;i<n;++i) out += static_cast<char>((val >> (8*i)) & 0xff);
+        }
+        /** Read a little endian integer
+         *
+         * @param ptr pointer to the first byte
+         * @param n number of bytes
+         * @return integer value
+         */
+        static ::uint64_t parse_le(const char* ptr, const size_t n)
+        {
+            ::uint64_t val = 0;
+            for(size_t i=0;i<n;++i) val |= static_cast< ::uint64_t >(static_cast<unsigned char>(ptr[i])) << (8*i);
+            return val;
+        }
+        /** Read bytes at an offset in a file
+         *
+         * @param fd file descriptor (POSIX) or input stream (WIN32)
+         * @param buffer destination buffer
+         * @param size number of bytes to read
+         * @param offset offset in the file
+         * @return true if all the bytes were read
+         */
+#ifndef WIN32
+        static bool read_at(const int fd, char* buffer, size_t size, ::uint64_t offset)
+        {
+            while(size > 0)
+            {
+                const ssize_t count = ::pread(fd, buffer, size, static_cast<off_t>(offset));
+                if(count <= 0) return false;
+                buffer += count;
+                size -= static_cast<size_t>(count);
+                offset += static_cast< ::uint64_t >(count);
+            }
+            return true;
+        }
+#else
+        static bool read_at(std::ifstream& fin, char* buffer, const size_t size, const ::uint64_t offset)
+        {
+            fin.seekg(static_cast<std::streamoff>(offset));
+            fin.read(buffer, static_cast<std::streamsize>(size));
+            return static_cast<size_t>(fin.gcount()) == size;
+        }
+#endif
+    }
+
+    /** Constructor
+     */
+    record_index::record_index() :
+            m_source_size(-1),
+            m_source_time(-1),
+            m_header_size(0),
+            m_record_size(0),
+            m_data(0),
+            m_entry_count(0),
+            m_map(0),
+            m_map_size(0)
+    {
+    }
+    /** Destructor
+     */
+    record_index::~record_index()
+    {
+        close();
+    }
+    /** Start a new index for an InterOp file
+     *
+     * @param source_size size of the InterOp file in bytes
+     * @param source_time modification time of the InterOp file
+     * @param header_size number of bytes before the first record
+     * @param record_size number of bytes in each record
+     */
+    void record_index::reset(const ::int64_t source_size,
+                             const ::int64_t source_time,
+                             const size_t header_size,
+                             const size_t record_size)
+    {
+        close();
+        m_source_size = source_size;
+        m_source_time = source_time;
+        m_header_size = header_size;
+        m_record_size = record_size;
+    }
+    /** Add the location of a record
+     *
+     * @param lane lane number
+     * @param tile tile number
+     * @param cycle cycle number, 0 for metrics without a cycle
+     * @param record position of the record in the file
+     */
+    void record_index::add(const ::uint32_t lane, const ::uint32_t tile, const ::uint32_t cycle, const ::uint64_t record)
+    {
+        entry e;
+        e.lane = lane;
+        e.tile = tile;
+        e.cycle = cycle;
+        e.record = record;
+        m_entries.push_back(e);
+    }
+    /** Sort the entries by lane, tile and cycle
+     */
+    void record_index::sort()
+    {
+        std::sort(m_entries.begin(), m_entries.end());
+    }
+    /** Open a saved index
+     *
+     * @param file_name name of the index file
+     * @return false if the index file is missing or not a valid index
+     */
+    bool record_index::read(const std::string& file_name)
+    {
+        close();
+        size_t size = 0;
+        const char* data = 0;
+#ifndef WIN32
+        const int fd = ::open(file_name.c_str(), O_RDONLY);
+        if(fd < 0) return false;
+        struct stat buf;
+        if(::fstat(fd, &buf) == 0 && buf.st_size >= static_cast<off_t>(detail::RECORD_INDEX_HEADER_SIZE))
+        {
+            void* map = ::mmap(0, static_cast<size_t>(buf.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+            if(map != MAP_FAILED)
+            {
+                m_map = map;
+                m_map_size = static_cast<size_t>(buf.st_size);
+                data = static_cast<const char*>(map);
+                size = m_map_size;
+            }
+        }
+        ::close(fd);
+#else
+        const ::int64_t file_bytes = file_size(file_name);
+        if(file_bytes >= static_cast< ::int64_t >(detail::RECORD_INDEX_HEADER_SIZE))
+        {
+            std::ifstream fin(file_name.c_str(), std::ios::binary);
+            m_buffer.resize(static_cast<size_t>(file_bytes));
+            fin.read(&m_buffer.front(), static_cast<std::streamsize>(m_buffer.size()));
+            m_buffer.resize(static_cast<size_t>(fin.gcount()));
+            size = m_buffer.size();
+            data = m_buffer.empty() ? 0 : &m_buffer.front();
+        }
+#endif
+        if(size < detail::RECORD_INDEX_HEADER_SIZE ||
+           std::memcmp(data, detail::RECORD_INDEX_MAGIC, detail::RECORD_INDEX_MAGIC_SIZE) != 0)
+        {
+            close();
+            return false;
+        }
+        const char* ptr = data + detail::RECORD_INDEX_MAGIC_SIZE;
+        const ::uint64_t entry_count = detail::parse_le(ptr+32, 8);
+        if((size - detail::RECORD_INDEX_HEADER_SIZE) / detail::RECORD_INDEX_ENTRY_SIZE != entry_count)
+        {
+            close();
+            return false;
+        }
+        m_source_size = static_cast< ::int64_t >(detail::parse_le(ptr, 8));
+        m_source_time = static_cast< ::int64_t >(detail::parse_le(ptr+8, 8));
+        m_header_size = detail::parse_le(ptr+16, 8);
+        m_record_size = detail::parse_le(ptr+24, 8);
+        m_entry_count = static_cast<size_t>(entry_count);
+        m_data = data + detail::RECORD_INDEX_HEADER_SIZE;
+        return true;
+    }
+    /** Release a saved index and clear the entries
+     */
+    void record_index::close()
+    {
+#ifndef WIN32
+        if(m_map != 0) ::munmap(m_map, m_map_size);
+#endif
+        m_map = 0;
+        m_map_size = 0;
+        m_data = 0;
+        m_entry_count = 0;
+        std::vector<char>().swap(m_buffer);
+        m_entries.clear();
+        m_source_size = -1;
+        m_source_time = -1;
+        m_header_size = 0;
+        m_record_size = 0;
+    }
+    /** Get an indexed record
+     *
+     * @param i index of the entry, in order of lane, tile and cycle
+     * @return entry
+     */
+    record_index::entry record_index::at(const size_t i)const
+    {
+        if(m_data == 0) return m_entries[i];
+        const char* ptr = m_data + i*detail::RECORD_INDEX_ENTRY_SIZE;
+        entry e;
+        e.lane = static_cast< ::uint32_t >(detail::parse_le(ptr, 4));
+        e.tile = static_cast< ::uint32_t >(detail::parse_le(ptr+4, 4));
+        e.cycle = static_cast< ::uint32_t >(detail::parse_le(ptr+8, 4));
+        e.record = detail::parse_le(ptr+12, 8);
+        return e;
+    }
+    /** Find the first entry in a range that is not before the given lane, tile and cycle
+     *
+     * @param first first entry in the range
+     * @param last end of the range
+     * @param lane lane number
+     * @param tile tile number
+     * @param cycle cycle number
+     * @return index of the entry, or last if every entry comes first
+     */
+    size_t record_index::lower_bound(size_t first,
+                                     size_t last,
+                                     const ::uint32_t lane,
+                                     const ::uint32_t tile,
+                                     const ::uint32_t cycle)const
+    {
+        while(first < last)
+        {
+            const size_t middle = first + (last-first)/2;
+            const entry e = at(middle);
+            const bool is_before = e.lane != lane ? e.lane < lane : (e.tile != tile ? e.tile < tile : e.cycle < cycle);
+            if(is_before) first = middle+1;
+            else last = middle;
+        }
+        return first;
+    }
+    /** Find the first entry of the next lane
+     *
+     * @param first first entry of the current lane
+     * @param last end of the entries
+     * @param lane current lane number
+     * @return index of the entry, or last if there is no following lane
+     */
+    size_t record_index::next_lane(const size_t first, const size_t last, const ::uint32_t lane)const
+    {
+        if(lane == std::numeric_limits< ::uint32_t >::max()) return last;
+        return lower_bound(first, last, lane+1, 0, 0);
+    }
+    /** Find the first entry of the next tile
+     *
+     * @param first first entry of the current tile
+     * @param last end of the entries
+     * @param lane current lane number
+     * @param tile current tile number
+     * @return index of the entry, or last if there is no following tile
+     */
+    size_t record_index::next_tile(const size_t first,
+                                   const size_t last,
+                                   const ::uint32_t lane,
+                                   const ::uint32_t tile)const
+    {
+        if(tile == std::numeric_limits< ::uint32_t >::max()) return next_lane(first, last, lane);
+        return lower_bound(first, last, lane, tile+1, 0);
+    }
+    /** Write the index to a file
+     *
+     * @param file_name name of the index file
+     * @return false if the index file could not be written
+     */
+    bool record_index::write(const std::string& file_name)const
+    {
+        std::string data(detail::RECORD_INDEX_MAGIC, detail::RECORD_INDEX_MAGIC_SIZE);
+        data.reserve(detail::RECORD_INDEX_HEADER_SIZE + size()*detail::RECORD_INDEX_ENTRY_SIZE);
+        detail::append_le(data, static_cast< ::uint64_t >(m_source_size), 8);
+        detail::append_le(data, static_cast< ::uint64_t >(m_source_time), 8);
+        detail::append_le(data, m_header_size, 8);
+        detail::append_le(data, m_record_size, 8);
+        detail::append_le(data, size(), 8);
+        for(size_t i=0;i<size();++i)
+        {
+            const entry e = at(i);
+            detail::append_le(data, e.lane, 4);
+            detail::append_le(data, e.tile, 4);
+            detail::append_le(data, e.cycle, 4);
+            detail::append_le(data, e.record, 8);
+        }
+        std::ofstream fout(file_name.c_str(), std::ios::binary);
+        if(!fout.good()) return false;
+        fout.write(data.c_str(), static_cast<std::streamsize>(data.size()));
+        return fout.good();
+    }
+    /** Test if the index matches the current size and modification time of the InterOp file
+     *
+     * @param file_name name of the InterOp file
+     * @return true if the index is up to date
+     */
+    bool record_index::is_current(const std::string& file_name)const
+    {
+        return m_source_size >= 0 &&
+               file_size(file_name) == m_source_size &&
+               file_modification_time(file_name) == m_source_time;
+    }
+    /** Read the header and the selected records of the InterOp file
+     *
+     * @param file_name name of the InterOp file
+     * @param records sorted positions of the records to read
+     * @param buffer destination for the header followed by the selected records
+     * @return false if the file could not be opened or is shorter than the index expects
+     */
+    bool record_index::read_records(const std::string& file_name,
+                                    const record_vector_t& records,
+                                    std::vector<char>& buffer)const
+    {
+        if(m_header_size == 0) return false;
+        const size_t header_bytes = header_size();
+        const size_t record_bytes = record_size();
+        buffer.resize(header_bytes + records.size()*record_bytes);
+#ifndef WIN32
+        const int fin = ::open(file_name.c_str(), O_RDONLY);
+        if(fin < 0) return false;
+#else
+        std::ifstream fin(file_name.c_str(), std::ios::binary);
+        if(!fin.good()) return false;
+#endif
+        bool is_read = detail::read_at(fin, &buffer.front(), header_bytes, 0);
+        for(size_t i=0;is_read && i<records.size();)
+        {
+            size_t run = 1;
+            while(i+run < records.size() && records[i+run] == records[i]+run) ++run;
+            is_read = detail::read_at(fin,
+                                      &buffer[header_bytes + i*record_bytes],
+                                      run*record_bytes,
+                                      m_header_size + records[i]*m_record_size);
+            i += run;
+        }
+#ifndef WIN32
+        ::close(fin);
+#endif
+        return is_read;
+    }
+}}}
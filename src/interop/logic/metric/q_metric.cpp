@@ -6,7 +6,10 @@
  *  @copyright GNU Public License.
  */
 #include <vector>
+#include <limits>
+#include <algorithm>
 #include "interop/util/map.h"
+#include "interop/util/radix_sort.h"
 #include "interop/logic/metric/q_metric.h"
 
 
@@ -50,11 +53,19 @@ namespace illumina { namespace interop { namespace logic { namespace metric
     namespace detail
     {
         template<class QMetric>
-        struct by_cycle
+        struct cycle_key
         {
-            bool operator()(const QMetric &lhs, const QMetric &rhs) const
+            ::uint64_t operator()(const QMetric &metric) const
             {
-                return lhs.cycle() < rhs.cycle();
+                return metric.cycle();
+            }
+        };
+        template<class QMetric>
+        struct id_key
+        {
+            ::uint64_t operator()(const QMetric &metric) const
+            {
+                return metric.id();
             }
         };
     }
@@ -70,7 +81,9 @@ namespace illumina { namespace interop { namespace logic { namespace metric
         if(metric_set.size()==0) return;
         if(!populate_cumulative_distribution_sorted(metric_set))
         {
-            std::sort(metric_set.begin(), metric_set.end(), detail::by_cycle<QMetric>());
+            std::vector<size_t> order;
+            util::radix_sort_order(metric_set.begin(), metric_set.end(), detail::cycle_key<QMetric>(), order);
+            util::apply_permutation(metric_set.begin(), order);
             metric_set.clear_lookup();
             populate_cumulative_distribution_sorted(metric_set);
         }
@@ -269,6 +282,130 @@ namespace illumina { namespace interop { namespace logic { namespace metric
         bylane.set_version(model::metrics::q_by_lane_metric::LATEST_VERSION);
     }
 
+    /** Derive the collapsed, by lane and cumulative Q-metrics in a single sweep
+     *
+     * @param metric_set Q-metrics
+     * @param collapsed empty collapsed Q-metrics
+     * @param bylane empty bylane Q-metrics
+     * @param instrument instrument type
+     * @param populate_tile_cumulative if false, skip the cumulative histograms of the Q-metrics
+     * @return true if the metrics were derived
+     * @throws index_out_of_bounds_exception
+     */
+    bool derive_q_metrics(model::metric_base::metric_set<model::metrics::q_metric>& metric_set,
+                          model::metric_base::metric_set<model::metrics::q_collapsed_metric>& collapsed,
+                          model::metric_base::metric_set<model::metrics::q_by_lane_metric>& bylane,
+                          const constants::instrument_type instrument,
+                          const bool populate_tile_cumulative)
+    INTEROP_THROW_SPEC((model::index_out_of_bounds_exception))
+    {
+        typedef model::metric_base::metric_set<model::metrics::q_metric> q_metric_set_t;
+        typedef model::metric_base::metric_set<model::metrics::q_collapsed_metric> q_collapsed_set_t;
+        typedef model::metric_base::metric_set<model::metrics::q_by_lane_metric> q_by_lane_set_t;
+        typedef q_metric_set_t::header_type header_type;
+        typedef q_metric_set_t::uint_t uint_t;
+        typedef model::metric_base::base_metric::id_t id_t;
+        typedef std::pair<id_t, size_t> record_key_t;
+
+        INTEROP_ASSERT(collapsed.empty() && bylane.empty());
+        if(metric_set.empty()) return true;
+
+        // Order the records by lane, tile then cycle, and mark where each tile and lane starts
+        std::vector<size_t> permutation;
+        util::radix_sort_order(metric_set.begin(),
+                               metric_set.end(),
+                               detail::id_key<model::metrics::q_metric>(),
+                               permutation);
+        std::vector<record_key_t> order(metric_set.size());
+        for(size_t k=0;k<permutation.size();++k)
+            order[k] = record_key_t(metric_set[permutation[k]].id(), permutation[k]);
+        std::vector<size_t> tile_offsets;
+        std::vector<size_t> lane_offsets;
+        uint_t max_lane = 0;
+        uint_t max_cycle = 0;
+        for(size_t k=0;k<order.size();++k)
+        {
+            const model::metrics::q_metric& metric = metric_set[order[k].second];
+            max_lane = std::max(max_lane, metric.lane());
+            max_cycle = std::max(max_cycle, metric.cycle());
+            if(k == 0 || metric.tile_hash() != metric_set[order[k-1].second].tile_hash())
+            {
+                if(k == 0 || metric.lane() != metric_set[order[k-1].second].lane())
+                    lane_offsets.push_back(tile_offsets.size());
+                tile_offsets.push_back(k);
+            }
+            else if(order[k].first == order[k-1].first || order[k].second < order[k-1].second)
+                return false; // Records of the tile are duplicated or not stored in cycle order
+        }
+        lane_offsets.push_back(tile_offsets.size());
+        tile_offsets.push_back(order.size());
+
+        // One by lane record per lane and cycle, in order of first appearance
+        const size_t cycle_count = static_cast<size_t>(max_cycle)+1;
+        const size_t no_slot = std::numeric_limits<size_t>::max();
+        std::vector<size_t> slot_by_lane_cycle((static_cast<size_t>(max_lane)+1)*cycle_count, no_slot);
+        std::vector<size_t> first_record_of_slot;
+        bylane = static_cast<const header_type&>(metric_set);
+        for(size_t i=0;i<metric_set.size();++i)
+        {
+            const model::metrics::q_metric& metric = metric_set[i];
+            size_t& slot = slot_by_lane_cycle[metric.lane()*cycle_count+metric.cycle()];
+            if(slot != no_slot) continue;
+            slot = bylane.size();
+            first_record_of_slot.push_back(i);
+            bylane.insert(model::metrics::q_by_lane_metric(metric.lane(), 0, metric.cycle(), metric.qscore_hist()));
+        }
+
+        const uint_t q20_idx = static_cast<uint_t>(index_for_q_value(metric_set, 20));
+        const uint_t q30_idx = static_cast<uint_t>(index_for_q_value(metric_set, 30));
+        collapsed.set_version(model::metrics::q_collapsed_metric::LATEST_VERSION);
+        collapsed.resize(metric_set.size());
+
+        const q_metric_set_t::iterator q_begin = metric_set.begin();
+        const q_collapsed_set_t::iterator collapsed_begin = collapsed.begin();
+        const q_by_lane_set_t::iterator bylane_begin = bylane.begin();
+        const int lane_count = static_cast<int>(lane_offsets.size()-1);
+        // Each lane owns its by lane records, so lanes can be processed in parallel without locking
+#ifdef _OPENMP
+#       pragma omp parallel for default(shared) schedule(dynamic)
+#endif
+        for(int lane_index=0;lane_index<lane_count;++lane_index)
+        {
+            for(size_t tile_index=lane_offsets[lane_index];tile_index<lane_offsets[lane_index+1];++tile_index)
+            {
+                for(size_t k=tile_offsets[tile_index];k<tile_offsets[tile_index+1];++k)
+                {
+                    const size_t current = order[k].second;
+                    const size_t previous = (k == tile_offsets[tile_index]) ? current : order[k-1].second;
+                    model::metrics::q_metric& metric = *(q_begin+current);
+                    model::metrics::q_collapsed_metric& collapsed_metric = *(collapsed_begin+current);
+                    collapsed_metric = model::metrics::q_collapsed_metric(metric.lane(),
+                                                                         metric.tile(),
+                                                                         metric.cycle(),
+                                                                         metric.total_over_qscore(q20_idx),
+                                                                         metric.total_over_qscore(q30_idx),
+                                                                         metric.sum_qscore(),
+                                                                         metric.median(metric_set.get_bins()));
+                    collapsed_metric.accumulate(*(collapsed_begin+previous));
+                    if(populate_tile_cumulative) metric.accumulate(*(q_begin+previous));
+                    const size_t slot = slot_by_lane_cycle[metric.lane()*cycle_count+metric.cycle()];
+                    if(first_record_of_slot[slot] != current) (bylane_begin+slot)->accumulate_by_lane(metric);
+                }
+            }
+        }
+        collapsed.rebuild_index(true);
+
+        const size_t bin_count = logic::metric::count_legacy_q_score_bins(bylane);
+        if(requires_legacy_bins(bin_count))
+        {
+            populate_legacy_q_score_bins(bylane.bins(), instrument, bin_count);
+            compress_q_metrics(bylane);
+        }
+        bylane.set_version(model::metrics::q_by_lane_metric::LATEST_VERSION);
+        populate_cumulative_distribution_t(bylane);
+        return true;
+    }
+
     /** Compress the q-metric set using the bins in the header
      *
      * @param q_metric_set q-metric set
@@ -22,9 +22,11 @@ namespace illumina { namespace interop { namespace logic { namespace plot
         /** Constructor
          *
          * @param points reference to collection of points
+         * @param mask filter options compiled against the run info
          */
-        by_cycle_average_plot(model::plot::data_point_collection<Point>&  points) :
-                m_points(points), m_max_cycle(0), m_empty(true){}
+        by_cycle_average_plot(model::plot::data_point_collection<Point>&  points,
+                              const model::plot::filter_mask& mask) :
+                m_points(points), m_mask(mask), m_max_cycle(0), m_empty(true){}
 
         /** Plot the average over all tiles of a specific metric by cycle
          *
@@ -60,7 +62,7 @@ namespace illumina { namespace interop { namespace logic { namespace plot
     private:
         template<typename MetricSet, typename MetricProxy>
         void plot(const MetricSet& metrics,
-                  const model::plot::filter_options& options,
+                  const model::plot::filter_options&,
                   const MetricProxy& proxy,
                   const constants::base_cycle_t*)
         {
@@ -68,9 +70,11 @@ namespace illumina { namespace interop { namespace logic { namespace plot
             m_empty = metrics.empty();
             m_points.assign(m_max_cycle, Point());
             const float dummy_x = 1;
-            for(typename MetricSet::const_iterator b = metrics.begin(), e = metrics.end();b != e;++b)
+            typedef std::pair<typename MetricSet::const_iterator, typename MetricSet::const_iterator> range_t;
+            const range_t range = m_mask.select(metrics);
+            for(typename MetricSet::const_iterator b = range.first, e = range.second;b != e;++b)
             {
-                if(!options.valid_tile(*b)) continue;
+                if(!m_mask.valid_tile(*b)) continue;
                 const float val = proxy(*b);
                 if(std::isnan(val) || std::isinf(val)) continue;
                 m_points[b->cycle()-1].add(dummy_x, val);
@@ -94,6 +98,7 @@ namespace illumina { namespace interop { namespace logic { namespace plot
 
     private:
         model::plot::data_point_collection<Point>& m_points;
+        const model::plot::filter_mask& m_mask;
         size_t m_max_cycle;
         bool m_empty;
     };
@@ -115,9 +120,11 @@ namespace illumina { namespace interop { namespace logic { namespace plot
         /** Constructor
          *
          * @param points reference to collection of points
+         * @param mask filter options compiled against the run info
          */
-        by_cycle_candle_stick_plot(model::plot::data_point_collection<Point>&  points) :
-            m_points(points), m_max_cycle(0), m_empty(true){}
+        by_cycle_candle_stick_plot(model::plot::data_point_collection<Point>&  points,
+                                   const model::plot::filter_mask& mask) :
+            m_points(points), m_mask(mask), m_max_cycle(0), m_empty(true){}
 
 
         /** Plot the candle stick over all tiles of a specific metric by cycle
@@ -159,7 +166,7 @@ namespace illumina { namespace interop { namespace logic { namespace plot
          */
         template<typename MetricSet, typename MetricProxy>
         void plot(const MetricSet& metrics,
-                  const model::plot::filter_options& options,
+                  const model::plot::filter_options&,
                   const MetricProxy& proxy,
                   const constants::base_cycle_t*)
         {
@@ -171,9 +178,11 @@ namespace illumina { namespace interop { namespace logic { namespace plot
             std::vector<float> outliers;
             outliers.reserve(10); // TODO: use as flag for keeping outliers
 
-            for(typename MetricSet::const_iterator b = metrics.begin(), e = metrics.end();b != e;++b)
+            typedef std::pair<typename MetricSet::const_iterator, typename MetricSet::const_iterator> range_t;
+            const range_t range = m_mask.select(metrics);
+            for(typename MetricSet::const_iterator b = range.first, e = range.second;b != e;++b)
             {
-                if(!options.valid_tile(*b)) continue;
+                if(!m_mask.valid_tile(*b)) continue;
                 const float val = proxy(*b);
                 if(std::isnan(val) || std::isinf(val)) continue;
                 tile_by_cycle[b->cycle()-1].push_back(val);
@@ -199,6 +208,7 @@ namespace illumina { namespace interop { namespace logic { namespace plot
                   const void*){}
     private:
         model::plot::data_point_collection<Point>& m_points;
+        const model::plot::filter_mask& m_mask;
         size_t m_max_cycle;
         bool m_empty;
     };
@@ -252,7 +262,7 @@ namespace illumina { namespace interop { namespace logic { namespace plot
      * @param skip_empty set false for testing purposes
      */
     template<class Point>
-    void plot_by_cycle_t(model::metrics::run_metrics& metrics,
+    void plot_by_cycle_t(const model::metrics::run_metrics& metrics,
                        const constants::metric_type type,
                        const model::plot::filter_options& options,
                        model::plot::plot_data<Point>& data,
@@ -270,19 +280,25 @@ namespace illumina { namespace interop { namespace logic { namespace plot
         size_t max_cycle=0;
         bool is_empty = true;
 
-        if(logic::utils::to_group(type) == constants::Q)
+        if(logic::utils::to_group(type) == constants::Q &&
+           metrics.get<model::metrics::q_collapsed_metric>().empty() &&
+           !metrics.get<model::metrics::q_metric>().empty())
         {
-            if(0 == metrics.get<model::metrics::q_collapsed_metric>().size())
-                logic::metric::create_collapse_q_metrics(metrics.get<model::metrics::q_metric>(),
-                                                         metrics.get<model::metrics::q_collapsed_metric>());
+            // Derive the collapsed q-metrics into a separate run, the source run is not modified
+            model::metrics::run_metrics derived(metrics.run_info(), metrics.run_parameters());
+            logic::metric::create_collapse_q_metrics(metrics.get<model::metrics::q_metric>(),
+                                                     derived.get<model::metrics::q_collapsed_metric>());
+            plot_by_cycle_t(derived, type, options, data, skip_empty);
+            return;
         }
+        const model::plot::filter_mask mask = options.compile(metrics.run_info());
         if(options.all_channels(type))
         {
             setup_series_by_channel(metrics.run_info().channels(), data);
             model::plot::filter_options updated_options(options);
             for(size_t i=0;i<data.size();++i)
             {
-                by_cycle_average_plot<Point> plot(data[i]);
+                by_cycle_average_plot<Point> plot(data[i], mask);
                 updated_options.channel(static_cast<model::plot::filter_options::channel_t>(i));
                 plot_metric_proxy::select(metrics, updated_options, type, plot);
                 max_cycle = plot.max_cycle();
@@ -295,7 +311,7 @@ namespace illumina { namespace interop { namespace logic { namespace plot
             model::plot::filter_options updated_options(options);
             for(size_t i=0;i<data.size();++i)
             {
-                by_cycle_average_plot<Point> plot(data[i]);
+                by_cycle_average_plot<Point> plot(data[i], mask);
                 updated_options.dna_base(static_cast<constants::dna_bases >(i));
                 plot_metric_proxy::select(metrics, updated_options, type, plot);
                 max_cycle = plot.max_cycle();
@@ -305,7 +321,7 @@ namespace illumina { namespace interop { namespace logic { namespace plot
         else
         {
             data.assign(1, model::plot::series<Point>());
-            by_cycle_candle_stick_plot<Point> plot(data[0]);
+            by_cycle_candle_stick_plot<Point> plot(data[0], mask);
             plot_metric_proxy::select(metrics, options, type, plot);
             max_cycle = plot.max_cycle();
             is_empty = plot.empty();
@@ -356,7 +372,7 @@ namespace illumina { namespace interop { namespace logic { namespace plot
      * @param skip_empty set false for testing purposes
      */
     template<class Point>
-    void plot_by_cycle_t(model::metrics::run_metrics& metrics,
+    void plot_by_cycle_t(const model::metrics::run_metrics& metrics,
                          const std::string& metric_name,
                          const model::plot::filter_options& options,
                          model::plot::plot_data<Point>& data,
@@ -377,7 +393,7 @@ namespace illumina { namespace interop { namespace logic { namespace plot
     * @param data output plot data
     * @param skip_empty set false for testing purposes
     */
-    void plot_by_cycle(model::metrics::run_metrics& metrics,
+    void plot_by_cycle(const model::metrics::run_metrics& metrics,
                        const constants::metric_type type,
                        const model::plot::filter_options& options,
                        model::plot::plot_data<model::plot::candle_stick_point>& data,
@@ -401,7 +417,7 @@ namespace illumina { namespace interop { namespace logic { namespace plot
      * @param data output plot data
      * @param skip_empty set false for testing purposes
      */
-    void plot_by_cycle(model::metrics::run_metrics& metrics,
+    void plot_by_cycle(const model::metrics::run_metrics& metrics,
                        const std::string& metric_name,
                        const model::plot::filter_options& options,
                        model::plot::plot_data<model::plot::candle_stick_point>& data,
@@ -22,9 +22,11 @@ namespace illumina { namespace interop { namespace logic { namespace plot
         /** Constructor
          *
          * @param points reference to collection of points
+         * @param mask filter options compiled against the run info
          */
-        by_lane_candle_stick_plot(model::plot::data_point_collection<Point>&  points) :
-                m_points(points){}
+        by_lane_candle_stick_plot(model::plot::data_point_collection<Point>&  points,
+                                  const model::plot::filter_mask& mask) :
+                m_points(points), m_mask(mask){}
 
 
         /** Plot the candle stick over all tiles of a specific metric by lane
@@ -50,7 +52,7 @@ namespace illumina { namespace interop { namespace logic { namespace plot
          */
         template<typename MetricSet, typename MetricProxy>
         void plot(const MetricSet& metrics,
-                  const model::plot::filter_options& options,
+                  const model::plot::filter_options&,
                   const MetricProxy& proxy,
                   const constants::base_tile_t*)
         {
@@ -62,9 +64,11 @@ namespace illumina { namespace interop { namespace logic { namespace plot
             std::vector<float> outliers;
             outliers.reserve(10);
 
-            for(typename MetricSet::const_iterator b = metrics.begin(), e = metrics.end();b != e;++b)
+            typedef std::pair<typename MetricSet::const_iterator, typename MetricSet::const_iterator> range_t;
+            const range_t range = m_mask.select(metrics);
+            for(typename MetricSet::const_iterator b = range.first, e = range.second;b != e;++b)
             {
-                if(!options.valid_tile(*b)) continue;
+                if(!m_mask.valid_tile(*b)) continue;
                 const float val = proxy(*b);
                 if(std::isnan(val)) continue;
                 tile_by_lane[b->lane()-1].push_back(val);
@@ -87,6 +91,7 @@ namespace illumina { namespace interop { namespace logic { namespace plot
                   const void*){}
     private:
         model::plot::data_point_collection<Point>& m_points;
+        const model::plot::filter_mask& m_mask;
     };
 
     /** Plot a specified metric value by lane
@@ -117,7 +122,8 @@ namespace illumina { namespace interop { namespace logic { namespace plot
         data.assign(1, model::plot::series<Point>(utils::to_description(type), "Blue"));
 
 
-        by_lane_candle_stick_plot<Point> plot(data[0]);
+        const model::plot::filter_mask mask = options.compile(metrics.run_info());
+        by_lane_candle_stick_plot<Point> plot(data[0], mask);
         plot_metric_proxy::select(metrics, options, type, plot);
         if (type == constants::ClusterCount || type == constants::Clusters)//constants::Density )
         {
@@ -125,7 +131,7 @@ namespace illumina { namespace interop { namespace logic { namespace plot
             const constants::metric_type second_type =
                     (type == constants::Clusters ? constants::ClustersPF : constants::ClusterCountPF);
 
-            by_lane_candle_stick_plot<Point> plot2(data[1]);
+            by_lane_candle_stick_plot<Point> plot2(data[1], mask);
             plot_metric_proxy::select(metrics, options, second_type, plot2);
         }
 
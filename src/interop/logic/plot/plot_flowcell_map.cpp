@@ -22,11 +22,13 @@ namespace illumina { namespace interop { namespace logic { namespace plot
          * @param data reference to collection of points
          * @param values_for_scaling references to values for color bar scaling
          * @param layout flowcell layout
+         * @param mask filter options compiled against the run info
          */
         flowcell_plot(model::plot::flowcell_data &data,
                       std::vector<float> &values_for_scaling,
-                      const model::run::flowcell_layout &layout) :
-                m_data(data), m_values_for_scaling(values_for_scaling), m_layout(layout), m_empty(true)
+                      const model::run::flowcell_layout &layout,
+                      const model::plot::filter_mask &mask) :
+                m_data(data), m_values_for_scaling(values_for_scaling), m_layout(layout), m_mask(mask), m_empty(true)
         {}
 
         /** Plot the average over all tiles of a specific metric by cycle
@@ -42,18 +44,15 @@ namespace illumina { namespace interop { namespace logic { namespace plot
         {
             m_empty = metrics.empty();
             const bool all_surfaces = !options.is_specific_surface();
-            for (typename MetricSet::const_iterator beg = metrics.begin(); beg != metrics.end(); ++beg)
+            typedef std::pair<typename MetricSet::const_iterator, typename MetricSet::const_iterator> range_t;
+            const range_t range = m_mask.select(metrics);
+            for (typename MetricSet::const_iterator beg = range.first; beg != range.second; ++beg)
             {
-                if (!options.valid_tile_cycle(*beg)) continue;
+                if (!m_mask.valid_tile_cycle(*beg)) continue;
                 const float val = proxy(*beg);
                 if (std::isnan(val)) continue;
                 m_data.set_data(beg->lane() - 1,
-                                beg->physical_location_index(
-                                        m_layout.naming_method(),
-                                        m_layout.sections_per_lane(),
-                                        m_layout.tile_count(),
-                                        m_layout.swath_count(),
-                                        all_surfaces),
+                                m_layout.geometry(beg->tile()).physical_location_index(all_surfaces),
                                 beg->tile(),
                                 val);
                 m_values_for_scaling.push_back(val);
@@ -73,7 +72,8 @@ namespace illumina { namespace interop { namespace logic { namespace plot
     private:
         model::plot::flowcell_data &m_data;
         std::vector<float> &m_values_for_scaling;
-        model::run::flowcell_layout m_layout;
+        const model::run::flowcell_layout& m_layout;
+        const model::plot::filter_mask& m_mask;
         bool m_empty;
     };
 
@@ -88,7 +88,7 @@ namespace illumina { namespace interop { namespace logic { namespace plot
      * @param tile_buffer preallocated memory for tile ids
      * @param skip_empty set false for testing purposes
      */
-    void plot_flowcell_map(model::metrics::run_metrics &metrics,
+    void plot_flowcell_map(const model::metrics::run_metrics &metrics,
                            const constants::metric_type type,
                            const model::plot::filter_options &options,
                            model::plot::flowcell_data &data,
@@ -133,13 +133,19 @@ namespace illumina { namespace interop { namespace logic { namespace plot
         if (options.all_bases(type))
             INTEROP_THROW(model::invalid_filter_option, "All bases is unsupported");
 
-        if(logic::utils::to_group(type) == constants::Q)
+        if(logic::utils::to_group(type) == constants::Q &&
+           metrics.get<model::metrics::q_collapsed_metric>().empty() &&
+           !metrics.get<model::metrics::q_metric>().empty())
         {
-            if(0 == metrics.get<model::metrics::q_collapsed_metric>().size())
-                logic::metric::create_collapse_q_metrics(metrics.get<model::metrics::q_metric>(),
-                                                         metrics.get<model::metrics::q_collapsed_metric>());
+            // Derive the collapsed q-metrics into a separate run, the source run is not modified
+            model::metrics::run_metrics derived(metrics.run_info(), metrics.run_parameters());
+            logic::metric::create_collapse_q_metrics(metrics.get<model::metrics::q_metric>(),
+                                                     derived.get<model::metrics::q_collapsed_metric>());
+            plot_flowcell_map(derived, type, options, data, buffer, tile_buffer, skip_empty);
+            return;
         }
-        flowcell_plot plot(data, values_for_scaling, layout);
+        const model::plot::filter_mask mask = options.compile(metrics.run_info());
+        flowcell_plot plot(data, values_for_scaling, layout, mask);
         plot_metric_proxy::select(metrics, options, type, plot);
         const bool is_empty = plot.empty();
         if (is_empty && !skip_empty)
@@ -194,7 +200,7 @@ namespace illumina { namespace interop { namespace logic { namespace plot
      * @param tile_buffer preallocated memory for tile ids
      * @param skip_empty set false for testing purposes
      */
-    void plot_flowcell_map(model::metrics::run_metrics &metrics,
+    void plot_flowcell_map(const model::metrics::run_metrics &metrics,
                            const std::string &metric_name,
                            const model::plot::filter_options &options,
                            model::plot::flowcell_data &data,
@@ -19,19 +19,19 @@ namespace illumina { namespace interop { namespace logic { namespace plot
      * @param beg iterator to start of q-metric collection
      * @param end iterator to end of q-metric collection
      * @param bins q-score bins
-     * @param options filter for metric records
+     * @param mask filter options compiled against the run info
      * @param data q-score heatmap
      */
     template<typename I, typename B>
     void populate_heatmap_from_compressed(I beg,
                                           I end,
                                           const std::vector<B>& bins,
-                                          const model::plot::filter_options &options,
+                                          const model::plot::filter_mask& mask,
                                           model::plot::heatmap_data& data)
     {
         for (;beg != end;++beg)
         {
-            if( !options.valid_tile(*beg) ) continue;
+            if( !mask.valid_tile(*beg) ) continue;
             for(size_t bin =0;bin < bins.size();++bin)
                 data(beg->cycle()-1, bins[bin].value()-1) += beg->qscore_hist(bin);
         }
@@ -40,18 +40,18 @@ namespace illumina { namespace interop { namespace logic { namespace plot
      *
      * @param beg iterator to start of q-metric collection
      * @param end iterator to end of q-metric collection
-     * @param options filter for metric records
+     * @param mask filter options compiled against the run info
      * @param data q-score heatmap
      */
     template<typename I>
     void populate_heatmap_from_uncompressed(I beg,
                                             I end,
-                                            const model::plot::filter_options &options,
+                                            const model::plot::filter_mask& mask,
                                             model::plot::heatmap_data& data)
     {
         for (;beg != end;++beg)
         {
-            if( !options.valid_tile(*beg) ) continue;
+            if( !mask.valid_tile(*beg) ) continue;
             for(size_t bin =0;bin < beg->size();++bin)
                 data(beg->cycle()-1, bin) += beg->qscore_hist(bin);
         }
@@ -95,13 +95,13 @@ namespace illumina { namespace interop { namespace logic { namespace plot
     /** Plot a heat map of q-scores
      *
      * @param metric_set q-metrics (full or by lane)
-     * @param options options to filter the data
+     * @param mask filter options compiled against the run info
      * @param data output heat map data
      * @param buffer preallocated memory
      */
     template<class Metric>
     void populate_heatmap(const model::metric_base::metric_set<Metric>& metric_set,
-                          const model::plot::filter_options& options,
+                          const model::plot::filter_mask& mask,
                           model::plot::heatmap_data& data,
                           float* buffer)
     {
@@ -119,12 +119,12 @@ namespace illumina { namespace interop { namespace logic { namespace plot
             populate_heatmap_from_compressed(metric_set.begin(),
                                              metric_set.end(),
                                              metric_set.get_bins(),
-                                             options,
+                                             mask,
                                              data);
         else
             populate_heatmap_from_uncompressed(metric_set.begin(),
                                                metric_set.end(),
-                                               options,
+                                               mask,
                                                data);
         normalize_heatmap(data);
         remap_to_bins(metric_set.get_bins().begin(),
@@ -140,7 +140,7 @@ namespace illumina { namespace interop { namespace logic { namespace plot
      * @param data output heat map data
      * @param buffer preallocated memory
      */
-    void plot_qscore_heatmap(model::metrics::run_metrics& metrics,
+    void plot_qscore_heatmap(const model::metrics::run_metrics& metrics,
                                     const model::plot::filter_options& options,
                                     model::plot::heatmap_data& data,
                                     float* buffer,
@@ -154,18 +154,24 @@ namespace illumina { namespace interop { namespace logic { namespace plot
             typedef model::metrics::q_metric metric_t;
             if (metrics.get<metric_t>().size() == 0)return;
             options.validate(constants::QScore, metrics.run_info());
-            populate_heatmap(metrics.get<metric_t>(), options, data, buffer);
+            populate_heatmap(metrics.get<metric_t>(), options.compile(metrics.run_info()), data, buffer);
         }
         else
         {
             typedef model::metrics::q_by_lane_metric metric_t;
-            if(0 == metrics.get<metric_t>().size())
+            // Derive the q-metrics by lane locally when missing, the source run is not modified
+            model::metric_base::metric_set<metric_t> derived;
+            const model::metric_base::metric_set<metric_t>* by_lane = &metrics.get<metric_t>();
+            if(0 == by_lane->size())
+            {
                 logic::metric::create_q_metrics_by_lane(metrics.get<model::metrics::q_metric>(),
-                                                        metrics.get<metric_t>(),
+                                                        derived,
                                                         metrics.run_parameters().instrument_type());
-            if (metrics.get<metric_t>().size() == 0)return;
+                by_lane = &derived;
+            }
+            if (by_lane->size() == 0)return;
             options.validate(constants::QScore, metrics.run_info());
-            populate_heatmap(metrics.get<metric_t>(), options, data, buffer);
+            populate_heatmap(*by_lane, options.compile(metrics.run_info()), data, buffer);
         }
 
         data.set_xrange(0, static_cast<float>(data.row_count()));
@@ -16,7 +16,7 @@ namespace illumina { namespace interop { namespace logic { namespace plot
      *
      * @param beg iterator to start of q-metric collection
      * @param end iterator to end of q-metric collection
-     * @param options filter for metric records
+     * @param mask filter options compiled against the run info
      * @param first_cycle first cycle to keep
      * @param last_cycle last cycle to keep
      * @param histogram q-score histogram
@@ -24,7 +24,7 @@ namespace illumina { namespace interop { namespace logic { namespace plot
     template<typename I>
     void populate_distribution(I beg,
                                I end,
-                               const model::plot::filter_options &options,
+                               const model::plot::filter_mask& mask,
                                const size_t first_cycle,
                                const size_t last_cycle,
                                std::vector<float>& histogram)
@@ -33,7 +33,7 @@ namespace illumina { namespace interop { namespace logic { namespace plot
         histogram.resize(beg->size(), 0);
         for (;beg != end;++beg)
         {
-            if( !options.valid_tile(*beg) || beg->cycle() < first_cycle || beg->cycle() > last_cycle) continue;
+            if( !mask.valid_tile(*beg) || beg->cycle() < first_cycle || beg->cycle() > last_cycle) continue;
             beg->accumulate_into(histogram);
         }
     }
@@ -144,7 +144,7 @@ namespace illumina { namespace interop { namespace logic { namespace plot
      * @param data output plot data
      * @param boundary index of bin to create the boundary sub plots (0 means do nothing)
      */
-    void plot_qscore_histogram(model::metrics::run_metrics& metrics,
+    void plot_qscore_histogram(const model::metrics::run_metrics& metrics,
                                const model::plot::filter_options& options,
                                model::plot::plot_data<model::plot::bar_point>& data,
                                const size_t boundary)
@@ -165,6 +165,7 @@ namespace illumina { namespace interop { namespace logic { namespace plot
         }
         options.validate(constants::QScore, metrics.run_info());
         const size_t first_cycle = options.all_reads() ? 1 : metrics.run_info().read(options.read()).first_cycle();
+        const model::plot::filter_mask mask = options.compile(metrics.run_info());
 
         data.push_back(model::plot::series<Point>("Q Score", "Blue", model::plot::series<Point>::Bar));
         if(boundary>0)
@@ -192,14 +193,14 @@ namespace illumina { namespace interop { namespace logic { namespace plot
             populate_distribution(
                     metrics.get<metric_t>().begin(),
                     metrics.get<metric_t>().end(),
-                    options,
+                    mask,
                     first_cycle,
                     last_cycle,
                     histogram);
             axis_scale = scale_histogram(histogram);
-            if(!metrics.get<metric_t>().bins().empty())
-                max_x_value=plot_binned_histogram(metrics.get<metric_t>().bins().begin(),
-                                                  metrics.get<metric_t>().bins().end(),
+            if(!metrics.get<metric_t>().get_bins().empty())
+                max_x_value=plot_binned_histogram(metrics.get<metric_t>().get_bins().begin(),
+                                                  metrics.get<metric_t>().get_bins().end(),
                                                   histogram,
                                                   data[0]);
             else max_x_value=plot_unbinned_histogram(histogram, data[0]);
@@ -207,26 +208,32 @@ namespace illumina { namespace interop { namespace logic { namespace plot
         else
         {
             typedef model::metrics::q_by_lane_metric metric_t;
-            if(0 == metrics.get<metric_t>().size())
+            // Derive the q-metrics by lane locally when missing, the source run is not modified
+            model::metric_base::metric_set<metric_t> derived;
+            const model::metric_base::metric_set<metric_t>* by_lane = &metrics.get<metric_t>();
+            if(0 == by_lane->size())
+            {
                 logic::metric::create_q_metrics_by_lane(metrics.get<model::metrics::q_metric>(),
-                                                        metrics.get<metric_t>(),
+                                                        derived,
                                                         metrics.run_parameters().instrument_type());
-            if(0 == metrics.get<metric_t>().size()) return;
+                by_lane = &derived;
+            }
+            if(0 == by_lane->size()) return;
             const size_t last_cycle = get_last_filtered_cycle(metrics.run_info(),
                                                               options,
-                                                              metrics.get<metric_t>().max_cycle());
-            INTEROP_ASSERT(0 != metrics.get<metric_t>().size());
+                                                              by_lane->max_cycle());
+            INTEROP_ASSERT(0 != by_lane->size());
             populate_distribution(
-                    metrics.get<metric_t>().begin(),
-                    metrics.get<metric_t>().end(),
-                    options,
+                    by_lane->begin(),
+                    by_lane->end(),
+                    mask,
                     first_cycle,
                     last_cycle,
                     histogram);
             axis_scale = scale_histogram(histogram);
-            if(!metrics.get<metric_t>().bins().empty())
-                max_x_value=plot_binned_histogram(metrics.get<metric_t>().bins().begin(),
-                                                  metrics.get<metric_t>().bins().end(),
+            if(!by_lane->get_bins().empty())
+                max_x_value=plot_binned_histogram(by_lane->get_bins().begin(),
+                                                  by_lane->get_bins().end(),
                                                   histogram,
                                                   data[0]);
             else max_x_value=plot_unbinned_histogram(histogram, data[0]);
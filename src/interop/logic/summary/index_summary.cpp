@@ -13,18 +13,16 @@
 
 namespace illumina { namespace interop { namespace logic { namespace summary {
 
-    /** Summarize a index metrics for a specific lane
+    /** Summarize a index metrics for a specific lane, where the index order and cluster counts are populated
      *
-     * @param index_metrics set of index metrics
-     * @param tile_metrics source collection of tile metrics
+     * @param index_metrics set of populated index metrics
      * @param lane lane number
      * @param summary destination index flowcell summary
      */
-    void summarize_index_metrics(model::metric_base::metric_set<model::metrics::index_metric>& index_metrics,
-                                 const model::metric_base::metric_set<model::metrics::tile_metric>& tile_metrics,
-                                 const size_t lane,
-                                 model::summary::index_lane_summary &summary)
-    INTEROP_THROW_SPEC((model::index_out_of_bounds_exception))
+    static void summarize_populated_index_metrics(
+            const model::metric_base::metric_set<model::metrics::index_metric>& index_metrics,
+            const size_t lane,
+            model::summary::index_lane_summary &summary)
     {
         typedef model::metric_base::metric_set<model::metrics::index_metric>::const_iterator const_iterator;
         typedef model::summary::index_lane_summary::read_count_t read_count_t;
@@ -35,8 +33,6 @@ namespace illumina { namespace interop { namespace logic { namespace summary {
         const size_t kAllLanes = 0;
 
         summary.clear();
-        if(index_metrics.empty() || tile_metrics.empty()) return;
-        logic::metric::populate_indices(tile_metrics, index_metrics);
         index_count_map_t index_count_map;
         ::uint64_t total_mapped_reads = 0;
         read_count_t pf_cluster_count_total = 0;
@@ -103,21 +99,59 @@ namespace illumina { namespace interop { namespace logic { namespace summary {
                     max_fraction_mapped,
                     std_fraction_mapped/avg_fraction_mapped);
     }
+    /** Select index metrics with populated index order and cluster counts
+     *
+     * If the run has not populated the index metrics, a populated copy is made, the run is not modified.
+     *
+     * @param metrics source run metrics
+     * @param populated storage for a populated copy
+     * @return populated index metrics
+     */
+    static const model::metric_base::metric_set<model::metrics::index_metric>&
+    populated_index_metrics(const model::metrics::run_metrics &metrics,
+                            model::metric_base::metric_set<model::metrics::index_metric>& populated)
+    {
+        const model::metric_base::metric_set<model::metrics::index_metric>& index_metrics =
+                metrics.get<model::metrics::index_metric>();
+        if(!index_metrics.index_order().empty()) return index_metrics;
+        populated = index_metrics;
+        logic::metric::populate_indices(metrics.get<model::metrics::tile_metric>(), populated);
+        return populated;
+    }
+    /** Summarize a index metrics for a specific lane
+     *
+     * @param index_metrics set of index metrics
+     * @param tile_metrics source collection of tile metrics
+     * @param lane lane number
+     * @param summary destination index flowcell summary
+     */
+    void summarize_index_metrics(model::metric_base::metric_set<model::metrics::index_metric>& index_metrics,
+                                 const model::metric_base::metric_set<model::metrics::tile_metric>& tile_metrics,
+                                 const size_t lane,
+                                 model::summary::index_lane_summary &summary)
+    INTEROP_THROW_SPEC((model::index_out_of_bounds_exception))
+    {
+        summary.clear();
+        if(index_metrics.empty() || tile_metrics.empty()) return;
+        logic::metric::populate_indices(tile_metrics, index_metrics);
+        summarize_populated_index_metrics(index_metrics, lane, summary);
+    }
     /** Summarize a collection index metrics for a specific lane
      *
      * @param metrics source run metrics
      * @param lane lane number
      * @param summary destination index lane summary
      */
-    void summarize_index_metrics(model::metrics::run_metrics &metrics,
+    void summarize_index_metrics(const model::metrics::run_metrics &metrics,
                                         const size_t lane,
                                         model::summary::index_lane_summary &summary)
     INTEROP_THROW_SPEC((model::index_out_of_bounds_exception))
     {
-        summarize_index_metrics(metrics.get<model::metrics::index_metric>(),
-                                metrics.get<model::metrics::tile_metric>(),
-                                lane,
-                                summary);
+        summary.clear();
+        if(metrics.get<model::metrics::index_metric>().empty() ||
+           metrics.get<model::metrics::tile_metric>().empty()) return;
+        model::metric_base::metric_set<model::metrics::index_metric> populated;
+        summarize_populated_index_metrics(populated_index_metrics(metrics, populated), lane, summary);
     }
     /** Summarize a collection index metrics
      *
@@ -147,15 +181,21 @@ namespace illumina { namespace interop { namespace logic { namespace summary {
      * @param metrics source collection of all metrics
      * @param summary destination index flowcell summary
      */
-    void summarize_index_metrics(model::metrics::run_metrics &metrics,
+    void summarize_index_metrics(const model::metrics::run_metrics &metrics,
                                         model::summary::index_flowcell_summary &summary)
     INTEROP_THROW_SPEC((model::index_out_of_bounds_exception))
     {
+        if(metrics.get<model::metrics::index_metric>().empty() ||
+           metrics.get<model::metrics::tile_metric>().empty()) return;
         const size_t lane_count = metrics.run_info().flowcell().lane_count();
-        summarize_index_metrics(metrics.get<model::metrics::index_metric>(),
-                                metrics.get<model::metrics::tile_metric>(),
-                                lane_count,
-                                summary);
+        model::metric_base::metric_set<model::metrics::index_metric> populated;
+        const model::metric_base::metric_set<model::metrics::index_metric>& index_metrics =
+                populated_index_metrics(metrics, populated);
+        summary.resize(lane_count);
+        for(size_t lane=1;lane <= lane_count;++lane)
+        {
+            summarize_populated_index_metrics(index_metrics, lane, summary[lane-1]);
+        }
     }
 
 }}}}
@@ -26,50 +26,32 @@ namespace illumina { namespace interop { namespace logic { namespace summary
     void summarize_tile_count(const model::metrics::run_metrics& metrics, model::summary::run_summary& summary)
     {
         using namespace model::metrics;
-        model::metrics::run_metrics::id_set_t tile_count_set;
         const std::vector<uint32_t> surface_list = metrics.run_info().flowcell().surface_list();
-        const constants::tile_naming_method naming_convention = metrics.run_info().flowcell().naming_method();
+        // A run modified since it was loaded is catalogued locally, the run is not modified
+        const bool is_catalog_current = metrics.is_catalog_current();
+        tile_catalog local_catalog;
+        if(!is_catalog_current) metrics.populate_catalog(local_catalog);
+        const tile_catalog& catalog = is_catalog_current ? metrics.catalog() : local_catalog;
+        tile_catalog::group_vector_t groups;
+        groups.push_back(constants::Tile);
+        groups.push_back(constants::Error);
+        groups.push_back(constants::Extraction);
+        groups.push_back(constants::Q);
+        groups.push_back(constants::CorrectedInt);
+        groups.push_back(constants::EmpiricalPhasing);
+        groups.push_back(constants::ExtendedTile);
         for(unsigned int lane=0;lane<summary.lane_count();++lane)
         {
             size_t tile_count_for_lane = 0;
             for(unsigned int surface_index=0;surface_index < surface_list.size();++surface_index)
             {
-                metrics.get<tile_metric>().populate_tile_numbers_for_lane_surface(tile_count_set,
-                                                                                  lane+1,
-                                                                                  surface_list[surface_index],
-                                                                                  naming_convention);
-                metrics.get<error_metric>().populate_tile_numbers_for_lane_surface(tile_count_set,
-                                                                                   lane+1,
-                                                                                   surface_list[surface_index],
-                                                                                   naming_convention);
-                metrics.get<extraction_metric>().populate_tile_numbers_for_lane_surface(tile_count_set,
-                                                                                        lane+1,
-                                                                                        surface_list[surface_index],
-                                                                                        naming_convention);
-                metrics.get<q_metric>().populate_tile_numbers_for_lane_surface(tile_count_set,
-                                                                               lane+1,
-                                                                               surface_list[surface_index],
-                                                                               naming_convention);
-                metrics.get<corrected_intensity_metric>().populate_tile_numbers_for_lane_surface(tile_count_set,
-                                                                                                 lane+1,
-                                                                                                 surface_list[surface_index],
-                                                                                                 naming_convention);
-                metrics.get<phasing_metric>().populate_tile_numbers_for_lane_surface(tile_count_set,
-                                                                                     lane+1,
-                                                                                     surface_list[surface_index],
-                                                                                     naming_convention);
-                metrics.get<extended_tile_metric>().populate_tile_numbers_for_lane_surface(tile_count_set,
-                                                                                           lane+1,
-                                                                                           surface_list[surface_index],
-                                                                                           naming_convention);
-
+                const size_t tile_count = catalog.tile_count(groups, lane+1, surface_list[surface_index]);
                 if(surface_list.size() > 1)
                 {
                     for (size_t read = 0; read < summary.size(); ++read)
-                        summary[read][lane][surface_index].tile_count(tile_count_set.size());
+                        summary[read][lane][surface_index].tile_count(tile_count);
                 }
-                tile_count_for_lane += tile_count_set.size();
-                tile_count_set.clear();
+                tile_count_for_lane += tile_count;
             }
             for(size_t read=0;read<summary.size();++read)
                 summary[read][lane].tile_count(tile_count_for_lane);
@@ -109,7 +91,7 @@ namespace illumina { namespace interop { namespace logic { namespace summary
      * @param skip_median skip the median calculation
      * @param trim removed unset lanes
      */
-    void summarize_run_metrics(model::metrics::run_metrics& metrics,
+    void summarize_run_metrics(const model::metrics::run_metrics& metrics,
                                model::summary::run_summary& summary,
                                const bool skip_median,
                                const bool trim)
@@ -126,21 +108,21 @@ namespace illumina { namespace interop { namespace logic { namespace summary
         summary.initialize(metrics.run_info());
 
         read_cycle_vector_t cycle_to_read;
-        const constants::tile_naming_method naming_method = metrics.run_info().flowcell().naming_method();
+        const model::run::flowcell_layout& layout = metrics.run_info().flowcell();
         map_read_to_cycle_number(summary.begin(), summary.end(), cycle_to_read);
         summarize_tile_metrics(metrics.get<tile_metric>().begin(),
                                metrics.get<tile_metric>().end(),
-                               naming_method,
+                               layout,
                                summary);
         summarize_extended_tile_metrics(metrics.get<extended_tile_metric>().begin(),
                                         metrics.get<extended_tile_metric>().end(),
-                                        naming_method,
+                                        layout,
                                         summary);
         validate_cycle_to_read(metrics.get<error_metric>(), cycle_to_read);
         summarize_error_metrics(metrics.get<error_metric>().begin(),
                                 metrics.get<error_metric>().end(),
                                 cycle_to_read,
-                                naming_method,
+                                layout,
                                 summary,
                                 skip_median);
         INTEROP_ASSERT(metrics.run_info().channels().size()>0);
@@ -149,34 +131,50 @@ namespace illumina { namespace interop { namespace logic { namespace summary
                                      metrics.get<extraction_metric>().end(),
                                      cycle_to_read,
                                      intensity_channel,
-                                     naming_method,
+                                     layout,
                                      summary,
                                      skip_median);
 
-        if(0 == metrics.get<q_collapsed_metric>().size())
-            logic::metric::create_collapse_q_metrics(metrics.get<q_metric>(),
-                                                     metrics.get<q_collapsed_metric>());
-        validate_cycle_to_read(metrics.get<q_collapsed_metric>(), cycle_to_read);
-        summarize_collapsed_quality_metrics(metrics.get<q_collapsed_metric>().begin(),
-                                            metrics.get<q_collapsed_metric>().end(),
+        // Derived metric sets missing from the run are derived locally, the run is not modified
+        typedef model::metric_base::metric_set<q_collapsed_metric> q_collapsed_metric_set_t;
+        q_collapsed_metric_set_t derived_collapsed;
+        const q_collapsed_metric_set_t* collapsed = &metrics.get<q_collapsed_metric>();
+        if(0 == collapsed->size())
+        {
+            logic::metric::create_collapse_q_metrics(metrics.get<q_metric>(), derived_collapsed);
+            collapsed = &derived_collapsed;
+        }
+        validate_cycle_to_read(*collapsed, cycle_to_read);
+        summarize_collapsed_quality_metrics(collapsed->begin(),
+                                            collapsed->end(),
                                             cycle_to_read,
-                                            naming_method,
+                                            layout,
                                             summary);
         summarize_tile_count(metrics, summary);
 
+        // Index the tiles once and share the index between all four cycle states
+        dense_tile_index tile_index;
+        tile_index.add(metrics.get<tile_metric>());
+        tile_index.add(metrics.get<error_metric>());
+        tile_index.add(metrics.get<extraction_metric>());
+        tile_index.add(metrics.get<q_metric>());
+        tile_index.add(metrics.get<corrected_intensity_metric>());
         summarize_cycle_state(metrics.get<tile_metric>(),
                               metrics.get<error_metric>(),
+                              tile_index,
                               cycle_to_read,
                               &model::summary::cycle_state_summary::error_cycle_range,
                               summary);
         summarize_cycle_state(metrics.get<tile_metric>(),
                               metrics.get<extraction_metric>(),
+                              tile_index,
                               cycle_to_read,
                               &model::summary::cycle_state_summary::extracted_cycle_range,
                               summary);
         validate_cycle_to_read(metrics.get<q_metric>(), cycle_to_read);
         summarize_cycle_state(metrics.get<tile_metric>(),
                               metrics.get<q_metric>(),
+                              tile_index,
                               cycle_to_read,
                               &model::summary::cycle_state_summary::qscored_cycle_range,
                               summary);
@@ -184,18 +182,24 @@ namespace illumina { namespace interop { namespace logic { namespace summary
         validate_cycle_to_read(metrics.get<corrected_intensity_metric>(), cycle_to_read);
         summarize_cycle_state(metrics.get<tile_metric>(),
                               metrics.get<corrected_intensity_metric>(),
+                              tile_index,
                               cycle_to_read,
                               &model::summary::cycle_state_summary::called_cycle_range,
                               summary);
-        if(0 == metrics.get<dynamic_phasing_metric>().size())
-            logic::metric::populate_dynamic_phasing_metrics(metrics.get<model::metrics::phasing_metric>(),
-                                                            cycle_to_read,
-                                                            metrics.get<model::metrics::dynamic_phasing_metric>(),
-                                                            metrics.get<model::metrics::tile_metric>());
-        summarize_phasing_metrics(metrics.get<dynamic_phasing_metric>().begin(),
-                                  metrics.get<dynamic_phasing_metric>().end(),
+        typedef model::metric_base::metric_set<dynamic_phasing_metric> dynamic_phasing_metric_set_t;
+        dynamic_phasing_metric_set_t derived_dynamic_phasing;
+        const dynamic_phasing_metric_set_t* dynamic_phasing = &metrics.get<dynamic_phasing_metric>();
+        if(0 == dynamic_phasing->size() && !metrics.get<phasing_metric>().empty())
+        {
+            model::metric_base::metric_set<phasing_metric> phasing(metrics.get<phasing_metric>());
+            model::metric_base::metric_set<tile_metric> tiles(metrics.get<tile_metric>());
+            logic::metric::populate_dynamic_phasing_metrics(phasing, cycle_to_read, derived_dynamic_phasing, tiles);
+            dynamic_phasing = &derived_dynamic_phasing;
+        }
+        summarize_phasing_metrics(dynamic_phasing->begin(),
+                                  dynamic_phasing->end(),
                                   summary,
-                                  naming_method,
+                                  layout,
                                   skip_median);
 
         if(trim)
@@ -11,6 +11,7 @@
 #include "interop/logic/table/create_imaging_table_columns.h"
 #include "interop/logic/table/table_populator.h"
 #include "interop/logic/metric/q_metric.h"
+#include "interop/logic/metric/dynamic_phasing_metric.h"
 #include "interop/logic/utils/metric_type_ext.h"
 
 namespace illumina { namespace interop { namespace logic { namespace table
@@ -334,13 +335,12 @@ namespace illumina { namespace interop { namespace logic { namespace table
         if(columns.empty()) return 0;
         return columns.back().column_count();
     }
-    /** Create an imaging table from run metrics
+    /** Populate an imaging table from run metrics that include all derived metrics
      *
      * @param metrics source run metrics
      * @param table destination imaging table
      */
-    void create_imaging_table(model::metrics::run_metrics& metrics, model::table::imaging_table& table)
-                                        INTEROP_THROW_SPEC((model::invalid_column_type, model::index_out_of_bounds_exception, model::invalid_parameter))
+    static void populate_imaging_table(const model::metrics::run_metrics& metrics, model::table::imaging_table& table)
     {
         typedef model::table::imaging_table::column_vector_t column_vector_t;
         typedef model::table::imaging_table::data_vector_t data_vector_t;
@@ -354,6 +354,32 @@ namespace illumina { namespace interop { namespace logic { namespace table
         create_imaging_table_data(metrics, columns, row_offset, data.begin(), data.end());
         table.set_data(row_offset.size(), columns, data);
     }
+    /** Create an imaging table from run metrics
+     *
+     * @param metrics source run metrics
+     * @param table destination imaging table
+     */
+    void create_imaging_table(const model::metrics::run_metrics& metrics, model::table::imaging_table& table)
+                                        INTEROP_THROW_SPEC((model::invalid_column_type, model::index_out_of_bounds_exception, model::invalid_parameter))
+    {
+        if(metrics.get<model::metrics::dynamic_phasing_metric>().empty() &&
+           !metrics.get<model::metrics::phasing_metric>().empty())
+        {
+            // Dynamic phasing also updates the tile metrics, so derive it on a copy, the source run is not modified
+            model::metrics::run_metrics derived(metrics);
+            summary::read_cycle_vector_t cycle_to_read;
+            summary::map_read_to_cycle_number(derived.run_info().reads().begin(),
+                                              derived.run_info().reads().end(),
+                                              cycle_to_read);
+            logic::metric::populate_dynamic_phasing_metrics(derived.get<model::metrics::phasing_metric>(),
+                                                            cycle_to_read,
+                                                            derived.get<model::metrics::dynamic_phasing_metric>(),
+                                                            derived.get<model::metrics::tile_metric>());
+            populate_imaging_table(derived, table);
+            return;
+        }
+        populate_imaging_table(metrics, table);
+    }
 
 
     /** Convert metric type to metric group
@@ -21,7 +21,7 @@ namespace illumina { namespace interop { namespace logic { namespace table
      * @param tile_hash map between the tile has and base metric
      * @param filled destination array that indicates whether a column should be filled
      */
-    void determine_filled_columns(model::metrics::run_metrics& metrics,
+    void determine_filled_columns(const model::metrics::run_metrics& metrics,
                                   const model::metrics::run_metrics::tile_metric_map_t& tile_hash,
                                   std::vector< bool >& filled)
     {
@@ -70,15 +70,20 @@ namespace illumina { namespace interop { namespace logic { namespace table
                                           metrics.run_info().reads().end(),
                                           cycle_to_read);
 
-        if(metrics.get<model::metrics::dynamic_phasing_metric>().empty())
+        // Derive the dynamic phasing metrics locally when missing, the source run is not modified
+        model::metric_base::metric_set<model::metrics::dynamic_phasing_metric> derived_dynamic_phasing;
+        const model::metric_base::metric_set<model::metrics::dynamic_phasing_metric>* dynamic_phasing =
+                &metrics.get<model::metrics::dynamic_phasing_metric>();
+        if(dynamic_phasing->empty() && !metrics.get<model::metrics::phasing_metric>().empty())
         {
-            logic::metric::populate_dynamic_phasing_metrics(metrics.get<model::metrics::phasing_metric>(),
-                                                            cycle_to_read,
-                                                            metrics.get<model::metrics::dynamic_phasing_metric>(),
-                                                            metrics.get<model::metrics::tile_metric>());
+            model::metric_base::metric_set<model::metrics::phasing_metric> phasing(
+                    metrics.get<model::metrics::phasing_metric>());
+            model::metric_base::metric_set<model::metrics::tile_metric> tiles(tile_metrics);
+            logic::metric::populate_dynamic_phasing_metrics(phasing, cycle_to_read, derived_dynamic_phasing, tiles);
+            dynamic_phasing = &derived_dynamic_phasing;
         }
         const model::metric_base::metric_set<model::metrics::dynamic_phasing_metric>& dynamic_phasing_metrics =
-                metrics.get<model::metrics::dynamic_phasing_metric>();
+                *dynamic_phasing;
         for(tile_metric_map_t::const_iterator it = tile_hash.begin();it != tile_hash.end();++it)
         {
             for(model::run::info::const_read_iterator read_it = metrics.run_info().reads().begin();read_it != metrics.run_info().reads().end();++read_it)
@@ -200,7 +205,7 @@ namespace illumina { namespace interop { namespace logic { namespace table
      * @param metrics source collection of InterOp metrics from the run
      * @param columns destination vector of column descriptors
      */
-    void create_imaging_table_columns(model::metrics::run_metrics& metrics,
+    void create_imaging_table_columns(const model::metrics::run_metrics& metrics,
                                       std::vector< model::table::imaging_column >& columns)
                                       INTEROP_THROW_SPEC((model::invalid_column_type,
                                       model::index_out_of_bounds_exception,
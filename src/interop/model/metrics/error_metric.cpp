@@ -11,6 +11,7 @@
 #include "interop/io/format/metric_format_factory.h"
 #include "interop/io/format/text_format_factory.h"
 #include "interop/io/format/default_layout.h"
+#include "interop/util/static_assert.h"
 #include "interop/io/format/metric_format.h"
 #include "interop/io/format/text_format.h"
 
@@ -72,6 +73,36 @@ namespace illumina{ namespace interop{ namespace io
         typedef float error_t;
         /** Error type */
         typedef ::uint32_t count_t;
+        enum
+        {
+            /** Flag indicating the layout defines a packed record */
+            FIXED_RECORD=1
+        };
+        /** Packed record decoded by fixed_record_decoder */
+        struct fixed_record_t
+        {
+            /** Lane, tile and cycle of the record */
+            metric_id_t id;
+            /** Error rate */
+            error_t error_rate;
+            /** Number of reads with 0 to 4 errors */
+            count_t mismatch_cluster_count[error_metric::MAX_MISMATCH];
+        };
+        /** Decode a packed record
+         *
+         * @param record packed record
+         * @param metric destination metric
+         */
+        template<class Metric>
+        static void decode(const fixed_record_t& record, Metric& metric)
+        {
+            static_assert(sizeof(fixed_record_t) ==
+                          sizeof(metric_id_t)+sizeof(error_t)+sizeof(count_t)*error_metric::MAX_MISMATCH,
+                          "Packed record does not match compute_size");
+            metric.m_error_rate = record.error_rate;
+            metric.m_mismatch_cluster_count.assign(record.mismatch_cluster_count,
+                                                   record.mismatch_cluster_count+error_metric::MAX_MISMATCH);
+        }
         /** Map reading/writing to stream
          *
          * Reading and writing are symmetric operations, map it once
@@ -155,6 +186,31 @@ namespace illumina{ namespace interop{ namespace io
         typedef layout::base_cycle_metric< ::uint32_t > metric_id_t;
         /** Error type */
         typedef float error_t;
+        enum
+        {
+            /** Flag indicating the layout defines a packed record */
+            FIXED_RECORD=1
+        };
+        /** Packed record decoded by fixed_record_decoder */
+        struct fixed_record_t
+        {
+            /** Lane, tile and cycle of the record */
+            metric_id_t id;
+            /** Error rate */
+            error_t error_rate;
+        };
+        /** Decode a packed record
+         *
+         * @param record packed record
+         * @param metric destination metric
+         */
+        template<class Metric>
+        static void decode(const fixed_record_t& record, Metric& metric)
+        {
+            static_assert(sizeof(fixed_record_t) == sizeof(metric_id_t)+sizeof(error_t),
+                          "Packed record does not match compute_size");
+            metric.m_error_rate = record.error_rate;
+        }
         /** Map reading/writing to stream
          *
          * Reading and writing are symmetric operations, map it once
@@ -237,6 +293,34 @@ namespace illumina{ namespace interop{ namespace io
         typedef layout::base_cycle_metric< ::uint32_t > metric_id_t;
         /** Error type */
         typedef float error_t;
+        enum
+        {
+            /** Flag indicating the layout defines a packed record */
+            FIXED_RECORD=1
+        };
+        /** Packed record decoded by fixed_record_decoder */
+        struct fixed_record_t
+        {
+            /** Lane, tile and cycle of the record */
+            metric_id_t id;
+            /** Error rate */
+            error_t error_rate;
+            /** Fraction of reads adapter-trimmed at the cycle */
+            error_t phix_adapter_rate;
+        };
+        /** Decode a packed record
+         *
+         * @param record packed record
+         * @param metric destination metric
+         */
+        template<class Metric>
+        static void decode(const fixed_record_t& record, Metric& metric)
+        {
+            static_assert(sizeof(fixed_record_t) == sizeof(metric_id_t)+sizeof(error_t)+sizeof(error_t),
+                          "Packed record does not match compute_size");
+            metric.m_error_rate = record.error_rate;
+            metric.m_phix_adapter_rate = record.phix_adapter_rate;
+        }
         /** Map reading/writing to stream
          *
          * Reading and writing are symmetric operations, map it once
@@ -231,6 +231,7 @@ namespace illumina { namespace interop { namespace model { namespace run
                         }
                     }
                 }
+                m_flowcell.update_tile_geometry();
             }
             else if (set_data(p_node, "ImageChannels", "Name", m_channels))
             {
@@ -10,6 +10,8 @@
 #endif
 
 #include "interop/model/run_metrics.h"
+#include "interop/io/bundle.h"
+#include "interop/io/record_index.h"
 
 #include "interop/logic/metric/q_metric.h"
 #include "interop/logic/metric/tile_metric.h"
@@ -17,10 +19,30 @@
 #include "interop/logic/utils/channel.h"
 #include "interop/logic/metric/dynamic_phasing_metric.h"
 #include "interop/logic/metric/extended_tile_metric.h"
+#include "interop/logic/utils/metrics_to_load.h"
 
 namespace illumina { namespace interop { namespace model { namespace metrics
 {
 
+    /** Get the filter used to read a metric set
+     *
+     * The cumulative q-score histograms accumulate over all earlier cycles, so the q-metrics are read from the first
+     * cycle of the run, and the cycles before the selection are removed after the cumulative pass.
+     *
+     * @param filter select the lanes, tiles and cycles to load
+     * @return filter for the metric set
+     */
+    template<class MetricSet>
+    io::load_filter metric_filter(const io::load_filter& filter)
+    {
+        const constants::metric_group group = static_cast<constants::metric_group>(MetricSet::TYPE);
+        const bool is_cumulative = (group == constants::Q || group == constants::QByLane || group == constants::QCollapsed);
+        if(!is_cumulative || filter.first_cycle() <= 1) return filter;
+        io::load_filter from_first_cycle(filter);
+        from_first_cycle.cycle_range(0, filter.last_cycle());
+        return from_first_cycle;
+    }
+
     struct clear_metric
     {
         template<class MetricSet>
@@ -33,11 +55,17 @@ namespace illumina { namespace interop { namespace model { namespace metrics
     struct read_func
     {
         typedef const unsigned char* bool_pointer;
-        read_func(const std::string &f, bool_pointer load_metric_check=0, const bool skip_loaded=false) :
+        read_func(const std::string &f,
+                  bool_pointer load_metric_check=0,
+                  const bool skip_loaded=false,
+                  const io::load_filter& filter=io::load_filter(),
+                  const bool use_index=false) :
                 m_run_folder(f),
                 m_load_metric_check(load_metric_check),
                 m_are_all_files_missing(true),
-                m_skip_loaded(skip_loaded)
+                m_skip_loaded(skip_loaded),
+                m_filter(filter),
+                m_use_index(use_index)
         {}
 
         template<class MetricSet>
@@ -62,7 +90,8 @@ namespace illumina { namespace interop { namespace model { namespace metrics
             }
             try
             {
-                io::read_interop(m_run_folder, metrics);
+                if(m_use_index) io::read_interop_indexed(m_run_folder, metrics, metric_filter<MetricSet>(m_filter));
+                else io::read_interop(m_run_folder, metrics, metric_filter<MetricSet>(m_filter));
                 if(m_are_all_files_missing && !is_aggregated_always) m_are_all_files_missing=false;
             }
             catch (const io::file_not_found_exception &)
@@ -86,6 +115,8 @@ namespace illumina { namespace interop { namespace model { namespace metrics
         bool_pointer m_load_metric_check;
         mutable bool m_are_all_files_missing;
         bool m_skip_loaded;
+        io::load_filter m_filter;
+        bool m_use_index;
     };
 
     struct write_func
@@ -103,6 +134,67 @@ namespace illumina { namespace interop { namespace model { namespace metrics
         bool m_use_out;
     };
 
+    struct add_to_tile_catalog
+    {
+        add_to_tile_catalog(tile_catalog& catalog) : m_catalog(catalog){}
+        template<class MetricSet>
+        void operator()(const MetricSet& metrics)const
+        {
+            m_catalog.add(metrics);
+        }
+    private:
+        tile_catalog& m_catalog;
+    };
+    struct is_tile_catalog_current
+    {
+        is_tile_catalog_current(const tile_catalog& catalog) : m_catalog(catalog), m_is_current(true){}
+        template<class MetricSet>
+        void operator()(const MetricSet& metrics)
+        {
+            if(m_catalog.generation(static_cast<constants::metric_group>(MetricSet::TYPE)) != metrics.generation())
+                m_is_current = false;
+        }
+        bool is_current()const
+        {
+            return m_is_current;
+        }
+    private:
+        const tile_catalog& m_catalog;
+        bool m_is_current;
+    };
+    struct cycle_exceeds
+    {
+        cycle_exceeds(const size_t max_cycle) : m_max_cycle(max_cycle){}
+        template<class Metric>
+        bool operator()(const Metric& metric)const
+        {
+            return metric.cycle() > m_max_cycle;
+        }
+    private:
+        size_t m_max_cycle;
+    };
+    struct cycle_before
+    {
+        cycle_before(const size_t first_cycle) : m_first_cycle(first_cycle){}
+        template<class Metric>
+        bool operator()(const Metric& metric)const
+        {
+            return metric.cycle() < m_first_cycle;
+        }
+    private:
+        size_t m_first_cycle;
+    };
+    struct read_exceeds
+    {
+        read_exceeds(const size_t max_read) : m_max_read(max_read){}
+        template<class Metric>
+        bool operator()(const Metric& metric)const
+        {
+            return metric.read() > m_max_read;
+        }
+    private:
+        size_t m_max_read;
+    };
     struct validate_run_info
     {
         validate_run_info(const run::info& info) : m_info(info){}
@@ -115,45 +207,53 @@ namespace illumina { namespace interop { namespace model { namespace metrics
         }
     private:
         template<class MetricSet>
-        void validate(const MetricSet &metrics, const constants::base_tile_t*)const
+        void validate_tiles(const MetricSet &metrics, const std::string& name)const
         {
-            const std::string name =  io::interop_basename<MetricSet>();
-            for(typename MetricSet::const_iterator it = metrics.begin();it != metrics.end();++it)
+            typedef typename MetricSet::id_vector id_vector;
+            const id_vector lanes = metrics.lanes();
+            for(typename id_vector::const_iterator lane = lanes.begin();lane != lanes.end();++lane)
             {
-                m_info.validate(it->lane(), it->tile(), name);
+                const id_vector tiles = metrics.tile_numbers_for_lane(*lane);
+                for(typename id_vector::const_iterator tile = tiles.begin();tile != tiles.end();++tile)
+                    m_info.validate(*lane, *tile, name);
             }
         }
         template<class MetricSet>
+        void validate(const MetricSet &metrics, const constants::base_tile_t*)const
+        {
+            validate_tiles(metrics, io::interop_basename<MetricSet>());
+        }
+        template<class MetricSet>
         void validate(MetricSet &metrics, const constants::base_cycle_t*)const
         {
             const std::string name =  io::interop_basename<MetricSet>();
-            bool exception_is_thrown = false;
+            validate_tiles(metrics, name);
+            const cycle_exceeds is_invalid(m_info.total_cycles());
+            typename MetricSet::const_iterator it = std::find_if(metrics.begin(), metrics.end(), is_invalid);
+            if(it == metrics.end()) return;
             std::string exception_string = "";
-            for(typename MetricSet::iterator it = metrics.begin();it != metrics.end();++it)
+            try
             {
-                try
-                {
-                    m_info.validate_cycle(it->lane(), it->tile(), it->cycle(), name);
-                }
-                catch(const model::invalid_run_info_cycle_exception& ex)
-                {
-                    metrics.remove(it);
-                    --it;
-                    exception_is_thrown = true;
-                    exception_string = ex.what();
-                }
+                m_info.validate_cycle(it->lane(), it->tile(), it->cycle(), name);
+            }
+            catch(const model::invalid_run_info_cycle_exception& ex)
+            {
+                exception_string = ex.what();
             }
-            if(exception_is_thrown)
-                INTEROP_THROW(model::invalid_run_info_cycle_exception, exception_string + ": truncating invalid entries");
+            metrics.remove_if(is_invalid);
+            INTEROP_THROW(model::invalid_run_info_cycle_exception, exception_string + ": truncating invalid entries");
         }
         template<class MetricSet>
         void validate(const MetricSet &metrics, const constants::base_read_t*)const
         {
+            if(metrics.empty()) return;
             const std::string name = io::interop_basename<MetricSet>();
-            for(typename MetricSet::const_iterator it = metrics.begin();it != metrics.end();++it)
-            {
-                m_info.validate_read(it->lane(), it->tile(), it->read(), name);
-            }
+            validate_tiles(metrics, name);
+            typename MetricSet::const_iterator it = std::find_if(metrics.begin(),
+                                                                 metrics.end(),
+                                                                 read_exceeds(m_info.reads().size()));
+            if(it == metrics.end()) it = metrics.begin();
+            m_info.validate_read(it->lane(), it->tile(), it->read(), name);
         }
         template<class MetricSet>
         void validate(const MetricSet &, const void*)const{}
@@ -161,6 +261,21 @@ namespace illumina { namespace interop { namespace model { namespace metrics
         const run::info& m_info;
     };
 
+    template<class Func>
+    struct apply_to_selected
+    {
+        typedef const unsigned char* bool_pointer;
+        apply_to_selected(const Func& func, bool_pointer selected) : m_func(func), m_selected(selected){}
+        template<class MetricSet>
+        void operator()(MetricSet &metrics)const
+        {
+            if(m_selected[MetricSet::TYPE]) m_func(metrics);
+        }
+    private:
+        Func m_func;
+        bool_pointer m_selected;
+    };
+
     class rebuild_index
     {
     public:
@@ -171,6 +286,20 @@ namespace illumina { namespace interop { namespace model { namespace metrics
         }
     };
 
+    struct partition_metric_set
+    {
+        partition_metric_set(std::vector<unsigned char>& partitioned) : m_partitioned(partitioned){}
+        template<class MetricSet>
+        void operator()(MetricSet &metrics)const
+        {
+            if(metrics.is_partitioned()) return;
+            metrics.partition_by_lane_cycle();
+            m_partitioned[MetricSet::TYPE] = 1;
+        }
+    private:
+        std::vector<unsigned char>& m_partitioned;
+    };
+
     class determine_tile_naming_method
     {
     public:
@@ -202,8 +331,16 @@ namespace illumina { namespace interop { namespace model { namespace metrics
     {
         typedef const unsigned char* bool_pointer;
 
-        read_by_cycle_func(const std::string &f, const size_t last_cycle, bool_pointer load_metric_check=0) :
-                m_run_folder(f), m_last_cycle(last_cycle), m_load_metric_check(load_metric_check)
+        read_by_cycle_func(const std::string &f,
+                           const size_t last_cycle,
+                           bool_pointer load_metric_check=0,
+                           const io::load_filter& filter=io::load_filter(),
+                           const size_t thread_count=1) :
+                m_run_folder(f),
+                m_last_cycle(last_cycle),
+                m_load_metric_check(load_metric_check),
+                m_filter(filter),
+                m_thread_count(thread_count)
         {}
 
         template<class MetricSet>
@@ -216,13 +353,20 @@ namespace illumina { namespace interop { namespace model { namespace metrics
             {
                 return 0;
             }
-            io::read_interop_by_cycle(m_run_folder, metrics, m_last_cycle);
+            io::read_interop_by_cycle(m_run_folder,
+                                      metrics,
+                                      m_last_cycle,
+                                      true,
+                                      metric_filter<MetricSet>(m_filter),
+                                      m_thread_count);
             return 0;
         }
 
         std::string m_run_folder;
         size_t m_last_cycle;
         bool_pointer m_load_metric_check;
+        io::load_filter m_filter;
+        size_t m_thread_count;
     };
 
     class read_metric_set_from_binary_buffer
@@ -292,6 +436,104 @@ namespace illumina { namespace interop { namespace model { namespace metrics
         const metric_base::base_metric m_tile_id;
     };
 
+    struct read_bundle_func
+    {
+        read_bundle_func(const io::bundle_reader& bundle, const io::load_filter& filter) :
+                m_bundle(bundle),
+                m_are_all_files_missing(true),
+                m_filter(filter)
+        {}
+
+        template<class MetricSet>
+        void operator()(MetricSet &metrics) const
+        {
+            const constants::metric_group group = static_cast<constants::metric_group>(MetricSet::TYPE);
+            const bool is_aggregated_always = (group == constants::Index || group == constants::QByLane || group == constants::QCollapsed);
+            metrics.clear();
+            const bool use_out[] = {true, false};
+            for(size_t i=0;i<2;++i)
+            {
+                const char* data;
+                size_t size;
+                if(!m_bundle.find(io::interop_filename<MetricSet>("", use_out[i]), data, size)) continue;
+                if(!is_aggregated_always) m_are_all_files_missing = false;
+                // The stream only reads from the section, so the read only mapping is never written
+                char* begin = const_cast<char*>(data);
+                io::detail::membuf sbuf(begin, begin + size);
+                std::istream in(&sbuf);
+                try
+                {
+                    io::read_metrics(in, metrics, size, true, metric_filter<MetricSet>(m_filter));
+                }
+                catch (const io::incomplete_file_exception &){}
+                return;
+            }
+        }
+
+        bool are_all_files_missing()const
+        {
+            return m_are_all_files_missing;
+        }
+
+        const io::bundle_reader& m_bundle;
+        mutable bool m_are_all_files_missing;
+        io::load_filter m_filter;
+    };
+
+    struct read_bundle_by_cycle_func
+    {
+        read_bundle_by_cycle_func(const io::bundle_reader& bundle,
+                                  const size_t last_cycle,
+                                  const io::load_filter& filter) :
+                m_bundle(bundle), m_last_cycle(last_cycle), m_filter(filter)
+        {}
+
+        template<class MetricSet>
+        void operator()(MetricSet &metrics) const
+        {
+            const io::load_filter filter = metric_filter<MetricSet>(m_filter);
+            for(size_t cycle=1;cycle <= m_last_cycle;++cycle)
+            {
+                if(!filter.is_cycle_file_selected<MetricSet>(cycle)) continue;
+                const char* data;
+                size_t size;
+                if(!m_bundle.find(io::interop_filename<MetricSet>("", cycle, true), data, size)) continue;
+                // The stream only reads from the section, so the read only mapping is never written
+                char* begin = const_cast<char*>(data);
+                io::detail::membuf sbuf(begin, begin + size);
+                std::istream in(&sbuf);
+                try
+                {
+                    io::read_metrics(in, metrics, size, false, filter);
+                }
+                catch (const io::incomplete_file_exception &){}
+            }
+            metrics.rebuild_index();
+        }
+
+        const io::bundle_reader& m_bundle;
+        size_t m_last_cycle;
+        io::load_filter m_filter;
+    };
+
+    struct write_bundle_func
+    {
+        write_bundle_func(io::bundle_writer& bundle) : m_bundle(bundle)
+        {}
+
+        template<class MetricSet>
+        void operator()(const MetricSet &metrics) const
+        {
+            if(metrics.empty() || metrics.version() == 0) return;
+            std::ostringstream fout;
+            io::write_metrics(fout, metrics, metrics.version());
+            const std::string data = fout.str();
+            m_bundle.add(io::interop_filename<MetricSet>("", true), data.c_str(), data.size());
+        }
+
+        io::bundle_writer& m_bundle;
+    };
+
     ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////
     // Definitions
     ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -344,6 +586,64 @@ namespace illumina { namespace interop { namespace model { namespace metrics
         read_metrics(run_folder, run_info().total_cycles(), thread_count);
         finalize_after_load(count);
     }
+    /** Read a subset of the binary metrics and XML files from the run folder
+     *
+     * @param run_folder run folder path
+     * @param filter select the lanes, tiles and cycles to load
+     * @param thread_count number of threads to use for network loading
+     */
+    void run_metrics::read(const std::string &run_folder, const io::load_filter& filter, const size_t thread_count)
+    INTEROP_THROW_SPEC((xml::xml_file_not_found_exception,
+    xml::bad_xml_format_exception,
+    xml::empty_xml_format_exception,
+    xml::missing_xml_element_exception,
+    xml::xml_parse_exception,
+    io::file_not_found_exception,
+    io::bad_format_exception,
+    io::incomplete_file_exception,
+    model::invalid_channel_exception,
+    model::index_out_of_bounds_exception,
+    model::invalid_tile_naming_method,
+    model::invalid_tile_list_exception,
+    model::invalid_run_info_exception,
+    model::invalid_run_info_cycle_exception,
+    model::invalid_parameter))
+    {
+        clear();
+        const size_t count = read_xml(run_folder);
+        read_metrics(run_folder, run_info().total_cycles(), thread_count, filter);
+        finalize_groups(std::vector<unsigned char>(constants::MetricCount, 1), count, filter.first_cycle());
+    }
+    /** Read the records selected by a filter using the sidecar record index of each InterOp file
+     *
+     * @param run_folder run folder path
+     * @param filter select the lanes, tiles and cycles to load
+     */
+    void run_metrics::read_indexed(const std::string &run_folder, const io::load_filter& filter)
+    INTEROP_THROW_SPEC((xml::xml_file_not_found_exception,
+    xml::bad_xml_format_exception,
+    xml::empty_xml_format_exception,
+    xml::missing_xml_element_exception,
+    xml::xml_parse_exception,
+    io::file_not_found_exception,
+    io::bad_format_exception,
+    io::incomplete_file_exception,
+    model::invalid_channel_exception,
+    model::index_out_of_bounds_exception,
+    model::invalid_tile_naming_method,
+    model::invalid_tile_list_exception,
+    model::invalid_run_info_exception,
+    model::invalid_run_info_cycle_exception,
+    model::invalid_parameter))
+    {
+        clear();
+        const size_t count = read_xml(run_folder);
+        read_func read_functor(run_folder, 0, false, filter, true);
+        m_metrics.apply(read_functor);
+        if (read_functor.are_all_files_missing())
+            m_metrics.apply(read_by_cycle_func(run_folder, run_info().total_cycles(), 0, filter));
+        finalize_groups(std::vector<unsigned char>(constants::MetricCount, 1), count, filter.first_cycle());
+    }
     /** Read binary metrics and XML files from the run folder
      *
      * @note This function does not clear
@@ -379,6 +679,148 @@ namespace illumina { namespace interop { namespace model { namespace metrics
         check_for_data_sources(run_folder, run_info().total_cycles());
     }
 
+    /** Read XML files from the run folder and defer reading each metric set until it is first accessed
+     *
+     * @param run_folder run folder path
+     * @param thread_count number of threads to use for network loading
+     */
+    void run_metrics::read_lazy(const std::string &run_folder, const size_t thread_count)
+    INTEROP_THROW_SPEC((xml::xml_file_not_found_exception,
+    xml::bad_xml_format_exception,
+    xml::empty_xml_format_exception,
+    xml::missing_xml_element_exception,
+    xml::xml_parse_exception))
+    {
+        clear();
+        read_run_info(run_folder);
+        m_lazy_run_folder = run_folder;
+        m_lazy_thread_count = thread_count;
+        m_lazy_loaded.assign(constants::MetricCount, 0);
+        m_is_lazy = true;
+        m_is_lazy_parameters_read = false;
+    }
+
+    /** Read a metric group, and the groups it depends on, if it has not already been read in lazy mode
+     *
+     * @param group metric group
+     */
+    void run_metrics::load(const constants::metric_group group) INTEROP_THROW_SPEC((
+    xml::xml_file_not_found_exception,
+    xml::bad_xml_format_exception,
+    xml::empty_xml_format_exception,
+    xml::missing_xml_element_exception,
+    xml::xml_parse_exception,
+    io::file_not_found_exception,
+    io::bad_format_exception,
+    io::incomplete_file_exception,
+    model::invalid_channel_exception,
+    model::index_out_of_bounds_exception,
+    model::invalid_tile_naming_method,
+    model::invalid_tile_list_exception,
+    model::invalid_run_info_exception,
+    model::invalid_run_info_cycle_exception,
+    model::invalid_parameter))
+    {
+        if(!m_is_lazy || group >= constants::MetricCount || m_lazy_loaded[group]) return;
+        std::vector<unsigned char> valid_to_load(constants::MetricCount, 0);
+        switch(group)
+        {
+            // Derived from the q-metrics, when the aggregate files are missing
+            case constants::QCollapsed:
+            case constants::QByLane:
+                logic::utils::list_metrics_to_load(constants::Q, valid_to_load, m_run_parameters.instrument_type());
+                break;
+            // Dynamic phasing is derived from phasing and written back into tile metrics
+            case constants::DynamicPhasing:
+            case constants::EmpiricalPhasing:
+            case constants::Tile:
+                logic::utils::list_metrics_to_load(constants::Tile, valid_to_load, m_run_parameters.instrument_type());
+                valid_to_load[constants::EmpiricalPhasing] = 1;
+                valid_to_load[constants::DynamicPhasing] = 1;
+                break;
+            default:
+                logic::utils::list_metrics_to_load(group, valid_to_load, m_run_parameters.instrument_type());
+                break;
+        }
+        std::vector<unsigned char> newly_loaded(constants::MetricCount, 0);
+        for(size_t i=0;i<valid_to_load.size();++i)
+        {
+            if(!valid_to_load[i] || m_lazy_loaded[i]) continue;
+            newly_loaded[i] = 1;
+            m_lazy_loaded[i] = 1;
+        }
+        read_metrics(m_lazy_run_folder, run_info().total_cycles(), newly_loaded, m_lazy_thread_count, true);
+        const size_t count = count_legacy_bins();
+        // RunParameters.xml is read at most once, the first time a loaded metric set requires it
+        if(!m_is_lazy_parameters_read && (m_run_info.channels().empty() || logic::metric::requires_legacy_bins(count)))
+        {
+            read_run_parameters(m_lazy_run_folder, true);
+            m_is_lazy_parameters_read = true;
+        }
+        finalize_groups(newly_loaded, count, 0);
+    }
+
+    /** Read binary metrics and XML files from a bundle file
+     *
+     * @param bundle_file bundle file path
+     * @param filter select the lanes, tiles and cycles to load
+     */
+    void run_metrics::read_bundle(const std::string &bundle_file, const io::load_filter& filter)
+    INTEROP_THROW_SPEC((xml::xml_file_not_found_exception,
+    xml::bad_xml_format_exception,
+    xml::empty_xml_format_exception,
+    xml::missing_xml_element_exception,
+    xml::xml_parse_exception,
+    io::file_not_found_exception,
+    io::bad_format_exception,
+    io::incomplete_file_exception,
+    model::invalid_channel_exception,
+    model::index_out_of_bounds_exception,
+    model::invalid_tile_naming_method,
+    model::invalid_tile_list_exception,
+    model::invalid_run_info_exception,
+    model::invalid_run_info_cycle_exception,
+    model::invalid_parameter))
+    {
+        clear();
+        io::bundle_reader bundle;
+        bundle.open(bundle_file);
+
+        // The XML parser works in place, so it is given a null terminated copy of each section
+        std::vector<char> xml;
+        const char* data;
+        size_t size;
+        if(!bundle.find(io::paths::run_info(), data, size))
+            INTEROP_THROW(xml::xml_file_not_found_exception, "RunInfo.xml not found in bundle: " << bundle_file);
+        xml.assign(data, data + size);
+        xml.push_back('\0');
+        m_run_info.parse(&xml.front());
+
+        const size_t count = count_legacy_bins();
+        if (m_run_info.channels().empty() || logic::metric::requires_legacy_bins(count))
+        {
+            if(bundle.find(io::paths::run_parameters(true), data, size) ||
+               bundle.find(io::paths::run_parameters(), data, size))
+            {
+                xml.assign(data, data + size);
+                xml.push_back('\0');
+                m_run_parameters.parse(&xml.front());
+            }
+            else if (m_run_info.channels().empty())
+                INTEROP_THROW(io::file_not_found_exception,
+                              "RunParameters.xml required for legacy run folders with missing channel names");
+            else
+                INTEROP_THROW(io::file_not_found_exception,
+                              "RunParameters.xml required for legacy run folders and is missing");
+        }
+
+        read_bundle_func read_functor(bundle, filter);
+        m_metrics.apply(read_functor);
+        if (read_functor.are_all_files_missing())
+            m_metrics.apply(read_bundle_by_cycle_func(bundle, run_info().total_cycles(), filter));
+        finalize_groups(std::vector<unsigned char>(constants::MetricCount, 1), count, filter.first_cycle());
+    }
+
     /** Read XML files: RunInfo.xml and possibly RunParameters.xml
      *
      * @param run_folder run folder path
@@ -454,16 +896,6 @@ namespace illumina { namespace interop { namespace model { namespace metrics
     model::invalid_run_info_exception,
     model::invalid_run_info_cycle_exception))
     {
-        if (m_run_info.flowcell().naming_method() == constants::UnknownTileNamingMethod)
-        {
-            determine_tile_naming_method naming_method_determinator;
-            m_metrics.apply(naming_method_determinator);
-            m_run_info.set_naming_method( naming_method_determinator.naming_method());
-        }
-        if(!get<model::metrics::index_metric>().empty())
-        {
-            logic::metric::populate_indices(get<model::metrics::tile_metric>(), get<model::metrics::index_metric>());
-        }
         if (count == std::numeric_limits<size_t>::max())
         {
             count = count_legacy_bins();
@@ -473,7 +905,33 @@ namespace illumina { namespace interop { namespace model { namespace metrics
             // This is already taken care of for SAV by the read_by_cycle function
             m_metrics.apply(rebuild_index());
         }
-        if(logic::metric::requires_legacy_bins(count))
+        finalize_groups(std::vector<unsigned char>(constants::MetricCount, 1), count, 0);
+    }
+
+    /** Finalize the selected metric sets after loading from disk
+     *
+     * Each step only runs when one of the metric sets it reads or writes is selected, so metric sets loaded
+     * earlier are not finalized again.
+     *
+     * @param groups flag for each metric group, 1 if the metric set was loaded
+     * @param count number of bins for legacy q-metrics
+     * @param first_cycle first cycle selected by the load filter, the q-metrics of earlier cycles are removed after
+     *                    the cumulative histograms are populated (0 or 1 keeps all cycles)
+     */
+    void run_metrics::finalize_groups(const std::vector<unsigned char>& groups, size_t count, const size_t first_cycle)
+    {
+        if (m_run_info.flowcell().naming_method() == constants::UnknownTileNamingMethod)
+        {
+            determine_tile_naming_method naming_method_determinator;
+            m_metrics.apply(naming_method_determinator);
+            m_run_info.set_naming_method( naming_method_determinator.naming_method());
+        }
+        if((groups[constants::Index] || groups[constants::Tile]) && !get<model::metrics::index_metric>().empty())
+        {
+            logic::metric::populate_indices(get<model::metrics::tile_metric>(), get<model::metrics::index_metric>());
+        }
+        const bool is_q_loaded = groups[constants::Q] || groups[constants::QCollapsed] || groups[constants::QByLane];
+        if(is_q_loaded && logic::metric::requires_legacy_bins(count))
         {
             logic::metric::populate_legacy_q_score_bins(get<q_metric>().bins(), m_run_parameters.instrument_type(),
                                                         count);
@@ -483,22 +941,47 @@ namespace illumina { namespace interop { namespace model { namespace metrics
             logic::metric::compress_q_metrics(get<q_metric>());
             logic::metric::compress_q_metrics(get<q_by_lane_metric>());
         }
-        if (get<q_metric>().size() > 0 && get<q_collapsed_metric>().size() == 0)
+        // The per tile cumulative histograms are the largest derived data, and are not required for reporting
+        const bool derived_q_metrics = is_q_loaded &&
+                get<q_metric>().size() > 0 &&
+                get<q_collapsed_metric>().size() == 0 &&
+                get<q_by_lane_metric>().size() == 0 &&
+                logic::metric::derive_q_metrics(get<q_metric>(),
+                                                get<q_collapsed_metric>(),
+                                                get<q_by_lane_metric>(),
+                                                m_run_parameters.instrument_type(),
+                                                !m_low_memory);
+        if (is_q_loaded && !derived_q_metrics)
         {
-            logic::metric::create_collapse_q_metrics(get<q_metric>(), get<q_collapsed_metric>());
+            if (get<q_metric>().size() > 0 && get<q_collapsed_metric>().size() == 0)
+            {
+                logic::metric::create_collapse_q_metrics(get<q_metric>(), get<q_collapsed_metric>());
+            }
+            if (get<q_metric>().size() > 0 && get<q_by_lane_metric>().size() == 0)
+                logic::metric::create_q_metrics_by_lane(get<q_metric>(),
+                                                        get<q_by_lane_metric>(),
+                                                        m_run_parameters.instrument_type());
+            if(!m_low_memory) logic::metric::populate_cumulative_distribution(get<q_metric>());
+            logic::metric::populate_cumulative_distribution(get<q_by_lane_metric>());
+            logic::metric::populate_cumulative_distribution(get<q_collapsed_metric>());
+        }
+        if (is_q_loaded && first_cycle > 1)
+        {
+            const cycle_before is_before(first_cycle);
+            get<q_metric>().remove_if(is_before);
+            get<q_by_lane_metric>().remove_if(is_before);
+            get<q_collapsed_metric>().remove_if(is_before);
+            get<q_metric>().rebuild_index();
+            get<q_by_lane_metric>().rebuild_index();
+            get<q_collapsed_metric>().rebuild_index();
         }
         INTEROP_ASSERTMSG(
                 get<q_metric>().size() == 0 ||
                 get<q_metric>().size() == get<q_collapsed_metric>().size(),
                 get<q_metric>().size() << " == " << get<q_collapsed_metric>().size());
-        if (get<q_metric>().size() > 0 && get<q_by_lane_metric>().size() == 0)
-            logic::metric::create_q_metrics_by_lane(get<q_metric>(),
-                                                    get<q_by_lane_metric>(),
-                                                    m_run_parameters.instrument_type());
-        logic::metric::populate_cumulative_distribution(get<q_metric>());
-        logic::metric::populate_cumulative_distribution(get<q_by_lane_metric>());
-        logic::metric::populate_cumulative_distribution(get<q_collapsed_metric>());
-        if(!get<model::metrics::extended_tile_metric>().empty() && !get<model::metrics::tile_metric>().empty())
+        if((groups[constants::ExtendedTile] || groups[constants::Tile]) &&
+           !get<model::metrics::extended_tile_metric>().empty() &&
+           !get<model::metrics::tile_metric>().empty())
         {
             logic::metric::populate_percent_occupied(get<model::metrics::tile_metric>(),
                                                      get<model::metrics::extended_tile_metric>());
@@ -514,12 +997,15 @@ namespace illumina { namespace interop { namespace model { namespace metrics
         typedef metric_base::metric_set< extraction_metric > extraction_metric_set_t;
         extraction_metric_set_t &extraction_metrics = get<extraction_metric>();
         // Trim excess channel data for imaging table
-        extraction_metrics.channel_count(run_info().channels().size());
-        for (extraction_metric_set_t::iterator it = extraction_metrics.begin(); it != extraction_metrics.end(); ++it)
-            it->trim(run_info().channels().size());
+        if(groups[constants::Extraction])
+        {
+            extraction_metrics.channel_count(run_info().channels().size());
+            for (extraction_metric_set_t::iterator it = extraction_metrics.begin(); it != extraction_metrics.end(); ++it)
+                it->trim(run_info().channels().size());
+        }
         typedef metric_base::metric_set<image_metric> image_metric_set_t;
         image_metric_set_t &image_metrics = get<image_metric>();
-        if(run_info().channels().size() < image_metrics.channel_count())
+        if(groups[constants::Image] && run_info().channels().size() < image_metrics.channel_count())
         {
             image_metrics.channel_count(run_info().channels().size());
             for (image_metric_set_t::iterator it = image_metrics.begin(); it != image_metrics.end(); ++it)
@@ -531,11 +1017,13 @@ namespace illumina { namespace interop { namespace model { namespace metrics
             if(run_info().flowcell().naming_method() == constants::UnknownTileNamingMethod)
                 INTEROP_THROW(model::invalid_tile_naming_method, "Unknown tile naming method - update your RunInfo.xml");
             m_run_info.validate();
-            validate();
+            m_metrics.apply(apply_to_selected<validate_run_info>(validate_run_info(m_run_info), &groups.front()));
             m_run_info.validate_tiles();
         }
 
-        if(!get<model::metrics::phasing_metric>().empty())
+        if(groups[constants::EmpiricalPhasing] &&
+           !get<model::metrics::phasing_metric>().empty() &&
+           get<model::metrics::dynamic_phasing_metric>().empty())
         {
             logic::summary::read_cycle_vector_t cycle_to_read;
             logic::summary::map_read_to_cycle_number(run_info().reads().begin(),
@@ -546,6 +1034,50 @@ namespace illumina { namespace interop { namespace model { namespace metrics
                                                             get<model::metrics::dynamic_phasing_metric>(),
                                                             get<model::metrics::tile_metric>());
         }
+        // Partition every metric set changed above for lane_range, cycle_range and filter_mask::select, then
+        // catalog the metric sets with a new generation
+        std::vector<unsigned char> changed(groups);
+        m_metrics.apply(partition_metric_set(changed));
+        m_metrics.apply(apply_to_selected<add_to_tile_catalog>(add_to_tile_catalog(m_tile_catalog), &changed.front()));
+        m_tile_catalog.build(m_run_info.flowcell().naming_method());
+    }
+
+    /** Get the catalog of the tiles present in each metric set
+     *
+     * @return tile catalog
+     */
+    const tile_catalog& run_metrics::catalog()const
+    {
+        return m_tile_catalog;
+    }
+    /** Test if the catalog matches the current metric sets
+     *
+     * @return true if no metric set or the tile naming method has changed since the catalog was built
+     */
+    bool run_metrics::is_catalog_current()const
+    {
+        if(!m_tile_catalog.is_built() || m_tile_catalog.naming_method() != m_run_info.flowcell().naming_method())
+            return false;
+        is_tile_catalog_current is_current(m_tile_catalog);
+        m_metrics.apply(is_current);
+        return is_current.is_current();
+    }
+    /** Rebuild the catalog if any metric set or the tile naming method has changed since it was built
+     */
+    void run_metrics::update_catalog()
+    {
+        if(is_catalog_current()) return;
+        populate_catalog(m_tile_catalog);
+    }
+    /** Build a catalog of the tiles present in each metric set
+     *
+     * @param catalog destination catalog
+     */
+    void run_metrics::populate_catalog(tile_catalog& catalog)const
+    {
+        catalog.clear();
+        m_metrics.apply(add_to_tile_catalog(catalog));
+        catalog.build(m_run_info.flowcell().naming_method());
     }
 
     /** Clear all the metrics
@@ -555,6 +1087,11 @@ namespace illumina { namespace interop { namespace model { namespace metrics
         m_run_info = run::info();
         m_run_parameters = run::parameters();
         m_metrics.apply(clear_metric());
+        m_tile_catalog.clear();
+        m_lazy_run_folder.clear();
+        m_lazy_loaded.clear();
+        m_is_lazy = false;
+        m_is_lazy_parameters_read = false;
     }
 
     /** Update channels for legacy runs
@@ -585,8 +1122,12 @@ namespace illumina { namespace interop { namespace model { namespace metrics
      * @param run_folder run folder path
      * @param last_cycle last cycle to search for by cycle interops
      * @param thread_count number of threads to use for network loading
+     * @param filter select the lanes, tiles and cycles to load
      */
-    void run_metrics::read_metrics(const std::string &run_folder, const size_t last_cycle, const size_t thread_count)
+    void run_metrics::read_metrics(const std::string &run_folder,
+                                   const size_t last_cycle,
+                                   const size_t thread_count,
+                                   const io::load_filter& filter)
     INTEROP_THROW_SPEC((
     io::file_not_found_exception,
     io::bad_format_exception,
@@ -596,15 +1137,15 @@ namespace illumina { namespace interop { namespace model { namespace metrics
         if(thread_count > 1)
         {
             std::vector<unsigned char> valid_to_load(constants::MetricCount, 1);
-            read_metrics(run_folder, last_cycle, valid_to_load, thread_count);
+            read_metrics(run_folder, last_cycle, valid_to_load, thread_count, false, filter);
         }
         else{
 #endif
-            read_func read_functor(run_folder);
+            read_func read_functor(run_folder, 0, false, filter);
             m_metrics.apply(read_functor);
             if (read_functor.are_all_files_missing())
             {
-                m_metrics.apply(read_by_cycle_func(run_folder, last_cycle));
+                m_metrics.apply(read_by_cycle_func(run_folder, last_cycle, 0, filter));
             }
 #ifdef _OPENMP
         }
@@ -623,12 +1164,14 @@ namespace illumina { namespace interop { namespace model { namespace metrics
      * @param valid_to_load list of metrics to load
      * @param thread_count number of threads to use for network loading
      * @param skip_loaded skip metrics that are already loaded
+     * @param filter select the lanes, tiles and cycles to load
      */
     void run_metrics::read_metrics(const std::string &run_folder,
                                    const size_t last_cycle,
                                    const std::vector<unsigned char>& valid_to_load,
                                    const size_t thread_count,
-                                   const bool skip_loaded)
+                                   const bool skip_loaded,
+                                   const io::load_filter& filter)
     INTEROP_THROW_SPEC((io::file_not_found_exception,
     io::bad_format_exception,
     io::incomplete_file_exception,
@@ -657,7 +1200,10 @@ namespace illumina { namespace interop { namespace model { namespace metrics
 #               pragma omp flush(exception_thrown)
                 if(exception_thrown) continue;
                 valid_to_load_local[ omp_get_thread_num() ][offset[i]] = 1;
-                read_func read_functor_l(run_folder, &valid_to_load_local[ omp_get_thread_num() ].front(), skip_loaded);
+                read_func read_functor_l(run_folder,
+                                         &valid_to_load_local[ omp_get_thread_num() ].front(),
+                                         skip_loaded,
+                                         filter);
                 try{
                     m_metrics.apply(read_functor_l);
                 }
@@ -679,7 +1225,7 @@ namespace illumina { namespace interop { namespace model { namespace metrics
         }
         else{
 #endif
-            read_func read_functor(run_folder, &valid_to_load.front(), skip_loaded);
+            read_func read_functor(run_folder, &valid_to_load.front(), skip_loaded, filter);
             m_metrics.apply(read_functor);
             all_files_are_missing = read_functor.are_all_files_missing();
 #ifdef _OPENMP
@@ -687,44 +1233,8 @@ namespace illumina { namespace interop { namespace model { namespace metrics
 #endif
         if (all_files_are_missing)
         {
-#ifdef _OPENMP
-            if(thread_count > 1)
-            {
-                std::vector<size_t> offset;
-                offset.reserve(valid_to_load.size());
-                for(size_t i=0;i<valid_to_load.size();++i)
-                    if(valid_to_load[i]) offset.push_back(i);
-                std::vector< std::vector<unsigned char> > valid_to_load_local(thread_count, std::vector<unsigned char>(valid_to_load.size(), 0));
-                bool exception_thrown = false;
-                std::string exception_msg;
-#               pragma omp parallel for default(shared) num_threads(static_cast<int>(thread_count)) schedule(dynamic)
-                for(int i=0;i<static_cast<int>(offset.size());++i)
-                {
-#               pragma omp flush(exception_thrown)
-                    valid_to_load_local[ omp_get_thread_num() ][offset[i]] = 1;
-                    try{
-                        m_metrics.apply(read_by_cycle_func(run_folder, last_cycle, &valid_to_load_local[ omp_get_thread_num() ].front()));
-                    }
-                    catch(const std::exception& ex)
-                    {
-#pragma                 omp critical(SaveMessage)
-                        exception_msg = ex.what();
-
-                        exception_thrown = true;
-#pragma                 omp flush(exception_thrown)
-                    }
-                    valid_to_load_local[ omp_get_thread_num() ][offset[i]] = 0;
-                }
-                if(exception_thrown)
-                    throw io::bad_format_exception(exception_msg);
-            }
-            else
-            {
-#endif
-                m_metrics.apply(read_by_cycle_func(run_folder, last_cycle, &valid_to_load.front()));
-#ifdef _OPENMP
-            }
-#endif
+            // Each metric set is loaded in turn, and its cycle files are read concurrently
+            m_metrics.apply(read_by_cycle_func(run_folder, last_cycle, &valid_to_load.front(), filter, thread_count));
         }
     }
 
@@ -740,6 +1250,28 @@ namespace illumina { namespace interop { namespace model { namespace metrics
         m_metrics.apply(write_func(run_folder, use_out));
     }
 
+    /** Write binary metrics and the XML files of the run folder to a single bundle file
+     *
+     * @param bundle_file bundle file path
+     * @param run_folder run folder path holding the XML files
+     */
+    void run_metrics::write_bundle(const std::string &bundle_file, const std::string &run_folder)const
+    INTEROP_THROW_SPEC((io::file_not_found_exception,
+    io::bad_format_exception))
+    {
+        io::bundle_writer bundle;
+        const std::string xml_files[] = {io::paths::run_info(),
+                                         io::paths::run_parameters(),
+                                         io::paths::run_parameters(true)};
+        for(size_t i=0;i<3;++i)
+        {
+            const std::string file_name = io::combine(run_folder, xml_files[i]);
+            if(io::file_size(file_name) >= 0) bundle.add_file(xml_files[i], file_name);
+        }
+        m_metrics.apply(write_bundle_func(bundle));
+        bundle.write(bundle_file);
+    }
+
     /** Read a single metric set from a binary buffer
      *
      * @param group metric set to write
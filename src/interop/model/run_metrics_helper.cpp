@@ -119,16 +119,14 @@ namespace illumina { namespace interop { namespace model { namespace metrics
 
      struct sort_by_lane_tile_cycle
      {
+         sort_by_lane_tile_cycle(const size_t thread_count) : m_thread_count(thread_count) {}
+
          template<class MetricSet>
          void operator()(MetricSet &metrics) const {
-             typedef typename MetricSet::metric_type metric_type;
-             std::sort(metrics.begin(), metrics.end(), is_less < metric_type > );
+             metrics.sort(m_thread_count);
          }
 
-         template<class T>
-         static bool is_less(const T &lhs, const T &rhs) {
-             return lhs.id() < rhs.id();
-         }
+         size_t m_thread_count;
      };
 
      struct check_for_each_data_source
@@ -354,10 +352,11 @@ namespace illumina { namespace interop { namespace model { namespace metrics
 
                 /** Sort the metrics by lane, then tile, then cycle
                  *
+                 * @param thread_count number of threads used to order the ids of each metric set
                  */
-                void run_metrics::sort()
+                void run_metrics::sort(const size_t thread_count)
                 {
-                    m_metrics.apply(sort_by_lane_tile_cycle());
+                    m_metrics.apply(sort_by_lane_tile_cycle(thread_count));
                 }
 
                 /** Check if the InterOp file for each metric set exists
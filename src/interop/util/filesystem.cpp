@@ -166,6 +166,23 @@ namespace illumina { namespace interop { namespace io
 #       endif
 
     }
+    /** Get the last modification time of a file
+     *
+     * @param path path to the target file
+     * @return modification time in seconds since the epoch or -1 if the operation failed
+     */
+    ::int64_t file_modification_time(const std::string& path)
+    {
+#       ifdef WIN32
+            struct __stat64 buf;
+            if (_stat64(path.c_str(), &buf) != 0)return -1;
+            return static_cast< ::int64_t >(buf.st_mtime);
+#       else
+            struct stat buf;
+            if (stat(path.c_str(), &buf) != 0)return -1;
+            return static_cast< ::int64_t >(buf.st_mtime);
+#       endif
+    }
 }}}
 
 
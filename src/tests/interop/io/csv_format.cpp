@@ -9,6 +9,7 @@
 #include <gtest/gtest.h>
 #include <vector>
 #include "interop/io/table/csv_format.h"
+#include "interop/io/format/text_buffer.h"
 #include "src/tests/interop/inc/generic_fixture.h"
 
 using namespace illumina::interop;
@@ -25,4 +26,72 @@ TEST(csv_format_test, read_value)
     INTEROP_EXPECT_NEAR(3.0f, vals[0], eps);
     INTEROP_EXPECT_NEAR(std::numeric_limits<float>::infinity(), vals[1], eps);
     INTEROP_EXPECT_NEAR(1.0f, vals[2], eps);
-}
\ No newline at end of file
+}
+TEST(csv_format_test, read_csv_rows_matches_read_csv_line)
+{
+    std::ostringstream oss;
+    for(int row=0;row<500;++row)
+        oss << row << "," << 0.1000000015f*row << ",," << -1.5e-7*row << ",nan,1.23456789012345678\n";
+    oss << "\n7,8,9,10,11,12";
+    const std::string text = oss.str();
+    const float missing = -1.0f;
+
+    std::vector<float> expected;
+    std::vector<float> values;
+    std::istringstream sin(text);
+    size_t expected_rows = 0;
+    while(!sin.eof())
+    {
+        io::table::read_csv_line(sin, values, missing);
+        if(values.empty()) continue;
+        expected.insert(expected.end(), values.begin(), values.end());
+        ++expected_rows;
+    }
+
+    for(size_t thread_count=1;thread_count<=3;++thread_count)
+    {
+        std::istringstream in(text);
+        std::vector<float> actual;
+        EXPECT_EQ(io::table::read_csv_rows(in, 6, actual, missing, thread_count), expected_rows);
+        ASSERT_EQ(actual.size(), expected.size());
+        for(size_t i=0;i<actual.size();++i)
+        {
+            if(std::isnan(expected[i])) EXPECT_TRUE(std::isnan(actual[i]));
+            else EXPECT_EQ(actual[i], expected[i]) << i;
+        }
+    }
+}
+
+TEST(csv_format_test, read_csv_rows_column_mismatch)
+{
+    std::istringstream in("1,2,3\n4,5\n");
+    std::vector<float> actual;
+    EXPECT_THROW(io::table::read_csv_rows(in, 3, actual), io::bad_format_exception);
+}
+
+TEST(csv_format_test, text_buffer_stream_matches_ostringstream)
+{
+    const double doubles[] = {0.0, -0.0, 1.0, 0.1, 1e-7, 123456789.0, -3.14159265358979, 2.08311e+06, 1e300,
+                              std::numeric_limits<double>::infinity(), std::numeric_limits<double>::quiet_NaN()};
+    const long longs[] = {0, 1, -1, 42, 1420585636, std::numeric_limits<long>::max(), std::numeric_limits<long>::min()};
+    for(int precision=1;precision<=17;precision+=4)
+    {
+        std::ostringstream expected;
+        io::text_buffer_stream actual(16);
+        expected.precision(precision);
+        actual.copy_format(expected);
+        for(size_t i=0;i<sizeof(doubles)/sizeof(doubles[0]);++i)
+        {
+            expected << doubles[i] << ',' << static_cast<float>(doubles[i]) << ',';
+            actual << doubles[i] << ',' << static_cast<float>(doubles[i]) << ',';
+        }
+        for(size_t i=0;i<sizeof(longs)/sizeof(longs[0]);++i)
+        {
+            expected << longs[i] << ',' << static_cast<unsigned long>(longs[i]) << ',';
+            actual << longs[i] << ',' << static_cast<unsigned long>(longs[i]) << ',';
+        }
+        expected << std::hex << 255 << std::fixed << 1.5;
+        actual << std::hex << 255 << std::fixed << 1.5;
+        EXPECT_EQ(std::string(actual.buffer().data(), actual.buffer().size()), expected.str()) << precision;
+    }
+}
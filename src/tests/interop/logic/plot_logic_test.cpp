@@ -647,3 +647,51 @@ TEST(plot_logic, check_all_flowcell_list)
 
 
 
+
+TEST(plot_logic, compiled_filter_mask_matches_filter_options)
+{
+    typedef model::metrics::error_metric metric_t;
+    model::run::info run_info;
+    hiseq4k_run_info::create_expected(run_info);
+
+    model::metric_base::metric_set<metric_t> metrics;
+    const ::uint32_t tiles[] = {1101, 1128, 1205, 2101, 2228, 1199, 3101};
+    for(::uint32_t lane=1;lane<=3;++lane)
+        for(size_t t=0;t<util::length_of(tiles);++t)
+            for(::uint32_t cycle=1;cycle<=3;++cycle)
+                metrics.insert(metric_t(lane, tiles[t], cycle, 0.5f, 0.0f));
+
+    const ::uint32_t ids[] = {0, 1, 2};
+    for(size_t l=0;l<util::length_of(ids);++l)
+    {
+        for(size_t s=0;s<util::length_of(ids);++s)
+        {
+            for(size_t w=0;w<util::length_of(ids);++w)
+            {
+                model::plot::filter_options options(constants::FourDigit);
+                options.lane(ids[l]);
+                options.surface(ids[s]);
+                options.swath(ids[w]);
+                options.cycle(ids[w]);
+                options.tile_number(ids[s] == 0 ? 0 : 28);
+                const model::plot::filter_mask mask = options.compile(run_info);
+                for(model::metric_base::metric_set<metric_t>::const_iterator it = metrics.begin();
+                    it != metrics.end(); ++it)
+                {
+                    EXPECT_EQ(options.valid_tile(*it), mask.valid_tile(*it)) << it->lane() << "_" << it->tile();
+                    EXPECT_EQ(options.valid_tile_cycle(*it), mask.valid_tile_cycle(*it))
+                                        << it->lane() << "_" << it->tile() << "_" << it->cycle();
+                }
+            }
+        }
+    }
+
+    model::plot::filter_options options(constants::FourDigit);
+    options.lane(2);
+    const model::plot::filter_mask mask = options.compile(run_info);
+    EXPECT_EQ(static_cast<size_t>(mask.select(metrics).second - mask.select(metrics).first), metrics.size());
+    metrics.partition_by_lane_cycle();
+    EXPECT_EQ(static_cast<size_t>(mask.select(metrics).second - mask.select(metrics).first),
+              util::length_of(tiles)*3);
+    EXPECT_EQ(2u, mask.select(metrics).first->lane());
+}
@@ -11,6 +11,8 @@
 #include <gtest/gtest.h>
 #include "interop/util/math.h"
 #include "interop/logic/summary/run_summary.h"
+#include "interop/logic/summary/tile_summary.h"
+#include "interop/logic/summary/cycle_state_summary.h"
 #include "interop/logic/utils/channel.h"
 #include "src/tests/interop/metrics/inc/corrected_intensity_metrics_test.h"
 #include "src/tests/interop/metrics/inc/error_metrics_test.h"
@@ -414,6 +416,70 @@ TEST(summary_metrics_test, cycle_35_cycle_34_tile)
 
 }
 
+TEST(summary_metrics_test, cycle_state_dense_tile_index)
+{
+    model::run::info run_info;
+    model::run::read_info reads[] = {model::run::read_info(1, 1, 36)};
+    hiseq4k_run_info::create_expected(run_info, util::to_vector(reads));
+
+    model::metrics::run_metrics run_metrics(run_info);
+    model::metric_base::metric_set<model::metrics::error_metric> &error_metrics =
+            run_metrics.get<model::metrics::error_metric>();
+    typedef model::metrics::error_metric::uint_t uint_t;
+    for (uint_t cycle_number = 0; cycle_number < 34; ++cycle_number)
+        error_metrics.insert(error_metric(1, 1102, 1 + cycle_number, 1.0f, 0.0f));
+    for (uint_t cycle_number = 0; cycle_number < 36; ++cycle_number)
+        error_metrics.insert(error_metric(1, 1101, 1 + cycle_number, 3.0f, 0.0f));
+
+    logic::summary::dense_tile_index tile_index;
+    tile_index.add(error_metrics);
+    ASSERT_EQ(tile_index.size(), 2u);
+    EXPECT_EQ(tile_index.index_of(1, 1101), 0u);
+    EXPECT_EQ(tile_index.index_of(1, 1102), 1u);
+    EXPECT_EQ(tile_index.index_of(2, 1101), tile_index.size());
+
+    model::summary::run_summary summary;
+    logic::summary::summarize_run_metrics(run_metrics, summary);
+    EXPECT_EQ(summary.cycle_state().error_cycle_range().first_cycle(), 34u);
+    EXPECT_EQ(summary.cycle_state().error_cycle_range().last_cycle(), 36u);
+    EXPECT_EQ(summary[0][0].cycle_state().error_cycle_range().first_cycle(), 34u);
+    EXPECT_EQ(summary[0][0].cycle_state().error_cycle_range().last_cycle(), 36u);
+}
+
+TEST(summary_metrics_test, summary_by_lane_read_buckets)
+{
+    model::run::read_info reads[] = {model::run::read_info(1, 1, 3), model::run::read_info(2, 4, 6)};
+    model::summary::run_summary summary(util::to_vector(reads), 2, 2, 4);
+    logic::summary::summary_by_lane_read<float> cache(summary, 2);
+    const float values[][4] = {{1,1,1,5.0f}, {0,0,0,1.0f}, {1,1,1,3.0f}, {0,1,0,2.0f}, {1,1,1,4.0f}};
+    for (size_t pass = 0; pass < 2; ++pass)
+    {
+        for (size_t i = 0; i < util::length_of(values); ++i)
+            cache.push_back(static_cast<size_t>(values[i][0]),
+                            static_cast<size_t>(values[i][1]),
+                            static_cast<size_t>(values[i][2]),
+                            values[i][3]);
+        if (pass == 0) cache.allocate();
+    }
+    ASSERT_TRUE(cache.is_allocated());
+    EXPECT_EQ(cache(0, 0, 0).size(), 1u);
+    EXPECT_EQ(cache(0, 0, 1).size(), 0u);
+    EXPECT_TRUE(cache(1, 0, 0).empty());
+    EXPECT_EQ(cache(0, 1, 0).size(), 1u);
+    ASSERT_EQ(cache(1, 1, 1).size(), 3u);
+    EXPECT_EQ(*cache(1, 1, 1).begin(), 5.0f);
+    EXPECT_EQ(*(cache(1, 1, 1).begin()+2), 4.0f);
+
+    model::summary::metric_stat stat;
+    logic::summary::summarize(cache(1, 1, 1).begin(), cache(1, 1, 1).end(), stat, false);
+    EXPECT_EQ(stat.mean(), 4.0f);
+    EXPECT_EQ(stat.median(), 4.0f);
+
+    cache.clear();
+    EXPECT_FALSE(cache.is_allocated());
+    EXPECT_TRUE(cache(1, 1, 1).empty());
+}
+
 TEST(summary_metrics_test, clear_run_metrics) // TODO Expand to catch everything: probably use a fixture and the methods above
 {
     const float tol = 1e-9f;
@@ -455,6 +521,41 @@ TEST(summary_metrics_test, empty_run_metrics)
     EXPECT_EQ(summary.size(), 0u);
 }
 
+TEST(summary_metrics_test, tile_summary_projection)
+{
+    const float tol = 1e-5f;
+    const float nan = std::numeric_limits<float>::quiet_NaN();
+    std::vector<model::metrics::tile_metric> tiles;
+    std::vector<model::metrics::read_metric> reads;
+    tiles.push_back(model::metrics::tile_metric(1, 1101, 2355.1f, 1158.1f, 6470.9f, 3182.0f));
+    tiles.push_back(model::metrics::tile_metric(1, 1102, 2501.3f, 1201.4f, 6800.2f, 3320.5f));
+    tiles.push_back(model::metrics::tile_metric(1, 1103, nan, nan, 6100.7f, 3050.1f));
+    reads.push_back(model::metrics::read_metric(1, 2.5f, 0.1f, 0.2f));
+    reads.push_back(model::metrics::read_metric(1, nan, 0.3f, -1.0f));
+    reads.push_back(model::metrics::read_metric(1, 3.5f, nan, 0.4f));
+
+    std::vector<logic::summary::tile_summary_projection> tile_projections(tiles.begin(), tiles.end());
+    std::vector<logic::summary::read_summary_projection> read_projections(reads.begin(), reads.end());
+
+    model::summary::lane_summary expected;
+    model::summary::lane_summary actual;
+    logic::summary::update_tile_summary_from_cache(tiles, expected, false);
+    logic::summary::update_tile_summary_from_cache(tile_projections, actual, false);
+    EXPECT_EQ(logic::summary::update_read_summary(reads, expected, false),
+              logic::summary::update_read_summary(read_projections, actual, false));
+
+    EXPECT_TRUE(AreStatsNear(expected.density(), actual.density(), tol));
+    EXPECT_TRUE(AreStatsNear(expected.density_pf(), actual.density_pf(), tol));
+    EXPECT_TRUE(AreStatsNear(expected.cluster_count(), actual.cluster_count(), tol));
+    EXPECT_TRUE(AreStatsNear(expected.cluster_count_pf(), actual.cluster_count_pf(), tol));
+    EXPECT_TRUE(AreStatsNear(expected.percent_pf(), actual.percent_pf(), tol));
+    EXPECT_TRUE(AreStatsNear(expected.percent_aligned(), actual.percent_aligned(), tol));
+    EXPECT_TRUE(AreStatsNear(expected.phasing(), actual.phasing(), tol));
+    EXPECT_TRUE(AreStatsNear(expected.prephasing(), actual.prephasing(), tol));
+    EXPECT_NEAR(expected.reads(), actual.reads(), tol);
+    EXPECT_NEAR(expected.reads_pf(), actual.reads_pf(), tol);
+}
+
 //---------------------------------------------------------------------------------------------------------------------
 // Unit test section
 //---------------------------------------------------------------------------------------------------------------------
@@ -11,8 +11,13 @@
 #pragma warning(disable:4127) // MSVC warns about using constants in conditional statements, for template constants
 #endif
 
+#include <cstring>
 #include <gtest/gtest.h>
 #include "interop/model/run_metrics.h"
+#include "interop/io/metric_stream.h"
+#include "interop/io/format/fixed_record.h"
+#include "interop/io/format/default_layout.h"
+#include "interop/io/layout/base_metric.h"
 #include "src/tests/interop/metrics/inc/error_metrics_test.h"
 #include "src/tests/interop/inc/generic_fixture.h"
 #include "src/tests/interop/inc/proxy_parameter_generator.h"
@@ -87,6 +92,187 @@ TEST(error_metrics_single_test, test_tile_metric_count_for_lane)
     EXPECT_EQ(metrics.tile_numbers_for_lane(7).size(), 1u);
 }
 
+/**
+ * @test Ensure the lane, tile and cycle catalog follows insert, resize and clear
+ */
+TEST(error_metrics_single_test, test_catalog_tracks_records)
+{
+    error_metric_set metrics;
+    metrics.insert(error_metric(1, 1102, 2, 0.5f, 0.0f));
+    metrics.insert(error_metric(1, 1101, 1, 0.5f, 0.0f));
+    metrics.insert(error_metric(3, 1101, 1, 0.5f, 0.0f));
+    EXPECT_EQ(metrics.lane_count(), 2u);
+    EXPECT_EQ(metrics.max_lane(), 3u);
+    ASSERT_EQ(metrics.tile_numbers_for_lane(1).size(), 2u);
+    EXPECT_EQ(metrics.tile_numbers_for_lane(1)[0], 1101u);
+    EXPECT_EQ(metrics.tile_numbers_for_lane(1)[1], 1102u);
+    EXPECT_EQ(metrics.tile_numbers().size(), 2u);
+    EXPECT_EQ(metrics.cycles().size(), 2u);
+    EXPECT_EQ(metrics.record_count_for_lane(1), 2u);
+    EXPECT_EQ(metrics.record_count_for_lane(2), 0u);
+    EXPECT_EQ(metrics.record_count_for_cycle(1), 2u);
+
+    metrics.trim(1);
+    EXPECT_EQ(metrics.lane_count(), 1u);
+    EXPECT_EQ(metrics.tile_numbers_for_lane(1).size(), 1u);
+    EXPECT_EQ(metrics.record_count_for_cycle(1), 0u);
+    metrics.rebuild_index(true);
+    EXPECT_EQ(metrics.record_count_for_lane(1), 1u);
+    EXPECT_EQ(metrics.max_lane(), 1u);
+
+    metrics.clear();
+    EXPECT_EQ(metrics.lane_count(), 0u);
+    EXPECT_EQ(metrics.cycles().size(), 0u);
+}
+
+/**
+ * @test Ensure the lane and cycle ranges match the copied metrics after partitioning
+ */
+TEST(error_metrics_single_test, test_partition_by_lane_cycle)
+{
+    error_metric_set metrics;
+    metrics.insert(error_metric(2, 1101, 2, 0.5f, 0.0f));
+    metrics.insert(error_metric(1, 1102, 1, 0.5f, 0.0f));
+    metrics.insert(error_metric(2, 1101, 1, 0.5f, 0.0f));
+    metrics.insert(error_metric(1, 1101, 1, 0.5f, 0.0f));
+    EXPECT_THROW(metrics.lane_range(1), model::index_out_of_bounds_exception);
+    metrics.partition_by_lane_cycle();
+    ASSERT_TRUE(metrics.is_partitioned());
+
+    error_metric_set::const_range_t lane1 = metrics.lane_range(1);
+    ASSERT_EQ(lane1.second-lane1.first, 2);
+    EXPECT_EQ(lane1.first->tile(), 1101u);
+    EXPECT_EQ(metrics.metrics_for_lane(2).size(), 2u);
+    EXPECT_EQ(metrics.lane_range(3).first, metrics.lane_range(3).second);
+
+    error_metric_set::const_range_t lane2_cycle2 = metrics.cycle_range(2, 2);
+    ASSERT_EQ(lane2_cycle2.second-lane2_cycle2.first, 1);
+    EXPECT_EQ(lane2_cycle2.first->cycle(), 2u);
+    EXPECT_EQ(metrics.metrics_for_cycle(1).size(), 3u);
+    EXPECT_EQ(metrics.get_metric(1, 1102, 1).lane(), 1u);
+
+    metrics.insert(error_metric(3, 1101, 1, 0.5f, 0.0f));
+    EXPECT_FALSE(metrics.is_partitioned());
+    EXPECT_EQ(metrics.metrics_for_lane(3).size(), 1u);
+
+    // Read only access keeps the partition, access for modification drops it
+    metrics.partition_by_lane_cycle();
+    const error_metric_set& const_metrics = metrics;
+    EXPECT_EQ(const_metrics.begin()->lane(), 1u);
+    EXPECT_EQ(const_metrics[0].lane(), 1u);
+    EXPECT_TRUE(metrics.is_partitioned());
+    metrics[0] = error_metric(3, 1102, 1, 0.5f, 0.0f);
+    EXPECT_FALSE(metrics.is_partitioned());
+}
+
+TEST(error_metrics_single_test, test_write_text_buffered_matches_write_text)
+{
+    error_metric_set metrics;
+    for(::uint32_t cycle=1;cycle<=25;++cycle)
+    {
+        metrics.insert(error_metric(1, 1101, cycle, 0.1f*static_cast<float>(cycle)/3.0f, 0.0f));
+        metrics.insert(error_metric(2, 2214, cycle, -12345.678f/static_cast<float>(cycle), 0.0f));
+    }
+    const std::vector<std::string> channels;
+    std::ostringstream expected;
+    io::write_text(expected, metrics, channels);
+    for(size_t thread_count=1;thread_count<=3;++thread_count)
+    {
+        std::ostringstream actual;
+        io::write_text_buffered(actual, metrics, channels, thread_count, -1, ',', '\n', '-', 7);
+        EXPECT_EQ(actual.str(), expected.str()) << thread_count;
+    }
+}
+
+/**
+ * @test Ensure the packed record decoder reads more than one block and stops cleanly on a partial record
+ */
+TEST(error_metrics_single_test, test_read_fixed_records_in_blocks)
+{
+    for(::int16_t version=3;version<=5;++version)
+    {
+        error_metric_set expected_metrics(error_metric_set::header_type::default_header(), version);
+        for(::uint32_t tile=1101;tile<=1150;++tile)
+            for(::uint32_t cycle=1;cycle<=101;++cycle)
+                expected_metrics.insert(error_metric(1+tile%2, tile, cycle, 0.01f*static_cast<float>(cycle), 0.5f));
+        std::vector< ::uint8_t > buffer(io::compute_buffer_size(expected_metrics));
+        io::write_interop_to_buffer(expected_metrics, &buffer.front(), buffer.size());
+
+        error_metric_set actual_metrics;
+        io::read_interop_from_buffer(&buffer.front(), buffer.size(), actual_metrics);
+        ASSERT_EQ(actual_metrics.size(), expected_metrics.size()) << version;
+        for(size_t i=0;i<actual_metrics.size();++i)
+        {
+            EXPECT_EQ(actual_metrics.at(i).id(), expected_metrics.at(i).id());
+            EXPECT_EQ(actual_metrics.at(i).error_rate(), expected_metrics.at(i).error_rate());
+        }
+
+        error_metric_set truncated_metrics;
+        EXPECT_THROW(io::read_interop_from_buffer(&buffer.front(), buffer.size()-1, truncated_metrics),
+                     io::incomplete_file_exception);
+        EXPECT_EQ(truncated_metrics.size(), expected_metrics.size()-1) << version;
+    }
+}
+#pragma pack(1)
+/** Packed layout that decodes only the error rate, used to test fixed_record_decoder directly */
+struct fixed_error_rate_layout : public io::default_layout<4>
+{
+    /** Metric ID type */
+    typedef io::layout::base_cycle_metric< ::uint32_t > metric_id_t;
+    /** Packed record */
+    struct fixed_record_t
+    {
+        /** Lane, tile and cycle of the record */
+        metric_id_t id;
+        /** Error rate */
+        float error_rate;
+    };
+    /** Decode a packed record
+     *
+     * @param record packed record
+     * @param metric destination metric
+     */
+    template<class Metric>
+    static void decode(const fixed_record_t& record, Metric& metric)
+    {
+        metric = error_metric(metric.lane(), metric.tile(), metric.cycle(), record.error_rate, 0.0f);
+    }
+};
+#pragma pack()
+
+/**
+ * @test Ensure the packed record decoder skips invalid and unselected records and overwrites a repeated id
+ */
+TEST(error_metrics_single_test, test_fixed_record_decoder)
+{
+    typedef io::fixed_record_decoder<fixed_error_rate_layout> decoder_t;
+    typedef fixed_error_rate_layout::fixed_record_t record_t;
+    typedef fixed_error_rate_layout::metric_id_t id_t;
+    EXPECT_EQ(static_cast<size_t>(decoder_t::RECORD_SIZE), sizeof(::uint16_t)+sizeof(::uint32_t)+sizeof(::uint16_t)+sizeof(float));
+
+    const record_t records[] = {
+            {id_t(1, 1101, 1), 0.1f},
+            {id_t(0, 0, 0), 0.9f},    // invalid
+            {id_t(2, 1101, 1), 0.2f}, // not selected
+            {id_t(1, 1101, 1), 0.3f}, // repeated
+            {id_t(1, 1102, 2), 0.4f}
+    };
+    const size_t record_count = sizeof(records)/sizeof(records[0]);
+    std::vector<char> buffer(record_count*decoder_t::RECORD_SIZE);
+    std::memcpy(&buffer.front(), records, buffer.size());
+
+    error_metric_set metrics;
+    error_metric scratch;
+    io::load_filter filter(io::load_filter::uint_vector_t(1, 1));
+    decoder_t::decode(&buffer.front(), record_count, metrics, metrics.offset_map(), scratch, filter);
+
+    ASSERT_EQ(metrics.size(), 2u);
+    EXPECT_EQ(metrics.offset_map().size(), 2u);
+    EXPECT_EQ(metrics[0].id(), error_metric::create_id(1, 1101, 1));
+    EXPECT_EQ(metrics[0].error_rate(), 0.3f);
+    EXPECT_EQ(metrics[1].id(), error_metric::create_id(1, 1102, 2));
+    EXPECT_EQ(metrics[1].error_rate(), 0.4f);
+}
 
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -11,6 +11,7 @@
 #pragma warning(disable:4127) // MSVC warns about using constants in conditional statements, for template constants
 #endif
 
+#include <sstream>
 #include <gtest/gtest.h>
 #include "interop/io/metric_stream.h"
 #include "interop/io/metric_file_stream.h"
@@ -81,6 +82,17 @@ TYPED_TEST_P(metric_stream_error_test, test_hardcoded_incomplete_file_exception_
             io::incomplete_file_exception) <<metric_set_t::prefix() << metric_set_t::suffix();
 }
 
+/** Confirm incomplete_file_exception is thrown when the stream is shorter than the reported file size
+ */
+TYPED_TEST_P(metric_stream_error_test, test_hardcoded_incomplete_file_exception_short_stream)
+{
+    typedef typename TypeParam::metric_set_t metric_set_t;
+    metric_set_t metrics;
+    std::istringstream in(TestFixture::expected.substr(0, TestFixture::expected.length() - 4));
+    EXPECT_THROW(io::read_metrics(in, metrics, TestFixture::expected.length()),
+            io::incomplete_file_exception) <<metric_set_t::prefix() << metric_set_t::suffix();
+}
+
 // TODO: Add write header test
 
 /** Confirm bad_format_exception is thrown when record size is incorrect
@@ -130,6 +142,7 @@ REGISTER_TYPED_TEST_CASE_P(metric_stream_error_test,
         test_hardcoded_bad_format_exception,
         test_hardcoded_incomplete_file_exception,
         test_hardcoded_incomplete_file_exception_last_metric,
+        test_hardcoded_incomplete_file_exception_short_stream,
         test_hardcoded_incorrect_record_size,
         test_hardcoded_file_not_found,
         test_hardcoded_read
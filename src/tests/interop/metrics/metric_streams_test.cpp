@@ -117,6 +117,61 @@ TYPED_TEST_P(metric_stream_test, test_write_data_size)
     EXPECT_NO_THROW(io::write_interop_to_buffer(metrics, &buffer.front(), buffer.size()));
 }
 
+/** Confirm that records outside the selected tile are skipped while reading
+ */
+TYPED_TEST_P(metric_stream_test, test_read_filtered_tile)
+{
+    typedef typename TypeParam::metric_set_t metric_set_t;
+    metric_set_t expected_metrics;
+    TypeParam::create_expected(expected_metrics);
+    if(expected_metrics.empty()) return;
+    const ::uint32_t tile = static_cast< ::uint32_t >(expected_metrics[0].tile());
+    size_t expected_count = 0;
+    for(size_t i=0;i<expected_metrics.size();++i)
+        if(expected_metrics[i].tile() == tile || expected_metrics[i].tile() == 0) ++expected_count;
+
+    io::load_filter filter;
+    filter.tiles(io::load_filter::uint_vector_t(1, tile));
+    metric_set_t metrics;
+    std::istringstream in(TestFixture::actual);
+    io::read_metrics(in, metrics, TestFixture::actual.size(), true, filter);
+    EXPECT_EQ(expected_count, metrics.size());
+    for(size_t i=0;i<metrics.size();++i)
+        EXPECT_TRUE(metrics[i].tile() == tile || metrics[i].tile() == 0);
+}
+
+/** Confirm that a filter that selects nothing reads an empty metric set without error
+ */
+TYPED_TEST_P(metric_stream_test, test_read_filtered_lane_empty)
+{
+    typename TypeParam::metric_set_t metrics;
+    const io::load_filter filter(io::load_filter::uint_vector_t(1, 63));
+    std::istringstream in(TestFixture::actual);
+    io::read_metrics(in, metrics, TestFixture::actual.size(), true, filter);
+    EXPECT_EQ(0u, metrics.size());
+}
+
+TEST(metric_stream_test, load_filter_cycle_range)
+{
+    const io::load_filter filter(io::load_filter::uint_vector_t(), 2, 3);
+    EXPECT_TRUE(filter.is_active());
+    EXPECT_FALSE(filter.is_cycle_selected(1));
+    EXPECT_TRUE(filter.is_cycle_selected(2));
+    EXPECT_TRUE(filter.is_cycle_selected(3));
+    EXPECT_FALSE(filter.is_cycle_selected(4));
+    EXPECT_FALSE(filter.is_cycle_file_selected<model::metric_base::metric_set<model::metrics::error_metric> >(1));
+    EXPECT_TRUE(filter.is_cycle_file_selected<model::metric_base::metric_set<model::metrics::tile_metric> >(1));
+}
+
+TEST(metric_stream_test, load_filter_surface)
+{
+    io::load_filter filter;
+    filter.surface(2, constants::FourDigit);
+    EXPECT_FALSE(filter.is_tile_selected(1114));
+    EXPECT_TRUE(filter.is_tile_selected(2114));
+    EXPECT_TRUE(filter.is_tile_selected(0));
+}
+
 TEST(metric_stream_test, list_filenames)
 {
     std::vector<std::string> error_metric_files;
@@ -161,7 +216,9 @@ REGISTER_TYPED_TEST_CASE_P(metric_stream_test,
                            test_read_data_size,
                            test_header_size,
                            test_write_read_binary_data,
-                           test_write_data_size
+                           test_write_data_size,
+                           test_read_filtered_tile,
+                           test_read_filtered_lane_empty
 );
 
 
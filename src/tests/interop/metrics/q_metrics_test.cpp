@@ -172,6 +172,67 @@ TEST(q_metrics_test, test_cumulative_reorder)
     EXPECT_EQ(q_metric_set[3].sum_qscore_cumulative(), qsum);
 }
 
+TEST(q_metrics_test, test_derive_q_metrics_matches_separate_passes)
+{
+    q_metric_set expected;
+    q_metric_v6::create_expected(expected);
+    metric_set<q_collapsed_metric> expected_collapsed;
+    metric_set<q_by_lane_metric> expected_bylane;
+    logic::metric::create_collapse_q_metrics(expected, expected_collapsed);
+    logic::metric::create_q_metrics_by_lane(expected, expected_bylane, constants::HiSeq);
+    logic::metric::populate_cumulative_distribution(expected);
+    logic::metric::populate_cumulative_distribution(expected_collapsed);
+    logic::metric::populate_cumulative_distribution(expected_bylane);
+
+    q_metric_set actual;
+    q_metric_v6::create_expected(actual);
+    metric_set<q_collapsed_metric> actual_collapsed;
+    metric_set<q_by_lane_metric> actual_bylane;
+    ASSERT_TRUE(logic::metric::derive_q_metrics(actual, actual_collapsed, actual_bylane, constants::HiSeq));
+
+    ASSERT_EQ(actual.size(), expected.size());
+    for(size_t i=0;i<actual.size();++i)
+    {
+        EXPECT_EQ(actual[i].id(), expected[i].id());
+        EXPECT_EQ(actual[i].sum_qscore_cumulative(), expected[i].sum_qscore_cumulative());
+    }
+    ASSERT_EQ(actual_collapsed.size(), expected_collapsed.size());
+    for(size_t i=0;i<actual_collapsed.size();++i)
+    {
+        EXPECT_EQ(actual_collapsed[i].id(), expected_collapsed[i].id());
+        EXPECT_EQ(actual_collapsed[i].q30(), expected_collapsed[i].q30());
+        EXPECT_EQ(actual_collapsed[i].median_qscore(), expected_collapsed[i].median_qscore());
+        EXPECT_EQ(actual_collapsed[i].cumulative_q30(), expected_collapsed[i].cumulative_q30());
+        EXPECT_EQ(actual_collapsed[i].cumulative_total(), expected_collapsed[i].cumulative_total());
+    }
+    ASSERT_EQ(actual_bylane.size(), expected_bylane.size());
+    for(size_t i=0;i<actual_bylane.size();++i)
+    {
+        EXPECT_EQ(actual_bylane[i].id(), expected_bylane[i].id());
+        EXPECT_EQ(actual_bylane[i].sum_qscore(), expected_bylane[i].sum_qscore());
+        EXPECT_EQ(actual_bylane[i].sum_qscore_cumulative(), expected_bylane[i].sum_qscore_cumulative());
+    }
+    EXPECT_EQ(actual_collapsed.get_metric(expected[0].id()).q20(), expected_collapsed[0].q20());
+}
+
+TEST(q_metrics_test, test_derive_q_metrics_out_of_order)
+{
+    typedef q_metric::uint_t uint_t;
+    typedef metric_test<q_metric, 0> helper_t;
+    uint_t hist1[] = {0, 267962, 118703, 4284, 2796110, 0, 0};
+    uint_t hist2[] = {0, 241483, 44960, 1100, 2899568, 0 ,0};
+
+    std::vector<q_metric> q_metric_vec;
+    q_metric_vec.push_back(q_metric(7, 1114, 2, helper_t::to_vector(hist2)));
+    q_metric_vec.push_back(q_metric(7, 1114, 1, helper_t::to_vector(hist1)));
+    metric_set<q_metric> q_metric_set(q_metric_vec, 6, q_metric::header_type());
+    metric_set<q_collapsed_metric> collapsed;
+    metric_set<q_by_lane_metric> bylane;
+    EXPECT_FALSE(logic::metric::derive_q_metrics(q_metric_set, collapsed, bylane, constants::HiSeq));
+    EXPECT_EQ(collapsed.size(), 0u);
+    EXPECT_EQ(bylane.size(), 0u);
+}
+
 TEST(q_metrics_test, test_percent_over_q30_unbinned)
 {
     q_score_header header;
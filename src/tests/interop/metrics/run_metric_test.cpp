@@ -8,10 +8,19 @@
  */
 
 
+#include <cstdio>
+#include <fstream>
+#include <iterator>
 #include <gtest/gtest.h>
 #include "src/tests/interop/metrics/inc/metric_format_fixtures.h"
 #include "interop/logic/utils/metrics_to_load.h"
 #include "interop/logic/table/create_imaging_table.h"
+#include "interop/util/filesystem.h"
+#include "interop/io/compressed_file.h"
+#include "interop/io/bundle.h"
+#include "interop/io/record_index.h"
+#include "interop/io/batch_file_reader.h"
+#include "src/tests/interop/run/info_test.h"
 
 
 using namespace illumina::interop;
@@ -104,6 +113,675 @@ TEST(run_metric_test, summary_subset_of_imaging)
     }
 }
 
+/** Write a small run folder with error, tile and q-metrics
+ *
+ * @param name name of the run folder in the temporary directory
+ * @param written metrics written to the run folder
+ * @return path to the run folder
+ */
+static std::string write_run_folder(const std::string& name, model::metrics::run_metrics& written)
+{
+    typedef model::run::info::str_vector_t str_vector_t;
+    const std::string run_folder = io::combine(::testing::TempDir(), name);
+    io::mkdir(run_folder);
+    io::mkdir(io::combine(run_folder, "InterOp"));
+
+    model::run::info::read_vector_t reads(1, model::run::read_info(1, 1, 3));
+    const model::run::flowcell_layout layout(8, 2, 2, 14, 1, 1, str_vector_t(), constants::FourDigit);
+    written = model::metrics::run_metrics(model::run::info(layout, reads, str_vector_t(2, "Red")));
+    error_metric_v3::create_expected(written.get<model::metrics::error_metric>());
+    tile_metric_v2::create_expected(written.get<model::metrics::tile_metric>());
+    q_metric_v6::create_expected(written.get<model::metrics::q_metric>());
+    written.write_metrics(run_folder);
+    written.run_info().write(io::combine(run_folder, "RunInfo.xml"));
+    return run_folder;
+}
+
+/** Confirm two error metric sets hold the same records in the same order
+ *
+ * @param expected expected error metrics
+ * @param actual actual error metrics
+ * @param trace message identifying the comparison
+ */
+static void expect_equal_error_metrics(const model::metric_base::metric_set<model::metrics::error_metric>& expected,
+                                       const model::metric_base::metric_set<model::metrics::error_metric>& actual,
+                                       const std::string& trace="")
+{
+    SCOPED_TRACE(trace);
+    ASSERT_EQ(expected.size(), actual.size());
+    for(size_t i=0;i<expected.size();++i)
+    {
+        EXPECT_EQ(expected[i].id(), actual[i].id());
+        EXPECT_EQ(expected[i].error_rate(), actual[i].error_rate());
+    }
+}
+
+/** Confirm two runs hold the same error metrics, and the same number of tile and q-metrics
+ *
+ * @param expected expected run metrics
+ * @param actual actual run metrics
+ * @param trace message identifying the comparison
+ */
+static void expect_equal_run_metrics(const model::metrics::run_metrics& expected,
+                                     const model::metrics::run_metrics& actual,
+                                     const std::string& trace="")
+{
+    expect_equal_error_metrics(expected.get<model::metrics::error_metric>(),
+                               actual.get<model::metrics::error_metric>(),
+                               trace);
+    SCOPED_TRACE(trace);
+    EXPECT_EQ(expected.get<model::metrics::tile_metric>().size(), actual.get<model::metrics::tile_metric>().size());
+    EXPECT_EQ(expected.get<model::metrics::q_metric>().size(), actual.get<model::metrics::q_metric>().size());
+}
+
+/** Confirm that lazy loading only reads the metric groups that are loaded */
+TEST(run_metric_test, read_lazy)
+{
+    model::metrics::run_metrics written;
+    const std::string run_folder = write_run_folder("run_metric_test_read_lazy", written);
+
+    model::metrics::run_metrics metrics;
+    metrics.read_lazy(run_folder);
+    EXPECT_TRUE(metrics.is_lazy());
+    EXPECT_TRUE(metrics.is_group_empty(constants::Error));
+    EXPECT_TRUE(metrics.is_group_empty(constants::Tile));
+
+    const model::metrics::run_metrics& const_metrics = metrics;
+    EXPECT_TRUE(const_metrics.get<model::metrics::error_metric>().empty());
+    metrics.load(constants::Error);
+    EXPECT_EQ(written.get<model::metrics::error_metric>().size(),
+              const_metrics.get<model::metrics::error_metric>().size());
+    EXPECT_FALSE(metrics.is_group_empty(constants::Error));
+    EXPECT_TRUE(metrics.is_group_empty(constants::Tile));
+    EXPECT_EQ(1u, metrics.catalog().tile_count(model::metrics::tile_catalog::group_vector_t(1, constants::Error), 7));
+
+    metrics.load(constants::Tile);
+    EXPECT_EQ(written.get<model::metrics::tile_metric>().size(), metrics.get<model::metrics::tile_metric>().size());
+    EXPECT_TRUE(metrics.is_group_empty(constants::Q));
+    EXPECT_TRUE(metrics.is_group_empty(constants::QCollapsed));
+
+    metrics.load(constants::QCollapsed);
+    EXPECT_EQ(written.get<model::metrics::q_metric>().size(), metrics.get<model::metrics::q_collapsed_metric>().size());
+    EXPECT_FALSE(metrics.is_group_empty(constants::Q));
+    EXPECT_EQ(written.get<model::metrics::error_metric>().size(), metrics.get<model::metrics::error_metric>().size());
+
+    metrics.clear();
+    EXPECT_FALSE(metrics.is_lazy());
+    EXPECT_TRUE(metrics.get<model::metrics::tile_metric>().empty());
+}
+
+/** Confirm that only the selected tiles and cycles are read */
+TEST(run_metric_test, read_filtered)
+{
+    model::metrics::run_metrics written;
+    const std::string run_folder = write_run_folder("run_metric_test_read_filtered", written);
+
+    io::load_filter filter(io::load_filter::uint_vector_t(1, 7), 2, 3);
+    filter.tiles(io::load_filter::uint_vector_t(1, 1114));
+    model::metrics::run_metrics metrics;
+    metrics.read(run_folder, filter);
+
+    const model::metric_base::metric_set<model::metrics::error_metric>& error_metrics =
+            metrics.get<model::metrics::error_metric>();
+    ASSERT_EQ(2u, error_metrics.size());
+    for(size_t i=0;i<error_metrics.size();++i)
+    {
+        EXPECT_EQ(1114u, error_metrics[i].tile());
+        EXPECT_GE(error_metrics[i].cycle(), 2u);
+    }
+    ASSERT_EQ(1u, metrics.get<model::metrics::tile_metric>().size());
+    EXPECT_EQ(1114u, metrics.get<model::metrics::tile_metric>()[0].tile());
+}
+
+/** Confirm that the cumulative q-metrics of a filter that starts after the first cycle match a full read */
+TEST(run_metric_test, read_filtered_cumulative_q)
+{
+    typedef model::metric_base::metric_set<model::metrics::q_collapsed_metric> q_collapsed_metric_set_t;
+    model::metrics::run_metrics written;
+    const std::string run_folder = write_run_folder("run_metric_test_read_filtered_cumulative_q", written);
+
+    model::metrics::run_metrics expected;
+    expected.read(run_folder);
+    model::metrics::run_metrics actual;
+    actual.read(run_folder, io::load_filter(io::load_filter::uint_vector_t(), 2, 0));
+
+    ASSERT_EQ(2u, actual.get<model::metrics::q_metric>().size());
+    for(size_t i=0;i<actual.get<model::metrics::q_metric>().size();++i)
+        EXPECT_GE(actual.get<model::metrics::q_metric>()[i].cycle(), 2u);
+    const q_collapsed_metric_set_t& expected_collapsed = expected.get<model::metrics::q_collapsed_metric>();
+    const q_collapsed_metric_set_t& actual_collapsed = actual.get<model::metrics::q_collapsed_metric>();
+    ASSERT_EQ(2u, actual_collapsed.size());
+    for(size_t i=0;i<actual_collapsed.size();++i)
+    {
+        // The full read has one more cycle before the selection
+        const model::metrics::q_collapsed_metric& full = expected_collapsed[i+1];
+        EXPECT_EQ(full.id(), actual_collapsed[i].id());
+        EXPECT_EQ(full.cumulative_q30(), actual_collapsed[i].cumulative_q30());
+        EXPECT_EQ(full.cumulative_total(), actual_collapsed[i].cumulative_total());
+    }
+    EXPECT_EQ(expected.get<model::metrics::q_metric>()[1].sum_qscore_cumulative(),
+              actual.get<model::metrics::q_metric>()[0].sum_qscore_cumulative());
+}
+
+/** Confirm that reading through the sidecar record index matches a filtered read, and that the index follows
+ * changes to the InterOp file
+ */
+TEST(run_metric_test, read_indexed)
+{
+    typedef model::metric_base::metric_set<model::metrics::error_metric> error_metric_set_t;
+    model::metrics::run_metrics written;
+    const std::string run_folder = write_run_folder("run_metric_test_read_indexed", written);
+    const std::string file_name = io::interop_filename<error_metric_set_t>(run_folder);
+    std::remove(io::record_index_filename(file_name).c_str());
+
+    io::load_filter filter(io::load_filter::uint_vector_t(1, 7), 2, 3);
+    filter.tiles(io::load_filter::uint_vector_t(1, 1114));
+    model::metrics::run_metrics expected;
+    expected.read(run_folder, filter);
+    for(int pass=0;pass<2;++pass)
+    {
+        model::metrics::run_metrics actual;
+        actual.read_indexed(run_folder, filter);
+        EXPECT_GE(io::file_size(io::record_index_filename(file_name)), 0) << pass;
+        expect_equal_run_metrics(expected, actual, pass == 0 ? "index built" : "index read");
+    }
+
+    // The error metrics are read through the index, the tile metrics cannot be indexed and are read in full
+    error_metric_set_t indexed_error;
+    EXPECT_TRUE(io::read_interop_indexed(run_folder, indexed_error, filter));
+    expect_equal_error_metrics(expected.get<model::metrics::error_metric>(), indexed_error);
+    model::metric_base::metric_set<model::metrics::tile_metric> tile_metrics;
+    EXPECT_FALSE(io::read_interop_indexed(run_folder, tile_metrics, filter));
+    EXPECT_EQ(expected.get<model::metrics::tile_metric>().size(), tile_metrics.size());
+
+    error_metric_set_t changed(written.get<model::metrics::error_metric>(),
+                               written.get<model::metrics::error_metric>().version());
+    changed.insert(model::metrics::error_metric(7, 1114, 3, 0.25f, 0.0f));
+    io::write_interop(run_folder, changed);
+    error_metric_set_t actual_error;
+    EXPECT_TRUE(io::read_interop_indexed(run_folder, actual_error, filter));
+    ASSERT_EQ(1u, actual_error.size());
+    EXPECT_EQ(0.25f, actual_error[0].error_rate());
+
+    io::record_index index;
+    ASSERT_TRUE(index.read(io::record_index_filename(file_name)));
+    EXPECT_TRUE(index.is_current(file_name));
+    EXPECT_EQ(changed.size(), index.size());
+}
+
+/** Confirm that the records selected by a binary search of the index match a scan of every entry, for both a built
+ * index and a saved index
+ */
+TEST(run_metric_test, record_index_select)
+{
+    typedef model::metric_base::metric_set<model::metrics::error_metric> error_metric_set_t;
+    typedef model::metric_base::metric_set<model::metrics::tile_metric> tile_metric_set_t;
+    const ::uint32_t tiles[] = {1201, 1101, 1102};
+    io::record_index index;
+    index.reset(0, 0, 8, 12);
+    ::uint64_t record = 0;
+    for(::uint32_t cycle=5;cycle>0;--cycle)
+        for(::uint32_t lane=1;lane<=3;++lane)
+            for(size_t t=0;t<3;++t)
+                index.add(lane, tiles[t], cycle, record++);
+    index.sort();
+    const std::string file_name = io::combine(::testing::TempDir(), "run_metric_test_record_index_select.idx");
+    ASSERT_TRUE(index.write(file_name));
+    io::record_index saved;
+    ASSERT_TRUE(saved.read(file_name));
+    ASSERT_EQ(index.size(), saved.size());
+
+    std::vector<io::load_filter> filters(5);
+    filters[1].lanes(io::load_filter::uint_vector_t(1, 2));
+    filters[2].tiles(io::load_filter::uint_vector_t(1, 1102));
+    filters[2].cycle_range(2, 4);
+    filters[3].lanes(io::load_filter::uint_vector_t(1, 3));
+    filters[3].cycle_range(5, 0);
+    filters[4].tiles(io::load_filter::uint_vector_t(1, 1301));
+    for(size_t f=0;f<filters.size();++f)
+    {
+        io::record_index::record_vector_t expected;
+        for(size_t i=0;i<index.size();++i)
+        {
+            const io::record_index::entry e = index.at(i);
+            if(filters[f].is_lane_selected(e.lane) && filters[f].is_tile_selected(e.tile) &&
+               filters[f].is_cycle_selected(e.cycle)) expected.push_back(e.record);
+        }
+        std::sort(expected.begin(), expected.end());
+        io::record_index::record_vector_t actual;
+        index.select<error_metric_set_t>(filters[f], actual);
+        EXPECT_EQ(expected, actual) << f;
+        saved.select<error_metric_set_t>(filters[f], actual);
+        EXPECT_EQ(expected, actual) << f;
+    }
+    // Metrics without a cycle ignore the cycle range
+    io::record_index::record_vector_t actual;
+    saved.select<tile_metric_set_t>(filters[3], actual);
+    EXPECT_EQ(15u, actual.size());
+    saved.close();
+    EXPECT_EQ(0u, saved.size());
+    std::remove(file_name.c_str());
+}
+
+/** Confirm that cycle files read by a pool of threads match cycle files read one at a time */
+TEST(run_metric_test, read_by_cycle_batched)
+{
+    typedef model::metric_base::metric_set<model::metrics::error_metric> error_metric_set_t;
+    const std::string run_folder = io::combine(::testing::TempDir(), "run_metric_test_read_by_cycle_batched");
+    io::mkdir(run_folder);
+    io::mkdir(io::combine(run_folder, "InterOp"));
+    error_metric_set_t written;
+    error_metric_v3::create_expected(written);
+    const size_t last_cycle = 4;
+    for(size_t cycle=1;cycle < last_cycle;++cycle)
+    {
+        error_metric_set_t cycle_metrics(written.version());
+        for(size_t i=0;i<written.size();++i)
+            if(written[i].cycle() == cycle) cycle_metrics.insert(written[i]);
+        const std::string file_name = io::interop_filename<error_metric_set_t>(run_folder, cycle);
+        io::mkdir(io::dirname(file_name));
+        std::ofstream fout(file_name.c_str(), std::ios::binary);
+        io::write_metrics(fout, cycle_metrics, cycle_metrics.version());
+    }
+
+    error_metric_set_t expected;
+    io::read_interop_by_cycle(run_folder, expected, last_cycle);
+    EXPECT_EQ(written.size(), expected.size());
+    error_metric_set_t actual;
+    io::read_interop_by_cycle(run_folder, actual, last_cycle, true, io::load_filter(), 3);
+    expect_equal_error_metrics(expected, actual);
+
+    std::vector<std::string> files;
+    files.push_back(io::interop_filename<error_metric_set_t>(run_folder, static_cast<size_t>(1)));
+    files.push_back(io::interop_filename<error_metric_set_t>(run_folder, last_cycle));
+    std::vector< std::vector<char> > buffers;
+    std::vector<unsigned char> exists;
+    io::read_files(files, buffers, exists, 2);
+    ASSERT_EQ(2u, exists.size());
+    EXPECT_EQ(1, exists[0]);
+    EXPECT_EQ(io::file_size(files[0]), static_cast< ::int64_t >(buffers[0].size()));
+    EXPECT_EQ(0, exists[1]);
+    EXPECT_TRUE(buffers[1].empty());
+
+    for(size_t cycle=2;cycle < last_cycle;++cycle)
+        files.push_back(io::interop_filename<error_metric_set_t>(run_folder, cycle));
+    io::read_files(files, buffers, exists, 1);
+    for(size_t thread_count=1;thread_count <= 3;++thread_count)
+    {
+        io::batch_file_reader reader(files, thread_count);
+        std::vector<char> buffer;
+        for(size_t i=0;i<files.size();++i)
+        {
+            EXPECT_EQ(exists[i] != 0, reader.next(buffer)) << files[i];
+            EXPECT_EQ(buffers[i], buffer) << files[i];
+        }
+        EXPECT_FALSE(reader.next(buffer));
+        EXPECT_TRUE(buffer.empty());
+    }
+    io::batch_file_reader early_stop(files, 2);
+    std::vector<char> buffer;
+    EXPECT_TRUE(early_stop.next(buffer));
+}
+
+/** Append a little endian integer to a byte string
+ *
+ * @param out destination byte string
+ * @param val integer value
+ * @param n number of bytes
+ */
+static void append_le(std::string& out, const size_t val, const size_t n)
+{
+    for(size_t i=0;i<n;++i) out += static_cast<char>((val >> (8*i)) & 0xff);
+}
+
+/** Read a little endian integer from a byte string
+ *
+ * @param data byte string
+ * @param offset offset of the first byte
+ * @param n number of bytes
+ * @return integer value
+ */
+static size_t parse_le(const std::string& data, const size_t offset, const size_t n)
+{
+    size_t val = 0;
+    for(size_t i=n;i>0;--i) val = (val << 8) | static_cast<unsigned char>(data[offset+i-1]);
+    return val;
+}
+
+/** Wrap data in a gzip member made of a single stored deflate block
+ *
+ * @param data at most 65535 bytes of data
+ * @param is_bgzf add the BGZF block size extra field
+ * @return gzip member
+ */
+static std::string gzip_stored_member(const std::string& data, const bool is_bgzf)
+{
+    ::uint32_t crc = 0xffffffffu;
+    for(size_t i=0;i<data.size();++i)
+    {
+        crc ^= static_cast<unsigned char>(data[i]);
+        for(int bit=0;bit<8;++bit) crc = (crc >> 1) ^ (0xedb88320u & (0u - (crc & 1u)));
+    }
+    std::string member("\x1f\x8b\x08", 3);
+    member += static_cast<char>(is_bgzf ? 4 : 0);
+    append_le(member, 0, 4);
+    member += '\0';
+    member += '\xff';
+    const size_t block_size_offset = member.size() + 6;
+    if(is_bgzf)
+    {
+        append_le(member, 6, 2);
+        member += "BC";
+        append_le(member, 2, 2);
+        append_le(member, 0, 2);
+    }
+    member += '\x01';
+    append_le(member, data.size(), 2);
+    append_le(member, ~data.size() & 0xffff, 2);
+    member += data;
+    append_le(member, ~crc, 4);
+    append_le(member, data.size(), 4);
+    if(is_bgzf)
+    {
+        member[block_size_offset] = static_cast<char>((member.size()-1) & 0xff);
+        member[block_size_offset+1] = static_cast<char>((member.size()-1) >> 8);
+    }
+    return member;
+}
+
+/** Confirm that a gzip compressed InterOp file is read in place of a missing binary file */
+TEST(run_metric_test, read_gzip_compressed)
+{
+    typedef model::metric_base::metric_set<model::metrics::error_metric> error_metric_set_t;
+    if(!io::is_compression_supported(".gz")) return;
+    model::metrics::run_metrics written;
+    const std::string run_folder = write_run_folder("run_metric_test_read_gzip_compressed", written);
+    const std::string file_name = io::interop_filename<error_metric_set_t>(run_folder);
+    std::string raw;
+    {
+        std::ifstream fin(file_name.c_str(), std::ios::binary);
+        raw.assign(std::istreambuf_iterator<char>(fin), std::istreambuf_iterator<char>());
+    }
+    ASSERT_FALSE(raw.empty());
+    std::remove(file_name.c_str());
+
+    const std::string single_member = gzip_stored_member(raw, false);
+    const std::string bgzf = gzip_stored_member(raw.substr(0, raw.size()/2), true) +
+                             gzip_stored_member(raw.substr(raw.size()/2), true) +
+                             gzip_stored_member("", true);
+    const std::string compressed_files[] = {single_member, bgzf};
+    for(size_t i=0;i<2;++i)
+    {
+        {
+            std::ofstream fout((file_name+".gz").c_str(), std::ios::binary);
+            fout.write(compressed_files[i].c_str(), static_cast<std::streamsize>(compressed_files[i].size()));
+        }
+        model::metrics::run_metrics metrics;
+        metrics.read(run_folder, 2);
+        expect_equal_run_metrics(written, metrics, i == 0 ? "gzip" : "bgzf");
+    }
+    {
+        std::ofstream fout((file_name+".gz").c_str(), std::ios::binary);
+        fout.write(single_member.c_str(), static_cast<std::streamsize>(single_member.size()-3));
+    }
+    error_metric_set_t truncated;
+    EXPECT_THROW(io::read_interop(run_folder, truncated), io::incomplete_file_exception);
+
+    std::string corrupt = single_member;
+    corrupt[corrupt.size()-5] ^= 0x1; // Bad checksum
+    {
+        std::ofstream fout((file_name+".gz").c_str(), std::ios::binary);
+        fout.write(corrupt.c_str(), static_cast<std::streamsize>(corrupt.size()));
+    }
+    error_metric_set_t corrupted;
+    EXPECT_THROW(io::read_interop(run_folder, corrupted), io::bad_format_exception);
+}
+
+/** Confirm that a compressed file larger than one chunk is streamed in order, with and without splitting members */
+TEST(run_metric_test, stream_compressed_file)
+{
+    if(!io::is_compression_supported(".gz")) return;
+    std::string raw;
+    for(size_t i=0;raw.size() < (3u << 20);++i) raw += static_cast<char>((i*7919) % 251);
+    const size_t member_size = 60000;
+    std::string bgzf;
+    std::string gzip;
+    for(size_t offset=0;offset<raw.size();offset+=member_size)
+    {
+        bgzf += gzip_stored_member(raw.substr(offset, member_size), true);
+        gzip += gzip_stored_member(raw.substr(offset, member_size), false);
+    }
+    bgzf += gzip_stored_member("", true);
+    const std::string compressed_files[] = {bgzf, gzip};
+    const std::string file_name = io::combine(::testing::TempDir(), "run_metric_test_stream_compressed_file.gz");
+    for(size_t i=0;i<2;++i)
+    {
+        {
+            std::ofstream fout(file_name.c_str(), std::ios::binary);
+            fout.write(compressed_files[i].c_str(), static_cast<std::streamsize>(compressed_files[i].size()));
+        }
+        for(size_t thread_count=1;thread_count<=2;++thread_count)
+        {
+            io::compressed_filebuf sbuf(file_name, thread_count);
+            std::istream in(&sbuf);
+            const std::string actual((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+            EXPECT_TRUE(actual == raw) << i << " " << thread_count;
+            EXPECT_TRUE(sbuf.is_complete());
+            EXPECT_EQ("", sbuf.error());
+        }
+        {
+            // Stop reading part way through the file
+            io::compressed_filebuf sbuf(file_name, 2);
+            std::istream in(&sbuf);
+            std::vector<char> head(1024);
+            in.read(&head.front(), static_cast<std::streamsize>(head.size()));
+            EXPECT_TRUE(std::equal(head.begin(), head.end(), raw.begin()));
+        }
+    }
+    std::remove(file_name.c_str());
+}
+
+/** Confirm that a bundle holds the same metrics as the run folder it was written from */
+TEST(run_metric_test, read_bundle)
+{
+    typedef model::metric_base::metric_set<model::metrics::error_metric> error_metric_set_t;
+    model::metrics::run_metrics written;
+    const std::string run_folder = write_run_folder("run_metric_test_read_bundle", written);
+    model::metrics::run_metrics expected;
+    expected.read(run_folder);
+
+    const std::string bundle_file = io::combine(::testing::TempDir(), "run_metric_test_read_bundle.bundle");
+    expected.write_bundle(bundle_file, run_folder);
+    model::metrics::run_metrics actual;
+    actual.read_bundle(bundle_file);
+    EXPECT_EQ(expected.run_info().total_cycles(), actual.run_info().total_cycles());
+    expect_equal_run_metrics(expected, actual);
+    EXPECT_EQ(expected.get<model::metrics::q_collapsed_metric>().size(),
+              actual.get<model::metrics::q_collapsed_metric>().size());
+
+    // Every section in the table of contents starts on a page boundary and holds a copy of its file
+    const std::string copy_folder = io::combine(::testing::TempDir(), "run_metric_test_read_bundle_copy");
+    io::mkdir(copy_folder);
+    io::mkdir(io::combine(copy_folder, "InterOp"));
+    expected.write_metrics(copy_folder);
+    std::string raw;
+    {
+        std::ifstream fin(bundle_file.c_str(), std::ios::binary);
+        raw.assign(std::istreambuf_iterator<char>(fin), std::istreambuf_iterator<char>());
+    }
+    ASSERT_GE(raw.size(), 16u);
+    EXPECT_EQ("IOPBNDL1", raw.substr(0, 8));
+    io::bundle_reader reader;
+    reader.open(bundle_file);
+    std::vector<std::string> names;
+    reader.list_sections(names);
+    EXPECT_EQ(parse_le(raw, 12, 4), names.size());
+    EXPECT_TRUE(reader.contains(io::paths::run_info()));
+    EXPECT_TRUE(reader.contains(io::interop_filename<error_metric_set_t>("")));
+    size_t position = 16;
+    for(size_t i=0;i<names.size() && position + 4 <= raw.size();++i)
+    {
+        const size_t name_length = parse_le(raw, position, 4);
+        ASSERT_LE(position + 4 + name_length + 16, raw.size());
+        const std::string name = raw.substr(position + 4, name_length);
+        const size_t offset = parse_le(raw, position + 4 + name_length, 8);
+        const size_t section_size = parse_le(raw, position + 4 + name_length + 8, 8);
+        position += 4 + name_length + 16;
+        EXPECT_EQ(0u, offset % io::bundle_writer::SECTION_ALIGNMENT) << name;
+        const char* data;
+        size_t size;
+        ASSERT_TRUE(reader.find(name, data, size)) << name;
+        EXPECT_EQ(section_size, size) << name;
+        const bool is_interop = name.compare(0, 8, "InterOp/") == 0;
+        std::ifstream fin(io::combine(is_interop ? copy_folder : run_folder, name).c_str(), std::ios::binary);
+        const std::string file((std::istreambuf_iterator<char>(fin)), std::istreambuf_iterator<char>());
+        EXPECT_TRUE(file == std::string(data, size)) << name;
+    }
+    reader.close();
+
+    // By cycle sections are read only when no aggregated section is found
+    io::bundle_writer by_cycle;
+    by_cycle.add_file("RunInfo.xml", io::combine(run_folder, "RunInfo.xml"));
+    by_cycle.add_file(io::interop_filename<error_metric_set_t>("", static_cast<size_t>(1)),
+                      io::interop_filename<error_metric_set_t>(run_folder));
+    by_cycle.write(bundle_file);
+    model::metrics::run_metrics by_cycle_metrics;
+    by_cycle_metrics.read_bundle(bundle_file);
+    EXPECT_EQ(expected.get<model::metrics::error_metric>().size(),
+              by_cycle_metrics.get<model::metrics::error_metric>().size());
+    EXPECT_TRUE(by_cycle_metrics.get<model::metrics::tile_metric>().empty());
+
+    EXPECT_THROW(actual.read_bundle(io::combine(run_folder, "RunInfo.xml")), io::bad_format_exception);
+    EXPECT_THROW(actual.read_bundle(bundle_file + ".missing"), io::file_not_found_exception);
+}
+
+/** Confirm that low memory mode derives the aggregate q-metrics without the per tile cumulative histograms */
+TEST(run_metric_test, read_low_memory)
+{
+    model::metrics::run_metrics written;
+    const std::string run_folder = write_run_folder("run_metric_test_read_low_memory", written);
+
+    model::metrics::run_metrics metrics;
+    metrics.low_memory(true);
+    metrics.read(run_folder);
+    EXPECT_TRUE(metrics.low_memory());
+    const model::metric_base::metric_set<model::metrics::q_metric>& q_metrics = metrics.get<model::metrics::q_metric>();
+    ASSERT_EQ(written.get<model::metrics::q_metric>().size(), q_metrics.size());
+    for(size_t i=0;i<q_metrics.size();++i)
+        EXPECT_TRUE(q_metrics[i].is_cumulative_empty());
+
+    model::metrics::run_metrics expected;
+    expected.read(run_folder);
+    const model::metric_base::metric_set<model::metrics::q_collapsed_metric>& expected_collapsed =
+            expected.get<model::metrics::q_collapsed_metric>();
+    const model::metric_base::metric_set<model::metrics::q_collapsed_metric>& actual_collapsed =
+            metrics.get<model::metrics::q_collapsed_metric>();
+    ASSERT_EQ(expected_collapsed.size(), actual_collapsed.size());
+    for(size_t i=0;i<expected_collapsed.size();++i)
+        EXPECT_EQ(expected_collapsed[i].cumulative_q30(), actual_collapsed[i].cumulative_q30());
+    EXPECT_EQ(expected.get<model::metrics::q_by_lane_metric>().size(),
+              metrics.get<model::metrics::q_by_lane_metric>().size());
+    EXPECT_FALSE(expected.get<model::metrics::q_metric>()[0].is_cumulative_empty());
+}
+
+/** Confirm that reading a run folder partitions each metric set by lane and cycle */
+TEST(run_metric_test, read_partitions_metric_sets)
+{
+    model::metrics::run_metrics written;
+    const std::string run_folder = write_run_folder("run_metric_test_read_partitions", written);
+    model::metrics::run_metrics metrics;
+    metrics.read(run_folder);
+
+    const model::metrics::run_metrics& const_metrics = metrics;
+    const model::metric_base::metric_set<model::metrics::error_metric>& error_metrics =
+            const_metrics.get<model::metrics::error_metric>();
+    ASSERT_TRUE(error_metrics.is_partitioned());
+    EXPECT_TRUE(const_metrics.get<model::metrics::tile_metric>().is_partitioned());
+    EXPECT_TRUE(const_metrics.get<model::metrics::q_collapsed_metric>().is_partitioned());
+    EXPECT_TRUE(metrics.is_catalog_current());
+    for(model::metrics::error_metric::uint_t lane=1;lane<=metrics.run_info().flowcell().lane_count();++lane)
+    {
+        model::metric_base::metric_set<model::metrics::error_metric>::const_range_t range =
+                error_metrics.lane_range(lane);
+        EXPECT_EQ(error_metrics.record_count_for_lane(lane), static_cast<size_t>(range.second-range.first));
+    }
+    metrics.get<model::metrics::error_metric>().begin();
+    EXPECT_FALSE(error_metrics.is_partitioned());
+}
+
+/** Confirm that the tile catalog matches a scan of each metric set, and follows changes to the metric sets */
+TEST(run_metric_test, tile_catalog)
+{
+    model::metrics::run_metrics written;
+    const std::string run_folder = write_run_folder("run_metric_test_tile_catalog", written);
+    model::metrics::run_metrics metrics;
+    metrics.read(run_folder);
+
+    const constants::tile_naming_method naming_method = metrics.run_info().flowcell().naming_method();
+    model::metrics::tile_catalog::group_vector_t groups(1, constants::Error);
+    for(model::metrics::tile_catalog::uint_t lane=1;lane<=metrics.run_info().flowcell().lane_count();++lane)
+    {
+        for(model::metrics::tile_catalog::uint_t surface=1;surface<=2;++surface)
+        {
+            model::metrics::run_metrics::id_set_t expected;
+            metrics.get<model::metrics::error_metric>().populate_tile_numbers_for_lane_surface(expected,
+                                                                                              lane,
+                                                                                              surface,
+                                                                                              naming_method);
+            EXPECT_EQ(expected.size(), metrics.catalog().tile_count(groups, lane, surface));
+        }
+    }
+    const model::metrics::error_metric& first = metrics.get<model::metrics::error_metric>()[0];
+    EXPECT_TRUE(metrics.catalog().contains(constants::Error, first.lane(), first.tile()));
+    EXPECT_FALSE(metrics.catalog().contains(constants::Extraction, first.lane(), first.tile()));
+
+    EXPECT_TRUE(metrics.is_catalog_current());
+    const size_t tile_count = metrics.catalog().tile_count(groups, 1);
+    metrics.get<model::metrics::error_metric>().insert(model::metrics::error_metric(1, 1199, 1, 0.5f, 0.0f));
+    EXPECT_FALSE(metrics.is_catalog_current());
+    EXPECT_EQ(tile_count, metrics.catalog().tile_count(groups, 1));
+    metrics.update_catalog();
+    EXPECT_TRUE(metrics.is_catalog_current());
+    EXPECT_EQ(tile_count+1, metrics.catalog().tile_count(groups, 1));
+    EXPECT_TRUE(metrics.catalog().contains(constants::Error, 1, 1199));
+
+    // A change to the records that keeps the same count is still detected
+    metrics.get<model::metrics::error_metric>().trim(metrics.get<model::metrics::error_metric>().size()-1);
+    metrics.get<model::metrics::error_metric>().insert(model::metrics::error_metric(1, 1198, 1, 0.5f, 0.0f));
+    EXPECT_FALSE(metrics.is_catalog_current());
+    metrics.update_catalog();
+    EXPECT_FALSE(metrics.catalog().contains(constants::Error, 1, 1199));
+    EXPECT_TRUE(metrics.catalog().contains(constants::Error, 1, 1198));
+}
+
+TEST(run_metric_test, validate_truncates_invalid_cycles_in_order)
+{
+    model::run::info run_info;
+    model::run::read_info reads[] = {model::run::read_info(1, 1, 36)};
+    hiseq4k_run_info::create_expected(run_info, util::to_vector(reads));
+
+    model::metrics::run_metrics metrics(run_info);
+    model::metric_base::metric_set<model::metrics::error_metric>& error_metrics =
+            metrics.get<model::metrics::error_metric>();
+    typedef model::metrics::error_metric::uint_t uint_t;
+    for (uint_t cycle = 1; cycle <= 40; ++cycle)
+    {
+        error_metrics.insert(model::metrics::error_metric(1, 1101, cycle, 1.0f, 0.0f));
+        error_metrics.insert(model::metrics::error_metric(2, 1102, cycle, 1.0f, 0.0f));
+    }
+    EXPECT_THROW(metrics.validate(), model::invalid_run_info_cycle_exception);
+    ASSERT_EQ(error_metrics.size(), 72u);
+    for (size_t i = 0; i < error_metrics.size(); ++i)
+    {
+        EXPECT_EQ(error_metrics[i].cycle(), i/2+1);
+        EXPECT_EQ(error_metrics[i].lane(), i%2+1);
+    }
+    EXPECT_NO_THROW(metrics.validate());
+
+    error_metrics.insert(model::metrics::error_metric(1, 1199, 1, 1.0f, 0.0f));
+    EXPECT_THROW(metrics.validate(), model::invalid_run_info_exception);
+}
+
 TYPED_TEST_P(run_metric_test, append_tiles)
 {
     typedef typename TestFixture::metric_set_t metric_set_t;
@@ -418,4 +418,33 @@ TEST(run_info_test, test_zero_lanes_per_section_count_exception)
     EXPECT_THROW(run_info.validate(), model::invalid_run_info_exception);
     EXPECT_EQ(2u, run_info.flowcell().surface_count());
     EXPECT_EQ(1u, run_info.flowcell().surface_list().size());
-}
\ No newline at end of file
+}
+TEST(run_info_test, test_tile_geometry_matches_tile_id)
+{
+    typedef run::flowcell_layout::str_vector_t str_vector_t;
+    const constants::tile_naming_method methods[] = {constants::FourDigit, constants::FiveDigit};
+    for(size_t m=0;m<util::length_of(methods);++m)
+    {
+        const constants::tile_naming_method method = methods[m];
+        run::flowcell_layout layout(4, 2, 4, 12, 3, 2, str_vector_t(), constants::UnknownTileNamingMethod);
+        EXPECT_EQ(0u, layout.tile_geometry_count());
+        layout.set_naming_method(method);
+        EXPECT_EQ(method == constants::FiveDigit ? 2u*4u*9u*12u : 2u*4u*12u, layout.tile_geometry_count());
+
+        const ::uint32_t tiles[] = {1101, 2412, 1312, 2104, 11101, 21412, 12312, 13612, 22105, 1113, 0};
+        for(size_t i=0;i<util::length_of(tiles);++i)
+        {
+            const metric_base::base_metric metric(1, tiles[i]);
+            const run::tile_geometry geometry = layout.geometry(tiles[i]);
+            EXPECT_EQ(metric.surface(method), geometry.surface()) << tiles[i];
+            EXPECT_EQ(metric.swath(method), geometry.swath()) << tiles[i];
+            EXPECT_EQ(metric.section(method), geometry.section()) << tiles[i];
+            EXPECT_EQ(metric.number(method), geometry.number()) << tiles[i];
+            if(layout.tile_index(tiles[i]) == layout.tile_geometry_count()) continue;
+            EXPECT_EQ(metric.physical_location_index(method, 3, 12, 4, true),
+                      geometry.physical_location_index(true)) << tiles[i];
+            EXPECT_EQ(metric.physical_location_index(method, 3, 12, 4, false),
+                      geometry.physical_location_index(false)) << tiles[i];
+        }
+    }
+}
@@ -12,6 +12,8 @@
 #include <gtest/gtest.h>
 #include "interop/util/math.h"
 #include "interop/util/statistics.h"
+#include "interop/util/length_of.h"
+#include "interop/util/radix_sort.h"
 #include "interop/model/run_metrics.h"
 #include "src/tests/interop/metrics/inc/tile_metrics_test.h"
 
@@ -106,3 +108,64 @@ TEST(stat_test, standard_deviation_vec)
 }
 
 
+TEST(stat_test, mean_variance_matches_two_pass)
+{
+    const float tol = 1e-4f;
+    const float nan = std::numeric_limits<float>::quiet_NaN();
+    const float values[] = {1002.5f, 998.25f, 1001.0f, 1003.75f, 999.5f, 1000.0f};
+    std::vector<float> values_vec(values, values+util::length_of(values));
+    float mean_val = 0;
+    float variance_val = 0;
+    EXPECT_EQ(interop::util::mean_variance(values_vec.begin(), values_vec.end(), mean_val, variance_val,
+                                           interop::util::op::operator_none(), false), values_vec.size());
+    EXPECT_NEAR(mean_val, interop::util::mean<float>(values_vec.begin(), values_vec.end()), tol);
+    EXPECT_NEAR(variance_val, interop::util::variance<float>(values_vec.begin(), values_vec.end()), tol);
+
+    std::vector<float> nan_vec(values_vec);
+    nan_vec.insert(nan_vec.begin(), nan);
+    nan_vec.insert(nan_vec.begin()+3, nan);
+    float nan_mean_val = 0;
+    float nan_variance_val = 0;
+    EXPECT_EQ(interop::util::mean_variance(nan_vec.begin(), nan_vec.end(), nan_mean_val, nan_variance_val,
+                                           interop::util::op::operator_none(), true), values_vec.size());
+    EXPECT_NEAR(nan_mean_val, mean_val, tol);
+    EXPECT_NEAR(nan_variance_val, variance_val, tol);
+}
+
+TEST(stat_test, median_interpolated_select_matches_sort)
+{
+    const float values[] = {5.0f, 1.0f, 4.0f, 4.0f, 2.0f, 8.0f, 3.0f, 7.0f};
+    for (size_t n = 1; n <= util::length_of(values); ++n)
+    {
+        std::vector<float> sorted(values, values+n);
+        std::vector<float> selected(sorted);
+        EXPECT_EQ(interop::util::median_interpolated_select<float>(selected.begin(), selected.end()),
+                  interop::util::median_interpolated<float>(sorted.begin(), sorted.end())) << "n=" << n;
+    }
+}
+
+TEST(stat_test, radix_sort_matches_sort_by_id)
+{
+    typedef model::metric_base::metric_set<error_metric> error_metric_set;
+    typedef error_metric::uint_t uint_t;
+    error_metric_set shuffled;
+    for (uint_t cycle = 300; cycle > 0; --cycle)
+    {
+        for (uint_t lane = 1; lane <= 3; ++lane)
+        {
+            shuffled.insert(error_metric(4-lane, 2101+(cycle*7)%5, cycle, 1.0f, 0.0f));
+            shuffled.insert(error_metric(lane, 1101+(cycle*3)%4, cycle, 1.0f, 0.0f));
+        }
+    }
+    std::vector<error_metric> expected(shuffled.begin(), shuffled.end());
+    std::stable_sort(expected.begin(), expected.end());
+    const size_t thread_counts[] = {1, 2, 3, 8};
+    for (size_t t = 0; t < util::length_of(thread_counts); ++t)
+    {
+        error_metric_set actual(shuffled);
+        actual.sort(thread_counts[t]);
+        ASSERT_EQ(actual.size(), expected.size());
+        for (size_t i = 0; i < expected.size(); ++i)
+            EXPECT_EQ(actual[i].id(), expected[i].id()) << "thread_count=" << thread_counts[t] << " i=" << i;
+    }
+}